@@ -0,0 +1,198 @@
+#include <math.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+
+#include "calibration.h"
+#include "error.h"
+
+static const char *const TAG = "calibration";
+
+static esp_err_t calibration_compile_piecewise(calibration_t *cal) {
+    for (size_t i = 0; i + 1 < cal->n; ++i) {
+        int32_t dx = cal->x[i + 1] - cal->x[i];
+        ARG_CHECK(dx > 0, "duplicated raw value: %d", cal->x[i]);
+        cal->slope[i] = ((int64_t) (cal->y[i + 1] - cal->y[i]) << CALIBRATION_Q) / dx;
+    }
+    cal->slope[cal->n - 1] = 0;
+    cal->x_min = cal->x[0];
+    cal->x_max = cal->x[cal->n - 1];
+    return ESP_OK;
+}
+
+static esp_err_t calibration_fit_piecewise(const calibration_point_t *points, size_t n, calibration_t *cal) {
+    ARG_CHECK(n >= 2, "piecewise needs at least 2 points");
+
+    // Insertion sort by the raw value, there are at most CALIBRATION_MAX_POINTS.
+    for (size_t i = 0; i < n; ++i) {
+        size_t j = i;
+        while (j > 0 && cal->x[j - 1] > points[i].raw) {
+            cal->x[j] = cal->x[j - 1];
+            cal->y[j] = cal->y[j - 1];
+            j--;
+        }
+        cal->x[j] = points[i].raw;
+        cal->y[j] = CALIBRATION_FROM_FLOAT(points[i].value);
+    }
+    cal->n = n;
+    return calibration_compile_piecewise(cal);
+}
+
+// Solves the (degree + 1) normal equations with gaussian elimination and partial pivoting.
+static esp_err_t calibration_fit_polynomial(const calibration_point_t *points, size_t n, uint8_t degree,
+                                            calibration_t *cal) {
+    ARG_CHECK(degree >= 1 && degree <= CALIBRATION_MAX_DEGREE, "invalid degree: %d", degree);
+    ARG_CHECK(n > degree, "degree %d needs at least %d points", degree, degree + 1);
+
+    int32_t x_min = points[0].raw, x_max = points[0].raw;
+    for (size_t i = 1; i < n; ++i) {
+        x_min = points[i].raw < x_min ? points[i].raw : x_min;
+        x_max = points[i].raw > x_max ? points[i].raw : x_max;
+    }
+    ARG_CHECK(x_max > x_min, "points must span more than one raw value");
+
+    const size_t m = degree + 1;
+    double a[CALIBRATION_MAX_DEGREE + 1][CALIBRATION_MAX_DEGREE + 2] = {0};
+    for (size_t k = 0; k < n; ++k) {
+        double t = (double) (points[k].raw - x_min) / (x_max - x_min);
+        double pow_t[2 * CALIBRATION_MAX_DEGREE + 1];
+        pow_t[0] = 1.;
+        for (size_t i = 1; i < 2 * m - 1; ++i) {
+            pow_t[i] = pow_t[i - 1] * t;
+        }
+        for (size_t i = 0; i < m; ++i) {
+            for (size_t j = 0; j < m; ++j) {
+                a[i][j] += pow_t[i + j];
+            }
+            a[i][m] += pow_t[i] * points[k].value;
+        }
+    }
+    for (size_t col = 0; col < m; ++col) {
+        size_t pivot = col;
+        for (size_t row = col + 1; row < m; ++row) {
+            if (fabs(a[row][col]) > fabs(a[pivot][col])) {
+                pivot = row;
+            }
+        }
+        ARG_CHECK(fabs(a[pivot][col]) > 1e-12, "points are degenerate for degree %d", degree);
+        if (pivot != col) {
+            for (size_t j = 0; j <= m; ++j) {
+                double tmp = a[col][j];
+                a[col][j] = a[pivot][j];
+                a[pivot][j] = tmp;
+            }
+        }
+        for (size_t row = 0; row < m; ++row) {
+            if (row == col) {
+                continue;
+            }
+            double f = a[row][col] / a[col][col];
+            for (size_t j = col; j <= m; ++j) {
+                a[row][j] -= f * a[col][j];
+            }
+        }
+    }
+    for (size_t i = 0; i < m; ++i) {
+        double c = a[i][m] / a[i][i];
+        ARG_CHECK(fabs(c) < (double) (INT32_MAX >> CALIBRATION_Q), "coefficient %u out of range: %f", (unsigned int) i,
+                  c);
+        // Stored highest degree first for Horner's method.
+        cal->y[degree - i] = CALIBRATION_FROM_FLOAT(c);
+    }
+    cal->n = m;
+    cal->x_min = x_min;
+    cal->x_max = x_max;
+    cal->scale = ((int64_t) 1 << 32) / (x_max - x_min);
+    return ESP_OK;
+}
+
+esp_err_t calibration_fit(const calibration_point_t *points, size_t n, calibration_type_t type, uint8_t degree,
+                          calibration_t *cal) {
+    ARG_CHECK(points != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(cal != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(n <= CALIBRATION_MAX_POINTS, "too many points: %u", (unsigned int) n);
+
+    memset(cal, 0, sizeof(calibration_t));
+    cal->type = type;
+    if (type == CALIBRATION_TYPE_POLYNOMIAL) {
+        return calibration_fit_polynomial(points, n, degree, cal);
+    }
+    ARG_CHECK(type == CALIBRATION_TYPE_PIECEWISE, "calibration type: %d is not supported", type);
+    return calibration_fit_piecewise(points, n, cal);
+}
+
+esp_err_t calibration_from_polynomial(const double *coeff, size_t coeff_size, int32_t x_min, int32_t x_max,
+                                      size_t points, calibration_t *cal) {
+    ARG_CHECK(coeff != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(coeff_size > 0, ERR_PARAM_LE_ZERO);
+    ARG_CHECK(cal != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(x_max > x_min, "x_max must be > x_min");
+    ARG_CHECK(points >= 2 && points <= CALIBRATION_MAX_POINTS, "invalid number of points: %u",
+              (unsigned int) points);
+
+    memset(cal, 0, sizeof(calibration_t));
+    cal->type = CALIBRATION_TYPE_PIECEWISE;
+    cal->n = points;
+    for (size_t i = 0; i < points; ++i) {
+        int32_t x = x_min + (int32_t) (((int64_t) (x_max - x_min) * i) / (points - 1));
+        double y = 0;
+        for (size_t j = 0; j < coeff_size; ++j) {
+            y = y * x + coeff[j];
+        }
+        cal->x[i] = x;
+        cal->y[i] = CALIBRATION_FROM_FLOAT(y);
+    }
+    ESP_LOGD(TAG, "Tabulated %u coefficients into %u points over [%d, %d]", (unsigned int) coeff_size,
+             (unsigned int) points, x_min, x_max);
+    return calibration_compile_piecewise(cal);
+}
+
+int32_t calibration_eval(const calibration_t *cal, int32_t raw) {
+    if (cal->n == 0) {
+        return 0;
+    }
+    if (raw < cal->x_min) {
+        raw = cal->x_min;
+    } else if (raw > cal->x_max) {
+        raw = cal->x_max;
+    }
+    if (cal->type == CALIBRATION_TYPE_POLYNOMIAL) {
+        int64_t t = ((int64_t) (raw - cal->x_min) * cal->scale) >> (32 - CALIBRATION_Q);
+        int64_t acc = cal->y[0];
+        for (size_t i = 1; i < cal->n; ++i) {
+            acc = ((acc * t) >> CALIBRATION_Q) + cal->y[i];
+        }
+        return (int32_t) acc;
+    }
+    // Binary search for the segment [x[lo], x[lo + 1]] holding raw.
+    size_t lo = 0, hi = cal->n - 1;
+    while (hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if (cal->x[mid] <= raw) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return cal->y[lo] + (int32_t) ((cal->slope[lo] * (raw - cal->x[lo])) >> CALIBRATION_Q);
+}
+
+int32_t calibration_invert(const calibration_t *cal, int32_t value) {
+    if (cal->n == 0) {
+        return cal->x_min;
+    }
+    // Curves are monotonic over the calibrated range, bisect towards the raw value producing `value`.
+    int32_t lo = cal->x_min, hi = cal->x_max;
+    bool rising = calibration_eval(cal, hi) >= calibration_eval(cal, lo);
+    while (hi - lo > 1) {
+        int32_t mid = lo + (hi - lo) / 2;
+        if ((calibration_eval(cal, mid) < value) == rising) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
@@ -0,0 +1,54 @@
+#ifndef HYDROPONICS_CALIBRATION_CALIBRATION_H
+#define HYDROPONICS_CALIBRATION_CALIBRATION_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#include "esp_err.h"
+
+#define CALIBRATION_MAX_POINTS 16
+#define CALIBRATION_MAX_DEGREE 3
+#define CALIBRATION_Q          16 /*!< Fractional bits of the fixed point values. */
+
+#define CALIBRATION_FROM_FLOAT(v) ((int32_t) ((v) * (float) (1 << CALIBRATION_Q) + ((v) < 0 ? -0.5f : 0.5f)))
+#define CALIBRATION_TO_FLOAT(q)   ((float) (q) / (float) (1 << CALIBRATION_Q))
+
+typedef enum {
+    CALIBRATION_TYPE_PIECEWISE = 0,  /*!< Linear interpolation between the sorted points. */
+    CALIBRATION_TYPE_POLYNOMIAL = 1, /*!< Least squares polynomial over the normalized range of the points. */
+} calibration_type_t;
+
+typedef struct {
+    int32_t raw;
+    float value;
+} calibration_point_t;
+
+/*
+ * A compiled curve, evaluated with integer math only. Piecewise curves keep the points and the Q16 slope of every
+ * segment, polynomials keep Q16 coefficients (highest degree first) over t = (raw - x_min) / (x_max - x_min).
+ */
+typedef struct {
+    calibration_type_t type;
+    size_t n;
+    int32_t x[CALIBRATION_MAX_POINTS];
+    int32_t y[CALIBRATION_MAX_POINTS];
+    int64_t slope[CALIBRATION_MAX_POINTS];
+    int32_t x_min;
+    int32_t x_max;
+    int64_t scale;                         /*!< Q32 reciprocal of (x_max - x_min). */
+} calibration_t;
+
+esp_err_t calibration_fit(const calibration_point_t *points, size_t n, calibration_type_t type, uint8_t degree,
+                          calibration_t *cal);
+
+// Tabulates a legacy floating point polynomial (highest degree first) into a piecewise curve over [x_min, x_max].
+esp_err_t calibration_from_polynomial(const double *coeff, size_t coeff_size, int32_t x_min, int32_t x_max,
+                                      size_t points, calibration_t *cal);
+
+// Returns the calibrated value in Q16. Inputs outside of the calibrated range are clamped.
+int32_t calibration_eval(const calibration_t *cal, int32_t raw);
+
+// Returns the raw input closest to the Q16 `value`, assumes the curve is monotonic. Mostly useful to simulate sensors.
+int32_t calibration_invert(const calibration_t *cal, int32_t value);
+
+#endif //HYDROPONICS_CALIBRATION_CALIBRATION_H
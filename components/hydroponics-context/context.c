@@ -2,9 +2,30 @@
 #include "freertos/event_groups.h"
 
 #include "context.h"
+#include "context_config.h"
+#include "crashlog.h"
 #include "error.h"
 #include "utils.h"
 
+// Only the state changes land in the crash log, the sensor updates would push them out of its few slots. The last
+// ones are reported after a panic or a watchdog reset.
+#define CONTEXT_CRASHLOG_EVENTS (CONTEXT_EVENT_NETWORK | CONTEXT_EVENT_NETWORK_ERROR | CONTEXT_EVENT_TIME | \
+                                 CONTEXT_EVENT_BASE_CONFIG | CONTEXT_EVENT_CONFIG | CONTEXT_EVENT_IOT)
+
+static void context_set_bits(context_t *context, EventBits_t bits) {
+    if (bits & CONTEXT_CRASHLOG_EVENTS) {
+        crashlog_event(bits & CONTEXT_CRASHLOG_EVENTS, true);
+    }
+    xEventGroupSetBits(context->event_group, bits);
+}
+
+static void context_clear_bits(context_t *context, EventBits_t bits) {
+    if (bits & CONTEXT_CRASHLOG_EVENTS) {
+        crashlog_event(bits & CONTEXT_CRASHLOG_EVENTS, false);
+    }
+    xEventGroupClearBits(context->event_group, bits);
+}
+
 #define context_set(p, v, f) do {                    \
       if ((p) != (v)) {                              \
         (p) = (v);                                   \
@@ -15,15 +36,15 @@
 #define context_set_single(c, p, v, f) do {          \
       if ((p) != (v)) {                              \
         (p) = (v);                                   \
-        xEventGroupSetBits((c)->event_group, (f));   \
+        context_set_bits((c), (f));                  \
       }                                              \
     } while (0)
 
 #define context_set_flags(c, v, f) do {              \
       if (v) {                                       \
-        xEventGroupSetBits((c)->event_group, (f));   \
+        context_set_bits((c), (f));                  \
       } else {                                       \
-        xEventGroupClearBits((c)->event_group, (f)); \
+        context_clear_bits((c), (f));                \
       }                                              \
     } while (0)
 
@@ -76,7 +97,7 @@ esp_err_t context_set_temp_indoor_humidity_pressure(context_t *context, float te
     context_set(context->sensors.pressure, pressure, CONTEXT_EVENT_PRESSURE);
     context_unlock(context);
 
-    if (bitsToSet) xEventGroupSetBits(context->event_group, bitsToSet);
+    if (bitsToSet) context_set_bits(context, bitsToSet);
     return ESP_OK;
 }
 
@@ -109,7 +130,7 @@ esp_err_t context_set_ec_target(context_t *context, int tank, float target_min,
     context_set(context->sensors.ec[tank].target_max, target_max, CONTEXT_EVENT_EC);
     context_unlock(context);
 
-    if (bitsToSet) xEventGroupSetBits(context->event_group, bitsToSet);
+    if (bitsToSet) context_set_bits(context, bitsToSet);
     return ESP_OK;
 }
 
@@ -130,7 +151,7 @@ esp_err_t context_set_ph_target(context_t *context, int tank, float target_min,
     context_set(context->sensors.ph[tank].target_max, target_max, CONTEXT_EVENT_PH);
     context_unlock(context);
 
-    if (bitsToSet) xEventGroupSetBits(context->event_group, bitsToSet);
+    if (bitsToSet) context_set_bits(context, bitsToSet);
     return ESP_OK;
 }
 
@@ -150,7 +171,7 @@ esp_err_t context_set_rotary(context_t *context, rotary_encoder_state_t state) {
     context_set(context->inputs.rotary.state.direction, state.direction, CONTEXT_EVENT_ROTARY);
     context_unlock(context);
 
-    if (bitsToSet) xEventGroupSetBits(context->event_group, bitsToSet);
+    if (bitsToSet) context_set_bits(context, bitsToSet);
     return ESP_OK;
 }
 
@@ -174,7 +195,7 @@ esp_err_t context_set_network_error(context_t *context, bool error) {
 
 esp_err_t context_set_time_updated(context_t *context) {
     ARG_CHECK(context != NULL, ERR_PARAM_NULL);
-    xEventGroupSetBits(context->event_group, CONTEXT_EVENT_TIME);
+    context_set_bits(context, CONTEXT_EVENT_TIME);
     return ESP_OK;
 }
 
@@ -196,7 +217,7 @@ esp_err_t context_set_base_config(context_t *context, const char *device_id, con
     context_set(context->config.syslog_port, CONFIG_ESP_SYSLOG_PORT, CONTEXT_EVENT_BASE_CONFIG);
     context_unlock(context);
 
-    if (bitsToSet) xEventGroupSetBits(context->event_group, bitsToSet);
+    if (bitsToSet) context_set_bits(context, bitsToSet);
     return ESP_OK;
 }
 
@@ -208,23 +229,38 @@ esp_err_t context_set_config(context_t *context, const Hydroponics__Config *conf
         context_unlock(context);
         return ESP_OK;
     }
-    if (context->config.config != NULL) {
-        hydroponics__config__free_unpacked((Hydroponics__Config *) context->config.config, NULL);
-        context->config.config = NULL;
-    }
+    const Hydroponics__Config *previous = context->config.config;
     context->config.config = config;
     context->config.config_version++;
+    context->config.packed = NULL;
+    context->config.packed_size = 0;
+    if (config != NULL && !context_config_share(config)) {
+        ESP_LOGW(TAG, "Too many configs in use, subscribers get their own copy");
+    }
     bool clear = context->config.config == NULL;
     context_unlock(context);
+    // Subscribers still holding the previous config keep it until they release it.
+    context_config_release(previous);
 
     if (clear) {
-        xEventGroupClearBits(context->event_group, CONTEXT_EVENT_CONFIG);
+        context_clear_bits(context, CONTEXT_EVENT_CONFIG);
     } else {
-        xEventGroupSetBits(context->event_group, CONTEXT_EVENT_CONFIG);
+        context_set_bits(context, CONTEXT_EVENT_CONFIG);
     }
     return ESP_OK;
 }
 
+esp_err_t context_set_config_source(context_t *context, const uint8_t *packed, size_t size) {
+    ARG_CHECK(context != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(packed != NULL || size == 0, ERR_PARAM_NULL);
+
+    context_lock(context);
+    context->config.packed = context->config.config != NULL ? packed : NULL;
+    context->config.packed_size = context->config.config != NULL ? size : 0;
+    context_unlock(context);
+    return ESP_OK;
+}
+
 esp_err_t context_get_config(context_t *context, const Hydroponics__Config **config) {
     ARG_CHECK(context != NULL, ERR_PARAM_NULL);
     ARG_CHECK(config != NULL, ERR_PARAM_NULL);
@@ -236,6 +272,15 @@ esp_err_t context_get_config(context_t *context, const Hydroponics__Config **con
     if (context->config.config == NULL) {
         goto fail;
     }
+    if (context_config_acquire(context->config.config)) {
+        *config = context->config.config;
+        goto fail;
+    }
+    if (context->config.packed != NULL) {
+        // Skips packing the live config again.
+        *config = hydroponics__config__unpack(NULL, context->config.packed_size, context->config.packed);
+        goto fail;
+    }
     size_t size = hydroponics__config__get_packed_size(context->config.config);
     if (size <= 0) {
         goto fail;
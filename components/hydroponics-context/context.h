@@ -8,6 +8,7 @@
 #include "esp_bit_defs.h"
 
 #include "config.pb-c.h"
+#include "context_config.h"
 #include "rotary_encoder.h"
 
 #define CONTEXT_UNKNOWN_VALUE INT16_MIN
@@ -49,6 +50,8 @@ typedef struct {
         uint16_t syslog_port;
         const Hydroponics__Config *config;
         uint32_t config_version;
+        const uint8_t *packed;   /*!< Packed `config`, e.g. mapped from flash. NULL when unknown. */
+        size_t packed_size;
     } config;
 
     struct {
@@ -141,6 +144,11 @@ esp_err_t context_set_base_config(context_t *context, const char *device_id, con
 
 esp_err_t context_set_config(context_t *context, const Hydroponics__Config *config);
 
+// Any new config clears the packed source, set it again after context_set_config. The data must outlive it.
+esp_err_t context_set_config_source(context_t *context, const uint8_t *packed, size_t size);
+
+// Returns a read-only reference to the current config, or NULL when there is none. Release it with
+// `context_config_release`, every subscriber shares the same instance.
 esp_err_t context_get_config(context_t *context, const Hydroponics__Config **config);
 
 #endif //HYDROPONICS_CONTEXT_H
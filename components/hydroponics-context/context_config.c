@@ -0,0 +1,76 @@
+#include "freertos/FreeRTOS.h"
+
+#include "context_config.h"
+
+typedef struct {
+    const Hydroponics__Config *config;
+    uint32_t refs;
+} context_config_ref_t;
+
+static context_config_ref_t refs[CONTEXT_CONFIG_SHARED] = {0};
+static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+static context_config_ref_t *context_config_find(const Hydroponics__Config *config) {
+    for (size_t i = 0; i < CONTEXT_CONFIG_SHARED; ++i) {
+        if (refs[i].config == config) {
+            return &refs[i];
+        }
+    }
+    return NULL;
+}
+
+bool context_config_share(const Hydroponics__Config *config) {
+    if (config == NULL) {
+        return false;
+    }
+    portENTER_CRITICAL(&spinlock);
+    context_config_ref_t *ref = context_config_find(NULL);
+    if (ref != NULL) {
+        ref->config = config;
+        ref->refs = 1;
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return ref != NULL;
+}
+
+bool context_config_acquire(const Hydroponics__Config *config) {
+    if (config == NULL) {
+        return false;
+    }
+    portENTER_CRITICAL(&spinlock);
+    context_config_ref_t *ref = context_config_find(config);
+    if (ref != NULL) {
+        ref->refs++;
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return ref != NULL;
+}
+
+void context_config_release(const Hydroponics__Config *config) {
+    if (config == NULL) {
+        return;
+    }
+    bool last = true;
+    portENTER_CRITICAL(&spinlock);
+    context_config_ref_t *ref = context_config_find(config);
+    if (ref != NULL && --ref->refs > 0) {
+        last = false;
+    } else if (ref != NULL) {
+        ref->config = NULL;
+    }
+    portEXIT_CRITICAL(&spinlock);
+    // Freed outside of the critical section, a private copy is always the last reference.
+    if (last) {
+        hydroponics__config__free_unpacked((Hydroponics__Config *) config, NULL);
+    }
+}
+
+size_t context_config_shared(void) {
+    size_t n = 0;
+    portENTER_CRITICAL(&spinlock);
+    for (size_t i = 0; i < CONTEXT_CONFIG_SHARED; ++i) {
+        n += refs[i].config != NULL;
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return n;
+}
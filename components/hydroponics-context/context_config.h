@@ -0,0 +1,27 @@
+#ifndef HYDROPONICS_CONTEXT_CONTEXT_CONFIG_H
+#define HYDROPONICS_CONTEXT_CONTEXT_CONFIG_H
+
+#include <stdbool.h>
+
+#include "config.pb-c.h"
+
+#define CONTEXT_CONFIG_SHARED 8 // The current config and the older ones subscribers did not release yet.
+
+/*
+ * Unpacked configs shared read-only between the context and its subscribers, freed with the last reference. A config
+ * that does not fit the table is not shared: every reference to it is a private copy freed on release.
+ */
+
+// Takes ownership of `config` with one reference. Returns false when the table is full.
+bool context_config_share(const Hydroponics__Config *config);
+
+// Adds a reference to a shared config. Returns false when `config` is not shared.
+bool context_config_acquire(const Hydroponics__Config *config);
+
+// Drops a reference taken by `context_config_share`, `context_config_acquire` or `context_get_config`.
+void context_config_release(const Hydroponics__Config *config);
+
+// Number of configs currently shared.
+size_t context_config_shared(void);
+
+#endif //HYDROPONICS_CONTEXT_CONTEXT_CONFIG_H
@@ -0,0 +1,166 @@
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include "esp_attr.h"
+#include "esp_log.h"
+
+#include "crashlog.h"
+#include "error.h"
+
+#define CRASHLOG_MAGIC 0x48434c47 // "HCLG"
+
+typedef struct {
+    uint32_t magic;
+    uint32_t boot_count;
+    crashlog_line_t lines[CONFIG_ESP_CRASHLOG_LINES];
+    crashlog_event_t events[CONFIG_ESP_CRASHLOG_EVENTS];
+} crashlog_rtc_t;
+
+_Static_assert(sizeof(crashlog_line_t) == 128, "crashlog_line_t must stay 128 bytes");
+
+static const char *const TAG = "crashlog";
+
+// Kept in RTC slow memory, it survives panics and watchdog resets. Not touched by the bootloader, so garbage after a
+// power on.
+static RTC_NOINIT_ATTR crashlog_rtc_t rtc;
+
+// The slot counters stay in DRAM, compare and swap does not work on RTC memory. Slots are written in the order they
+// were handed out, the sequence number tells it after a reset.
+static _Atomic uint32_t next_line = 0;
+static _Atomic uint32_t next_event = 0;
+static _Atomic bool line_busy[CONFIG_ESP_CRASHLOG_LINES] = {0};
+static _Atomic bool event_busy[CONFIG_ESP_CRASHLOG_EVENTS] = {0};
+static bool ready = false;
+static crashlog_previous_t *previous = NULL;
+
+// Both slot types start with the sequence number.
+static int crashlog_by_sequence(const void *a, const void *b) {
+    uint32_t sa = *(const uint32_t *) a;
+    uint32_t sb = *(const uint32_t *) b;
+    return sa < sb ? -1 : sa > sb ? 1 : 0;
+}
+
+static esp_err_t crashlog_collect(crashlog_previous_t *prev) {
+    prev->lines = calloc(CONFIG_ESP_CRASHLOG_LINES, sizeof(crashlog_line_t));
+    CHECK_NO_MEM(prev->lines);
+    for (int i = 0; i < CONFIG_ESP_CRASHLOG_LINES; ++i) {
+        const crashlog_line_t *line = &rtc.lines[i];
+        // Half written slots still have a 0 sequence number.
+        if (line->sequence != 0 && line->len <= CRASHLOG_LINE_SIZE) {
+            prev->lines[prev->n_lines++] = *line;
+        }
+    }
+    qsort(prev->lines, prev->n_lines, sizeof(crashlog_line_t), crashlog_by_sequence);
+
+    prev->events = calloc(CONFIG_ESP_CRASHLOG_EVENTS, sizeof(crashlog_event_t));
+    CHECK_NO_MEM(prev->events);
+    for (int i = 0; i < CONFIG_ESP_CRASHLOG_EVENTS; ++i) {
+        if (rtc.events[i].sequence != 0) {
+            prev->events[prev->n_events++] = rtc.events[i];
+        }
+    }
+    qsort(prev->events, prev->n_events, sizeof(crashlog_event_t), crashlog_by_sequence);
+    return ESP_OK;
+}
+
+esp_err_t crashlog_init(void) {
+    if (ready) {
+        return ESP_OK;
+    }
+    previous = calloc(1, sizeof(crashlog_previous_t));
+    CHECK_NO_MEM(previous);
+    previous->reason = esp_reset_reason();
+    if (rtc.magic == CRASHLOG_MAGIC && previous->reason != ESP_RST_POWERON) {
+        previous->boot_count = rtc.boot_count;
+        ESP_ERROR_CHECK(crashlog_collect(previous));
+    }
+    memset(&rtc, 0, sizeof(rtc));
+    rtc.magic = CRASHLOG_MAGIC;
+    rtc.boot_count = previous->boot_count + 1;
+    ready = true;
+    return ESP_OK;
+}
+
+void crashlog_append(uint8_t pri, const void *data, size_t len) {
+    if (!ready) {
+        return;
+    }
+    const uint32_t n = atomic_fetch_add_explicit(&next_line, 1, memory_order_relaxed);
+    const uint32_t slot = n % CONFIG_ESP_CRASHLOG_LINES;
+    // Still written by a line that took it a lap ago, e.g. from a preempted task. Skip this one rather than mix both.
+    if (atomic_exchange_explicit(&line_busy[slot], true, memory_order_acquire)) {
+        return;
+    }
+    crashlog_line_t *line = &rtc.lines[slot];
+    line->sequence = 0;
+    atomic_thread_fence(memory_order_release);
+    line->len = MIN(len, CRASHLOG_LINE_SIZE);
+    line->pri = pri;
+    memcpy(line->data, data, line->len);
+    atomic_thread_fence(memory_order_release);
+    line->sequence = n + 1;
+    atomic_store_explicit(&line_busy[slot], false, memory_order_release);
+}
+
+void crashlog_event(uint32_t bits, bool set) {
+    if (!ready) {
+        return;
+    }
+    const uint32_t n = atomic_fetch_add_explicit(&next_event, 1, memory_order_relaxed);
+    const uint32_t slot = n % CONFIG_ESP_CRASHLOG_EVENTS;
+    if (atomic_exchange_explicit(&event_busy[slot], true, memory_order_acquire)) {
+        return;
+    }
+    crashlog_event_t *event = &rtc.events[slot];
+    event->sequence = 0;
+    atomic_thread_fence(memory_order_release);
+    event->timestamp_ms = esp_log_timestamp();
+    event->bits = bits | (set ? CRASHLOG_EVENT_SET : 0);
+    atomic_thread_fence(memory_order_release);
+    event->sequence = n + 1;
+    atomic_store_explicit(&event_busy[slot], false, memory_order_release);
+}
+
+const crashlog_previous_t *crashlog_previous(void) {
+    return previous;
+}
+
+void crashlog_free_previous(void) {
+    if (previous == NULL) {
+        return;
+    }
+    free(previous->lines);
+    free(previous->events);
+    free(previous);
+    previous = NULL;
+}
+
+const char *crashlog_reason_name(esp_reset_reason_t reason) {
+    switch (reason) {
+        case ESP_RST_POWERON:
+            return "power on";
+        case ESP_RST_EXT:
+            return "external pin";
+        case ESP_RST_SW:
+            return "software";
+        case ESP_RST_PANIC:
+            return "panic";
+        case ESP_RST_INT_WDT:
+            return "interrupt watchdog";
+        case ESP_RST_TASK_WDT:
+            return "task watchdog";
+        case ESP_RST_WDT:
+            return "watchdog";
+        case ESP_RST_DEEPSLEEP:
+            return "deep sleep";
+        case ESP_RST_BROWNOUT:
+            return "brownout";
+        case ESP_RST_SDIO:
+            return "sdio";
+        case ESP_RST_UNKNOWN:
+        default:
+            return "unknown";
+    }
+}
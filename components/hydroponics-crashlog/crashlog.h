@@ -0,0 +1,55 @@
+#ifndef HYDROPONICS_CRASHLOG_CRASHLOG_H
+#define HYDROPONICS_CRASHLOG_CRASHLOG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_system.h"
+
+#define CRASHLOG_LINE_SIZE 120      // Bytes of a line kept, the slot takes 128.
+#define CRASHLOG_EVENT_SET 0x80000000 // Event group bits stop at 24, the top bit tells a set from a clear.
+
+typedef struct {
+    uint32_t sequence;              /*!< 0 while the slot is free or being written. */
+    uint16_t len;
+    uint8_t pri;                    /*!< Syslog PRI of the line. */
+    uint8_t reserved;
+    uint8_t data[CRASHLOG_LINE_SIZE];
+} crashlog_line_t;
+
+typedef struct {
+    uint32_t sequence;
+    uint32_t timestamp_ms;          /*!< esp_log_timestamp() when it happened. */
+    uint32_t bits;                  /*!< Context event bits, CRASHLOG_EVENT_SET when they were set. */
+} crashlog_event_t;
+
+// What the previous boot left in RTC memory, oldest first. Empty after a power on.
+typedef struct {
+    esp_reset_reason_t reason;
+    uint32_t boot_count;
+    size_t n_lines;
+    crashlog_line_t *lines;
+    size_t n_events;
+    crashlog_event_t *events;
+} crashlog_previous_t;
+
+// Takes the lines and events of the previous boot out of RTC memory and starts recording this one. Must run before
+// anything logs.
+esp_err_t crashlog_init(void);
+
+// Keeps the line in RTC memory, overwriting the oldest. Lock free and safe on both cores, called for every line. A line
+// that would overwrite one still being written is skipped.
+void crashlog_append(uint8_t pri, const void *data, size_t len);
+
+void crashlog_event(uint32_t bits, bool set);
+
+// NULL before crashlog_init() or once freed.
+const crashlog_previous_t *crashlog_previous(void);
+
+void crashlog_free_previous(void);
+
+const char *crashlog_reason_name(esp_reset_reason_t reason);
+
+#endif //HYDROPONICS_CRASHLOG_CRASHLOG_H
@@ -1,13 +1,16 @@
 #include <errno.h>
-#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/param.h>
 #include <string.h>
 #include <time.h>
-#include <sys/queue.h>
 
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
+#include "freertos/semphr.h"
 
 #include "esp_err.h"
+#include "esp_timer.h"
 
 #include "ccronexpr.h"
 #include "timespec.h"
@@ -20,45 +23,109 @@
 #define INVALID_INSTANT ((time_t) -1) // Invalid time defined in time.h.
 #define NS_TO_MS 1000000L
 
+#define CRON_MAX_JOBS CONFIG_ESP_CRON_MAX_JOBS
+#define CRON_NOT_SCHEDULED (-1)
+#define CRON_WORKERS CONFIG_ESP_CRON_WORKERS
+#define CRON_DISPATCH_QUEUE_SIZE 16
+#define CRON_LAG_WARN_MS 500
+#define CRON_CLOCK_CHECK_MS 60000   // Wake up at least this often to notice clock steps.
+#define CRON_CLOCK_STEP_US 1000000  // Offset changes above this are treated as a clock step.
+#define CRON_MISFIRE_TOLERANCE_S 1  // Occurrences passed by less than this after a step still run, without a misfire.
+#define CRON_DST_SHIFT_S 3600
+#define CRON_MISFIRE_GRACE_S CONFIG_ESP_CRON_MISFIRE_GRACE_S
+#define US_PER_S 1000000LL
+#define CRON_TIME_POLL_MS 1000      // How often to check if the time was set while waiting for it.
+
+// A handle packs the pool slot (+1, so it is never INVALID_CRON_HANDLE) and a generation counter that detects stale
+// handles after a slot has been recycled.
+#define CRON_SLOT_BITS 16
+#define CRON_SLOT_MASK ((1U << CRON_SLOT_BITS) - 1)
+#define CRON_HANDLE(generation, slot) ((cron_handle_t) (((uint32_t) (generation) << CRON_SLOT_BITS) | ((slot) + 1)))
+#define CRON_HANDLE_SLOT(handle) ((int) ((handle) & CRON_SLOT_MASK) - 1)
+
 typedef struct {
     cron_handle_t handle;
-    const char name[32];
-    const char expression[64];
+    char name[32];
+    char group[16];
+    char expression[64];
     cron_callback_t callback;
     void *data;
     cron_expr expr;
     struct timespec next_execution;
 } cron_job_t;
 
+typedef struct {
+    cron_job_t job;
+    cron_priority_t priority;
+    cron_misfire_t misfire;
+    int64_t deadline_us;  /*!< next_execution mapped to the monotonic clock, the heap is ordered by it. */
+    time_t last_fired;    /*!< Last wall clock instant dispatched, never repeated if the clock goes back. */
+    bool relative;        /*!< Scheduled with a delay, the deadline is kept when the wall clock changes. */
+    bool skip;            /*!< Missed oneshot that must be dropped instead of run. */
+    bool pending;         /*!< Allocated by a caller but not yet seen by the cron task. */
+    cron_stats_t stats;
+    uint16_t generation;
+    int heap_index;  /*!< Position inside the heap or CRON_NOT_SCHEDULED. */
+    bool used;
+    bool running;    /*!< Queued to or executing on a worker, guarded by the spinlock. */
+    bool deleted;    /*!< Deleted while running, the worker skips the callback if not started and releases the slot. */
+    bool finished;   /*!< Oneshot handed to a worker, the worker releases the slot when done. */
+} cron_entry_t;
+
+typedef struct {
+    cron_entry_t *entry;
+    struct timespec scheduled;
+} cron_dispatch_t;
+
 typedef enum {
     CRON_OP_ADD = 0,
     CRON_OP_REMOVE = 1,
     CRON_OP_DUMP = 2,
+    CRON_OP_TIME = 3,
+    CRON_OP_REPLACE = 4,
 } cron_op_type_t;
 
+typedef struct {
+    cron_info_t *infos;
+    size_t max;
+    size_t count;
+    StaticSemaphore_t done_buf;
+    SemaphoreHandle_t done;  /*!< Given by the cron task, task notifications are left to the callers. */
+} cron_dump_t;
+
+typedef struct {
+    const char *group;
+    const cron_handle_t *handles;
+    size_t n;
+    StaticSemaphore_t done_buf;
+    SemaphoreHandle_t done;
+} cron_replace_t;
+
 typedef struct {
     cron_op_type_t type;
     union {
-        struct {
-            cron_job_t job;
-        } add;
-        struct {
-            cron_handle_t handle;
-        } remove;
+        cron_handle_t handle;
+        cron_dump_t *dump;
+        cron_replace_t *replace;
     };
 } cron_op_t;
 
-typedef struct cron_job_entry {
-    cron_job_t job;
-    TAILQ_ENTRY(cron_job_entry) next;
-} cron_job_entry_t;
-
-typedef TAILQ_HEAD(cron_job_head, cron_job_entry) cron_job_head_t;
-
 static const char *TAG = "cron";
-static atomic_uint id = 1;
 static QueueHandle_t queue;
-static cron_job_head_t cron_job_head;
+static QueueHandle_t dispatch[CRON_PRIORITY_MAX];
+static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+// Preallocated entry pool, free slot stack and min-heap ordered by next_execution. The pool and the free stack are
+// shared with the callers (guarded by the spinlock), the heap is only touched by the cron task.
+static cron_entry_t *entries;
+static uint16_t *free_slots;
+static size_t free_size;
+static cron_entry_t **heap;
+static size_t heap_size;
+// Wall clock minus monotonic clock, in microseconds. Recomputed when a clock step is detected.
+static int64_t offset_us;
+// Jobs stay parked until the time has been set.
+static bool time_valid;
 
 static struct timespec cron_now(void) {
     struct timespec now = {0};
@@ -69,30 +136,142 @@ static struct timespec cron_now(void) {
     return now;
 }
 
-static TickType_t cron_next_delay(void) {
-    if (TAILQ_EMPTY(&cron_job_head)) {
-        return portMAX_DELAY;
+static inline int64_t cron_timespec_to_us(struct timespec ts) {
+    return (int64_t) ts.tv_sec * US_PER_S + ts.tv_nsec / 1000;
+}
+
+static inline struct timespec cron_timespec_from_us(int64_t us) {
+    struct timespec ts = {.tv_sec = (time_t) (us / US_PER_S), .tv_nsec = (long) (us % US_PER_S) * 1000};
+    return ts;
+}
+
+static inline int64_t cron_clock_offset(void) {
+    return cron_timespec_to_us(cron_now()) - esp_timer_get_time();
+}
+
+static cron_entry_t *cron_entry_alloc(void) {
+    cron_entry_t *entry = NULL;
+    portENTER_CRITICAL(&spinlock);
+    if (free_size > 0) {
+        entry = &entries[free_slots[--free_size]];
+        entry->generation++;
+        entry->used = true;
+        entry->running = false;
+        entry->deleted = false;
+        entry->finished = false;
+        entry->heap_index = CRON_NOT_SCHEDULED;
+        entry->priority = CRON_PRIORITY_NORMAL;
+        entry->misfire = CRON_MISFIRE_FIRE_ONCE;
+        entry->deadline_us = 0;
+        entry->last_fired = INVALID_INSTANT;
+        entry->relative = false;
+        entry->skip = false;
+        entry->pending = true;
+        memset(&entry->stats, 0, sizeof(cron_stats_t));
     }
-    cron_job_entry_t *first = TAILQ_FIRST(&cron_job_head);
-    if (first == NULL || first->job.next_execution.tv_sec == INVALID_INSTANT) {
-        return portMAX_DELAY;
+    portEXIT_CRITICAL(&spinlock);
+    return entry;
+}
+
+static void cron_entry_release_locked(cron_entry_t *entry) {
+    entry->used = false;
+    free_slots[free_size++] = (uint16_t) (entry - entries);
+}
+
+static void cron_entry_release(cron_entry_t *entry) {
+    portENTER_CRITICAL(&spinlock);
+    cron_entry_release_locked(entry);
+    portEXIT_CRITICAL(&spinlock);
+}
+
+static cron_entry_t *cron_entry_find(cron_handle_t handle) {
+    int slot = CRON_HANDLE_SLOT(handle);
+    if (slot < 0 || slot >= CRON_MAX_JOBS) {
+        return NULL;
     }
-    struct timespec now = {0};
-    if (clock_gettime(CLOCK_REALTIME, &now) != 0) {
+    cron_entry_t *entry = &entries[slot];
+    return entry->used && !entry->deleted && entry->job.handle == handle ? entry : NULL;
+}
+
+static inline bool cron_heap_less(size_t a, size_t b) {
+    return heap[a]->deadline_us < heap[b]->deadline_us;
+}
+
+static inline void cron_heap_swap(size_t a, size_t b) {
+    cron_entry_t *tmp = heap[a];
+    heap[a] = heap[b];
+    heap[b] = tmp;
+    heap[a]->heap_index = (int) a;
+    heap[b]->heap_index = (int) b;
+}
+
+static void cron_heap_sift_up(size_t i) {
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!cron_heap_less(i, parent)) {
+            break;
+        }
+        cron_heap_swap(i, parent);
+        i = parent;
+    }
+}
+
+static void cron_heap_sift_down(size_t i) {
+    while (true) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t smallest = i;
+        if (left < heap_size && cron_heap_less(left, smallest)) {
+            smallest = left;
+        }
+        if (right < heap_size && cron_heap_less(right, smallest)) {
+            smallest = right;
+        }
+        if (smallest == i) {
+            break;
+        }
+        cron_heap_swap(i, smallest);
+        i = smallest;
+    }
+}
+
+static void cron_heap_push(cron_entry_t *entry) {
+    entry->heap_index = (int) heap_size;
+    heap[heap_size++] = entry;
+    cron_heap_sift_up(entry->heap_index);
+}
+
+static void cron_heap_remove(cron_entry_t *entry) {
+    if (entry->heap_index == CRON_NOT_SCHEDULED) {
+        return;
+    }
+    size_t i = entry->heap_index;
+    entry->heap_index = CRON_NOT_SCHEDULED;
+    if (i == --heap_size) {
+        return;
+    }
+    heap[i] = heap[heap_size];
+    heap[i]->heap_index = (int) i;
+    cron_heap_sift_up(i);
+    cron_heap_sift_down(heap[i]->heap_index);
+}
+
+static TickType_t cron_next_delay(void) {
+    if (heap_size == 0) {
         return portMAX_DELAY;
     }
-    struct timespec sub = timespec_sub(first->job.next_execution, now);
-    long delay_ms = timespec_to_ms(sub);
-    if (delay_ms <= 0) {
+    cron_entry_t *first = heap[0];
+    int64_t delay_us = first->deadline_us - esp_timer_get_time();
+    if (delay_us <= 0) {
         // We passed the deadline so run as many as possible.
         return 0;
     }
     // Round up the delay to the nearest 'tick' to avoid undershooting.
+    long delay_ms = (long) MIN((delay_us + 999) / 1000, CRON_CLOCK_CHECK_MS);
     long tick_ms = portTICK_PERIOD_MS;
     long round_up_delay_ms = ((delay_ms + tick_ms - 1) / tick_ms) * tick_ms;
-    ESP_LOGD(TAG, "cron_next_delay will wait %ld ms (next: %lds.%ldms, noew: %lds.%ldms)", round_up_delay_ms,
-             first->job.next_execution.tv_sec, first->job.next_execution.tv_nsec / NS_TO_MS, now.tv_sec,
-             now.tv_nsec / NS_TO_MS);
+    ESP_LOGD(TAG, "cron_next_delay will wait %ld ms (next: %lds.%ldms)", round_up_delay_ms,
+             first->job.next_execution.tv_sec, first->job.next_execution.tv_nsec / NS_TO_MS);
     return pdMS_TO_TICKS(round_up_delay_ms);
 }
 
@@ -100,114 +279,361 @@ static inline bool cron_is_oneshot(cron_job_t *job) {
     return job->expression[0] == '\0';
 }
 
-static void cron_calculate_next(cron_job_t *job) {
-    if (cron_is_oneshot(job)) {
-        return;
+static inline int64_t cron_local_seconds(time_t t) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    return (((int64_t) tm.tm_year * 366 + tm.tm_yday) * 24 + tm.tm_hour) * 3600 + tm.tm_min * 60 + tm.tm_sec;
+}
+
+static inline bool cron_runs_every_hour(const cron_expr *expr) {
+    for (int h = 0; h < 24; ++h) {
+        if ((expr->hours[h / 8] & (1 << (h % 8))) == 0) {
+            return false;
+        }
     }
-    job->next_execution.tv_sec = cron_next(&job->expr, cron_now().tv_sec);
-    job->next_execution.tv_nsec = 0;
+    return true;
 }
 
-static esp_err_t cron_unschedule_job(cron_handle_t handle) {
-    ARG_CHECK(handle > INVALID_CRON_HANDLE, ERR_PARAM_LE_ZERO);
+static time_t cron_next_occurrence(cron_entry_t *entry, time_t from) {
+    cron_expr *expr = &entry->job.expr;
+    time_t next = cron_next(expr, from);
+    if (next == INVALID_INSTANT || entry->last_fired == INVALID_INSTANT || next - entry->last_fired > CRON_DST_SHIFT_S
+        || cron_runs_every_hour(expr)) {
+        return next;
+    }
+    // The local time repeats when DST ends. Jobs pinned to some hours only run in the first pass, like on a wall clock.
+    int64_t repeated = cron_local_seconds(entry->last_fired) - cron_local_seconds(next);
+    return repeated >= 0 ? cron_next(expr, next + (time_t) repeated) : next;
+}
+
+static void cron_calculate_next(cron_entry_t *entry) {
+    cron_job_t *job = &entry->job;
+    if (entry->relative) {
+        job->next_execution = cron_timespec_from_us(entry->deadline_us + offset_us);
+        return;
+    }
+    if (!cron_is_oneshot(job)) {
+        // Never go back past the last run, otherwise the same occurrence fires twice when the clock is stepped back.
+        time_t from = MAX(cron_now().tv_sec, entry->last_fired);
+        job->next_execution.tv_sec = cron_next_occurrence(entry, from);
+        job->next_execution.tv_nsec = 0;
+    }
+    if (job->next_execution.tv_sec != INVALID_INSTANT) {
+        entry->deadline_us = cron_timespec_to_us(job->next_execution) - offset_us;
+    }
+}
 
-    cron_job_entry_t *e = NULL, *tmp = NULL;
-    TAILQ_FOREACH_SAFE(e, &cron_job_head, next, tmp) {
-        if (e->job.handle == handle) {
-            TAILQ_REMOVE(&cron_job_head, e, next);
+static void cron_misfire(cron_entry_t *entry, struct timespec now) {
+    cron_job_t *job = &entry->job;
+    bool fire = false;
+    switch (entry->misfire) {
+        case CRON_MISFIRE_FIRE_ONCE:
+            fire = true;
+            break;
+        case CRON_MISFIRE_SKIP:
+        default:
+            break;
+        case CRON_MISFIRE_COALESCE: {
+            time_t latest = cron_is_oneshot(job) ? job->next_execution.tv_sec : cron_prev(&job->expr, now.tv_sec);
+            fire = latest != INVALID_INSTANT && now.tv_sec - latest <= CRON_MISFIRE_GRACE_S;
             break;
         }
     }
-    return ESP_OK;
+    entry->stats.misfires++;
+    ESP_LOGW(TAG, "Job %s missed %lds, %s", job->name, job->next_execution.tv_sec, fire ? "firing now" : "skipping");
+    if (fire) {
+        // Keep next_execution so the lag reflects the missed occurrence.
+        entry->deadline_us = esp_timer_get_time();
+    } else if (cron_is_oneshot(job)) {
+        entry->skip = true;
+        entry->deadline_us = esp_timer_get_time();
+    } else {
+        entry->last_fired = MAX(entry->last_fired, job->next_execution.tv_sec);
+        cron_calculate_next(entry);
+    }
+}
+
+static void cron_resync(void) {
+    struct timespec now = cron_now();
+    int64_t mono = esp_timer_get_time();
+    struct timespec tolerance = {.tv_sec = now.tv_sec - CRON_MISFIRE_TOLERANCE_S, .tv_nsec = now.tv_nsec};
+    for (size_t i = 0; i < heap_size; ++i) {
+        cron_entry_t *e = heap[i];
+        if (e->deadline_us <= mono) {
+            // Already due, the dispatch loop runs it right after.
+            continue;
+        }
+        // Deadlines are monotonic, a job is only missed when the wall clock jumped over it before it became due.
+        if (e->relative) {
+            cron_calculate_next(e);
+        } else if (timespec_lt(e->job.next_execution, tolerance)) {
+            cron_misfire(e, now);
+        } else if (!timespec_lt(now, e->job.next_execution)) {
+            // A small correction, e.g. from SNTP, moved past it.
+            e->deadline_us = mono;
+        } else {
+            cron_calculate_next(e);
+        }
+    }
+    for (size_t i = heap_size / 2; i-- > 0;) {
+        cron_heap_sift_down(i);
+    }
 }
 
-static esp_err_t cron_schedule_job(cron_job_entry_t *entry) {
-    ESP_ERROR_CHECK(cron_unschedule_job(entry->job.handle));
+static void cron_sync_clock(bool force) {
+    int64_t offset = cron_clock_offset();
+    int64_t step = offset - offset_us;
+    if (!force && llabs(step) < CRON_CLOCK_STEP_US) {
+        return;
+    }
+    ESP_LOGI(TAG, "Clock changed by %lld ms, rescheduling %u jobs", (long long) (step / 1000),
+             (unsigned int) heap_size);
+    offset_us = offset;
+    cron_resync();
+}
 
+static esp_err_t cron_schedule_job(cron_entry_t *entry) {
+    // Jobs without a valid next execution are parked outside the heap until they are deleted.
     if (entry->job.next_execution.tv_sec == INVALID_INSTANT) {
-        TAILQ_INSERT_TAIL(&cron_job_head, entry, next);
+        cron_heap_remove(entry);
         return ESP_OK;
     }
-    if (TAILQ_EMPTY(&cron_job_head)) {
-        TAILQ_INSERT_HEAD(&cron_job_head, entry, next);
+    if (entry->heap_index == CRON_NOT_SCHEDULED) {
+        cron_heap_push(entry);
         return ESP_OK;
     }
-    cron_job_entry_t *e = NULL;
-    TAILQ_FOREACH(e, &cron_job_head, next) {
-        if (timespec_lt(entry->job.next_execution, e->job.next_execution)) {
-            TAILQ_INSERT_BEFORE(e, entry, next);
-            return ESP_OK;
-        }
-    }
-    TAILQ_INSERT_TAIL(&cron_job_head, entry, next);
+    cron_heap_sift_up(entry->heap_index);
+    cron_heap_sift_down(entry->heap_index);
     return ESP_OK;
 }
 
-static esp_err_t cron_create_job(cron_job_t *job) {
-    ARG_CHECK(job != NULL, ERR_PARAM_NULL);
-    cron_job_entry_t *entry = calloc(1, sizeof(cron_job_entry_t));
-    if (entry == NULL) {
-        return ESP_ERR_NO_MEM;
+static esp_err_t cron_create_job(cron_handle_t handle) {
+    cron_entry_t *entry = cron_entry_find(handle);
+    ARG_CHECK(entry != NULL, "unknown handle: %u", handle);
+
+    entry->pending = false;
+    if (!time_valid) {
+        return ESP_OK;
     }
-    memcpy(&entry->job, job, sizeof(cron_job_t));
-    cron_calculate_next(&entry->job);
+    cron_calculate_next(entry);
     ESP_ERROR_CHECK(cron_schedule_job(entry));
     return ESP_OK;
 }
 
+static void cron_schedule_parked(void) {
+    for (size_t i = 0; i < CRON_MAX_JOBS; ++i) {
+        cron_entry_t *e = &entries[i];
+        // Callers allocate slots concurrently.
+        portENTER_CRITICAL(&spinlock);
+        bool parked = e->used && !e->deleted && !e->pending && !e->finished && e->heap_index == CRON_NOT_SCHEDULED;
+        portEXIT_CRITICAL(&spinlock);
+        if (parked) {
+            cron_calculate_next(e);
+            ESP_ERROR_CHECK(cron_schedule_job(e));
+        }
+    }
+}
+
 static esp_err_t cron_destroy_job(cron_handle_t handle) {
     ARG_CHECK(handle > INVALID_CRON_HANDLE, ERR_PARAM_LE_ZERO);
 
-    cron_job_entry_t *e = NULL, *tmp = NULL;
-    TAILQ_FOREACH_SAFE(e, &cron_job_head, next, tmp) {
-        if (e->job.handle == handle) {
-            TAILQ_REMOVE(&cron_job_head, e, next);
-            SAFE_FREE(e);
-            break;
-        }
+    cron_entry_t *entry = cron_entry_find(handle);
+    if (entry == NULL) {
+        return ESP_OK;
+    }
+    cron_heap_remove(entry);
+    portENTER_CRITICAL(&spinlock);
+    entry->deleted = true;
+    if (!entry->running) {
+        cron_entry_release_locked(entry);
     }
+    portEXIT_CRITICAL(&spinlock);
     return ESP_OK;
 }
 
+// A oneshot is done once dispatched. It can still be cancelled with cron_delete until its worker picks it up.
+static void cron_finish_oneshot(cron_entry_t *entry) {
+    cron_heap_remove(entry);
+    portENTER_CRITICAL(&spinlock);
+    entry->finished = true;
+    if (!entry->running) {
+        cron_entry_release_locked(entry);
+    }
+    portEXIT_CRITICAL(&spinlock);
+}
+
+static void cron_replace_jobs(cron_replace_t *replace) {
+    // Drop the previous members of the group and schedule the new ones in a single step, so no schedule is missing
+    // in between.
+    for (size_t i = 0; i < CRON_MAX_JOBS; ++i) {
+        cron_entry_t *e = &entries[i];
+        portENTER_CRITICAL(&spinlock);
+        bool member = e->used && !e->deleted && !e->pending && strcmp(e->job.group, replace->group) == 0;
+        portEXIT_CRITICAL(&spinlock);
+        if (member) {
+            ESP_ERROR_CHECK(cron_destroy_job(e->job.handle));
+        }
+    }
+    for (size_t i = 0; i < replace->n; ++i) {
+        ESP_ERROR_CHECK(cron_create_job(replace->handles[i]));
+    }
+    xSemaphoreGive(replace->done);
+}
+
+static void cron_dump_jobs(cron_dump_t *dump) {
+    dump->count = 0;
+    for (size_t i = 0; i < CRON_MAX_JOBS && dump->count < dump->max; ++i) {
+        cron_entry_t *e = &entries[i];
+        cron_info_t *info = &dump->infos[dump->count];
+        portENTER_CRITICAL(&spinlock);
+        // Pending slots are still being filled by their caller.
+        bool live = e->used && !e->deleted && !e->pending && !e->finished;
+        if (live) {
+            info->stats = e->stats;
+        }
+        portEXIT_CRITICAL(&spinlock);
+        if (!live) {
+            continue;
+        }
+        info->handle = e->job.handle;
+        strlcpy(info->name, e->job.name, sizeof(info->name));
+        strlcpy(info->group, e->job.group, sizeof(info->group));
+        strlcpy(info->expression, e->job.expression, sizeof(info->expression));
+        info->next_execution = e->heap_index == CRON_NOT_SCHEDULED && !e->relative
+                               ? (struct timespec) {.tv_sec = INVALID_INSTANT}
+                               : e->job.next_execution;
+        info->priority = e->priority;
+        info->misfire = e->misfire;
+        dump->count++;
+    }
+    xSemaphoreGive(dump->done);
+}
+
+static inline size_t cron_lateness_bucket(int32_t lag_ms) {
+    size_t bucket = 0;
+    for (int32_t limit = 10; bucket < CRON_LATENESS_BUCKETS - 1 && lag_ms >= limit; limit *= 10) {
+        bucket++;
+    }
+    return bucket;
+}
+
+static void cron_dispatch(cron_entry_t *entry) {
+    portENTER_CRITICAL(&spinlock);
+    bool busy = entry->running;
+    if (busy) {
+        entry->stats.overruns++;
+    }
+    entry->running = true;
+    portEXIT_CRITICAL(&spinlock);
+    if (busy) {
+        ESP_LOGW(TAG, "Skipping %s, previous run is still executing", entry->job.name);
+        return;
+    }
+    cron_dispatch_t d = {.entry = entry, .scheduled = entry->job.next_execution};
+    if (xQueueSend(dispatch[entry->priority], &d, 0) != pdPASS) {
+        portENTER_CRITICAL(&spinlock);
+        entry->running = false;
+        entry->stats.overruns++;
+        portEXIT_CRITICAL(&spinlock);
+        ESP_LOGW(TAG, "Skipping %s, all workers are busy", entry->job.name);
+    }
+}
+
+static void cron_worker_task(void *arg) {
+    QueueHandle_t q = (QueueHandle_t) arg;
+    ARG_ERROR_CHECK(q != NULL, ERR_PARAM_NULL);
+
+    while (true) {
+        cron_dispatch_t d = {0};
+        if (xQueueReceive(q, &d, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+        cron_entry_t *e = d.entry;
+        // Deleted while queued, the callback's data may already be gone.
+        portENTER_CRITICAL(&spinlock);
+        bool cancelled = e->deleted;
+        portEXIT_CRITICAL(&spinlock);
+        int32_t lag_ms = 0;
+        uint32_t duration_ms = 0;
+        if (!cancelled) {
+            lag_ms = (int32_t) timespec_to_ms(timespec_sub(cron_now(), d.scheduled));
+            int64_t start = esp_timer_get_time();
+            e->job.callback(e->job.handle, e->job.name, e->job.data);
+            duration_ms = (uint32_t) ((esp_timer_get_time() - start) / 1000);
+            if (lag_ms > CRON_LAG_WARN_MS) {
+                ESP_LOGW(TAG, "Job %s started %d ms late", e->job.name, lag_ms);
+            }
+        }
+
+        portENTER_CRITICAL(&spinlock);
+        if (!cancelled) {
+            e->stats.runs++;
+            e->stats.last_lag_ms = lag_ms;
+            e->stats.lateness[cron_lateness_bucket(lag_ms)]++;
+            e->stats.last_duration_ms = duration_ms;
+            if (duration_ms > e->stats.max_duration_ms) {
+                e->stats.max_duration_ms = duration_ms;
+            }
+        }
+        e->running = false;
+        if (e->deleted || e->finished) {
+            cron_entry_release_locked(e);
+        }
+        portEXIT_CRITICAL(&spinlock);
+    }
+}
+
 static void cron_task(void *arg) {
     context_t *context = (context_t *) arg;
     ARG_ERROR_CHECK(context != NULL, ERR_PARAM_NULL);
 
-    // Wait for the time to be accurate.
-    xEventGroupWaitBits(context->event_group, CONTEXT_EVENT_TIME, pdFALSE, pdTRUE, portMAX_DELAY);
     while (true) {
-        TickType_t ticks = cron_next_delay();
+        TickType_t ticks = time_valid ? cron_next_delay() : pdMS_TO_TICKS(CRON_TIME_POLL_MS);
         cron_op_t op = {0};
+        bool time_changed = false;
         if (xQueueReceive(queue, &op, ticks) == pdTRUE) {
             switch (op.type) {
                 case CRON_OP_ADD:
-                    ESP_ERROR_CHECK(cron_create_job(&op.add.job));
+                    ESP_ERROR_CHECK(cron_create_job(op.handle));
                     break;
                 case CRON_OP_REMOVE:
-                    ESP_ERROR_CHECK(cron_destroy_job(op.remove.handle));
+                    ESP_ERROR_CHECK(cron_destroy_job(op.handle));
                     break;
                 case CRON_OP_DUMP:
-                    // TODO
+                    cron_dump_jobs(op.dump);
+                    break;
+                case CRON_OP_TIME:
+                    time_changed = true;
+                    break;
+                case CRON_OP_REPLACE:
+                    cron_replace_jobs(op.replace);
                     break;
             }
         }
-        if (TAILQ_EMPTY(&cron_job_head)) {
-            continue;
+        if (!time_valid) {
+            // Keep serving requests but only schedule once the time is accurate.
+            if ((xEventGroupGetBits(context->event_group) & CONTEXT_EVENT_TIME) == 0) {
+                continue;
+            }
+            time_valid = true;
+            offset_us = cron_clock_offset();
+            cron_schedule_parked();
         }
-        cron_job_entry_t *e = NULL, *tmp = NULL;
-        TAILQ_FOREACH_SAFE(e, &cron_job_head, next, tmp) {
-            if (e->job.next_execution.tv_sec == INVALID_INSTANT) {
+        cron_sync_clock(time_changed);
+        while (heap_size > 0) {
+            cron_entry_t *e = heap[0];
+            if (e->deadline_us > esp_timer_get_time()) {
                 break;
             }
-            struct timespec now = cron_now();
-            if (timespec_gt(e->job.next_execution, now)) {
-                break;
+            if (!e->skip) {
+                cron_dispatch(e);
             }
-            e->job.callback(e->job.handle, e->job.name, e->job.data);
+            e->skip = false;
             if (cron_is_oneshot(&e->job)) {
-                ESP_ERROR_CHECK(cron_destroy_job(e->job.handle));
+                cron_finish_oneshot(e);
             } else {
-                cron_calculate_next(&e->job);
+                e->last_fired = e->job.next_execution.tv_sec;
+                cron_calculate_next(e);
                 ESP_ERROR_CHECK(cron_schedule_job(e));
             }
         }
@@ -216,49 +642,119 @@ static void cron_task(void *arg) {
 
 esp_err_t cron_init(context_t *context) {
     queue = xQueueCreate(10, sizeof(cron_op_t));
-    if (queue == NULL) {
-        return ESP_ERR_NO_MEM;
+    CHECK_NO_MEM(queue);
+
+    entries = calloc(CRON_MAX_JOBS, sizeof(cron_entry_t));
+    CHECK_NO_MEM(entries);
+    free_slots = calloc(CRON_MAX_JOBS, sizeof(uint16_t));
+    CHECK_NO_MEM(free_slots);
+    heap = calloc(CRON_MAX_JOBS, sizeof(cron_entry_t *));
+    CHECK_NO_MEM(heap);
+
+    // Hand out the lower slots first.
+    for (free_size = 0; free_size < CRON_MAX_JOBS; ++free_size) {
+        free_slots[free_size] = CRON_MAX_JOBS - 1 - free_size;
+        entries[free_size].heap_index = CRON_NOT_SCHEDULED;
+    }
+    heap_size = 0;
+
+    // Jobs with a high priority share a single worker so they run in the order they were scheduled.
+    dispatch[CRON_PRIORITY_HIGH] = xQueueCreate(CRON_DISPATCH_QUEUE_SIZE, sizeof(cron_dispatch_t));
+    CHECK_NO_MEM(dispatch[CRON_PRIORITY_HIGH]);
+    dispatch[CRON_PRIORITY_NORMAL] = xQueueCreate(CRON_DISPATCH_QUEUE_SIZE, sizeof(cron_dispatch_t));
+    CHECK_NO_MEM(dispatch[CRON_PRIORITY_NORMAL]);
+
+    xTaskCreatePinnedToCore(cron_task, "cron", 3072, context, configMAX_PRIORITIES - 5, NULL, tskNO_AFFINITY);
+    xTaskCreatePinnedToCore(cron_worker_task, "cron_hi", 5120, dispatch[CRON_PRIORITY_HIGH],
+                            configMAX_PRIORITIES - 6, NULL, tskNO_AFFINITY);
+    for (int i = 0; i < CRON_WORKERS; ++i) {
+        char name[configMAX_TASK_NAME_LEN];
+        snprintf(name, sizeof(name), "cron_%d", i);
+        xTaskCreatePinnedToCore(cron_worker_task, name, 5120, dispatch[CRON_PRIORITY_NORMAL], tskIDLE_PRIORITY + 10,
+                                NULL, tskNO_AFFINITY);
     }
-    TAILQ_INIT(&cron_job_head);
-
-    xTaskCreatePinnedToCore(cron_task, "cron", 5120, context, configMAX_PRIORITIES - 5, NULL, tskNO_AFFINITY);
     return ESP_OK;
 }
 
-static esp_err_t cron_add(cron_job_t *job, cron_handle_t *handle) {
-    cron_op_t arg = {.type = CRON_OP_ADD, .add = {.job = *job}};
+// The priority and the misfire policy are set before the job is queued, it may fire before the caller gets its handle
+// back.
+static cron_entry_t *cron_prepare(const char *name, cron_callback_t callback, void *data, cron_priority_t priority,
+                                  cron_misfire_t misfire) {
+    cron_entry_t *entry = cron_entry_alloc();
+    if (entry == NULL) {
+        ESP_LOGE(TAG, "No free slots to schedule %s, max: %d", name, CRON_MAX_JOBS);
+        return NULL;
+    }
+    entry->priority = priority;
+    entry->misfire = misfire;
+    cron_job_t *job = &entry->job;
+    memset(job, 0, sizeof(cron_job_t));
+    job->handle = CRON_HANDLE(entry->generation, entry - entries);
+    strlcpy(job->name, name, sizeof(job->name));
+    job->callback = callback;
+    job->data = data;
+    job->next_execution.tv_sec = INVALID_INSTANT;
+    job->next_execution.tv_nsec = 0;
+    return entry;
+}
+
+static esp_err_t cron_add(cron_entry_t *entry, cron_handle_t *handle) {
+    cron_op_t arg = {.type = CRON_OP_ADD, .handle = entry->job.handle};
+    if (handle != NULL) {
+        *handle = arg.handle;
+    }
     if (xQueueSend(queue, &arg, portMAX_DELAY) != pdPASS) {
+        cron_entry_release(entry);
         return ESP_FAIL;
     }
-    if (handle != NULL) {
-        *handle = arg.add.job.handle;
+    return ESP_OK;
+}
+
+esp_err_t cron_parse(const char *expression, cron_expr *expr) {
+    ARG_CHECK(expression != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(expr != NULL, ERR_PARAM_NULL);
+
+    const char *error = NULL;
+    cron_parse_expr(expression, expr, &error);
+    if (error != NULL) {
+        ESP_LOGE(TAG, "Could not parse %s, error: %s", expression, error);
+        return ESP_ERR_INVALID_ARG;
     }
     return ESP_OK;
 }
 
 esp_err_t cron_create(const char *name, const char *expression, cron_callback_t callback, void *data,
                       cron_handle_t *handle) {
+    return cron_create_with_priority(name, expression, CRON_PRIORITY_NORMAL, callback, data, handle);
+}
+
+esp_err_t cron_create_with_priority(const char *name, const char *expression, cron_priority_t priority,
+                                    cron_callback_t callback, void *data, cron_handle_t *handle) {
+    return cron_create_with_misfire(name, expression, priority, CRON_MISFIRE_FIRE_ONCE, callback, data, handle);
+}
+
+esp_err_t cron_create_with_misfire(const char *name, const char *expression, cron_priority_t priority,
+                                   cron_misfire_t misfire, cron_callback_t callback, void *data,
+                                   cron_handle_t *handle) {
     ARG_CHECK(name != NULL, ERR_PARAM_NULL);
     ARG_CHECK(expression != NULL, ERR_PARAM_NULL);
     ARG_CHECK(callback != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(priority >= 0 && priority < CRON_PRIORITY_MAX, "invalid priority: %d", priority);
+    ARG_CHECK(misfire >= 0 && misfire < CRON_MISFIRE_MAX, "invalid misfire policy: %d", misfire);
 
-    cron_handle_t new_handle = (cron_handle_t) id++;
-    cron_job_t job = {0};
-    job.handle = new_handle;
-    strlcpy((char *) job.name, name, sizeof(job.name));
-    strlcpy((char *) job.expression, expression, sizeof(job.expression));
-    job.callback = callback;
-    job.data = data;
-    job.next_execution.tv_sec = INVALID_INSTANT;
-    job.next_execution.tv_nsec = 0;
+    cron_entry_t *entry = cron_prepare(name, callback, data, priority, misfire);
+    if (entry == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    cron_job_t *job = &entry->job;
+    strlcpy(job->expression, expression, sizeof(job->expression));
 
-    const char *error = NULL;
-    cron_parse_expr(job.expression, &job.expr, &error);
-    if (error != NULL) {
-        ESP_LOGE(TAG, "Could not parse %s, error: %s", job.expression, error);
-        return ESP_ERR_INVALID_ARG;
+    esp_err_t err = cron_parse(job->expression, &job->expr);
+    if (err != ESP_OK) {
+        cron_entry_release(entry);
+        return err;
     }
-    ESP_ERROR_CHECK(cron_add(&job, handle));
+    ESP_ERROR_CHECK(cron_add(entry, handle));
     return ESP_OK;
 }
 
@@ -268,28 +764,159 @@ esp_err_t cron_schedule_at(const char *name, struct timespec in, cron_callback_t
     ARG_CHECK(in.tv_sec != INVALID_INSTANT, "timespec is INVALID");
     ARG_CHECK(callback != NULL, ERR_PARAM_NULL);
 
-    cron_handle_t new_handle = (cron_handle_t) id++;
-    cron_job_t job = {0};
-    job.handle = new_handle;
-    strlcpy((char *) job.name, name, sizeof(job.name));
-    job.callback = callback;
-    job.data = data;
-    struct timespec normalized = timespec_normalise(in);
-    job.next_execution.tv_sec = normalized.tv_sec;
-    job.next_execution.tv_nsec = normalized.tv_nsec;
-
-    ESP_ERROR_CHECK(cron_add(&job, handle));
+    cron_entry_t *entry = cron_prepare(name, callback, data, CRON_PRIORITY_NORMAL, CRON_MISFIRE_FIRE_ONCE);
+    if (entry == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    entry->job.next_execution = timespec_normalise(in);
+
+    ESP_ERROR_CHECK(cron_add(entry, handle));
     return ESP_OK;
 }
 
 esp_err_t cron_schedule_in(const char *name, uint32_t delay_ms, cron_callback_t callback, void *data,
                            cron_handle_t *handle) {
-    return cron_schedule_at(name, timespec_add(cron_now(), timespec_from_ms(delay_ms)), callback, data, handle);
+    return cron_schedule_in_with_priority(name, delay_ms, CRON_PRIORITY_NORMAL, callback, data, handle);
+}
+
+esp_err_t cron_schedule_in_with_priority(const char *name, uint32_t delay_ms, cron_priority_t priority,
+                                         cron_callback_t callback, void *data, cron_handle_t *handle) {
+    ARG_CHECK(name != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(callback != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(priority >= 0 && priority < CRON_PRIORITY_MAX, "invalid priority: %d", priority);
+
+    cron_entry_t *entry = cron_prepare(name, callback, data, priority, CRON_MISFIRE_FIRE_ONCE);
+    if (entry == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    // Delays are measured on the monotonic clock so wall clock steps don't shorten or stretch them.
+    entry->relative = true;
+    entry->deadline_us = esp_timer_get_time() + (int64_t) delay_ms * 1000;
+    entry->job.next_execution = timespec_add(cron_now(), timespec_from_ms(delay_ms));
+
+    ESP_ERROR_CHECK(cron_add(entry, handle));
+    return ESP_OK;
 }
 
 esp_err_t cron_delete(cron_handle_t handle) {
     ARG_CHECK(handle > INVALID_CRON_HANDLE, ERR_PARAM_LE_ZERO);
 
-    cron_op_t arg = {.type = CRON_OP_REMOVE, .remove = {.handle = handle}};
+    cron_op_t arg = {.type = CRON_OP_REMOVE, .handle = handle};
     return xQueueSend(queue, &arg, portMAX_DELAY) == pdPASS ? ESP_OK : ESP_FAIL;
 }
+
+esp_err_t cron_set_priority(cron_handle_t handle, cron_priority_t priority) {
+    ARG_CHECK(handle > INVALID_CRON_HANDLE, ERR_PARAM_LE_ZERO);
+    ARG_CHECK(priority >= 0 && priority < CRON_PRIORITY_MAX, "invalid priority: %d", priority);
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    portENTER_CRITICAL(&spinlock);
+    cron_entry_t *entry = cron_entry_find(handle);
+    if (entry != NULL) {
+        entry->priority = priority;
+        err = ESP_OK;
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return err;
+}
+
+esp_err_t cron_set_misfire(cron_handle_t handle, cron_misfire_t misfire) {
+    ARG_CHECK(handle > INVALID_CRON_HANDLE, ERR_PARAM_LE_ZERO);
+    ARG_CHECK(misfire >= 0 && misfire < CRON_MISFIRE_MAX, "invalid misfire policy: %d", misfire);
+
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    portENTER_CRITICAL(&spinlock);
+    cron_entry_t *entry = cron_entry_find(handle);
+    if (entry != NULL) {
+        entry->misfire = misfire;
+        err = ESP_OK;
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return err;
+}
+
+esp_err_t cron_time_changed(void) {
+    if (queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    // May be called from the SNTP callback, never block.
+    cron_op_t arg = {.type = CRON_OP_TIME};
+    return xQueueSend(queue, &arg, 0) == pdPASS ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t cron_dump(cron_info_t *infos, size_t max, size_t *count) {
+    ARG_CHECK(infos != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(count != NULL, ERR_PARAM_NULL);
+    if (queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    cron_dump_t dump = {.infos = infos, .max = max, .count = 0};
+    dump.done = xSemaphoreCreateBinaryStatic(&dump.done_buf);
+    cron_op_t arg = {.type = CRON_OP_DUMP, .dump = &dump};
+    if (xQueueSend(queue, &arg, portMAX_DELAY) != pdPASS) {
+        vSemaphoreDelete(dump.done);
+        return ESP_FAIL;
+    }
+    xSemaphoreTake(dump.done, portMAX_DELAY);
+    vSemaphoreDelete(dump.done);
+    *count = dump.count;
+    return ESP_OK;
+}
+
+// Slots reserved by cron_replace_group and never seen by the cron task.
+static void cron_release_reserved(cron_handle_t *handles, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        cron_entry_release(cron_entry_find(handles[i]));
+        handles[i] = INVALID_CRON_HANDLE;
+    }
+}
+
+esp_err_t cron_replace_group(const char *group, const cron_spec_t *specs, size_t n, cron_handle_t *handles) {
+    ARG_CHECK(group != NULL && group[0] != '\0', "group is empty");
+    ARG_CHECK(n == 0 || specs != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(n == 0 || handles != NULL, ERR_PARAM_NULL);
+    if (queue == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        ARG_CHECK(specs[i].name != NULL, ERR_PARAM_NULL);
+        ARG_CHECK(specs[i].expr != NULL, ERR_PARAM_NULL);
+        ARG_CHECK(specs[i].callback != NULL, ERR_PARAM_NULL);
+        ARG_CHECK(specs[i].priority >= 0 && specs[i].priority < CRON_PRIORITY_MAX, "invalid priority: %d",
+                  specs[i].priority);
+        ARG_CHECK(specs[i].misfire >= 0 && specs[i].misfire < CRON_MISFIRE_MAX, "invalid misfire policy: %d",
+                  specs[i].misfire);
+    }
+
+    // Reserve every slot first so a full pool leaves the current group untouched.
+    for (size_t i = 0; i < n; ++i) {
+        cron_entry_t *entry = cron_prepare(specs[i].name, specs[i].callback, specs[i].data, specs[i].priority,
+                                           specs[i].misfire);
+        if (entry == NULL) {
+            cron_release_reserved(handles, i);
+            return ESP_ERR_NO_MEM;
+        }
+        cron_job_t *job = &entry->job;
+        strlcpy(job->group, group, sizeof(job->group));
+        if (specs[i].expression != NULL) {
+            strlcpy(job->expression, specs[i].expression, sizeof(job->expression));
+        } else {
+            // Only used to tell recurring jobs from oneshots and for introspection.
+            strlcpy(job->expression, "?", sizeof(job->expression));
+        }
+        memcpy(&job->expr, specs[i].expr, sizeof(cron_expr));
+        handles[i] = job->handle;
+    }
+
+    cron_replace_t replace = {.group = group, .handles = handles, .n = n};
+    replace.done = xSemaphoreCreateBinaryStatic(&replace.done_buf);
+    cron_op_t arg = {.type = CRON_OP_REPLACE, .replace = &replace};
+    if (xQueueSend(queue, &arg, portMAX_DELAY) != pdPASS) {
+        vSemaphoreDelete(replace.done);
+        cron_release_reserved(handles, n);
+        return ESP_FAIL;
+    }
+    xSemaphoreTake(replace.done, portMAX_DELAY);
+    vSemaphoreDelete(replace.done);
+    return ESP_OK;
+}
@@ -1,15 +1,65 @@
 #ifndef HYDROPONICS_TASKS_CRON_H
 #define HYDROPONICS_TASKS_CRON_H
 
+#include <time.h>
+
 #include "esp_err.h"
 
+#include "ccronexpr.h"
+
 #include "context.h"
 
 #define INVALID_CRON_HANDLE 0
 typedef unsigned int cron_handle_t;
 
+typedef enum {
+    CRON_PRIORITY_NORMAL = 0, /*!< Shared worker pool, default for new jobs. */
+    CRON_PRIORITY_HIGH = 1,   /*!< Dedicated worker, jobs run in order. */
+    CRON_PRIORITY_MAX,
+} cron_priority_t;
+
+typedef enum {
+    CRON_MISFIRE_FIRE_ONCE = 0, /*!< Run once right away for all missed occurrences, default for new jobs. */
+    CRON_MISFIRE_SKIP = 1,      /*!< Drop missed occurrences and wait for the next one. */
+    CRON_MISFIRE_COALESCE = 2,  /*!< Run once only if the latest missed occurrence is within the grace period. */
+    CRON_MISFIRE_MAX,
+} cron_misfire_t;
+
+#define CRON_LATENESS_BUCKETS 5
+
+typedef struct {
+    uint32_t runs;
+    uint32_t overruns;         /*!< Runs skipped because the previous one was still executing. */
+    uint32_t misfires;         /*!< Occurrences missed because the wall clock jumped over them. */
+    int32_t last_lag_ms;       /*!< Difference between the actual and the scheduled start. */
+    uint32_t last_duration_ms;
+    uint32_t max_duration_ms;
+    uint32_t lateness[CRON_LATENESS_BUCKETS]; /*!< Start lag histogram: <10ms, <100ms, <1s, <10s and above. */
+} cron_stats_t;
+
+typedef struct {
+    cron_handle_t handle;
+    char name[32];
+    char group[16];                 /*!< Empty unless created through cron_replace_group. */
+    char expression[64];            /*!< Empty for oneshots. */
+    struct timespec next_execution; /*!< tv_sec is -1 when the job will not run again. */
+    cron_priority_t priority;
+    cron_misfire_t misfire;
+    cron_stats_t stats;
+} cron_info_t;
+
 typedef void (*cron_callback_t)(cron_handle_t handle, const char *name, void *data);
 
+typedef struct {
+    const char *name;
+    const char *expression;  /*!< Optional, only kept for introspection. */
+    const cron_expr *expr;   /*!< Parsed with cron_parse, copied into the job. */
+    cron_callback_t callback;
+    void *data;
+    cron_priority_t priority;
+    cron_misfire_t misfire;
+} cron_spec_t;
+
 esp_err_t cron_init(context_t *context);
 
 /*
@@ -28,12 +78,58 @@ esp_err_t cron_init(context_t *context);
 esp_err_t cron_create(const char *name, const char *expression, cron_callback_t callback, void *data,
                       cron_handle_t *handle);
 
+// Same as cron_create, the job runs on the worker of `priority` from its first occurrence.
+esp_err_t cron_create_with_priority(const char *name, const char *expression, cron_priority_t priority,
+                                    cron_callback_t callback, void *data, cron_handle_t *handle);
+
+// Same as cron_create_with_priority, `misfire` applies from the first occurrence.
+esp_err_t cron_create_with_misfire(const char *name, const char *expression, cron_priority_t priority,
+                                   cron_misfire_t misfire, cron_callback_t callback, void *data,
+                                   cron_handle_t *handle);
+
 esp_err_t cron_schedule_at(const char *name, struct timespec in, cron_callback_t callback, void *data,
                            cron_handle_t *handle);
 
 esp_err_t cron_schedule_in(const char *name, uint32_t delay_ms, cron_callback_t callback, void *data,
                            cron_handle_t *handle);
 
+esp_err_t cron_schedule_in_with_priority(const char *name, uint32_t delay_ms, cron_priority_t priority,
+                                         cron_callback_t callback, void *data, cron_handle_t *handle);
+
 esp_err_t cron_delete(cron_handle_t handle);
 
+esp_err_t cron_parse(const char *expression, cron_expr *expr);
+
+/*
+ * Atomically replaces all the jobs of a group with the n jobs described by specs and returns their handles. Either all
+ * jobs are scheduled or, if the pool is too small, the group is left untouched and ESP_ERR_NO_MEM is returned. Blocks
+ * until the cron task has applied the change.
+ */
+esp_err_t cron_replace_group(const char *group, const cron_spec_t *specs, size_t n, cron_handle_t *handles);
+
+/*
+ * Selects the worker that runs the job's callback. A job that is still executing when it becomes due again is skipped
+ * and counted as an overrun. Short oneshots may already have run and been destroyed when this is called, pass the
+ * priority to the *_with_priority variants instead.
+ */
+esp_err_t cron_set_priority(cron_handle_t handle, cron_priority_t priority);
+
+/*
+ * Selects what happens to occurrences the wall clock jumped over, e.g. after an SNTP step. Jobs are scheduled on the
+ * monotonic clock and an occurrence already run is never repeated when the clock goes back. Steps shorter than a second
+ * are not misfires, the occurrence runs. The job may already be due when this is called, pass the policy to
+ * cron_create_with_misfire instead.
+ */
+esp_err_t cron_set_misfire(cron_handle_t handle, cron_misfire_t misfire);
+
+/*
+ * Reschedules all jobs against the current wall clock and timezone. Safe to call from the SNTP sync callback.
+ */
+esp_err_t cron_time_changed(void);
+
+/*
+ * Copies up to max jobs into infos. Blocks until the cron task serves the request.
+ */
+esp_err_t cron_dump(cron_info_t *infos, size_t max, size_t *count);
+
 #endif //HYDROPONICS_TASKS_CRON_H
@@ -0,0 +1,110 @@
+#include <string.h>
+
+#include "health.h"
+
+void health_init(health_t *health, const health_limits_t *limits, uint64_t now_ms) {
+    memset(health, 0, sizeof(health_t));
+    health->limits = *limits;
+    if (health->limits.retries == 0) {
+        health->limits.retries = 1;
+    }
+    health->last_good_ms = now_ms;
+    health->last_fault_ms = now_ms;
+}
+
+health_action_t health_fault(health_t *health, health_fault_t fault, uint64_t now_ms) {
+    health->samples++;
+    health->errors++;
+    health->fault = fault;
+    health->last_fault_ms = now_ms;
+    if (health->consecutive < UINT16_MAX) {
+        health->consecutive++;
+    }
+    health_action_t step = HEALTH_ACTION_RETRY + (health->consecutive - 1) / health->limits.retries;
+    if (step > HEALTH_ACTION_ALERT) {
+        step = HEALTH_ACTION_ALERT;
+    }
+    health_action_t previous = health->step;
+    health->step = step;
+    health->status = step == HEALTH_ACTION_ALERT ? HEALTH_STATUS_FAILED : HEALTH_STATUS_DEGRADED;
+    if (step != previous) {
+        return step;
+    }
+    return step == HEALTH_ACTION_ALERT ? HEALTH_ACTION_NONE : HEALTH_ACTION_RETRY;
+}
+
+void health_success(health_t *health, uint64_t now_ms) {
+    health->samples++;
+    if (health->consecutive > 0) {
+        health->recoveries++;
+    }
+    health->consecutive = 0;
+    health->step = HEALTH_ACTION_NONE;
+    health->status = HEALTH_STATUS_OK;
+    health->last_good_ms = now_ms;
+}
+
+health_action_t health_value(health_t *health, float value, uint64_t now_ms) {
+    const health_limits_t *limits = &health->limits;
+    // Also catches NaN, which fails both comparisons.
+    if (!(value >= limits->min && value <= limits->max)) {
+        return health_fault(health, HEALTH_FAULT_RANGE, now_ms);
+    }
+    bool same = health->samples > 0 && value == health->last;
+    health->same = same ? (health->same < UINT16_MAX ? health->same + 1 : UINT16_MAX) : 0;
+    health->last = value;
+    health_success(health, now_ms);
+    if (limits->stuck == 0 || health->same < limits->stuck) {
+        return HEALTH_ACTION_NONE;
+    }
+    health->status = HEALTH_STATUS_DEGRADED;
+    health->fault = HEALTH_FAULT_STUCK;
+    if (health->same > limits->stuck) {
+        return HEALTH_ACTION_NONE;
+    }
+    health->errors++;
+    health->last_fault_ms = now_ms;
+    return HEALTH_ACTION_ALERT;
+}
+
+health_action_t health_check(health_t *health, uint64_t now_ms) {
+    uint32_t stale_ms = health->limits.stale_ms;
+    if (stale_ms == 0 || now_ms - health->last_good_ms < stale_ms || now_ms - health->last_fault_ms < stale_ms) {
+        return HEALTH_ACTION_NONE;
+    }
+    return health_fault(health, HEALTH_FAULT_STALE, now_ms);
+}
+
+bool health_is_good(const health_t *health) {
+    return health->consecutive == 0;
+}
+
+const char *health_status_name(health_status_t status) {
+    switch (status) {
+        case HEALTH_STATUS_OK:
+            return "ok";
+        case HEALTH_STATUS_DEGRADED:
+            return "degraded";
+        case HEALTH_STATUS_FAILED:
+            return "failed";
+        default:
+            return "?";
+    }
+}
+
+const char *health_fault_name(health_fault_t fault) {
+    switch (fault) {
+        case HEALTH_FAULT_NONE:
+            return "none";
+        case HEALTH_FAULT_ERROR:
+            return "error";
+        case HEALTH_FAULT_STUCK:
+            return "stuck";
+        case HEALTH_FAULT_RANGE:
+            return "range";
+        case HEALTH_FAULT_STALE:
+            return "stale";
+        default:
+            return "?";
+    }
+}
@@ -0,0 +1,74 @@
+#ifndef HYDROPONICS_HEALTH_HEALTH_H
+#define HYDROPONICS_HEALTH_HEALTH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef enum {
+    HEALTH_STATUS_OK = 0,
+    HEALTH_STATUS_DEGRADED = 1, /*!< Faulting, recovery in progress. */
+    HEALTH_STATUS_FAILED = 2,   /*!< Every recovery step was tried, still sampled in case it comes back. */
+} health_status_t;
+
+typedef enum {
+    HEALTH_FAULT_NONE = 0,
+    HEALTH_FAULT_ERROR = 1,     /*!< The device or the bus returned an error. */
+    HEALTH_FAULT_STUCK = 2,     /*!< Same value for too many samples in a row. */
+    HEALTH_FAULT_RANGE = 3,     /*!< Value outside of what the sensor can physically measure. */
+    HEALTH_FAULT_STALE = 4,     /*!< No good sample for too long. */
+} health_fault_t;
+
+// Recovery steps, in escalation order.
+typedef enum {
+    HEALTH_ACTION_NONE = 0,
+    HEALTH_ACTION_RETRY = 1,
+    HEALTH_ACTION_RESET_DEVICE = 2,
+    HEALTH_ACTION_RESET_BUS = 3,
+    HEALTH_ACTION_ALERT = 4,
+} health_action_t;
+
+typedef struct {
+    float min;
+    float max;
+    uint16_t stuck;       /*!< Identical samples before the value is flagged stuck, 0 to disable. Calm water
+                               legitimately repeats readings, so a stuck value only alerts and is still published. */
+    uint32_t stale_ms;    /*!< Time without a good sample before it is stale, 0 to disable. */
+    uint8_t retries;      /*!< Consecutive faults spent on every recovery step. */
+} health_limits_t;
+
+typedef struct {
+    health_limits_t limits;
+    health_status_t status;
+    health_fault_t fault;       /*!< Last fault, kept after recovering for diagnostics. */
+    health_action_t step;       /*!< Current recovery step. */
+    uint32_t samples;
+    uint32_t errors;
+    uint32_t recoveries;
+    uint16_t consecutive;
+    uint16_t same;
+    float last;
+    uint64_t last_good_ms;
+    uint64_t last_fault_ms;
+} health_t;
+
+void health_init(health_t *health, const health_limits_t *limits, uint64_t now_ms);
+
+// Every call returns the action to take now. Steps other than retry are only returned once, when escalating.
+health_action_t health_fault(health_t *health, health_fault_t fault, uint64_t now_ms);
+
+void health_success(health_t *health, uint64_t now_ms);
+
+// Classifies a sample, faults it when out of range and counts it as a success otherwise. A stuck value is a success that
+// degrades the status and alerts once, it never climbs the recovery ladder.
+health_action_t health_value(health_t *health, float value, uint64_t now_ms);
+
+// Faults a stale sensor at most once every `stale_ms`.
+health_action_t health_check(health_t *health, uint64_t now_ms);
+
+bool health_is_good(const health_t *health);
+
+const char *health_status_name(health_status_t status);
+
+const char *health_fault_name(health_fault_t fault);
+
+#endif //HYDROPONICS_HEALTH_HEALTH_H
@@ -0,0 +1,306 @@
+#include <string.h>
+#include <sys/param.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "driver/i2c.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "error.h"
+#include "i2c_bus.h"
+
+typedef struct i2c_bus_device {
+    char name[16];
+    uint8_t address;
+    i2c_bus_priority_t priority;
+    i2c_bus_stats_t stats;
+} i2c_bus_device_t;
+
+typedef struct {
+    i2c_bus_device_t *dev;
+    i2c_cmd_handle_t cmd;
+    i2c_bus_recover_t recover;  /*!< Runs instead of the command link when set. */
+    int64_t enqueued_us;
+    int64_t deadline_us;
+    uint32_t seq;
+    StaticSemaphore_t done_buf;
+    SemaphoreHandle_t done;     /*!< Given by the bus owner, task notifications are left to the callers' ISRs. */
+    esp_err_t err;
+} i2c_bus_request_t;
+
+static const char *TAG = "i2c_bus";
+static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+static i2c_port_t bus_port;
+static i2c_bus_transport_t transport;
+static TaskHandle_t owner;
+static SemaphoreHandle_t pending_count; // Requests waiting in the heap.
+static SemaphoreHandle_t free_count;    // Free heap slots, makes submitters block when the queue is full.
+
+static i2c_bus_device_t devices[I2C_BUS_MAX_DEVICES];
+static size_t n_devices;
+// Recoveries jump the queue, nothing else can make progress on a stuck bus anyway.
+static i2c_bus_device_t recover_dev = {.name = "recover", .priority = I2C_BUS_PRIORITY_HIGH};
+
+// Min-heap of the pending requests (highest priority, then earliest deadline, then FIFO), guarded by the spinlock.
+static i2c_bus_request_t *pending[I2C_BUS_MAX_PENDING];
+static size_t n_pending;
+static uint32_t seq;
+
+static bool i2c_bus_before(const i2c_bus_request_t *a, const i2c_bus_request_t *b) {
+    if (a->dev->priority != b->dev->priority) {
+        return a->dev->priority > b->dev->priority;
+    }
+    if (a->deadline_us != b->deadline_us) {
+        return a->deadline_us < b->deadline_us;
+    }
+    return (int32_t) (a->seq - b->seq) < 0;
+}
+
+static void i2c_bus_push(i2c_bus_request_t *req) {
+    size_t i = n_pending++;
+    pending[i] = req;
+    while (i > 0) {
+        size_t parent = (i - 1) / 2;
+        if (!i2c_bus_before(pending[i], pending[parent])) {
+            break;
+        }
+        i2c_bus_request_t *tmp = pending[i];
+        pending[i] = pending[parent];
+        pending[parent] = tmp;
+        i = parent;
+    }
+}
+
+static i2c_bus_request_t *i2c_bus_pop(void) {
+    i2c_bus_request_t *top = pending[0];
+    pending[0] = pending[--n_pending];
+    size_t i = 0;
+    while (true) {
+        size_t left = 2 * i + 1;
+        size_t right = left + 1;
+        size_t first = i;
+        if (left < n_pending && i2c_bus_before(pending[left], pending[first])) {
+            first = left;
+        }
+        if (right < n_pending && i2c_bus_before(pending[right], pending[first])) {
+            first = right;
+        }
+        if (first == i) {
+            break;
+        }
+        i2c_bus_request_t *tmp = pending[i];
+        pending[i] = pending[first];
+        pending[first] = tmp;
+        i = first;
+    }
+    return top;
+}
+
+static void i2c_bus_task(void *arg) {
+    ARG_UNUSED(arg);
+
+    while (true) {
+        xSemaphoreTake(pending_count, portMAX_DELAY);
+        portENTER_CRITICAL(&spinlock);
+        i2c_bus_request_t *req = i2c_bus_pop();
+        portEXIT_CRITICAL(&spinlock);
+        xSemaphoreGive(free_count);
+
+        int64_t start = esp_timer_get_time();
+        uint32_t exec_us = 0;
+        bool expired = start >= req->deadline_us;
+        if (expired) {
+            req->err = ESP_ERR_TIMEOUT;
+        } else if (req->recover != NULL) {
+            ESP_LOGW(TAG, "Recovering the bus");
+            req->err = req->recover(bus_port);
+            exec_us = (uint32_t) (esp_timer_get_time() - start);
+        } else {
+            TickType_t ticks = pdMS_TO_TICKS((req->deadline_us - start + 999) / 1000);
+            req->err = transport(bus_port, req->cmd, ticks > 0 ? ticks : 1);
+            exec_us = (uint32_t) (esp_timer_get_time() - start);
+        }
+
+        i2c_bus_stats_t *stats = &req->dev->stats;
+        uint32_t wait_us = (uint32_t) (start - req->enqueued_us);
+        portENTER_CRITICAL(&spinlock);
+        stats->transactions++;
+        if (expired) {
+            stats->expired++;
+        } else if (req->err != ESP_OK) {
+            stats->errors++;
+        }
+        stats->last_wait_us = wait_us;
+        stats->max_wait_us = MAX(stats->max_wait_us, wait_us);
+        stats->last_exec_us = exec_us;
+        stats->max_exec_us = MAX(stats->max_exec_us, exec_us);
+        portEXIT_CRITICAL(&spinlock);
+
+        // The caller returns right away, req is gone after this.
+        xSemaphoreGive(req->done);
+    }
+}
+
+esp_err_t i2c_bus_init(i2c_port_t port) {
+    return i2c_bus_init_with_transport(port, i2c_master_cmd_begin);
+}
+
+esp_err_t i2c_bus_init_with_transport(i2c_port_t port, i2c_bus_transport_t t) {
+    ARG_CHECK(t != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(owner == NULL, "already initialized");
+
+    bus_port = port;
+    transport = t;
+    pending_count = xSemaphoreCreateCounting(I2C_BUS_MAX_PENDING, 0);
+    CHECK_NO_MEM(pending_count);
+    free_count = xSemaphoreCreateCounting(I2C_BUS_MAX_PENDING, I2C_BUS_MAX_PENDING);
+    CHECK_NO_MEM(free_count);
+
+    xTaskCreatePinnedToCore(i2c_bus_task, "i2c_bus", 2560, NULL, configMAX_PRIORITIES - 4, &owner, tskNO_AFFINITY);
+    return ESP_OK;
+}
+
+esp_err_t i2c_bus_add_device(const char *name, uint8_t address, i2c_bus_priority_t priority,
+                             i2c_bus_device_handle_t *dev) {
+    ARG_CHECK(name != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(priority >= 0 && priority < I2C_BUS_PRIORITY_MAX, "invalid priority: %d", priority);
+    ARG_CHECK(dev != NULL, ERR_PARAM_NULL);
+
+    i2c_bus_device_t *d = NULL;
+    portENTER_CRITICAL(&spinlock);
+    if (n_devices < I2C_BUS_MAX_DEVICES) {
+        d = &devices[n_devices++];
+    }
+    portEXIT_CRITICAL(&spinlock);
+    if (d == NULL) {
+        ESP_LOGE(TAG, "No free slots for device %s, max: %d", name, I2C_BUS_MAX_DEVICES);
+        return ESP_ERR_NO_MEM;
+    }
+    strlcpy(d->name, name, sizeof(d->name));
+    d->address = address;
+    d->priority = priority;
+    *dev = d;
+    return ESP_OK;
+}
+
+uint8_t i2c_bus_device_address(i2c_bus_device_handle_t dev) {
+    return dev->address;
+}
+
+i2c_bus_device_handle_t i2c_bus_find_device(uint8_t address) {
+    i2c_bus_device_t *d = NULL;
+    portENTER_CRITICAL(&spinlock);
+    for (size_t i = 0; i < n_devices && d == NULL; ++i) {
+        if (devices[i].address == address) {
+            d = &devices[i];
+        }
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return d;
+}
+
+static esp_err_t i2c_bus_submit(i2c_bus_device_t *dev, i2c_cmd_handle_t cmd, i2c_bus_recover_t recover,
+                                uint32_t deadline_ms) {
+    ARG_CHECK(owner != NULL, "i2c_bus_init was not called");
+    ARG_CHECK(xTaskGetCurrentTaskHandle() != owner, "called from the bus owner");
+
+    i2c_bus_request_t req = {
+            .dev = dev,
+            .cmd = cmd,
+            .recover = recover,
+            .enqueued_us = esp_timer_get_time(),
+            .err = ESP_FAIL,
+    };
+    req.deadline_us = req.enqueued_us + (int64_t) deadline_ms * 1000;
+    req.done = xSemaphoreCreateBinaryStatic(&req.done_buf);
+
+    xSemaphoreTake(free_count, portMAX_DELAY);
+    portENTER_CRITICAL(&spinlock);
+    req.seq = seq++;
+    i2c_bus_push(&req);
+    portEXIT_CRITICAL(&spinlock);
+    xSemaphoreGive(pending_count);
+
+    xSemaphoreTake(req.done, portMAX_DELAY);
+    vSemaphoreDelete(req.done);
+    return req.err;
+}
+
+esp_err_t i2c_bus_cmd_begin(i2c_bus_device_handle_t dev, i2c_cmd_handle_t cmd, uint32_t deadline_ms) {
+    ARG_CHECK(dev != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(cmd != NULL, ERR_PARAM_NULL);
+    return i2c_bus_submit(dev, cmd, NULL, deadline_ms);
+}
+
+esp_err_t i2c_bus_recover(i2c_bus_recover_t recover) {
+    ARG_CHECK(recover != NULL, ERR_PARAM_NULL);
+    return i2c_bus_submit(&recover_dev, NULL, recover, I2C_BUS_DEFAULT_DEADLINE_MS);
+}
+
+esp_err_t i2c_bus_write_reg_read(i2c_bus_device_handle_t dev, uint8_t reg_address, const uint8_t *write_buffer,
+                                 size_t write_size, uint8_t *read_buffer, size_t read_size) {
+    ARG_CHECK(dev != NULL, ERR_PARAM_NULL);
+    return i2c_bus_write_reg_read_at(dev, dev->address, reg_address, write_buffer, write_size, read_buffer,
+                                     read_size);
+}
+
+esp_err_t i2c_bus_write_reg_read_at(i2c_bus_device_handle_t dev, uint8_t address, uint8_t reg_address,
+                                    const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer,
+                                    size_t read_size) {
+    ARG_CHECK(dev != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(address < 0x80, "invalid address: 0x%02x", address);
+    ARG_CHECK(write_size == 0 || write_buffer != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(read_size == 0 || read_buffer != NULL, ERR_PARAM_NULL);
+
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    CHECK_NO_MEM(cmd);
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write_byte(cmd, reg_address, true);
+    if (write_size > 0) {
+        i2c_master_write(cmd, write_buffer, write_size, true);
+    }
+    if (read_size > 0) {
+        i2c_master_start(cmd);
+        i2c_master_write_byte(cmd, (address << 1) | I2C_MASTER_READ, true);
+        i2c_master_read(cmd, read_buffer, read_size, I2C_MASTER_LAST_NACK);
+    }
+    i2c_master_stop(cmd);
+
+    esp_err_t err = i2c_bus_cmd_begin(dev, cmd, I2C_BUS_DEFAULT_DEADLINE_MS);
+    i2c_cmd_link_delete(cmd);
+    return err;
+}
+
+esp_err_t i2c_bus_get_stats(i2c_bus_device_handle_t dev, i2c_bus_stats_t *stats) {
+    ARG_CHECK(dev != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(stats != NULL, ERR_PARAM_NULL);
+
+    portENTER_CRITICAL(&spinlock);
+    *stats = dev->stats;
+    portEXIT_CRITICAL(&spinlock);
+    return ESP_OK;
+}
+
+// Header and rows share the column widths, keep them in sync.
+#define I2C_BUS_DUMP_HEADER " %-4s %-15s %1s %8s %7s %7s %8s %7s %8s %7s"
+#define I2C_BUS_DUMP_ROW " 0x%02x %-15.15s %1d %8u %7u %7u %8u %7u %8u %7u"
+#define I2C_BUS_DUMP_LINE "=================================================================================="
+
+void i2c_bus_dump(void) {
+    ESP_LOGI(TAG, I2C_BUS_DUMP_LINE);
+    ESP_LOGI(TAG, I2C_BUS_DUMP_HEADER, "Addr", "Name", "P", "Count", "Errors", "Expired", "Wait us", "Max us",
+             "Exec us", "Max us");
+    ESP_LOGI(TAG, I2C_BUS_DUMP_LINE);
+    for (size_t i = 0; i < n_devices; ++i) {
+        i2c_bus_stats_t s = {0};
+        ESP_ERROR_CHECK(i2c_bus_get_stats(&devices[i], &s));
+        ESP_LOGI(TAG, I2C_BUS_DUMP_ROW, devices[i].address, devices[i].name, devices[i].priority, s.transactions,
+                 s.errors, s.expired, s.last_wait_us, s.max_wait_us, s.last_exec_us, s.max_exec_us);
+    }
+    ESP_LOGI(TAG, I2C_BUS_DUMP_LINE);
+}
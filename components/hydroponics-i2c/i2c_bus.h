@@ -0,0 +1,73 @@
+#ifndef HYDROPONICS_I2C_I2C_BUS_H
+#define HYDROPONICS_I2C_I2C_BUS_H
+
+#include "driver/i2c.h"
+
+#include "esp_err.h"
+
+#define I2C_BUS_MAX_DEVICES 16
+#define I2C_BUS_MAX_PENDING 16
+#define I2C_BUS_DEFAULT_DEADLINE_MS 1000
+
+typedef enum {
+    I2C_BUS_PRIORITY_LOW = 0,    /*!< Bulk transfers that can wait, e.g. display frames. */
+    I2C_BUS_PRIORITY_NORMAL = 1, /*!< Sensor reads. */
+    I2C_BUS_PRIORITY_HIGH = 2,   /*!< Actuator writes. */
+    I2C_BUS_PRIORITY_MAX,
+} i2c_bus_priority_t;
+
+typedef struct {
+    uint32_t transactions;
+    uint32_t errors;
+    uint32_t expired;         /*!< Transactions dropped because their deadline passed while queued. */
+    uint32_t last_wait_us;    /*!< Time spent queued waiting for the bus. */
+    uint32_t max_wait_us;
+    uint32_t last_exec_us;    /*!< Time spent on the wire. */
+    uint32_t max_exec_us;
+} i2c_bus_stats_t;
+
+typedef struct i2c_bus_device *i2c_bus_device_handle_t;
+
+// Brings a wedged bus back, e.g. reinstalling the driver around a manual clock out. Runs on the bus owner.
+typedef esp_err_t (*i2c_bus_recover_t)(i2c_port_t port);
+
+// Executes a command link on the wire, i2c_master_cmd_begin by default.
+typedef esp_err_t (*i2c_bus_transport_t)(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks);
+
+// The I2C driver must already be installed on the port.
+esp_err_t i2c_bus_init(i2c_port_t port);
+
+// Same scheduling without the I2C driver, e.g. a simulated bus on boards without the hardware.
+esp_err_t i2c_bus_init_with_transport(i2c_port_t port, i2c_bus_transport_t transport);
+
+esp_err_t i2c_bus_add_device(const char *name, uint8_t address, i2c_bus_priority_t priority,
+                             i2c_bus_device_handle_t *dev);
+
+uint8_t i2c_bus_device_address(i2c_bus_device_handle_t dev);
+
+// First device registered at `address`, NULL if none.
+i2c_bus_device_handle_t i2c_bus_find_device(uint8_t address);
+
+/*
+ * Queues a command link and blocks until the bus owner executed it. Transactions run by device priority and then by
+ * deadline. A transaction still queued when its deadline passes fails with ESP_ERR_TIMEOUT without touching the bus.
+ * The command link remains owned by the caller.
+ */
+esp_err_t i2c_bus_cmd_begin(i2c_bus_device_handle_t dev, i2c_cmd_handle_t cmd, uint32_t deadline_ms);
+
+// Runs `recover` between two transactions, ahead of anything else queued.
+esp_err_t i2c_bus_recover(i2c_bus_recover_t recover);
+
+esp_err_t i2c_bus_write_reg_read(i2c_bus_device_handle_t dev, uint8_t reg_address, const uint8_t *write_buffer,
+                                 size_t write_size, uint8_t *read_buffer, size_t read_size);
+
+// Same as i2c_bus_write_reg_read on another address, e.g. a raw device shared by ad hoc transfers. Counted on `dev`.
+esp_err_t i2c_bus_write_reg_read_at(i2c_bus_device_handle_t dev, uint8_t address, uint8_t reg_address,
+                                    const uint8_t *write_buffer, size_t write_size, uint8_t *read_buffer,
+                                    size_t read_size);
+
+esp_err_t i2c_bus_get_stats(i2c_bus_device_handle_t dev, i2c_bus_stats_t *stats);
+
+void i2c_bus_dump(void);
+
+#endif //HYDROPONICS_I2C_I2C_BUS_H
@@ -0,0 +1,170 @@
+#include <math.h>
+#include <string.h>
+
+#include "esp_err.h"
+
+#include "error.h"
+#include "plant.h"
+
+#define PLANT_EC_PER_G_L        1500.f  /*!< uS/cm for every gram of salts per liter. */
+#define PLANT_PKA               6.5f    /*!< Dominant buffer of the nutrient solution. */
+#define PLANT_PH_SPAN           2.f     /*!< Past this the buffer is exhausted, the model saturates. */
+#define PLANT_MIN_VOLUME_L      0.5f    /*!< The pump intake, below it nothing leaves the tank. */
+#define PLANT_MIX_ON_S          30.f
+#define PLANT_MIX_OFF_S         1200.f
+#define PLANT_TEMP_TAU_S        10800.f
+#define PLANT_UPTAKE_SALT_RATIO 0.8f    /*!< Plants drink water faster than they take salts, EC climbs. */
+#define PLANT_UPTAKE_BASE_MMOL  0.5f    /*!< Released per liter drunk, nitrate uptake pushes the pH up. */
+
+static const char *const TAG = "plant";
+
+// Fresh water, per liter.
+static const plant_solutes_t FILL = {.salt_g = 0.1f, .buffer_mmol = 2.f, .base_mmol = 0.6f};
+// Nutrient concentrate, per milliliter, besides its salts.
+static const plant_solutes_t NUTRIENT = {.buffer_mmol = 0.5f, .base_mmol = -0.2f};
+
+static void plant_solutes_add(plant_solutes_t *s, const plant_solutes_t *o, float amount) {
+    s->salt_g += o->salt_g * amount;
+    s->buffer_mmol += o->buffer_mmol * amount;
+    s->base_mmol += o->base_mmol * amount;
+}
+
+static void plant_solutes_scale(plant_solutes_t *s, float factor) {
+    s->salt_g *= factor;
+    s->buffer_mmol *= factor;
+    s->base_mmol *= factor;
+}
+
+static void plant_add_nutrient(plant_t *plant, plant_solutes_t *s, float ml) {
+    s->salt_g += plant->params.nutrient_g_per_ml * ml;
+    plant_solutes_add(s, &NUTRIENT, ml);
+    plant->volume_l += ml / 1000.f;
+}
+
+static void plant_dose(plant_t *plant, float dt_s) {
+    const plant_params_t *p = &plant->params;
+    float dose_ml = p->dose_mlpm * dt_s / 60.f;
+    if (plant->outputs[PLANT_OUTPUT_NUTRIENTS]) {
+        plant_add_nutrient(plant, &plant->unmixed, dose_ml);
+    }
+    if (plant->outputs[PLANT_OUTPUT_PH_DOWN]) {
+        plant->unmixed.base_mmol -= p->acid_mmol_per_ml * dose_ml;
+        plant->volume_l += dose_ml / 1000.f;
+    }
+    if (plant->outputs[PLANT_OUTPUT_PH_UP]) {
+        plant->unmixed.base_mmol += p->base_mmol_per_ml * dose_ml;
+        plant->volume_l += dose_ml / 1000.f;
+    }
+}
+
+static void plant_fill(plant_t *plant, float dt_s) {
+    const plant_params_t *p = &plant->params;
+    if (!plant->outputs[PLANT_OUTPUT_FILL]) {
+        return;
+    }
+    float liters = p->fill_lpm * dt_s / 60.f;
+    plant->temp_c = (plant->temp_c * plant->volume_l + p->fill_c * liters) / (plant->volume_l + liters);
+    plant->volume_l += liters;
+    plant_solutes_add(&plant->mixed, &FILL, liters);
+}
+
+static void plant_mix(plant_t *plant, float dt_s) {
+    float tau = plant->outputs[PLANT_OUTPUT_MIXER] ? PLANT_MIX_ON_S : PLANT_MIX_OFF_S;
+    float f = fminf(dt_s / tau, 1.f);
+    plant_solutes_t moved = plant->unmixed;
+    plant_solutes_scale(&moved, f);
+    plant_solutes_add(&plant->mixed, &moved, 1.f);
+    plant_solutes_scale(&plant->unmixed, 1.f - f);
+}
+
+static void plant_drain(plant_t *plant, float dt_s) {
+    const plant_params_t *p = &plant->params;
+    float available = fmaxf(plant->volume_l - PLANT_MIN_VOLUME_L, 0.f);
+    float evaporation = p->evaporation_lph * (1.f + 0.05f * (plant->temp_c - 20.f)) * dt_s / 3600.f;
+    evaporation = fminf(fmaxf(evaporation, 0.f), available);
+    plant->volume_l -= evaporation;
+    available -= evaporation;
+
+    if (plant->outputs[PLANT_OUTPUT_IRRIGATION]) {
+        float drunk = fminf(p->transpiration_lph * dt_s / 3600.f, available);
+        float salt = plant->mixed.salt_g / plant->volume_l * drunk * PLANT_UPTAKE_SALT_RATIO;
+        plant->mixed.salt_g -= fminf(salt, plant->mixed.salt_g);
+        plant->mixed.base_mmol += PLANT_UPTAKE_BASE_MMOL * drunk;
+        plant->volume_l -= drunk;
+    }
+    // Anything above the rim spills with whatever is dissolved in it.
+    if (plant->volume_l > p->capacity_l) {
+        plant_solutes_scale(&plant->mixed, p->capacity_l / plant->volume_l);
+        plant->volume_l = p->capacity_l;
+    }
+}
+
+static void plant_step(plant_t *plant, float dt_s) {
+    plant_fill(plant, dt_s);
+    plant_dose(plant, dt_s);
+    plant_mix(plant, dt_s);
+    plant_drain(plant, dt_s);
+    plant->temp_c += (plant->params.ambient_c - plant->temp_c) * fminf(dt_s / PLANT_TEMP_TAU_S, 1.f);
+}
+
+esp_err_t plant_init(plant_t *plant, const plant_params_t *params) {
+    ARG_CHECK(plant != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(params != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(params->capacity_l > 0, ERR_PARAM_LE_ZERO);
+    ARG_CHECK(params->volume_l >= PLANT_MIN_VOLUME_L && params->volume_l <= params->capacity_l,
+              "volume out of range: %.1f", params->volume_l);
+
+    memset(plant, 0, sizeof(plant_t));
+    plant->params = *params;
+    plant->volume_l = params->volume_l;
+    plant->temp_c = params->ambient_c;
+    plant_solutes_add(&plant->mixed, &FILL, params->volume_l);
+    if (params->nutrient_g_per_ml > 0) {
+        plant_add_nutrient(plant, &plant->mixed, params->nutrient_g_l * params->volume_l / params->nutrient_g_per_ml);
+    }
+    plant->noise = params->seed;
+    return ESP_OK;
+}
+
+esp_err_t plant_set_output(plant_t *plant, plant_output_t output, bool on) {
+    ARG_CHECK(plant != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(output < PLANT_OUTPUT_MAX, "invalid output: %d", output);
+    plant->outputs[output] = on;
+    return ESP_OK;
+}
+
+esp_err_t plant_advance(plant_t *plant, uint64_t now_ms) {
+    ARG_CHECK(plant != NULL, ERR_PARAM_NULL);
+    while (plant->now_ms + PLANT_STEP_MS <= now_ms) {
+        plant_step(plant, PLANT_STEP_MS / 1000.f);
+        plant->now_ms += PLANT_STEP_MS;
+    }
+    return ESP_OK;
+}
+
+float plant_level(const plant_t *plant) {
+    return plant->volume_l / plant->params.capacity_l;
+}
+
+float plant_ec(const plant_t *plant) {
+    return plant->mixed.salt_g / plant->volume_l * PLANT_EC_PER_G_L;
+}
+
+// Henderson-Hasselbalch over the buffer pair, clamped once either side of the pair runs out.
+float plant_ph(const plant_t *plant) {
+    float half = plant->mixed.buffer_mmol / 2.f;
+    if (half <= 0.f) {
+        return 7.f;
+    }
+    float ph = PLANT_PKA + log10f(fmaxf(half + plant->mixed.base_mmol, 1e-6f) / fmaxf(half - plant->mixed.base_mmol, 1e-6f));
+    return fminf(fmaxf(ph, PLANT_PKA - PLANT_PH_SPAN), PLANT_PKA + PLANT_PH_SPAN);
+}
+
+float plant_temp(const plant_t *plant) {
+    return plant->temp_c;
+}
+
+float plant_noise(plant_t *plant, float amplitude) {
+    plant->noise = plant->noise * 1664525u + 1013904223u;
+    return ((float) (plant->noise >> 8) / (float) (1u << 24) * 2.f - 1.f) * amplitude;
+}
@@ -0,0 +1,88 @@
+#ifndef HYDROPONICS_PLANT_PLANT_H
+#define HYDROPONICS_PLANT_PLANT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define PLANT_STEP_MS 1000 /*!< Integration step of the model, in virtual milliseconds. */
+
+typedef enum {
+    PLANT_OUTPUT_FILL = 0,       /*!< Fresh water valve. */
+    PLANT_OUTPUT_MIXER = 1,
+    PLANT_OUTPUT_PH_DOWN = 2,    /*!< Acid doser. */
+    PLANT_OUTPUT_PH_UP = 3,      /*!< Base doser. */
+    PLANT_OUTPUT_NUTRIENTS = 4,  /*!< Nutrient concentrate doser. */
+    PLANT_OUTPUT_IRRIGATION = 5, /*!< Any of the grow bed pumps, plants only drink while it runs. */
+    PLANT_OUTPUT_MAX = 6,
+} plant_output_t;
+
+typedef struct {
+    float capacity_l;
+    float volume_l;               /*!< Initial volume. */
+    float nutrient_g_l;           /*!< Initial salts from concentrate, on top of the fresh water ones. */
+    float ambient_c;              /*!< Air temperature the water drifts towards. */
+    float fill_c;                 /*!< Temperature of the fresh water. */
+    float fill_lpm;
+    float dose_mlpm;              /*!< Flow of every doser. */
+    float nutrient_g_per_ml;      /*!< Salts in the nutrient concentrate. */
+    float acid_mmol_per_ml;
+    float base_mmol_per_ml;
+    float evaporation_lph;        /*!< At 20 C, grows 5% per degree. */
+    float transpiration_lph;      /*!< While irrigating. */
+    uint32_t seed;                /*!< Seed of the sensor noise, equal seeds replay the same run. */
+} plant_params_t;
+
+#define PLANT_PARAMS_DEFAULT {        \
+        .capacity_l = 100.f,          \
+        .volume_l = 60.f,             \
+        .nutrient_g_l = 1.f,          \
+        .ambient_c = 21.f,            \
+        .fill_c = 15.f,               \
+        .fill_lpm = 4.f,              \
+        .dose_mlpm = 50.f,            \
+        .nutrient_g_per_ml = 0.2f,    \
+        .acid_mmol_per_ml = 1.f,      \
+        .base_mmol_per_ml = 1.f,      \
+        .evaporation_lph = 0.05f,     \
+        .transpiration_lph = 0.2f,    \
+        .seed = 1,                    \
+}
+
+typedef struct {
+    float salt_g;
+    float buffer_mmol; /*!< Weak acid and its conjugate base, sets how hard the pH is to move. */
+    float base_mmol;   /*!< Excess of conjugate base over the weak acid, positive is alkaline. */
+} plant_solutes_t;
+
+typedef struct {
+    plant_params_t params;
+    uint64_t now_ms;           /*!< Virtual time of the last step. */
+    bool outputs[PLANT_OUTPUT_MAX];
+    float volume_l;
+    float temp_c;
+    plant_solutes_t mixed;     /*!< What the probes see. */
+    plant_solutes_t unmixed;   /*!< Doses still sitting around the injection point. */
+    uint32_t noise;
+} plant_t;
+
+esp_err_t plant_init(plant_t *plant, const plant_params_t *params);
+
+esp_err_t plant_set_output(plant_t *plant, plant_output_t output, bool on);
+
+// Integrates the model in fixed steps up to the virtual time `now_ms`, identical inputs always give identical states.
+esp_err_t plant_advance(plant_t *plant, uint64_t now_ms);
+
+float plant_level(const plant_t *plant);
+
+float plant_ec(const plant_t *plant);
+
+float plant_ph(const plant_t *plant);
+
+float plant_temp(const plant_t *plant);
+
+// Deterministic uniform noise in [-amplitude, amplitude].
+float plant_noise(plant_t *plant, float amplitude);
+
+#endif //HYDROPONICS_PLANT_PLANT_H
@@ -187,6 +187,51 @@ void   hydroponics__command_i2c__free_unpacked
   assert(message->base.descriptor == &hydroponics__command_i2c__descriptor);
   protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
 }
+void   hydroponics__command_calibration__init
+                     (Hydroponics__CommandCalibration         *message)
+{
+  static const Hydroponics__CommandCalibration init_value = HYDROPONICS__COMMAND_CALIBRATION__INIT;
+  *message = init_value;
+}
+size_t hydroponics__command_calibration__get_packed_size
+                     (const Hydroponics__CommandCalibration *message)
+{
+  assert(message->base.descriptor == &hydroponics__command_calibration__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t hydroponics__command_calibration__pack
+                     (const Hydroponics__CommandCalibration *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &hydroponics__command_calibration__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t hydroponics__command_calibration__pack_to_buffer
+                     (const Hydroponics__CommandCalibration *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &hydroponics__command_calibration__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Hydroponics__CommandCalibration *
+       hydroponics__command_calibration__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Hydroponics__CommandCalibration *)
+     protobuf_c_message_unpack (&hydroponics__command_calibration__descriptor,
+                                allocator, len, data);
+}
+void   hydroponics__command_calibration__free_unpacked
+                     (Hydroponics__CommandCalibration *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &hydroponics__command_calibration__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
 void   hydroponics__command__init
                      (Hydroponics__Command         *message)
 {
@@ -487,7 +532,86 @@ const ProtobufCMessageDescriptor hydroponics__command_i2c__descriptor =
   (ProtobufCMessageInit) hydroponics__command_i2c__init,
   NULL,NULL,NULL    /* reserved[123] */
 };
-static const ProtobufCFieldDescriptor hydroponics__command__field_descriptors[4] =
+static const ProtobufCEnumValue hydroponics__command_calibration__action__enum_values_by_number[2] =
+{
+  { "SNAPSHOT", "HYDROPONICS__COMMAND_CALIBRATION__ACTION__SNAPSHOT", 0 },
+  { "RESTORE", "HYDROPONICS__COMMAND_CALIBRATION__ACTION__RESTORE", 1 },
+};
+static const ProtobufCIntRange hydroponics__command_calibration__action__value_ranges[] = {
+{0, 0},{0, 2}
+};
+static const ProtobufCEnumValueIndex hydroponics__command_calibration__action__enum_values_by_name[2] =
+{
+  { "RESTORE", 1 },
+  { "SNAPSHOT", 0 },
+};
+const ProtobufCEnumDescriptor hydroponics__command_calibration__action__descriptor =
+{
+  PROTOBUF_C__ENUM_DESCRIPTOR_MAGIC,
+  "hydroponics.CommandCalibration.Action",
+  "Action",
+  "Hydroponics__CommandCalibration__Action",
+  "hydroponics",
+  2,
+  hydroponics__command_calibration__action__enum_values_by_number,
+  2,
+  hydroponics__command_calibration__action__enum_values_by_name,
+  1,
+  hydroponics__command_calibration__action__value_ranges,
+  NULL,NULL,NULL,NULL   /* reserved[1234] */
+};
+static const ProtobufCFieldDescriptor hydroponics__command_calibration__field_descriptors[2] =
+{
+  {
+    "action",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_ENUM,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__CommandCalibration, action),
+    &hydroponics__command_calibration__action__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "sensor",
+    2,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_STRING,
+    offsetof(Hydroponics__CommandCalibration, n_sensor),
+    offsetof(Hydroponics__CommandCalibration, sensor),
+    NULL,
+    &protobuf_c_empty_string,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__command_calibration__field_indices_by_name[] = {
+  0,   /* field[0] = action */
+  1,   /* field[1] = sensor */
+};
+static const ProtobufCIntRange hydroponics__command_calibration__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 2 }
+};
+const ProtobufCMessageDescriptor hydroponics__command_calibration__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.CommandCalibration",
+  "CommandCalibration",
+  "Hydroponics__CommandCalibration",
+  "hydroponics",
+  sizeof(Hydroponics__CommandCalibration),
+  2,
+  hydroponics__command_calibration__field_descriptors,
+  hydroponics__command_calibration__field_indices_by_name,
+  1,  hydroponics__command_calibration__number_ranges,
+  (ProtobufCMessageInit) hydroponics__command_calibration__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor hydroponics__command__field_descriptors[5] =
 {
   {
     "reboot",
@@ -537,8 +661,21 @@ static const ProtobufCFieldDescriptor hydroponics__command__field_descriptors[4]
     0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
+  {
+    "calibration",
+    5,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__Command, command_case),
+    offsetof(Hydroponics__Command, calibration),
+    &hydroponics__command_calibration__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
 };
 static const unsigned hydroponics__command__field_indices_by_name[] = {
+  4,   /* field[4] = calibration */
   3,   /* field[3] = i2c */
   2,   /* field[2] = impulse */
   0,   /* field[0] = reboot */
@@ -547,7 +684,7 @@ static const unsigned hydroponics__command__field_indices_by_name[] = {
 static const ProtobufCIntRange hydroponics__command__number_ranges[1 + 1] =
 {
   { 1, 0 },
-  { 0, 4 }
+  { 0, 5 }
 };
 const ProtobufCMessageDescriptor hydroponics__command__descriptor =
 {
@@ -557,7 +694,7 @@ const ProtobufCMessageDescriptor hydroponics__command__descriptor =
   "Hydroponics__Command",
   "hydroponics",
   sizeof(Hydroponics__Command),
-  4,
+  5,
   hydroponics__command__field_descriptors,
   hydroponics__command__field_indices_by_name,
   1,  hydroponics__command__number_ranges,
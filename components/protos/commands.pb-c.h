@@ -20,12 +20,18 @@ typedef struct Hydroponics__CommandReboot Hydroponics__CommandReboot;
 typedef struct Hydroponics__CommandSet Hydroponics__CommandSet;
 typedef struct Hydroponics__CommandImpulse Hydroponics__CommandImpulse;
 typedef struct Hydroponics__CommandI2c Hydroponics__CommandI2c;
+typedef struct Hydroponics__CommandCalibration Hydroponics__CommandCalibration;
 typedef struct Hydroponics__Command Hydroponics__Command;
 typedef struct Hydroponics__Commands Hydroponics__Commands;
 
 
 /* --- enums --- */
 
+typedef enum _Hydroponics__CommandCalibration__Action {
+  HYDROPONICS__COMMAND_CALIBRATION__ACTION__SNAPSHOT = 0,
+  HYDROPONICS__COMMAND_CALIBRATION__ACTION__RESTORE = 1
+    PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__COMMAND_CALIBRATION__ACTION)
+} Hydroponics__CommandCalibration__Action;
 
 /* --- messages --- */
 
@@ -81,12 +87,28 @@ struct  Hydroponics__CommandI2c
     , 0, 0, {0,NULL}, 0 }
 
 
+/*
+ * Snapshots the calibration of the EZO modules into NVS or restores it. An empty `sensor` list means every module.
+ */
+struct  Hydroponics__CommandCalibration
+{
+  ProtobufCMessage base;
+  Hydroponics__CommandCalibration__Action action;
+  size_t n_sensor;
+  char **sensor;
+};
+#define HYDROPONICS__COMMAND_CALIBRATION__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&hydroponics__command_calibration__descriptor) \
+    , HYDROPONICS__COMMAND_CALIBRATION__ACTION__SNAPSHOT, 0,NULL }
+
+
 typedef enum {
   HYDROPONICS__COMMAND__COMMAND__NOT_SET = 0,
   HYDROPONICS__COMMAND__COMMAND_REBOOT = 1,
   HYDROPONICS__COMMAND__COMMAND_SET = 2,
   HYDROPONICS__COMMAND__COMMAND_IMPULSE = 3,
-  HYDROPONICS__COMMAND__COMMAND_I2C = 4
+  HYDROPONICS__COMMAND__COMMAND_I2C = 4,
+  HYDROPONICS__COMMAND__COMMAND_CALIBRATION = 5
     PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__COMMAND__COMMAND__CASE)
 } Hydroponics__Command__CommandCase;
 
@@ -99,6 +121,7 @@ struct  Hydroponics__Command
     Hydroponics__CommandSet *set;
     Hydroponics__CommandImpulse *impulse;
     Hydroponics__CommandI2c *i2c;
+    Hydroponics__CommandCalibration *calibration;
   };
 };
 #define HYDROPONICS__COMMAND__INIT \
@@ -193,6 +216,25 @@ Hydroponics__CommandI2c *
 void   hydroponics__command_i2c__free_unpacked
                      (Hydroponics__CommandI2c *message,
                       ProtobufCAllocator *allocator);
+/* Hydroponics__CommandCalibration methods */
+void   hydroponics__command_calibration__init
+                     (Hydroponics__CommandCalibration         *message);
+size_t hydroponics__command_calibration__get_packed_size
+                     (const Hydroponics__CommandCalibration   *message);
+size_t hydroponics__command_calibration__pack
+                     (const Hydroponics__CommandCalibration   *message,
+                      uint8_t             *out);
+size_t hydroponics__command_calibration__pack_to_buffer
+                     (const Hydroponics__CommandCalibration   *message,
+                      ProtobufCBuffer     *buffer);
+Hydroponics__CommandCalibration *
+       hydroponics__command_calibration__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   hydroponics__command_calibration__free_unpacked
+                     (Hydroponics__CommandCalibration *message,
+                      ProtobufCAllocator *allocator);
 /* Hydroponics__Command methods */
 void   hydroponics__command__init
                      (Hydroponics__Command         *message);
@@ -245,6 +287,9 @@ typedef void (*Hydroponics__CommandImpulse_Closure)
 typedef void (*Hydroponics__CommandI2c_Closure)
                  (const Hydroponics__CommandI2c *message,
                   void *closure_data);
+typedef void (*Hydroponics__CommandCalibration_Closure)
+                 (const Hydroponics__CommandCalibration *message,
+                  void *closure_data);
 typedef void (*Hydroponics__Command_Closure)
                  (const Hydroponics__Command *message,
                   void *closure_data);
@@ -261,6 +306,8 @@ extern const ProtobufCMessageDescriptor hydroponics__command_reboot__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__command_set__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__command_impulse__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__command_i2c__descriptor;
+extern const ProtobufCMessageDescriptor hydroponics__command_calibration__descriptor;
+extern const ProtobufCEnumDescriptor    hydroponics__command_calibration__action__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__command__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__commands__descriptor;
 
@@ -295,6 +295,102 @@ void   hydroponics__firmware__free_unpacked
   assert(message->base.descriptor == &hydroponics__firmware__descriptor);
   protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
 }
+void   hydroponics__calibration__point__init
+                     (Hydroponics__Calibration__Point         *message)
+{
+  static const Hydroponics__Calibration__Point init_value = HYDROPONICS__CALIBRATION__POINT__INIT;
+  *message = init_value;
+}
+void   hydroponics__calibration__init
+                     (Hydroponics__Calibration         *message)
+{
+  static const Hydroponics__Calibration init_value = HYDROPONICS__CALIBRATION__INIT;
+  *message = init_value;
+}
+size_t hydroponics__calibration__get_packed_size
+                     (const Hydroponics__Calibration *message)
+{
+  assert(message->base.descriptor == &hydroponics__calibration__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t hydroponics__calibration__pack
+                     (const Hydroponics__Calibration *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &hydroponics__calibration__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t hydroponics__calibration__pack_to_buffer
+                     (const Hydroponics__Calibration *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &hydroponics__calibration__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Hydroponics__Calibration *
+       hydroponics__calibration__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Hydroponics__Calibration *)
+     protobuf_c_message_unpack (&hydroponics__calibration__descriptor,
+                                allocator, len, data);
+}
+void   hydroponics__calibration__free_unpacked
+                     (Hydroponics__Calibration *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &hydroponics__calibration__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   hydroponics__one_wire_probe__init
+                     (Hydroponics__OneWireProbe         *message)
+{
+  static const Hydroponics__OneWireProbe init_value = HYDROPONICS__ONE_WIRE_PROBE__INIT;
+  *message = init_value;
+}
+size_t hydroponics__one_wire_probe__get_packed_size
+                     (const Hydroponics__OneWireProbe *message)
+{
+  assert(message->base.descriptor == &hydroponics__one_wire_probe__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t hydroponics__one_wire_probe__pack
+                     (const Hydroponics__OneWireProbe *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &hydroponics__one_wire_probe__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t hydroponics__one_wire_probe__pack_to_buffer
+                     (const Hydroponics__OneWireProbe *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &hydroponics__one_wire_probe__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Hydroponics__OneWireProbe *
+       hydroponics__one_wire_probe__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Hydroponics__OneWireProbe *)
+     protobuf_c_message_unpack (&hydroponics__one_wire_probe__descriptor,
+                                allocator, len, data);
+}
+void   hydroponics__one_wire_probe__free_unpacked
+                     (Hydroponics__OneWireProbe *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &hydroponics__one_wire_probe__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
 void   hydroponics__config__init
                      (Hydroponics__Config         *message)
 {
@@ -340,7 +436,7 @@ void   hydroponics__config__free_unpacked
   assert(message->base.descriptor == &hydroponics__config__descriptor);
   protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
 }
-static const ProtobufCFieldDescriptor hydroponics__sampling__field_descriptors[6] =
+static const ProtobufCFieldDescriptor hydroponics__sampling__field_descriptors[7] =
 {
   {
     "humidity_ms",
@@ -414,6 +510,18 @@ static const ProtobufCFieldDescriptor hydroponics__sampling__field_descriptors[6
     0,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
+  {
+    "tank_ms",
+    7,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_INT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__Sampling, tank_ms),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
 };
 static const unsigned hydroponics__sampling__field_indices_by_name[] = {
   2,   /* field[2] = ec_probe_ms */
@@ -421,12 +529,13 @@ static const unsigned hydroponics__sampling__field_indices_by_name[] = {
   0,   /* field[0] = humidity_ms */
   5,   /* field[5] = mqtt_ms */
   4,   /* field[4] = ph_probe_ms */
+  6,   /* field[6] = tank_ms */
   1,   /* field[1] = temperature_ms */
 };
 static const ProtobufCIntRange hydroponics__sampling__number_ranges[1 + 1] =
 {
   { 1, 0 },
-  { 0, 6 }
+  { 0, 7 }
 };
 const ProtobufCMessageDescriptor hydroponics__sampling__descriptor =
 {
@@ -436,7 +545,7 @@ const ProtobufCMessageDescriptor hydroponics__sampling__descriptor =
   "Hydroponics__Sampling",
   "hydroponics",
   sizeof(Hydroponics__Sampling),
-  6,
+  7,
   hydroponics__sampling__field_descriptors,
   hydroponics__sampling__field_indices_by_name,
   1,  hydroponics__sampling__number_ranges,
@@ -1089,7 +1198,283 @@ const ProtobufCMessageDescriptor hydroponics__firmware__descriptor =
   (ProtobufCMessageInit) hydroponics__firmware__init,
   NULL,NULL,NULL    /* reserved[123] */
 };
-static const ProtobufCFieldDescriptor hydroponics__config__field_descriptors[6] =
+static const ProtobufCFieldDescriptor hydroponics__calibration__point__field_descriptors[2] =
+{
+  {
+    "raw",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_INT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__Calibration__Point, raw),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "value",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_FLOAT,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__Calibration__Point, value),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__calibration__point__field_indices_by_name[] = {
+  0,   /* field[0] = raw */
+  1,   /* field[1] = value */
+};
+static const ProtobufCIntRange hydroponics__calibration__point__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 2 }
+};
+const ProtobufCMessageDescriptor hydroponics__calibration__point__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.Calibration.Point",
+  "Point",
+  "Hydroponics__Calibration__Point",
+  "hydroponics",
+  sizeof(Hydroponics__Calibration__Point),
+  2,
+  hydroponics__calibration__point__field_descriptors,
+  hydroponics__calibration__point__field_indices_by_name,
+  1,  hydroponics__calibration__point__number_ranges,
+  (ProtobufCMessageInit) hydroponics__calibration__point__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCEnumValue hydroponics__calibration__sensor__enum_values_by_number[2] =
+{
+  { "TANK_A", "HYDROPONICS__CALIBRATION__SENSOR__TANK_A", 0 },
+  { "TANK_B", "HYDROPONICS__CALIBRATION__SENSOR__TANK_B", 1 },
+};
+static const ProtobufCIntRange hydroponics__calibration__sensor__value_ranges[] = {
+{0, 0},{0, 2}
+};
+static const ProtobufCEnumValueIndex hydroponics__calibration__sensor__enum_values_by_name[2] =
+{
+  { "TANK_A", 0 },
+  { "TANK_B", 1 },
+};
+const ProtobufCEnumDescriptor hydroponics__calibration__sensor__descriptor =
+{
+  PROTOBUF_C__ENUM_DESCRIPTOR_MAGIC,
+  "hydroponics.Calibration.Sensor",
+  "Sensor",
+  "Hydroponics__Calibration__Sensor",
+  "hydroponics",
+  2,
+  hydroponics__calibration__sensor__enum_values_by_number,
+  2,
+  hydroponics__calibration__sensor__enum_values_by_name,
+  1,
+  hydroponics__calibration__sensor__value_ranges,
+  NULL,NULL,NULL,NULL   /* reserved[1234] */
+};
+static const ProtobufCEnumValue hydroponics__calibration__type__enum_values_by_number[2] =
+{
+  { "PIECEWISE", "HYDROPONICS__CALIBRATION__TYPE__PIECEWISE", 0 },
+  { "POLYNOMIAL", "HYDROPONICS__CALIBRATION__TYPE__POLYNOMIAL", 1 },
+};
+static const ProtobufCIntRange hydroponics__calibration__type__value_ranges[] = {
+{0, 0},{0, 2}
+};
+static const ProtobufCEnumValueIndex hydroponics__calibration__type__enum_values_by_name[2] =
+{
+  { "PIECEWISE", 0 },
+  { "POLYNOMIAL", 1 },
+};
+const ProtobufCEnumDescriptor hydroponics__calibration__type__descriptor =
+{
+  PROTOBUF_C__ENUM_DESCRIPTOR_MAGIC,
+  "hydroponics.Calibration.Type",
+  "Type",
+  "Hydroponics__Calibration__Type",
+  "hydroponics",
+  2,
+  hydroponics__calibration__type__enum_values_by_number,
+  2,
+  hydroponics__calibration__type__enum_values_by_name,
+  1,
+  hydroponics__calibration__type__value_ranges,
+  NULL,NULL,NULL,NULL   /* reserved[1234] */
+};
+static const ProtobufCFieldDescriptor hydroponics__calibration__field_descriptors[4] =
+{
+  {
+    "sensor",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_ENUM,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__Calibration, sensor),
+    &hydroponics__calibration__sensor__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "type",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_ENUM,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__Calibration, type),
+    &hydroponics__calibration__type__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "degree",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_INT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__Calibration, degree),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "point",
+    4,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__Calibration, n_point),
+    offsetof(Hydroponics__Calibration, point),
+    &hydroponics__calibration__point__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__calibration__field_indices_by_name[] = {
+  2,   /* field[2] = degree */
+  3,   /* field[3] = point */
+  0,   /* field[0] = sensor */
+  1,   /* field[1] = type */
+};
+static const ProtobufCIntRange hydroponics__calibration__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 4 }
+};
+const ProtobufCMessageDescriptor hydroponics__calibration__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.Calibration",
+  "Calibration",
+  "Hydroponics__Calibration",
+  "hydroponics",
+  sizeof(Hydroponics__Calibration),
+  4,
+  hydroponics__calibration__field_descriptors,
+  hydroponics__calibration__field_indices_by_name,
+  1,  hydroponics__calibration__number_ranges,
+  (ProtobufCMessageInit) hydroponics__calibration__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCEnumValue hydroponics__one_wire_probe__channel__enum_values_by_number[2] =
+{
+  { "NONE", "HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__NONE", 0 },
+  { "WATER", "HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__WATER", 1 },
+};
+static const ProtobufCIntRange hydroponics__one_wire_probe__channel__value_ranges[] = {
+{0, 0},{0, 2}
+};
+static const ProtobufCEnumValueIndex hydroponics__one_wire_probe__channel__enum_values_by_name[2] =
+{
+  { "NONE", 0 },
+  { "WATER", 1 },
+};
+const ProtobufCEnumDescriptor hydroponics__one_wire_probe__channel__descriptor =
+{
+  PROTOBUF_C__ENUM_DESCRIPTOR_MAGIC,
+  "hydroponics.OneWireProbe.Channel",
+  "Channel",
+  "Hydroponics__OneWireProbe__Channel",
+  "hydroponics",
+  2,
+  hydroponics__one_wire_probe__channel__enum_values_by_number,
+  2,
+  hydroponics__one_wire_probe__channel__enum_values_by_name,
+  1,
+  hydroponics__one_wire_probe__channel__value_ranges,
+  NULL,NULL,NULL,NULL   /* reserved[1234] */
+};
+static const ProtobufCFieldDescriptor hydroponics__one_wire_probe__field_descriptors[3] =
+{
+  {
+    "rom",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_STRING,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__OneWireProbe, rom),
+    NULL,
+    &protobuf_c_empty_string,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "channel",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_ENUM,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__OneWireProbe, channel),
+    &hydroponics__one_wire_probe__channel__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "resolution",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_INT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__OneWireProbe, resolution),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__one_wire_probe__field_indices_by_name[] = {
+  1,   /* field[1] = channel */
+  2,   /* field[2] = resolution */
+  0,   /* field[0] = rom */
+};
+static const ProtobufCIntRange hydroponics__one_wire_probe__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 3 }
+};
+const ProtobufCMessageDescriptor hydroponics__one_wire_probe__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.OneWireProbe",
+  "OneWireProbe",
+  "Hydroponics__OneWireProbe",
+  "hydroponics",
+  sizeof(Hydroponics__OneWireProbe),
+  3,
+  hydroponics__one_wire_probe__field_descriptors,
+  hydroponics__one_wire_probe__field_indices_by_name,
+  1,  hydroponics__one_wire_probe__number_ranges,
+  (ProtobufCMessageInit) hydroponics__one_wire_probe__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor hydroponics__config__field_descriptors[8] =
 {
   {
     "sampling",
@@ -1163,11 +1548,37 @@ static const ProtobufCFieldDescriptor hydroponics__config__field_descriptors[6]
     0,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
+  {
+    "calibration",
+    7,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__Config, n_calibration),
+    offsetof(Hydroponics__Config, calibration),
+    &hydroponics__calibration__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "one_wire_probe",
+    8,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__Config, n_one_wire_probe),
+    offsetof(Hydroponics__Config, one_wire_probe),
+    &hydroponics__one_wire_probe__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
 };
 static const unsigned hydroponics__config__field_indices_by_name[] = {
+  6,   /* field[6] = calibration */
   1,   /* field[1] = controller */
   5,   /* field[5] = firmware */
   3,   /* field[3] = hardware_id */
+  7,   /* field[7] = one_wire_probe */
   0,   /* field[0] = sampling */
   4,   /* field[4] = startup_state */
   2,   /* field[2] = task */
@@ -1175,7 +1586,7 @@ static const unsigned hydroponics__config__field_indices_by_name[] = {
 static const ProtobufCIntRange hydroponics__config__number_ranges[1 + 1] =
 {
   { 1, 0 },
-  { 0, 6 }
+  { 0, 8 }
 };
 const ProtobufCMessageDescriptor hydroponics__config__descriptor =
 {
@@ -1185,7 +1596,7 @@ const ProtobufCMessageDescriptor hydroponics__config__descriptor =
   "Hydroponics__Config",
   "hydroponics",
   sizeof(Hydroponics__Config),
-  6,
+  8,
   hydroponics__config__field_descriptors,
   hydroponics__config__field_indices_by_name,
   1,  hydroponics__config__number_ranges,
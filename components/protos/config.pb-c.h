@@ -24,6 +24,9 @@ typedef struct Hydroponics__Task__Cron Hydroponics__Task__Cron;
 typedef struct Hydroponics__HardwareId Hydroponics__HardwareId;
 typedef struct Hydroponics__StartupState Hydroponics__StartupState;
 typedef struct Hydroponics__Firmware Hydroponics__Firmware;
+typedef struct Hydroponics__Calibration Hydroponics__Calibration;
+typedef struct Hydroponics__Calibration__Point Hydroponics__Calibration__Point;
+typedef struct Hydroponics__OneWireProbe Hydroponics__OneWireProbe;
 typedef struct Hydroponics__Config Hydroponics__Config;
 
 
@@ -39,6 +42,30 @@ typedef enum _Hydroponics__Firmware__Arch {
   HYDROPONICS__FIRMWARE__ARCH__ESP32_S2 = 1
     PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__FIRMWARE__ARCH)
 } Hydroponics__Firmware__Arch;
+typedef enum _Hydroponics__Calibration__Sensor {
+  HYDROPONICS__CALIBRATION__SENSOR__TANK_A = 0,
+  HYDROPONICS__CALIBRATION__SENSOR__TANK_B = 1
+    PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__CALIBRATION__SENSOR)
+} Hydroponics__Calibration__Sensor;
+typedef enum _Hydroponics__Calibration__Type {
+  /*
+   * Linear interpolation between the points.
+   */
+  HYDROPONICS__CALIBRATION__TYPE__PIECEWISE = 0,
+  /*
+   * Least squares polynomial fitted on the device.
+   */
+  HYDROPONICS__CALIBRATION__TYPE__POLYNOMIAL = 1
+    PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__CALIBRATION__TYPE)
+} Hydroponics__Calibration__Type;
+typedef enum _Hydroponics__OneWireProbe__Channel {
+  /*
+   * Read and logged but not published.
+   */
+  HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__NONE = 0,
+  HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__WATER = 1
+    PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__ONE_WIRE_PROBE__CHANNEL)
+} Hydroponics__OneWireProbe__Channel;
 /*
  * Directly matches "ext_gpio_num_t" enumeration.
  */
@@ -132,10 +159,11 @@ struct  Hydroponics__Sampling
   int32_t ec_probe_temp_ms;
   int32_t ph_probe_ms;
   int32_t mqtt_ms;
+  int32_t tank_ms;
 };
 #define HYDROPONICS__SAMPLING__INIT \
  { PROTOBUF_C_MESSAGE_INIT (&hydroponics__sampling__descriptor) \
-    , 0, 0, 0, 0, 0, 0 }
+    , 0, 0, 0, 0, 0, 0, 0 }
 
 
 struct  Hydroponics__Controller__Entry__Pid
@@ -244,6 +272,58 @@ struct  Hydroponics__Firmware
     , HYDROPONICS__FIRMWARE__TYPE__TEST, HYDROPONICS__FIRMWARE__ARCH__ESP32, (char *)protobuf_c_empty_string, (char *)protobuf_c_empty_string, (char *)protobuf_c_empty_string }
 
 
+struct  Hydroponics__Calibration__Point
+{
+  ProtobufCMessage base;
+  /*
+   * Raw ADC reading.
+   */
+  int32_t raw;
+  /*
+   * Calibrated value for the reading.
+   */
+  float value;
+};
+#define HYDROPONICS__CALIBRATION__POINT__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&hydroponics__calibration__point__descriptor) \
+    , 0, 0 }
+
+
+struct  Hydroponics__Calibration
+{
+  ProtobufCMessage base;
+  Hydroponics__Calibration__Sensor sensor;
+  Hydroponics__Calibration__Type type;
+  /*
+   * Only used by POLYNOMIAL, between 1 and 3.
+   */
+  int32_t degree;
+  size_t n_point;
+  Hydroponics__Calibration__Point **point;
+};
+#define HYDROPONICS__CALIBRATION__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&hydroponics__calibration__descriptor) \
+    , HYDROPONICS__CALIBRATION__SENSOR__TANK_A, HYDROPONICS__CALIBRATION__TYPE__PIECEWISE, 0, 0,NULL }
+
+
+struct  Hydroponics__OneWireProbe
+{
+  ProtobufCMessage base;
+  /*
+   * ROM code as 16 hex digits, e.g. "ec03109779b03128".
+   */
+  char *rom;
+  Hydroponics__OneWireProbe__Channel channel;
+  /*
+   * Between 9 and 12 bits, 0 means 12. Each bit less halves the conversion time.
+   */
+  int32_t resolution;
+};
+#define HYDROPONICS__ONE_WIRE_PROBE__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&hydroponics__one_wire_probe__descriptor) \
+    , (char *)protobuf_c_empty_string, HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__NONE, 0 }
+
+
 struct  Hydroponics__Config
 {
   ProtobufCMessage base;
@@ -257,10 +337,14 @@ struct  Hydroponics__Config
   Hydroponics__StartupState **startup_state;
   size_t n_firmware;
   Hydroponics__Firmware **firmware;
+  size_t n_calibration;
+  Hydroponics__Calibration **calibration;
+  size_t n_one_wire_probe;
+  Hydroponics__OneWireProbe **one_wire_probe;
 };
 #define HYDROPONICS__CONFIG__INIT \
  { PROTOBUF_C_MESSAGE_INIT (&hydroponics__config__descriptor) \
-    , NULL, NULL, 0,NULL, 0,NULL, 0,NULL, 0,NULL }
+    , NULL, NULL, 0,NULL, 0,NULL, 0,NULL, 0,NULL, 0,NULL, 0,NULL }
 
 
 /* Hydroponics__Sampling methods */
@@ -386,6 +470,47 @@ Hydroponics__Firmware *
 void   hydroponics__firmware__free_unpacked
                      (Hydroponics__Firmware *message,
                       ProtobufCAllocator *allocator);
+/* Hydroponics__Calibration__Point methods */
+void   hydroponics__calibration__point__init
+                     (Hydroponics__Calibration__Point         *message);
+/* Hydroponics__Calibration methods */
+void   hydroponics__calibration__init
+                     (Hydroponics__Calibration         *message);
+size_t hydroponics__calibration__get_packed_size
+                     (const Hydroponics__Calibration   *message);
+size_t hydroponics__calibration__pack
+                     (const Hydroponics__Calibration   *message,
+                      uint8_t             *out);
+size_t hydroponics__calibration__pack_to_buffer
+                     (const Hydroponics__Calibration   *message,
+                      ProtobufCBuffer     *buffer);
+Hydroponics__Calibration *
+       hydroponics__calibration__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   hydroponics__calibration__free_unpacked
+                     (Hydroponics__Calibration *message,
+                      ProtobufCAllocator *allocator);
+/* Hydroponics__OneWireProbe methods */
+void   hydroponics__one_wire_probe__init
+                     (Hydroponics__OneWireProbe         *message);
+size_t hydroponics__one_wire_probe__get_packed_size
+                     (const Hydroponics__OneWireProbe   *message);
+size_t hydroponics__one_wire_probe__pack
+                     (const Hydroponics__OneWireProbe   *message,
+                      uint8_t             *out);
+size_t hydroponics__one_wire_probe__pack_to_buffer
+                     (const Hydroponics__OneWireProbe   *message,
+                      ProtobufCBuffer     *buffer);
+Hydroponics__OneWireProbe *
+       hydroponics__one_wire_probe__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   hydroponics__one_wire_probe__free_unpacked
+                     (Hydroponics__OneWireProbe *message,
+                      ProtobufCAllocator *allocator);
 /* Hydroponics__Config methods */
 void   hydroponics__config__init
                      (Hydroponics__Config         *message);
@@ -434,6 +559,15 @@ typedef void (*Hydroponics__StartupState_Closure)
 typedef void (*Hydroponics__Firmware_Closure)
                  (const Hydroponics__Firmware *message,
                   void *closure_data);
+typedef void (*Hydroponics__Calibration__Point_Closure)
+                 (const Hydroponics__Calibration__Point *message,
+                  void *closure_data);
+typedef void (*Hydroponics__Calibration_Closure)
+                 (const Hydroponics__Calibration *message,
+                  void *closure_data);
+typedef void (*Hydroponics__OneWireProbe_Closure)
+                 (const Hydroponics__OneWireProbe *message,
+                  void *closure_data);
 typedef void (*Hydroponics__Config_Closure)
                  (const Hydroponics__Config *message,
                   void *closure_data);
@@ -456,6 +590,12 @@ extern const ProtobufCMessageDescriptor hydroponics__startup_state__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__firmware__descriptor;
 extern const ProtobufCEnumDescriptor    hydroponics__firmware__type__descriptor;
 extern const ProtobufCEnumDescriptor    hydroponics__firmware__arch__descriptor;
+extern const ProtobufCMessageDescriptor hydroponics__calibration__descriptor;
+extern const ProtobufCMessageDescriptor hydroponics__calibration__point__descriptor;
+extern const ProtobufCEnumDescriptor    hydroponics__calibration__sensor__descriptor;
+extern const ProtobufCEnumDescriptor    hydroponics__calibration__type__descriptor;
+extern const ProtobufCMessageDescriptor hydroponics__one_wire_probe__descriptor;
+extern const ProtobufCEnumDescriptor    hydroponics__one_wire_probe__channel__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__config__descriptor;
 
 PROTOBUF_C__END_DECLS
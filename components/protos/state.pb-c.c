@@ -277,6 +277,12 @@ void   hydroponics__state_outputs__free_unpacked
   assert(message->base.descriptor == &hydroponics__state_outputs__descriptor);
   protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
 }
+void   hydroponics__state_reboot__event__init
+                     (Hydroponics__StateReboot__Event         *message)
+{
+  static const Hydroponics__StateReboot__Event init_value = HYDROPONICS__STATE_REBOOT__EVENT__INIT;
+  *message = init_value;
+}
 void   hydroponics__state_reboot__init
                      (Hydroponics__StateReboot         *message)
 {
@@ -322,6 +328,153 @@ void   hydroponics__state_reboot__free_unpacked
   assert(message->base.descriptor == &hydroponics__state_reboot__descriptor);
   protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
 }
+void   hydroponics__state_cron__job__init
+                     (Hydroponics__StateCron__Job         *message)
+{
+  static const Hydroponics__StateCron__Job init_value = HYDROPONICS__STATE_CRON__JOB__INIT;
+  *message = init_value;
+}
+void   hydroponics__state_cron__init
+                     (Hydroponics__StateCron         *message)
+{
+  static const Hydroponics__StateCron init_value = HYDROPONICS__STATE_CRON__INIT;
+  *message = init_value;
+}
+size_t hydroponics__state_cron__get_packed_size
+                     (const Hydroponics__StateCron *message)
+{
+  assert(message->base.descriptor == &hydroponics__state_cron__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t hydroponics__state_cron__pack
+                     (const Hydroponics__StateCron *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &hydroponics__state_cron__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t hydroponics__state_cron__pack_to_buffer
+                     (const Hydroponics__StateCron *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &hydroponics__state_cron__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Hydroponics__StateCron *
+       hydroponics__state_cron__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Hydroponics__StateCron *)
+     protobuf_c_message_unpack (&hydroponics__state_cron__descriptor,
+                                allocator, len, data);
+}
+void   hydroponics__state_cron__free_unpacked
+                     (Hydroponics__StateCron *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &hydroponics__state_cron__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   hydroponics__state_health__sensor__init
+                     (Hydroponics__StateHealth__Sensor         *message)
+{
+  static const Hydroponics__StateHealth__Sensor init_value = HYDROPONICS__STATE_HEALTH__SENSOR__INIT;
+  *message = init_value;
+}
+void   hydroponics__state_health__init
+                     (Hydroponics__StateHealth         *message)
+{
+  static const Hydroponics__StateHealth init_value = HYDROPONICS__STATE_HEALTH__INIT;
+  *message = init_value;
+}
+size_t hydroponics__state_health__get_packed_size
+                     (const Hydroponics__StateHealth *message)
+{
+  assert(message->base.descriptor == &hydroponics__state_health__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t hydroponics__state_health__pack
+                     (const Hydroponics__StateHealth *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &hydroponics__state_health__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t hydroponics__state_health__pack_to_buffer
+                     (const Hydroponics__StateHealth *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &hydroponics__state_health__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Hydroponics__StateHealth *
+       hydroponics__state_health__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Hydroponics__StateHealth *)
+     protobuf_c_message_unpack (&hydroponics__state_health__descriptor,
+                                allocator, len, data);
+}
+void   hydroponics__state_health__free_unpacked
+                     (Hydroponics__StateHealth *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &hydroponics__state_health__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
+void   hydroponics__state_config__init
+                     (Hydroponics__StateConfig         *message)
+{
+  static const Hydroponics__StateConfig init_value = HYDROPONICS__STATE_CONFIG__INIT;
+  *message = init_value;
+}
+size_t hydroponics__state_config__get_packed_size
+                     (const Hydroponics__StateConfig *message)
+{
+  assert(message->base.descriptor == &hydroponics__state_config__descriptor);
+  return protobuf_c_message_get_packed_size ((const ProtobufCMessage*)(message));
+}
+size_t hydroponics__state_config__pack
+                     (const Hydroponics__StateConfig *message,
+                      uint8_t       *out)
+{
+  assert(message->base.descriptor == &hydroponics__state_config__descriptor);
+  return protobuf_c_message_pack ((const ProtobufCMessage*)message, out);
+}
+size_t hydroponics__state_config__pack_to_buffer
+                     (const Hydroponics__StateConfig *message,
+                      ProtobufCBuffer *buffer)
+{
+  assert(message->base.descriptor == &hydroponics__state_config__descriptor);
+  return protobuf_c_message_pack_to_buffer ((const ProtobufCMessage*)message, buffer);
+}
+Hydroponics__StateConfig *
+       hydroponics__state_config__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data)
+{
+  return (Hydroponics__StateConfig *)
+     protobuf_c_message_unpack (&hydroponics__state_config__descriptor,
+                                allocator, len, data);
+}
+void   hydroponics__state_config__free_unpacked
+                     (Hydroponics__StateConfig *message,
+                      ProtobufCAllocator *allocator)
+{
+  if(!message)
+    return;
+  assert(message->base.descriptor == &hydroponics__state_config__descriptor);
+  protobuf_c_message_free_unpacked ((ProtobufCMessage*)message, allocator);
+}
 void   hydroponics__state__init
                      (Hydroponics__State         *message)
 {
@@ -928,9 +1081,178 @@ const ProtobufCMessageDescriptor hydroponics__state_outputs__descriptor =
   (ProtobufCMessageInit) hydroponics__state_outputs__init,
   NULL,NULL,NULL    /* reserved[123] */
 };
-#define hydroponics__state_reboot__field_descriptors NULL
-#define hydroponics__state_reboot__field_indices_by_name NULL
-#define hydroponics__state_reboot__number_ranges NULL
+static const ProtobufCFieldDescriptor hydroponics__state_reboot__event__field_descriptors[3] =
+{
+  {
+    "timestamp_ms",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateReboot__Event, timestamp_ms),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "bits",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateReboot__Event, bits),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "set",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_BOOL,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateReboot__Event, set),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__state_reboot__event__field_indices_by_name[] = {
+  1,   /* field[1] = bits */
+  2,   /* field[2] = set */
+  0,   /* field[0] = timestamp_ms */
+};
+static const ProtobufCIntRange hydroponics__state_reboot__event__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 3 }
+};
+const ProtobufCMessageDescriptor hydroponics__state_reboot__event__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.StateReboot.Event",
+  "Event",
+  "Hydroponics__StateReboot__Event",
+  "hydroponics",
+  sizeof(Hydroponics__StateReboot__Event),
+  3,
+  hydroponics__state_reboot__event__field_descriptors,
+  hydroponics__state_reboot__event__field_indices_by_name,
+  1,  hydroponics__state_reboot__event__number_ranges,
+  (ProtobufCMessageInit) hydroponics__state_reboot__event__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCEnumValue hydroponics__state_reboot__reason__enum_values_by_number[11] =
+{
+  { "UNKNOWN", "HYDROPONICS__STATE_REBOOT__REASON__UNKNOWN", 0 },
+  { "POWER_ON", "HYDROPONICS__STATE_REBOOT__REASON__POWER_ON", 1 },
+  { "EXTERNAL", "HYDROPONICS__STATE_REBOOT__REASON__EXTERNAL", 2 },
+  { "SOFTWARE", "HYDROPONICS__STATE_REBOOT__REASON__SOFTWARE", 3 },
+  { "PANIC", "HYDROPONICS__STATE_REBOOT__REASON__PANIC", 4 },
+  { "INT_WDT", "HYDROPONICS__STATE_REBOOT__REASON__INT_WDT", 5 },
+  { "TASK_WDT", "HYDROPONICS__STATE_REBOOT__REASON__TASK_WDT", 6 },
+  { "WDT", "HYDROPONICS__STATE_REBOOT__REASON__WDT", 7 },
+  { "DEEP_SLEEP", "HYDROPONICS__STATE_REBOOT__REASON__DEEP_SLEEP", 8 },
+  { "BROWNOUT", "HYDROPONICS__STATE_REBOOT__REASON__BROWNOUT", 9 },
+  { "SDIO", "HYDROPONICS__STATE_REBOOT__REASON__SDIO", 10 },
+};
+static const ProtobufCIntRange hydroponics__state_reboot__reason__value_ranges[] = {
+{0, 0},{0, 11}
+};
+static const ProtobufCEnumValueIndex hydroponics__state_reboot__reason__enum_values_by_name[11] =
+{
+  { "BROWNOUT", 9 },
+  { "DEEP_SLEEP", 8 },
+  { "EXTERNAL", 2 },
+  { "INT_WDT", 5 },
+  { "PANIC", 4 },
+  { "POWER_ON", 1 },
+  { "SDIO", 10 },
+  { "SOFTWARE", 3 },
+  { "TASK_WDT", 6 },
+  { "UNKNOWN", 0 },
+  { "WDT", 7 },
+};
+const ProtobufCEnumDescriptor hydroponics__state_reboot__reason__descriptor =
+{
+  PROTOBUF_C__ENUM_DESCRIPTOR_MAGIC,
+  "hydroponics.StateReboot.Reason",
+  "Reason",
+  "Hydroponics__StateReboot__Reason",
+  "hydroponics",
+  11,
+  hydroponics__state_reboot__reason__enum_values_by_number,
+  11,
+  hydroponics__state_reboot__reason__enum_values_by_name,
+  1,
+  hydroponics__state_reboot__reason__value_ranges,
+  NULL,NULL,NULL,NULL   /* reserved[1234] */
+};
+static const ProtobufCFieldDescriptor hydroponics__state_reboot__field_descriptors[4] =
+{
+  {
+    "reason",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_ENUM,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateReboot, reason),
+    &hydroponics__state_reboot__reason__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "boot_count",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateReboot, boot_count),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "line",
+    3,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_BYTES,
+    offsetof(Hydroponics__StateReboot, n_line),
+    offsetof(Hydroponics__StateReboot, line),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "event",
+    4,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__StateReboot, n_event),
+    offsetof(Hydroponics__StateReboot, event),
+    &hydroponics__state_reboot__event__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__state_reboot__field_indices_by_name[] = {
+  1,   /* field[1] = boot_count */
+  3,   /* field[3] = event */
+  2,   /* field[2] = line */
+  0,   /* field[0] = reason */
+};
+static const ProtobufCIntRange hydroponics__state_reboot__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 4 }
+};
 const ProtobufCMessageDescriptor hydroponics__state_reboot__descriptor =
 {
   PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
@@ -939,110 +1261,637 @@ const ProtobufCMessageDescriptor hydroponics__state_reboot__descriptor =
   "Hydroponics__StateReboot",
   "hydroponics",
   sizeof(Hydroponics__StateReboot),
-  0,
+  4,
   hydroponics__state_reboot__field_descriptors,
   hydroponics__state_reboot__field_indices_by_name,
-  0,  hydroponics__state_reboot__number_ranges,
+  1,  hydroponics__state_reboot__number_ranges,
   (ProtobufCMessageInit) hydroponics__state_reboot__init,
   NULL,NULL,NULL    /* reserved[123] */
 };
-static const ProtobufCFieldDescriptor hydroponics__state__field_descriptors[6] =
+static const ProtobufCFieldDescriptor hydroponics__state_cron__job__field_descriptors[10] =
 {
   {
-    "timestamp",
+    "name",
     1,
     PROTOBUF_C_LABEL_NONE,
-    PROTOBUF_C_TYPE_UINT64,
+    PROTOBUF_C_TYPE_STRING,
     0,   /* quantifier_offset */
-    offsetof(Hydroponics__State, timestamp),
-    NULL,
+    offsetof(Hydroponics__StateCron__Job, name),
     NULL,
+    &protobuf_c_empty_string,
     0,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
   {
-    "telemetry",
+    "expression",
     2,
     PROTOBUF_C_LABEL_NONE,
-    PROTOBUF_C_TYPE_MESSAGE,
-    offsetof(Hydroponics__State, state_case),
-    offsetof(Hydroponics__State, telemetry),
-    &hydroponics__state_telemetry__descriptor,
+    PROTOBUF_C_TYPE_STRING,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateCron__Job, expression),
     NULL,
-    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    &protobuf_c_empty_string,
+    0,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
   {
-    "tasks",
+    "next_execution",
     3,
     PROTOBUF_C_LABEL_NONE,
-    PROTOBUF_C_TYPE_MESSAGE,
-    offsetof(Hydroponics__State, state_case),
-    offsetof(Hydroponics__State, tasks),
-    &hydroponics__state_tasks__descriptor,
+    PROTOBUF_C_TYPE_UINT64,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateCron__Job, next_execution),
     NULL,
-    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    NULL,
+    0,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
   {
-    "memory",
+    "runs",
     4,
     PROTOBUF_C_LABEL_NONE,
-    PROTOBUF_C_TYPE_MESSAGE,
-    offsetof(Hydroponics__State, state_case),
-    offsetof(Hydroponics__State, memory),
-    &hydroponics__state_memory__descriptor,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateCron__Job, runs),
     NULL,
-    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    NULL,
+    0,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
   {
-    "outputs",
+    "overruns",
     5,
     PROTOBUF_C_LABEL_NONE,
-    PROTOBUF_C_TYPE_MESSAGE,
-    offsetof(Hydroponics__State, state_case),
-    offsetof(Hydroponics__State, outputs),
-    &hydroponics__state_outputs__descriptor,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateCron__Job, overruns),
     NULL,
-    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    NULL,
+    0,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
   {
-    "reboot",
+    "misfires",
     6,
     PROTOBUF_C_LABEL_NONE,
-    PROTOBUF_C_TYPE_MESSAGE,
-    offsetof(Hydroponics__State, state_case),
-    offsetof(Hydroponics__State, reboot),
-    &hydroponics__state_reboot__descriptor,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateCron__Job, misfires),
     NULL,
-    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    NULL,
+    0,             /* flags */
     0,NULL,NULL    /* reserved1,reserved2, etc */
   },
-};
-static const unsigned hydroponics__state__field_indices_by_name[] = {
-  3,   /* field[3] = memory */
-  4,   /* field[4] = outputs */
-  5,   /* field[5] = reboot */
-  2,   /* field[2] = tasks */
-  1,   /* field[1] = telemetry */
-  0,   /* field[0] = timestamp */
-};
-static const ProtobufCIntRange hydroponics__state__number_ranges[1 + 1] =
-{
-  { 1, 0 },
-  { 0, 6 }
-};
-const ProtobufCMessageDescriptor hydroponics__state__descriptor =
-{
-  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
-  "hydroponics.State",
+  {
+    "last_lag_ms",
+    7,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_INT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateCron__Job, last_lag_ms),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "last_duration_ms",
+    8,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateCron__Job, last_duration_ms),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "max_duration_ms",
+    9,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateCron__Job, max_duration_ms),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "lateness",
+    10,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_UINT32,
+    offsetof(Hydroponics__StateCron__Job, n_lateness),
+    offsetof(Hydroponics__StateCron__Job, lateness),
+    NULL,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_PACKED,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__state_cron__job__field_indices_by_name[] = {
+  1,   /* field[1] = expression */
+  7,   /* field[7] = last_duration_ms */
+  6,   /* field[6] = last_lag_ms */
+  9,   /* field[9] = lateness */
+  8,   /* field[8] = max_duration_ms */
+  5,   /* field[5] = misfires */
+  0,   /* field[0] = name */
+  2,   /* field[2] = next_execution */
+  4,   /* field[4] = overruns */
+  3,   /* field[3] = runs */
+};
+static const ProtobufCIntRange hydroponics__state_cron__job__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 10 }
+};
+const ProtobufCMessageDescriptor hydroponics__state_cron__job__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.StateCron.Job",
+  "Job",
+  "Hydroponics__StateCron__Job",
+  "hydroponics",
+  sizeof(Hydroponics__StateCron__Job),
+  10,
+  hydroponics__state_cron__job__field_descriptors,
+  hydroponics__state_cron__job__field_indices_by_name,
+  1,  hydroponics__state_cron__job__number_ranges,
+  (ProtobufCMessageInit) hydroponics__state_cron__job__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor hydroponics__state_cron__field_descriptors[1] =
+{
+  {
+    "job",
+    1,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__StateCron, n_job),
+    offsetof(Hydroponics__StateCron, job),
+    &hydroponics__state_cron__job__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__state_cron__field_indices_by_name[] = {
+  0,   /* field[0] = job */
+};
+static const ProtobufCIntRange hydroponics__state_cron__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor hydroponics__state_cron__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.StateCron",
+  "StateCron",
+  "Hydroponics__StateCron",
+  "hydroponics",
+  sizeof(Hydroponics__StateCron),
+  1,
+  hydroponics__state_cron__field_descriptors,
+  hydroponics__state_cron__field_indices_by_name,
+  1,  hydroponics__state_cron__number_ranges,
+  (ProtobufCMessageInit) hydroponics__state_cron__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor hydroponics__state_health__sensor__field_descriptors[8] =
+{
+  {
+    "name",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_STRING,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateHealth__Sensor, name),
+    NULL,
+    &protobuf_c_empty_string,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "status",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_ENUM,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateHealth__Sensor, status),
+    &hydroponics__state_health__status__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "fault",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_ENUM,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateHealth__Sensor, fault),
+    &hydroponics__state_health__fault__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "samples",
+    4,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateHealth__Sensor, samples),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "errors",
+    5,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateHealth__Sensor, errors),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "recoveries",
+    6,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateHealth__Sensor, recoveries),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "consecutive",
+    7,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateHealth__Sensor, consecutive),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "last_good_ms",
+    8,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT64,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateHealth__Sensor, last_good_ms),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__state_health__sensor__field_indices_by_name[] = {
+  6,   /* field[6] = consecutive */
+  4,   /* field[4] = errors */
+  2,   /* field[2] = fault */
+  7,   /* field[7] = last_good_ms */
+  0,   /* field[0] = name */
+  5,   /* field[5] = recoveries */
+  3,   /* field[3] = samples */
+  1,   /* field[1] = status */
+};
+static const ProtobufCIntRange hydroponics__state_health__sensor__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 8 }
+};
+const ProtobufCMessageDescriptor hydroponics__state_health__sensor__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.StateHealth.Sensor",
+  "Sensor",
+  "Hydroponics__StateHealth__Sensor",
+  "hydroponics",
+  sizeof(Hydroponics__StateHealth__Sensor),
+  8,
+  hydroponics__state_health__sensor__field_descriptors,
+  hydroponics__state_health__sensor__field_indices_by_name,
+  1,  hydroponics__state_health__sensor__number_ranges,
+  (ProtobufCMessageInit) hydroponics__state_health__sensor__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCEnumValue hydroponics__state_health__status__enum_values_by_number[3] =
+{
+  { "OK", "HYDROPONICS__STATE_HEALTH__STATUS__OK", 0 },
+  { "DEGRADED", "HYDROPONICS__STATE_HEALTH__STATUS__DEGRADED", 1 },
+  { "FAILED", "HYDROPONICS__STATE_HEALTH__STATUS__FAILED", 2 },
+};
+static const ProtobufCIntRange hydroponics__state_health__status__value_ranges[] = {
+{0, 0},{0, 3}
+};
+static const ProtobufCEnumValueIndex hydroponics__state_health__status__enum_values_by_name[3] =
+{
+  { "DEGRADED", 1 },
+  { "FAILED", 2 },
+  { "OK", 0 },
+};
+const ProtobufCEnumDescriptor hydroponics__state_health__status__descriptor =
+{
+  PROTOBUF_C__ENUM_DESCRIPTOR_MAGIC,
+  "hydroponics.StateHealth.Status",
+  "Status",
+  "Hydroponics__StateHealth__Status",
+  "hydroponics",
+  3,
+  hydroponics__state_health__status__enum_values_by_number,
+  3,
+  hydroponics__state_health__status__enum_values_by_name,
+  1,
+  hydroponics__state_health__status__value_ranges,
+  NULL,NULL,NULL,NULL   /* reserved[1234] */
+};
+static const ProtobufCEnumValue hydroponics__state_health__fault__enum_values_by_number[5] =
+{
+  { "NONE", "HYDROPONICS__STATE_HEALTH__FAULT__NONE", 0 },
+  { "ERROR", "HYDROPONICS__STATE_HEALTH__FAULT__ERROR", 1 },
+  { "STUCK", "HYDROPONICS__STATE_HEALTH__FAULT__STUCK", 2 },
+  { "RANGE", "HYDROPONICS__STATE_HEALTH__FAULT__RANGE", 3 },
+  { "STALE", "HYDROPONICS__STATE_HEALTH__FAULT__STALE", 4 },
+};
+static const ProtobufCIntRange hydroponics__state_health__fault__value_ranges[] = {
+{0, 0},{0, 5}
+};
+static const ProtobufCEnumValueIndex hydroponics__state_health__fault__enum_values_by_name[5] =
+{
+  { "ERROR", 1 },
+  { "NONE", 0 },
+  { "RANGE", 3 },
+  { "STALE", 4 },
+  { "STUCK", 2 },
+};
+const ProtobufCEnumDescriptor hydroponics__state_health__fault__descriptor =
+{
+  PROTOBUF_C__ENUM_DESCRIPTOR_MAGIC,
+  "hydroponics.StateHealth.Fault",
+  "Fault",
+  "Hydroponics__StateHealth__Fault",
+  "hydroponics",
+  5,
+  hydroponics__state_health__fault__enum_values_by_number,
+  5,
+  hydroponics__state_health__fault__enum_values_by_name,
+  1,
+  hydroponics__state_health__fault__value_ranges,
+  NULL,NULL,NULL,NULL   /* reserved[1234] */
+};
+static const ProtobufCFieldDescriptor hydroponics__state_health__field_descriptors[1] =
+{
+  {
+    "sensor",
+    1,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__StateHealth, n_sensor),
+    offsetof(Hydroponics__StateHealth, sensor),
+    &hydroponics__state_health__sensor__descriptor,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__state_health__field_indices_by_name[] = {
+  0,   /* field[0] = sensor */
+};
+static const ProtobufCIntRange hydroponics__state_health__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 1 }
+};
+const ProtobufCMessageDescriptor hydroponics__state_health__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.StateHealth",
+  "StateHealth",
+  "Hydroponics__StateHealth",
+  "hydroponics",
+  sizeof(Hydroponics__StateHealth),
+  1,
+  hydroponics__state_health__field_descriptors,
+  hydroponics__state_health__field_indices_by_name,
+  1,  hydroponics__state_health__number_ranges,
+  (ProtobufCMessageInit) hydroponics__state_health__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor hydroponics__state_config__field_descriptors[3] =
+{
+  {
+    "version",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateConfig, version),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "size",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT32,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateConfig, size),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "sha256",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_BYTES,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__StateConfig, sha256),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__state_config__field_indices_by_name[] = {
+  2,   /* field[2] = sha256 */
+  1,   /* field[1] = size */
+  0,   /* field[0] = version */
+};
+static const ProtobufCIntRange hydroponics__state_config__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 3 }
+};
+const ProtobufCMessageDescriptor hydroponics__state_config__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.StateConfig",
+  "StateConfig",
+  "Hydroponics__StateConfig",
+  "hydroponics",
+  sizeof(Hydroponics__StateConfig),
+  3,
+  hydroponics__state_config__field_descriptors,
+  hydroponics__state_config__field_indices_by_name,
+  1,  hydroponics__state_config__number_ranges,
+  (ProtobufCMessageInit) hydroponics__state_config__init,
+  NULL,NULL,NULL    /* reserved[123] */
+};
+static const ProtobufCFieldDescriptor hydroponics__state__field_descriptors[9] =
+{
+  {
+    "timestamp",
+    1,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_UINT64,
+    0,   /* quantifier_offset */
+    offsetof(Hydroponics__State, timestamp),
+    NULL,
+    NULL,
+    0,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "telemetry",
+    2,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__State, state_case),
+    offsetof(Hydroponics__State, telemetry),
+    &hydroponics__state_telemetry__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "tasks",
+    3,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__State, state_case),
+    offsetof(Hydroponics__State, tasks),
+    &hydroponics__state_tasks__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "memory",
+    4,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__State, state_case),
+    offsetof(Hydroponics__State, memory),
+    &hydroponics__state_memory__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "outputs",
+    5,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__State, state_case),
+    offsetof(Hydroponics__State, outputs),
+    &hydroponics__state_outputs__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "reboot",
+    6,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__State, state_case),
+    offsetof(Hydroponics__State, reboot),
+    &hydroponics__state_reboot__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "cron",
+    7,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__State, state_case),
+    offsetof(Hydroponics__State, cron),
+    &hydroponics__state_cron__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "health",
+    8,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__State, state_case),
+    offsetof(Hydroponics__State, health),
+    &hydroponics__state_health__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+  {
+    "config",
+    9,
+    PROTOBUF_C_LABEL_NONE,
+    PROTOBUF_C_TYPE_MESSAGE,
+    offsetof(Hydroponics__State, state_case),
+    offsetof(Hydroponics__State, config),
+    &hydroponics__state_config__descriptor,
+    NULL,
+    0 | PROTOBUF_C_FIELD_FLAG_ONEOF,             /* flags */
+    0,NULL,NULL    /* reserved1,reserved2, etc */
+  },
+};
+static const unsigned hydroponics__state__field_indices_by_name[] = {
+  8,   /* field[8] = config */
+  6,   /* field[6] = cron */
+  7,   /* field[7] = health */
+  3,   /* field[3] = memory */
+  4,   /* field[4] = outputs */
+  5,   /* field[5] = reboot */
+  2,   /* field[2] = tasks */
+  1,   /* field[1] = telemetry */
+  0,   /* field[0] = timestamp */
+};
+static const ProtobufCIntRange hydroponics__state__number_ranges[1 + 1] =
+{
+  { 1, 0 },
+  { 0, 9 }
+};
+const ProtobufCMessageDescriptor hydroponics__state__descriptor =
+{
+  PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC,
+  "hydroponics.State",
   "State",
   "Hydroponics__State",
   "hydroponics",
   sizeof(Hydroponics__State),
-  6,
+  9,
   hydroponics__state__field_descriptors,
   hydroponics__state__field_indices_by_name,
   1,  hydroponics__state__number_ranges,
@@ -23,6 +23,12 @@ typedef struct Hydroponics__StateTelemetry Hydroponics__StateTelemetry;
 typedef struct Hydroponics__StateOutput Hydroponics__StateOutput;
 typedef struct Hydroponics__StateOutputs Hydroponics__StateOutputs;
 typedef struct Hydroponics__StateReboot Hydroponics__StateReboot;
+typedef struct Hydroponics__StateReboot__Event Hydroponics__StateReboot__Event;
+typedef struct Hydroponics__StateCron Hydroponics__StateCron;
+typedef struct Hydroponics__StateCron__Job Hydroponics__StateCron__Job;
+typedef struct Hydroponics__StateHealth Hydroponics__StateHealth;
+typedef struct Hydroponics__StateHealth__Sensor Hydroponics__StateHealth__Sensor;
+typedef struct Hydroponics__StateConfig Hydroponics__StateConfig;
 typedef struct Hydroponics__State Hydroponics__State;
 typedef struct Hydroponics__States Hydroponics__States;
 
@@ -69,6 +75,43 @@ typedef enum _Hydroponics__StateTelemetry__Type {
   HYDROPONICS__STATE_TELEMETRY__TYPE__TANK_B = 10
     PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__STATE_TELEMETRY__TYPE)
 } Hydroponics__StateTelemetry__Type;
+/*
+ * Same values as esp_reset_reason_t.
+ */
+typedef enum _Hydroponics__StateReboot__Reason {
+  HYDROPONICS__STATE_REBOOT__REASON__UNKNOWN = 0,
+  HYDROPONICS__STATE_REBOOT__REASON__POWER_ON = 1,
+  HYDROPONICS__STATE_REBOOT__REASON__EXTERNAL = 2,
+  HYDROPONICS__STATE_REBOOT__REASON__SOFTWARE = 3,
+  HYDROPONICS__STATE_REBOOT__REASON__PANIC = 4,
+  HYDROPONICS__STATE_REBOOT__REASON__INT_WDT = 5,
+  HYDROPONICS__STATE_REBOOT__REASON__TASK_WDT = 6,
+  HYDROPONICS__STATE_REBOOT__REASON__WDT = 7,
+  HYDROPONICS__STATE_REBOOT__REASON__DEEP_SLEEP = 8,
+  HYDROPONICS__STATE_REBOOT__REASON__BROWNOUT = 9,
+  HYDROPONICS__STATE_REBOOT__REASON__SDIO = 10
+    PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__STATE_REBOOT__REASON)
+} Hydroponics__StateReboot__Reason;
+typedef enum _Hydroponics__StateHealth__Status {
+  HYDROPONICS__STATE_HEALTH__STATUS__OK = 0,
+  /*
+   * Faulting, recovery in progress.
+   */
+  HYDROPONICS__STATE_HEALTH__STATUS__DEGRADED = 1,
+  /*
+   * Every recovery step was tried.
+   */
+  HYDROPONICS__STATE_HEALTH__STATUS__FAILED = 2
+    PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__STATE_HEALTH__STATUS)
+} Hydroponics__StateHealth__Status;
+typedef enum _Hydroponics__StateHealth__Fault {
+  HYDROPONICS__STATE_HEALTH__FAULT__NONE = 0,
+  HYDROPONICS__STATE_HEALTH__FAULT__ERROR = 1,
+  HYDROPONICS__STATE_HEALTH__FAULT__STUCK = 2,
+  HYDROPONICS__STATE_HEALTH__FAULT__RANGE = 3,
+  HYDROPONICS__STATE_HEALTH__FAULT__STALE = 4
+    PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__STATE_HEALTH__FAULT)
+} Hydroponics__StateHealth__Fault;
 
 /* --- messages --- */
 
@@ -151,13 +194,129 @@ struct  Hydroponics__StateOutputs
     , 0,NULL }
 
 
+/*
+ * Context event bits set or cleared.
+ */
+struct  Hydroponics__StateReboot__Event
+{
+  ProtobufCMessage base;
+  /*
+   * Milliseconds since the previous boot.
+   */
+  uint32_t timestamp_ms;
+  uint32_t bits;
+  protobuf_c_boolean set;
+};
+#define HYDROPONICS__STATE_REBOOT__EVENT__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&hydroponics__state_reboot__event__descriptor) \
+    , 0, 0, 0 }
+
+
 struct  Hydroponics__StateReboot
 {
   ProtobufCMessage base;
+  Hydroponics__StateReboot__Reason reason;
+  uint32_t boot_count;
+  /*
+   * Last log lines of the previous boot, oldest first. Binary records with CONFIG_ESP_SYSLOG_BINARY.
+   */
+  size_t n_line;
+  ProtobufCBinaryData *line;
+  size_t n_event;
+  Hydroponics__StateReboot__Event **event;
 };
 #define HYDROPONICS__STATE_REBOOT__INIT \
  { PROTOBUF_C_MESSAGE_INIT (&hydroponics__state_reboot__descriptor) \
-     }
+    , HYDROPONICS__STATE_REBOOT__REASON__UNKNOWN, 0, 0,NULL, 0,NULL }
+
+
+struct  Hydroponics__StateCron__Job
+{
+  ProtobufCMessage base;
+  char *name;
+  /*
+   * Empty for oneshots.
+   */
+  char *expression;
+  /*
+   * Milliseconds since the epoch, 0 when the job will not run again.
+   */
+  uint64_t next_execution;
+  uint32_t runs;
+  uint32_t overruns;
+  uint32_t misfires;
+  int32_t last_lag_ms;
+  uint32_t last_duration_ms;
+  uint32_t max_duration_ms;
+  /*
+   * Start lag histogram: <10ms, <100ms, <1s, <10s and above.
+   */
+  size_t n_lateness;
+  uint32_t *lateness;
+};
+#define HYDROPONICS__STATE_CRON__JOB__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&hydroponics__state_cron__job__descriptor) \
+    , (char *)protobuf_c_empty_string, (char *)protobuf_c_empty_string, 0, 0, 0, 0, 0, 0, 0, 0,NULL }
+
+
+struct  Hydroponics__StateCron
+{
+  ProtobufCMessage base;
+  size_t n_job;
+  Hydroponics__StateCron__Job **job;
+};
+#define HYDROPONICS__STATE_CRON__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&hydroponics__state_cron__descriptor) \
+    , 0,NULL }
+
+
+struct  Hydroponics__StateHealth__Sensor
+{
+  ProtobufCMessage base;
+  char *name;
+  Hydroponics__StateHealth__Status status;
+  /*
+   * Last fault, kept after recovering.
+   */
+  Hydroponics__StateHealth__Fault fault;
+  uint32_t samples;
+  uint32_t errors;
+  uint32_t recoveries;
+  uint32_t consecutive;
+  /*
+   * Milliseconds since boot of the last good sample.
+   */
+  uint64_t last_good_ms;
+};
+#define HYDROPONICS__STATE_HEALTH__SENSOR__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&hydroponics__state_health__sensor__descriptor) \
+    , (char *)protobuf_c_empty_string, HYDROPONICS__STATE_HEALTH__STATUS__OK, HYDROPONICS__STATE_HEALTH__FAULT__NONE, 0, 0, 0, 0, 0 }
+
+
+struct  Hydroponics__StateHealth
+{
+  ProtobufCMessage base;
+  size_t n_sensor;
+  Hydroponics__StateHealth__Sensor **sensor;
+};
+#define HYDROPONICS__STATE_HEALTH__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&hydroponics__state_health__descriptor) \
+    , 0,NULL }
+
+
+/*
+ * Digest of the config stored on the device. A config with the same digest is ignored, no need to send it again.
+ */
+struct  Hydroponics__StateConfig
+{
+  ProtobufCMessage base;
+  uint32_t version;
+  uint32_t size;
+  ProtobufCBinaryData sha256;
+};
+#define HYDROPONICS__STATE_CONFIG__INIT \
+ { PROTOBUF_C_MESSAGE_INIT (&hydroponics__state_config__descriptor) \
+    , 0, 0, {0,NULL} }
 
 
 typedef enum {
@@ -166,7 +325,10 @@ typedef enum {
   HYDROPONICS__STATE__STATE_TASKS = 3,
   HYDROPONICS__STATE__STATE_MEMORY = 4,
   HYDROPONICS__STATE__STATE_OUTPUTS = 5,
-  HYDROPONICS__STATE__STATE_REBOOT = 6
+  HYDROPONICS__STATE__STATE_REBOOT = 6,
+  HYDROPONICS__STATE__STATE_CRON = 7,
+  HYDROPONICS__STATE__STATE_HEALTH = 8,
+  HYDROPONICS__STATE__STATE_CONFIG = 9
     PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(HYDROPONICS__STATE__STATE__CASE)
 } Hydroponics__State__StateCase;
 
@@ -181,6 +343,9 @@ struct  Hydroponics__State
     Hydroponics__StateMemory *memory;
     Hydroponics__StateOutputs *outputs;
     Hydroponics__StateReboot *reboot;
+    Hydroponics__StateCron *cron;
+    Hydroponics__StateHealth *health;
+    Hydroponics__StateConfig *config;
   };
 };
 #define HYDROPONICS__STATE__INIT \
@@ -313,6 +478,9 @@ Hydroponics__StateOutputs *
 void   hydroponics__state_outputs__free_unpacked
                      (Hydroponics__StateOutputs *message,
                       ProtobufCAllocator *allocator);
+/* Hydroponics__StateReboot__Event methods */
+void   hydroponics__state_reboot__event__init
+                     (Hydroponics__StateReboot__Event         *message);
 /* Hydroponics__StateReboot methods */
 void   hydroponics__state_reboot__init
                      (Hydroponics__StateReboot         *message);
@@ -332,6 +500,69 @@ Hydroponics__StateReboot *
 void   hydroponics__state_reboot__free_unpacked
                      (Hydroponics__StateReboot *message,
                       ProtobufCAllocator *allocator);
+/* Hydroponics__StateCron__Job methods */
+void   hydroponics__state_cron__job__init
+                     (Hydroponics__StateCron__Job         *message);
+/* Hydroponics__StateCron methods */
+void   hydroponics__state_cron__init
+                     (Hydroponics__StateCron         *message);
+size_t hydroponics__state_cron__get_packed_size
+                     (const Hydroponics__StateCron   *message);
+size_t hydroponics__state_cron__pack
+                     (const Hydroponics__StateCron   *message,
+                      uint8_t             *out);
+size_t hydroponics__state_cron__pack_to_buffer
+                     (const Hydroponics__StateCron   *message,
+                      ProtobufCBuffer     *buffer);
+Hydroponics__StateCron *
+       hydroponics__state_cron__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   hydroponics__state_cron__free_unpacked
+                     (Hydroponics__StateCron *message,
+                      ProtobufCAllocator *allocator);
+/* Hydroponics__StateHealth__Sensor methods */
+void   hydroponics__state_health__sensor__init
+                     (Hydroponics__StateHealth__Sensor         *message);
+/* Hydroponics__StateHealth methods */
+void   hydroponics__state_health__init
+                     (Hydroponics__StateHealth         *message);
+size_t hydroponics__state_health__get_packed_size
+                     (const Hydroponics__StateHealth   *message);
+size_t hydroponics__state_health__pack
+                     (const Hydroponics__StateHealth   *message,
+                      uint8_t             *out);
+size_t hydroponics__state_health__pack_to_buffer
+                     (const Hydroponics__StateHealth   *message,
+                      ProtobufCBuffer     *buffer);
+Hydroponics__StateHealth *
+       hydroponics__state_health__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   hydroponics__state_health__free_unpacked
+                     (Hydroponics__StateHealth *message,
+                      ProtobufCAllocator *allocator);
+/* Hydroponics__StateConfig methods */
+void   hydroponics__state_config__init
+                     (Hydroponics__StateConfig         *message);
+size_t hydroponics__state_config__get_packed_size
+                     (const Hydroponics__StateConfig   *message);
+size_t hydroponics__state_config__pack
+                     (const Hydroponics__StateConfig   *message,
+                      uint8_t             *out);
+size_t hydroponics__state_config__pack_to_buffer
+                     (const Hydroponics__StateConfig   *message,
+                      ProtobufCBuffer     *buffer);
+Hydroponics__StateConfig *
+       hydroponics__state_config__unpack
+                     (ProtobufCAllocator  *allocator,
+                      size_t               len,
+                      const uint8_t       *data);
+void   hydroponics__state_config__free_unpacked
+                     (Hydroponics__StateConfig *message,
+                      ProtobufCAllocator *allocator);
 /* Hydroponics__State methods */
 void   hydroponics__state__init
                      (Hydroponics__State         *message);
@@ -390,9 +621,27 @@ typedef void (*Hydroponics__StateOutput_Closure)
 typedef void (*Hydroponics__StateOutputs_Closure)
                  (const Hydroponics__StateOutputs *message,
                   void *closure_data);
+typedef void (*Hydroponics__StateReboot__Event_Closure)
+                 (const Hydroponics__StateReboot__Event *message,
+                  void *closure_data);
 typedef void (*Hydroponics__StateReboot_Closure)
                  (const Hydroponics__StateReboot *message,
                   void *closure_data);
+typedef void (*Hydroponics__StateCron__Job_Closure)
+                 (const Hydroponics__StateCron__Job *message,
+                  void *closure_data);
+typedef void (*Hydroponics__StateCron_Closure)
+                 (const Hydroponics__StateCron *message,
+                  void *closure_data);
+typedef void (*Hydroponics__StateHealth__Sensor_Closure)
+                 (const Hydroponics__StateHealth__Sensor *message,
+                  void *closure_data);
+typedef void (*Hydroponics__StateHealth_Closure)
+                 (const Hydroponics__StateHealth *message,
+                  void *closure_data);
+typedef void (*Hydroponics__StateConfig_Closure)
+                 (const Hydroponics__StateConfig *message,
+                  void *closure_data);
 typedef void (*Hydroponics__State_Closure)
                  (const Hydroponics__State *message,
                   void *closure_data);
@@ -414,6 +663,15 @@ extern const ProtobufCEnumDescriptor    hydroponics__state_telemetry__type__desc
 extern const ProtobufCMessageDescriptor hydroponics__state_output__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__state_outputs__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__state_reboot__descriptor;
+extern const ProtobufCMessageDescriptor hydroponics__state_reboot__event__descriptor;
+extern const ProtobufCEnumDescriptor    hydroponics__state_reboot__reason__descriptor;
+extern const ProtobufCMessageDescriptor hydroponics__state_cron__descriptor;
+extern const ProtobufCMessageDescriptor hydroponics__state_cron__job__descriptor;
+extern const ProtobufCMessageDescriptor hydroponics__state_health__descriptor;
+extern const ProtobufCMessageDescriptor hydroponics__state_health__sensor__descriptor;
+extern const ProtobufCEnumDescriptor    hydroponics__state_health__status__descriptor;
+extern const ProtobufCEnumDescriptor    hydroponics__state_health__fault__descriptor;
+extern const ProtobufCMessageDescriptor hydroponics__state_config__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__state__descriptor;
 extern const ProtobufCMessageDescriptor hydroponics__states__descriptor;
 
@@ -3,9 +3,19 @@
 #include "driver/i2c.h"
 
 #include "buses.h"
+#include "i2c_bus.h"
 #include "utils.h"
 
 static const char *TAG = "buses";
+static i2c_bus_device_handle_t scan_dev;
+static const i2c_config_t i2c_config = {
+        .mode = I2C_MODE_MASTER,
+        .sda_io_num = I2C_MASTER_SDA,
+        .sda_pullup_en = GPIO_PULLUP_ENABLE,
+        .scl_io_num = I2C_MASTER_SCL,
+        .scl_pullup_en = GPIO_PULLUP_ENABLE,
+        .master.clk_speed = I2C_MASTER_FREQ_HZ,
+};
 
 static void buses_reset(void) {
     gpio_config_t config = {
@@ -57,26 +67,40 @@ static void buses_i2c_unstuck(void) {
     safe_delay_ms(250);
 }
 
+static esp_err_t buses_i2c_install(i2c_port_t port) {
+    esp_err_t err = i2c_param_config(port, &i2c_config);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return i2c_driver_install(port, i2c_config.mode, I2C_MASTER_RX_BUF_DISABLE, I2C_MASTER_TX_BUF_DISABLE, 0);
+}
+
+// Runs on the bus owner, no transaction is in flight while the pins are taken away from the driver.
+static esp_err_t buses_i2c_recover(i2c_port_t port) {
+    esp_err_t err = i2c_driver_delete(port);
+    if (err != ESP_OK) {
+        return err;
+    }
+    buses_i2c_unstuck();
+    return buses_i2c_install(port);
+}
+
 void buses_init(void) {
     buses_reset();
     buses_i2c_unstuck();
 
-    const i2c_config_t conf = {
-            .mode = I2C_MODE_MASTER,
-            .sda_io_num = I2C_MASTER_SDA,
-            .sda_pullup_en = GPIO_PULLUP_ENABLE,
-            .scl_io_num = I2C_MASTER_SCL,
-            .scl_pullup_en = GPIO_PULLUP_ENABLE,
-            .master.clk_speed = I2C_MASTER_FREQ_HZ,
-    };
-
     ESP_LOGI(TAG, "I2C clock: %d kHz", I2C_MASTER_FREQ_HZ / 1000);
-    ESP_ERROR_CHECK(i2c_param_config(I2C_MASTER_NUM, &conf));
-    ESP_ERROR_CHECK(i2c_driver_install(I2C_MASTER_NUM, conf.mode, I2C_MASTER_RX_BUF_DISABLE,
-                                       I2C_MASTER_TX_BUF_DISABLE, 0));
+    ESP_ERROR_CHECK(buses_i2c_install(I2C_MASTER_NUM));
+    // From now on every transaction goes through the bus manager.
+    ESP_ERROR_CHECK(i2c_bus_init(I2C_MASTER_NUM));
+    ESP_ERROR_CHECK(i2c_bus_add_device("scan", I2C_NO_DEVICE, I2C_BUS_PRIORITY_LOW, &scan_dev));
     ESP_ERROR_CHECK(gpio_install_isr_service(0));
 }
 
+esp_err_t buses_recover(void) {
+    return i2c_bus_recover(buses_i2c_recover);
+}
+
 void buses_scan(void) {
     printf("     0  1  2  3  4  5  6  7  8  9  a  b  c  d  e  f\n");
     printf("00:         ");
@@ -88,7 +112,7 @@ void buses_scan(void) {
         ESP_ERROR_CHECK(i2c_master_start(handle));
         ESP_ERROR_CHECK(i2c_master_write_byte(handle, (i << 1) | I2C_MASTER_WRITE, I2C_WRITE_ACK_CHECK));
         ESP_ERROR_CHECK(i2c_master_stop(handle));
-        esp_err_t err = i2c_master_cmd_begin(I2C_MASTER_NUM, handle, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+        esp_err_t err = i2c_bus_cmd_begin(scan_dev, handle, I2C_TIMEOUT_MS);
         i2c_cmd_link_delete(handle);
 
         if (err == ESP_OK) {
@@ -50,6 +50,7 @@ typedef enum {
 #endif
 
 #define TANK_A_CHANNEL ADC1_CHANNEL_0        /*!< GPIO36 Tank A water level analog pin. */
+#define ADS1115_ALERT_GPIO CONFIG_ESP_SENSOR_ADS1115_ALERT_GPIO /*!< ADS1115 ALERT/RDY conversion ready pin. */
 
 typedef enum {
     BUSES_I2C_NO_STOP = 0x0,                 /*!< I2C don't send stop command. */
@@ -69,4 +70,7 @@ void buses_init(void);
 
 void buses_scan(void);
 
+// Clocks out a slave stuck in the middle of a transfer and reinstalls the I2C driver.
+esp_err_t buses_recover(void);
+
 #endif //HYDROPONICS_BUSES_H
@@ -2,11 +2,17 @@
 #include <string.h>
 #include <sys/queue.h>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
 #include "esp_err.h"
 #include "esp_log.h"
 
 #include "config.h"
+#include "config_flash.h"
+#include "config_validate.h"
 #include "context.h"
+#include "cron.h"
 #include "error.h"
 #include "storage.h"
 #include "utils.h"
@@ -14,7 +20,8 @@
 #define CONFIG_KEY_DEVICE_ID  "device_id"
 #define CONFIG_KEY_SSID       "wifi_ssid"
 #define CONFIG_KEY_PASSWORD   "wifi_password"
-#define CONFIG_KEY_IOT_CONFIG "iot_config"
+#define CONFIG_KEY_IOT_CONFIG "iot_config"    // Only read to migrate older firmware.
+#define CONFIG_KEY_IOT_DIGEST "iot_config_dg" // Only read to migrate older firmware.
 
 typedef struct entry {
     config_callback_t callback;
@@ -25,38 +32,105 @@ typedef TAILQ_HEAD(head, entry) head_t;
 
 static const char *TAG = "config";
 static head_t head;
+static config_digest_t digest = {0}; /*!< Digest of the stored config, duplicates never touch the flash. */
+static portMUX_TYPE digest_spinlock = portMUX_INITIALIZER_UNLOCKED;
+static SemaphoreHandle_t lock = NULL;   /*!< Serializes updates, commits and rollbacks. */
+static context_t *health_context = NULL;
+static uint32_t health_generation = 0; /*!< Bumped for every staged config, older health checks are ignored. */
+static bool health_failed = false;
 
-static esp_err_t config_load_from_storage(context_t *context) {
+static void config_set_digest(const config_digest_t *next) {
+    portENTER_CRITICAL(&digest_spinlock);
+    digest = *next;
+    portEXIT_CRITICAL(&digest_spinlock);
+}
+
+// Configs used to live in NVS next to a digest record, move them to the config partition once.
+static esp_err_t config_migrate_from_nvs(void) {
     uint8_t *data = NULL;
     size_t size = 0;
     ESP_ERROR_CHECK(storage_get_blob(CONFIG_KEY_IOT_CONFIG, &data, &size));
-    if (size <= 0 || data == NULL) {
-        SAFE_FREE(data);
+    if (data == NULL) {
         return ESP_OK;
     }
-    ESP_ERROR_CHECK(config_update(context, data, size));
+    config_digest_t next = {.version = 1, .size = size};
+    ESP_ERROR_CHECK(sha256(data, size, next.sha256));
+    ESP_ERROR_CHECK(config_flash_stage(data, &next));
+    ESP_ERROR_CHECK(config_flash_commit());
     SAFE_FREE(data);
+    ESP_ERROR_CHECK(storage_delete(CONFIG_KEY_IOT_CONFIG));
+    ESP_ERROR_CHECK(storage_delete(CONFIG_KEY_IOT_DIGEST));
+    ESP_LOGI(TAG, "Migrated the config from NVS (%u bytes)", size);
     return ESP_OK;
 }
 
-static esp_err_t config_save_to_storage(const uint8_t *data, size_t size, bool *updated) {
+static esp_err_t config_load_from_storage(context_t *context) {
+    ESP_ERROR_CHECK(config_flash_init());
+    ESP_ERROR_CHECK(config_migrate_from_nvs());
+
+    const uint8_t *data = NULL;
+    config_digest_t stored = {0};
+    esp_err_t err = config_flash_read(&data, &stored);
+    if (err == ESP_ERR_NOT_FOUND) {
+        return ESP_OK;
+    }
+    ESP_ERROR_CHECK(err);
+    config_set_digest(&stored);
+    if (data == NULL) {
+        return ESP_OK;
+    }
+    // Unpacked straight from the mapped partition, no copy of the packed config is ever made.
+    err = config_update(context, data, stored.size);
+    if (err != ESP_OK) {
+        // Keep booting without a config rather than looping on one this firmware refuses.
+        ESP_LOGE(TAG, "Unable to load the stored config v%u: %s", stored.version, esp_err_to_name(err));
+    }
+    return ESP_OK;
+}
+
+// Private copies of a config that could not be shared are unpacked straight from the mapped partition.
+static esp_err_t config_set_source(context_t *context) {
+    const uint8_t *mapped = NULL;
+    config_digest_t stored = {0};
+    if (config_flash_read(&mapped, &stored) != ESP_OK || mapped == NULL) {
+        return ESP_OK;
+    }
+    return context_set_config_source(context, mapped, stored.size);
+}
+
+// Whether `sha` is the digest of the stored config and the context already holds it.
+static bool config_is_current(context_t *context, size_t size, const uint8_t *sha) {
+    config_digest_t stored = {0};
+    ESP_ERROR_CHECK(config_get_digest(&stored));
+    return stored.size == size && memcmp(stored.sha256, sha, CONFIG_DIGEST_LEN) == 0 && context->config.config != NULL;
+}
+
+static esp_err_t config_save_to_storage(const uint8_t *data, size_t size, const uint8_t *sha, bool *updated) {
+    config_digest_t next = {0};
+    ESP_ERROR_CHECK(config_get_digest(&next));
     if (data == NULL || size == 0) {
         ESP_LOGI(TAG, "Config was deleted.");
         *updated = true;
-        ESP_ERROR_CHECK(storage_delete(CONFIG_KEY_IOT_CONFIG));
+        if (next.size > 0) {
+            next.version++;
+            next.size = 0;
+            memset(next.sha256, 0, CONFIG_DIGEST_LEN);
+            ESP_ERROR_CHECK(config_flash_stage(NULL, &next));
+            config_set_digest(&next);
+        }
         return ESP_OK;
     }
-    uint8_t *current = NULL;
-    size_t current_size = 0;
-    ESP_ERROR_CHECK(storage_get_blob(CONFIG_KEY_IOT_CONFIG, &current, &current_size));
-    if (current_size == size && memcmp(data, current, size) == 0) {
+    if (next.size == size && memcmp(next.sha256, sha, CONFIG_DIGEST_LEN) == 0) {
         // Same config, nothing to do.
-        SAFE_FREE(current);
         *updated = false;
         return ESP_OK;
     }
-    ESP_ERROR_CHECK(storage_set_blob(CONFIG_KEY_IOT_CONFIG, data, size));
-    SAFE_FREE(current);
+    next.version++;
+    next.size = size;
+    memcpy(next.sha256, sha, CONFIG_DIGEST_LEN);
+    ESP_ERROR_CHECK(config_flash_stage(data, &next));
+    config_set_digest(&next);
+    ESP_LOGI(TAG, "Staged config v%u (%u bytes)", next.version, size);
     *updated = true;
     return ESP_OK;
 }
@@ -70,29 +144,129 @@ static void config_updated_dispatch(context_t *context) {
     }
 }
 
+// Goes back to the last committed config, or to none if there was never one. Must hold the lock.
+static esp_err_t config_rollback(context_t *context) {
+    ESP_ERROR_CHECK(context_set_config_source(context, NULL, 0));
+    ESP_ERROR_CHECK(config_flash_rollback());
+
+    const uint8_t *data = NULL;
+    config_digest_t stored = {0};
+    esp_err_t err = config_flash_read(&data, &stored);
+    if (err != ESP_OK && err != ESP_ERR_NOT_FOUND) {
+        return err;
+    }
+    config_set_digest(&stored);
+    const Hydroponics__Config *config = data != NULL ? hydroponics__config__unpack(NULL, stored.size, data) : NULL;
+    ESP_ERROR_CHECK(context_set_config(context, config));
+    ESP_ERROR_CHECK(config_set_source(context));
+    ESP_LOGW(TAG, "Rolled back to config v%u", stored.version);
+    return ESP_OK;
+}
+
+static void config_health_callback(cron_handle_t handle, const char *name, void *data) {
+    ARG_UNUSED(handle);
+    ARG_UNUSED(name);
+    uint32_t generation = (uint32_t) (uintptr_t) data;
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (generation != health_generation || !config_flash_pending()) {
+        xSemaphoreGive(lock);
+        return;
+    }
+    if (!health_failed) {
+        ESP_ERROR_CHECK(config_flash_commit());
+        xSemaphoreGive(lock);
+        return;
+    }
+    ESP_ERROR_CHECK(config_rollback(health_context));
+    xSemaphoreGive(lock);
+    config_updated_dispatch(health_context);
+}
+
+// The staged config is committed once it ran for the whole window without any subscriber reporting a failure.
+static esp_err_t config_health_start(void) {
+    health_generation++;
+    health_failed = false;
+    cron_handle_t handle = INVALID_CRON_HANDLE;
+    return cron_schedule_in("config_health", CONFIG_ESP_CONFIG_HEALTH_WINDOW_S * 1000, config_health_callback,
+                            (void *) (uintptr_t) health_generation, &handle);
+}
+
 esp_err_t config_update(context_t *context, const uint8_t *data, size_t size) {
     ARG_CHECK(context != NULL, ERR_PARAM_NULL);
 
-    bool updated = false;
-    ESP_ERROR_CHECK(config_save_to_storage(data, size, &updated));
-    if (data == NULL || size <= 0) {
-        ESP_ERROR_CHECK(context_set_config(context, NULL));
-        config_updated_dispatch(context);
-        return ESP_OK;
-    }
-    if (updated || context->config.config == NULL) {
-        const Hydroponics__Config *config = hydroponics__config__unpack(NULL, size, data);
-        ESP_ERROR_CHECK(context_set_config(context, config));
-        config_updated_dispatch(context);
+    // Parse and validate before anything is stored, a config that can't be applied never replaces the current one.
+    const Hydroponics__Config *config = NULL;
+    uint8_t sha[CONFIG_DIGEST_LEN] = {0};
+    if (data != NULL && size > 0) {
+        ESP_ERROR_CHECK(sha256(data, size, sha));
+        // The same config pushed again is dropped before it is parsed.
+        xSemaphoreTake(lock, portMAX_DELAY);
+        bool current = config_is_current(context, size, sha);
+        xSemaphoreGive(lock);
+        if (current) {
+            ESP_LOGD(TAG, "Config unchanged, %u bytes ignored.", size);
+            return ESP_OK;
+        }
+        config = hydroponics__config__unpack(NULL, size, data);
         if (config == NULL) {
             ESP_LOGE(TAG, "Failed to parse the config proto.");
             return ESP_FAIL;
         }
+        esp_err_t err = config_validate(config);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Refusing invalid config, keeping the current one.");
+            hydroponics__config__free_unpacked((Hydroponics__Config *) config, NULL);
+            return err;
+        }
+    }
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    bool updated = false;
+    // Staging may reuse the slot mapped as the packed source.
+    ESP_ERROR_CHECK(context_set_config_source(context, NULL, 0));
+    ESP_ERROR_CHECK(config_save_to_storage(data, size, sha, &updated));
+    if (!updated && context->config.config != NULL) {
+        if (config != NULL) {
+            hydroponics__config__free_unpacked((Hydroponics__Config *) config, NULL);
+        }
+        ESP_ERROR_CHECK(config_set_source(context));
+        xSemaphoreGive(lock);
+        return ESP_OK;
+    }
+    ESP_ERROR_CHECK(context_set_config(context, config));
+    ESP_ERROR_CHECK(config_set_source(context));
+    if (updated) {
+        ESP_ERROR_CHECK(config_health_start());
+    }
+    xSemaphoreGive(lock);
+
+    config_updated_dispatch(context);
+    if (config != NULL) {
         ESP_ERROR_CHECK(config_dump(config));
     }
     return ESP_OK;
 }
 
+esp_err_t config_report_failure(const char *source, esp_err_t err) {
+    ARG_CHECK(source != NULL, ERR_PARAM_NULL);
+    ESP_LOGE(TAG, "%s failed to apply the config: %s", source, esp_err_to_name(err));
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    if (!config_flash_pending()) {
+        // A committed config already proved itself, nothing to go back to.
+        xSemaphoreGive(lock);
+        return ESP_OK;
+    }
+    health_failed = true;
+    uint32_t generation = health_generation;
+    xSemaphoreGive(lock);
+
+    // Roll back right away instead of waiting for the end of the window.
+    cron_handle_t handle = INVALID_CRON_HANDLE;
+    return cron_schedule_in("config_rollback", 0, config_health_callback, (void *) (uintptr_t) generation, &handle);
+}
+
 static void config_print_controller_entry(FILE *stream, int precision, const Hydroponics__Controller__Entry *entry) {
     if (entry != NULL) {
         fprintf(stream, "  target: %.*f  [%.*f, %.*f]\n", precision, entry->target, precision, entry->min, precision,
@@ -125,6 +299,7 @@ esp_err_t config_dump(const Hydroponics__Config *config) {
         fprintf(stream, "  ec_probe:      %d ms\n", config->sampling->ec_probe_ms);
         fprintf(stream, "  ec_probe_temp: %d ms\n", config->sampling->ec_probe_temp_ms);
         fprintf(stream, "  ph_probe:      %d ms\n", config->sampling->ph_probe_ms);
+        fprintf(stream, "  tank:          %d ms\n", config->sampling->tank_ms);
     } else {
         fprintf(stream, "  none\n");
     }
@@ -185,6 +360,21 @@ esp_err_t config_dump(const Hydroponics__Config *config) {
     } else {
         fprintf(stream, "  none\n");
     }
+    fprintf(stream, "Calibration:\n");
+    if (config->n_calibration > 0 && config->calibration != NULL) {
+        for (int i = 0; i < config->n_calibration; ++i) {
+            Hydroponics__Calibration *c = config->calibration[i];
+            fprintf(stream, "  [%*d] sensor: %s\n", config->n_calibration >= 10 ? 2 : 1, i,
+                    enum_from_value(&hydroponics__calibration__sensor__descriptor, c->sensor));
+            fprintf(stream, "      type: %s  degree: %d\n",
+                    enum_from_value(&hydroponics__calibration__type__descriptor, c->type), c->degree);
+            for (int j = 0; j < c->n_point; ++j) {
+                fprintf(stream, "      point: %d -> %.4f\n", c->point[j]->raw, c->point[j]->value);
+            }
+        }
+    } else {
+        fprintf(stream, "  none\n");
+    }
     fclose(stream);
     ESP_LOGI(TAG, "%.*s", len, buf);
     SAFE_FREE(buf);
@@ -193,6 +383,9 @@ esp_err_t config_dump(const Hydroponics__Config *config) {
 
 esp_err_t config_init(context_t *context) {
     TAILQ_INIT(&head);
+    lock = xSemaphoreCreateMutex();
+    CHECK_NO_MEM(lock);
+    health_context = context;
     char *device_id = (char *) CONFIG_GIOT_DEVICE_ID;
     char *ssid = (char *) CONFIG_ESP_WIFI_SSID;
     char *password = (char *) CONFIG_ESP_WIFI_PASSWORD;
@@ -207,6 +400,14 @@ esp_err_t config_init(context_t *context) {
     return ESP_OK;
 }
 
+esp_err_t config_get_digest(config_digest_t *out) {
+    ARG_CHECK(out != NULL, ERR_PARAM_NULL);
+    portENTER_CRITICAL(&digest_spinlock);
+    *out = digest;
+    portEXIT_CRITICAL(&digest_spinlock);
+    return ESP_OK;
+}
+
 esp_err_t config_register(config_callback_t callback) {
     ARG_CHECK(callback != NULL, ERR_PARAM_NULL);
     entry_t *e = NULL, *tmp = NULL;
@@ -6,12 +6,27 @@
 #include "config.pb-c.h"
 #include "context.h"
 
+#define CONFIG_DIGEST_LEN 32
+
+typedef struct {
+    uint32_t version;                   /*!< Incremented every time a different config is stored. */
+    uint32_t size;                      /*!< Size of the stored config, 0 when there is none. */
+    uint8_t sha256[CONFIG_DIGEST_LEN];  /*!< SHA-256 of the stored config. */
+} config_digest_t;
+
+// Gets a shared reference to the new config, or NULL when it was removed. Release it with `context_config_release`.
 typedef void (*config_callback_t)(const Hydroponics__Config *config);
 
 esp_err_t config_init(context_t *context);
 
 esp_err_t config_update(context_t *context, const uint8_t *data, size_t size);
 
+// Returns the digest of the stored config, a push with the same digest is ignored without touching the flash.
+esp_err_t config_get_digest(config_digest_t *digest);
+
+// Called by subscribers that could not apply the config. A config still in its health window is rolled back.
+esp_err_t config_report_failure(const char *source, esp_err_t err);
+
 esp_err_t config_dump(const Hydroponics__Config *config);
 
 esp_err_t config_register(config_callback_t callback);
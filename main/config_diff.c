@@ -0,0 +1,248 @@
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+
+#include "config_diff.h"
+#include "error.h"
+#include "utils.h"
+
+static const char *const TAG = "config_diff";
+
+static bool config_diff_message_equal(const ProtobufCMessage *a, const ProtobufCMessage *b);
+
+static size_t config_diff_value_size(const ProtobufCFieldDescriptor *field) {
+    switch (field->type) {
+        case PROTOBUF_C_TYPE_INT32:
+        case PROTOBUF_C_TYPE_SINT32:
+        case PROTOBUF_C_TYPE_SFIXED32:
+        case PROTOBUF_C_TYPE_UINT32:
+        case PROTOBUF_C_TYPE_FIXED32:
+        case PROTOBUF_C_TYPE_FLOAT:
+        case PROTOBUF_C_TYPE_ENUM:
+            return 4;
+        case PROTOBUF_C_TYPE_INT64:
+        case PROTOBUF_C_TYPE_SINT64:
+        case PROTOBUF_C_TYPE_SFIXED64:
+        case PROTOBUF_C_TYPE_UINT64:
+        case PROTOBUF_C_TYPE_FIXED64:
+        case PROTOBUF_C_TYPE_DOUBLE:
+            return 8;
+        case PROTOBUF_C_TYPE_BOOL:
+            return sizeof(protobuf_c_boolean);
+        case PROTOBUF_C_TYPE_STRING:
+            return sizeof(char *);
+        case PROTOBUF_C_TYPE_BYTES:
+            return sizeof(ProtobufCBinaryData);
+        case PROTOBUF_C_TYPE_MESSAGE:
+            return sizeof(ProtobufCMessage *);
+    }
+    return 0;
+}
+
+static bool config_diff_value_equal(const ProtobufCFieldDescriptor *field, const void *a, const void *b) {
+    switch (field->type) {
+        case PROTOBUF_C_TYPE_STRING: {
+            const char *sa = *(char *const *) a;
+            const char *sb = *(char *const *) b;
+            return strcmp(sa != NULL ? sa : "", sb != NULL ? sb : "") == 0;
+        }
+        case PROTOBUF_C_TYPE_BYTES: {
+            const ProtobufCBinaryData *ba = (const ProtobufCBinaryData *) a;
+            const ProtobufCBinaryData *bb = (const ProtobufCBinaryData *) b;
+            return ba->len == bb->len && (ba->len == 0 || memcmp(ba->data, bb->data, ba->len) == 0);
+        }
+        case PROTOBUF_C_TYPE_MESSAGE:
+            return config_diff_message_equal(*(ProtobufCMessage *const *) a, *(ProtobufCMessage *const *) b);
+        default:
+            return memcmp(a, b, config_diff_value_size(field)) == 0;
+    }
+}
+
+static bool config_diff_field_equal(const ProtobufCFieldDescriptor *field, const ProtobufCMessage *a,
+                                    const ProtobufCMessage *b) {
+    const uint8_t *pa = (const uint8_t *) a + field->offset;
+    const uint8_t *pb = (const uint8_t *) b + field->offset;
+    if (field->label == PROTOBUF_C_LABEL_REPEATED) {
+        size_t na = *(const size_t *) ((const uint8_t *) a + field->quantifier_offset);
+        size_t nb = *(const size_t *) ((const uint8_t *) b + field->quantifier_offset);
+        if (na != nb) {
+            return false;
+        }
+        const uint8_t *va = *(uint8_t *const *) pa;
+        const uint8_t *vb = *(uint8_t *const *) pb;
+        size_t size = config_diff_value_size(field);
+        for (size_t i = 0; i < na; ++i) {
+            if (!config_diff_value_equal(field, &va[i * size], &vb[i * size])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    if (field->flags & PROTOBUF_C_FIELD_FLAG_ONEOF) {
+        uint32_t ca = *(const uint32_t *) ((const uint8_t *) a + field->quantifier_offset);
+        uint32_t cb = *(const uint32_t *) ((const uint8_t *) b + field->quantifier_offset);
+        if (ca != cb) {
+            return false;
+        }
+        if (ca != field->id) {
+            return true;
+        }
+    } else if (field->label == PROTOBUF_C_LABEL_OPTIONAL && field->quantifier_offset != 0) {
+        protobuf_c_boolean ha = *(const protobuf_c_boolean *) ((const uint8_t *) a + field->quantifier_offset);
+        protobuf_c_boolean hb = *(const protobuf_c_boolean *) ((const uint8_t *) b + field->quantifier_offset);
+        if (ha != hb) {
+            return false;
+        }
+        if (!ha) {
+            return true;
+        }
+    }
+    return config_diff_value_equal(field, pa, pb);
+}
+
+static bool config_diff_message_equal(const ProtobufCMessage *a, const ProtobufCMessage *b) {
+    if (a == b) {
+        return true;
+    }
+    if (a == NULL || b == NULL || a->descriptor != b->descriptor) {
+        return false;
+    }
+    const ProtobufCMessageDescriptor *desc = a->descriptor;
+    for (unsigned i = 0; i < desc->n_fields; ++i) {
+        if (!config_diff_field_equal(&desc->fields[i], a, b)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Entries are matched by their lowest numbered field, the generated descriptors list the fields by number.
+static bool config_diff_key_equal(const ProtobufCMessage *a, const ProtobufCMessage *b) {
+    if (a == NULL || b == NULL || a->descriptor != b->descriptor || a->descriptor->n_fields == 0) {
+        return a == b;
+    }
+    return config_diff_field_equal(&a->descriptor->fields[0], a, b);
+}
+
+static esp_err_t config_diff_entries(const ProtobufCFieldDescriptor *field, const ProtobufCMessage *old_msg,
+                                     const ProtobufCMessage *new_msg, config_diff_section_t *section) {
+    size_t n_old = *(const size_t *) ((const uint8_t *) old_msg + field->quantifier_offset);
+    size_t n_new = *(const size_t *) ((const uint8_t *) new_msg + field->quantifier_offset);
+    ProtobufCMessage *const *old_entries = *(ProtobufCMessage *const *const *) ((const uint8_t *) old_msg +
+                                                                               field->offset);
+    ProtobufCMessage *const *new_entries = *(ProtobufCMessage *const *const *) ((const uint8_t *) new_msg +
+                                                                               field->offset);
+    section->n_entry = 0;
+    section->entry = NULL;
+    if (n_old + n_new == 0) {
+        return ESP_OK;
+    }
+    // Worst case every old entry is removed and every new one is added.
+    section->entry = calloc(n_old + n_new, sizeof(config_diff_entry_t));
+    bool *matched = calloc(n_old + 1, sizeof(bool));
+    if (section->entry == NULL || matched == NULL) {
+        SAFE_FREE(section->entry);
+        SAFE_FREE(matched);
+        return ESP_ERR_NO_MEM;
+    }
+    for (size_t i = 0; i < n_new; ++i) {
+        int found = -1;
+        for (size_t j = 0; j < n_old && found < 0; ++j) {
+            if (!matched[j] && config_diff_key_equal(old_entries[j], new_entries[i])) {
+                found = (int) j;
+            }
+        }
+        if (found < 0) {
+            section->entry[section->n_entry++] = (config_diff_entry_t) {CONFIG_DIFF_ADDED, -1, (int) i};
+            continue;
+        }
+        matched[found] = true;
+        if (!config_diff_message_equal(old_entries[found], new_entries[i])) {
+            section->entry[section->n_entry++] = (config_diff_entry_t) {CONFIG_DIFF_CHANGED, found, (int) i};
+        }
+    }
+    for (size_t j = 0; j < n_old; ++j) {
+        if (!matched[j]) {
+            section->entry[section->n_entry++] = (config_diff_entry_t) {CONFIG_DIFF_REMOVED, (int) j, -1};
+        }
+    }
+    SAFE_FREE(matched);
+    section->changed = section->n_entry > 0;
+    return ESP_OK;
+}
+
+esp_err_t config_diff(const Hydroponics__Config *old_config, const Hydroponics__Config *new_config,
+                      config_diff_t *diff) {
+    ARG_CHECK(diff != NULL, ERR_PARAM_NULL);
+
+    Hydroponics__Config empty = HYDROPONICS__CONFIG__INIT;
+    const ProtobufCMessage *old_msg = (const ProtobufCMessage *) (old_config != NULL ? old_config : &empty);
+    const ProtobufCMessage *new_msg = (const ProtobufCMessage *) (new_config != NULL ? new_config : &empty);
+    const ProtobufCMessageDescriptor *desc = &hydroponics__config__descriptor;
+
+    diff->n_section = desc->n_fields;
+    diff->section = calloc(desc->n_fields, sizeof(config_diff_section_t));
+    CHECK_NO_MEM(diff->section);
+    for (unsigned i = 0; i < desc->n_fields; ++i) {
+        const ProtobufCFieldDescriptor *field = &desc->fields[i];
+        config_diff_section_t *section = &diff->section[i];
+        section->id = field->id;
+        if (field->label == PROTOBUF_C_LABEL_REPEATED && field->type == PROTOBUF_C_TYPE_MESSAGE) {
+            esp_err_t err = config_diff_entries(field, old_msg, new_msg, section);
+            if (err != ESP_OK) {
+                config_diff_free(diff);
+                return err;
+            }
+        } else {
+            section->changed = !config_diff_field_equal(field, old_msg, new_msg);
+        }
+    }
+    return ESP_OK;
+}
+
+void config_diff_free(config_diff_t *diff) {
+    if (diff == NULL) {
+        return;
+    }
+    for (size_t i = 0; diff->section != NULL && i < diff->n_section; ++i) {
+        SAFE_FREE(diff->section[i].entry);
+    }
+    SAFE_FREE(diff->section);
+    diff->n_section = 0;
+}
+
+const config_diff_section_t *config_diff_section(const config_diff_t *diff, uint32_t id) {
+    for (size_t i = 0; diff != NULL && i < diff->n_section; ++i) {
+        if (diff->section[i].id == id) {
+            return &diff->section[i];
+        }
+    }
+    return NULL;
+}
+
+bool config_diff_changed(const config_diff_t *diff, uint32_t id) {
+    const config_diff_section_t *section = config_diff_section(diff, id);
+    return section != NULL && section->changed;
+}
+
+void config_diff_dump(const char *tag, const config_diff_t *diff) {
+    const ProtobufCMessageDescriptor *desc = &hydroponics__config__descriptor;
+    for (size_t i = 0; diff != NULL && i < diff->n_section; ++i) {
+        const config_diff_section_t *section = &diff->section[i];
+        if (!section->changed) {
+            continue;
+        }
+        const ProtobufCFieldDescriptor *field = protobuf_c_message_descriptor_get_field(desc, section->id);
+        if (section->n_entry == 0) {
+            ESP_LOGI(tag, "  %s: changed", field != NULL ? field->name : "?");
+            continue;
+        }
+        size_t count[3] = {0};
+        for (size_t j = 0; j < section->n_entry; ++j) {
+            count[section->entry[j].kind]++;
+        }
+        ESP_LOGI(tag, "  %s: +%u -%u ~%u", field != NULL ? field->name : "?", (unsigned int) count[CONFIG_DIFF_ADDED],
+                 (unsigned int) count[CONFIG_DIFF_REMOVED], (unsigned int) count[CONFIG_DIFF_CHANGED]);
+    }
+}
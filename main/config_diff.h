@@ -0,0 +1,59 @@
+#ifndef HYDROPONICS_CONFIG_DIFF_H
+#define HYDROPONICS_CONFIG_DIFF_H
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+#include "config.pb-c.h"
+
+// Field numbers of the Hydroponics__Config sections, see config.proto.
+#define CONFIG_SECTION_SAMPLING       1
+#define CONFIG_SECTION_CONTROLLER     2
+#define CONFIG_SECTION_TASK           3
+#define CONFIG_SECTION_HARDWARE_ID    4
+#define CONFIG_SECTION_STARTUP_STATE  5
+#define CONFIG_SECTION_FIRMWARE       6
+#define CONFIG_SECTION_CALIBRATION    7
+#define CONFIG_SECTION_ONE_WIRE_PROBE 8
+
+typedef enum {
+    CONFIG_DIFF_ADDED = 0,
+    CONFIG_DIFF_REMOVED = 1,
+    CONFIG_DIFF_CHANGED = 2,
+} config_diff_kind_t;
+
+typedef struct {
+    config_diff_kind_t kind;
+    int old_index;  /*!< Index in the old config, -1 when added. */
+    int new_index;  /*!< Index in the new config, -1 when removed. */
+} config_diff_entry_t;
+
+typedef struct {
+    uint32_t id;                /*!< Field number of the section in Hydroponics__Config. */
+    bool changed;
+    size_t n_entry;             /*!< Only repeated message sections list their entries. */
+    config_diff_entry_t *entry;
+} config_diff_section_t;
+
+typedef struct {
+    size_t n_section;
+    config_diff_section_t *section;
+} config_diff_t;
+
+// Compares two configs section by section, a NULL config is the same as an empty one. Entries of a repeated message
+// section are matched by their lowest numbered field, e.g. the task name, so reordering them is not a change.
+esp_err_t config_diff(const Hydroponics__Config *old_config, const Hydroponics__Config *new_config,
+                      config_diff_t *diff);
+
+void config_diff_free(config_diff_t *diff);
+
+// Returns the section for field `id` of Hydroponics__Config, never NULL for a valid id.
+const config_diff_section_t *config_diff_section(const config_diff_t *diff, uint32_t id);
+
+bool config_diff_changed(const config_diff_t *diff, uint32_t id);
+
+// Logs a one line summary of every changed section.
+void config_diff_dump(const char *tag, const config_diff_t *diff);
+
+#endif //HYDROPONICS_CONFIG_DIFF_H
@@ -0,0 +1,196 @@
+#include <stddef.h>
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_spi_flash.h"
+
+#include "config.h"
+#include "config_flash.h"
+#include "error.h"
+#include "utils.h"
+
+#define CONFIG_FLASH_SECTOR_SIZE 4096
+#define CONFIG_FLASH_DATA_OFFSET 64 // Leaves room for the header to grow.
+
+typedef struct {
+    const config_flash_header_t *header; /*!< Mapped header, NULL when the slot is blank or was rejected. */
+    spi_flash_mmap_handle_t handle;
+} slot_t;
+
+static const char *const TAG = "config_flash";
+static const esp_partition_t *partition = NULL;
+static slot_t slots[CONFIG_FLASH_SLOTS] = {0};
+static int active = -1; /*!< Slot of the config in use, -1 when there is none. */
+
+static inline size_t config_flash_slot_size(void) {
+    return partition->size / CONFIG_FLASH_SLOTS;
+}
+
+static inline size_t config_flash_slot_offset(int slot) {
+    return slot * config_flash_slot_size();
+}
+
+static inline bool config_flash_committed(int slot) {
+    return slots[slot].header != NULL && slots[slot].header->committed == CONFIG_FLASH_MARK_SET;
+}
+
+static void config_flash_unmap(int slot) {
+    if (slots[slot].header != NULL) {
+        spi_flash_munmap(slots[slot].handle);
+        slots[slot].header = NULL;
+        slots[slot].handle = 0;
+    }
+}
+
+static bool config_flash_valid(const config_flash_header_t *h) {
+    return h->magic == CONFIG_FLASH_MAGIC
+           && h->format == CONFIG_FLASH_FORMAT
+           && h->data_offset >= sizeof(config_flash_header_t)
+           && (size_t) h->data_offset + h->digest.size <= config_flash_slot_size()
+           && h->rejected == CONFIG_FLASH_MARK_CLEAR;
+}
+
+// Maps the header first, then the whole header and config once the size is known.
+static esp_err_t config_flash_map(int slot) {
+    config_flash_unmap(slot);
+
+    config_flash_header_t h = {0};
+    ESP_ERROR_CHECK(esp_partition_read(partition, config_flash_slot_offset(slot), &h, sizeof(h)));
+    if (!config_flash_valid(&h)) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    const void *ptr = NULL;
+    esp_err_t err = esp_partition_mmap(partition, config_flash_slot_offset(slot), h.data_offset + h.digest.size,
+                                       SPI_FLASH_MMAP_DATA, &ptr, &slots[slot].handle);
+    if (err != ESP_OK) {
+        return err;
+    }
+    slots[slot].header = (const config_flash_header_t *) ptr;
+    return ESP_OK;
+}
+
+// Flash bits can be cleared without an erase, the mapped header sees the mark right away.
+static esp_err_t config_flash_mark(int slot, size_t field) {
+    const uint32_t mark = CONFIG_FLASH_MARK_SET;
+    return esp_partition_write(partition, config_flash_slot_offset(slot) + field, &mark, sizeof(mark));
+}
+
+static esp_err_t config_flash_verify(int slot) {
+    const config_flash_header_t *h = slots[slot].header;
+    if (h == NULL || h->digest.size == 0) {
+        return ESP_OK;
+    }
+    uint8_t sha[CONFIG_DIGEST_LEN];
+    ESP_ERROR_CHECK(sha256((const uint8_t *) h + h->data_offset, h->digest.size, sha));
+    if (memcmp(sha, h->digest.sha256, CONFIG_DIGEST_LEN) != 0) {
+        ESP_LOGE(TAG, "Stored config v%u does not match its digest, ignoring it.", h->digest.version);
+        config_flash_unmap(slot);
+    }
+    return ESP_OK;
+}
+
+esp_err_t config_flash_init(void) {
+    partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, CONFIG_FLASH_PARTITION);
+    if (partition == NULL) {
+        ESP_LOGE(TAG, "Partition '%s' not found, check the partition table.", CONFIG_FLASH_PARTITION);
+        return ESP_ERR_NOT_FOUND;
+    }
+    active = -1;
+    for (int slot = 0; slot < CONFIG_FLASH_SLOTS; ++slot) {
+        esp_err_t err = config_flash_map(slot);
+        if (err == ESP_ERR_NOT_FOUND) {
+            continue;
+        }
+        ESP_ERROR_CHECK(err);
+        ESP_ERROR_CHECK(config_flash_verify(slot));
+        if (slots[slot].header == NULL) {
+            continue;
+        }
+        if (!config_flash_committed(slot)) {
+            // Rebooted before the health window was over, the config is the prime suspect.
+            ESP_LOGW(TAG, "Config v%u never passed its health window, rolling back.",
+                     slots[slot].header->digest.version);
+            ESP_ERROR_CHECK(config_flash_mark(slot, offsetof(config_flash_header_t, rejected)));
+            config_flash_unmap(slot);
+            continue;
+        }
+        if (active < 0 || slots[slot].header->digest.version > slots[active].header->digest.version) {
+            active = slot;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t config_flash_read(const uint8_t **data, config_digest_t *digest) {
+    ARG_CHECK(data != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(digest != NULL, ERR_PARAM_NULL);
+    if (active < 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    const config_flash_header_t *h = slots[active].header;
+    *digest = h->digest;
+    *data = h->digest.size > 0 ? (const uint8_t *) h + h->data_offset : NULL;
+    return ESP_OK;
+}
+
+esp_err_t config_flash_stage(const uint8_t *data, const config_digest_t *digest) {
+    ARG_CHECK(digest != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(data != NULL || digest->size == 0, ERR_PARAM_NULL);
+    ARG_CHECK(partition != NULL, "partition not initialized");
+    ARG_CHECK(CONFIG_FLASH_DATA_OFFSET + digest->size <= config_flash_slot_size(), "config is bigger than a slot");
+
+    // A config replacing one still in its health window takes its slot, the committed one is kept as the fallback.
+    int slot = active >= 0 && config_flash_pending() ? active : (active + 1) % CONFIG_FLASH_SLOTS;
+    // The old mapping points at sectors that are about to be erased.
+    config_flash_unmap(slot);
+    size_t offset = config_flash_slot_offset(slot);
+    size_t len = round_up(CONFIG_FLASH_DATA_OFFSET + digest->size, CONFIG_FLASH_SECTOR_SIZE);
+    ESP_ERROR_CHECK(esp_partition_erase_range(partition, offset, len));
+    if (digest->size > 0) {
+        ESP_ERROR_CHECK(esp_partition_write(partition, offset + CONFIG_FLASH_DATA_OFFSET, data, digest->size));
+    }
+    config_flash_header_t h = {
+            .magic = CONFIG_FLASH_MAGIC,
+            .format = CONFIG_FLASH_FORMAT,
+            .data_offset = CONFIG_FLASH_DATA_OFFSET,
+            .digest = *digest,
+            .committed = CONFIG_FLASH_MARK_CLEAR,
+            .rejected = CONFIG_FLASH_MARK_CLEAR,
+    };
+    ESP_ERROR_CHECK(esp_partition_write(partition, offset, &h, sizeof(h)));
+    ESP_ERROR_CHECK(config_flash_map(slot));
+    active = slot;
+    return ESP_OK;
+}
+
+bool config_flash_pending(void) {
+    return active >= 0 && !config_flash_committed(active);
+}
+
+esp_err_t config_flash_commit(void) {
+    if (!config_flash_pending()) {
+        return ESP_OK;
+    }
+    ESP_ERROR_CHECK(config_flash_mark(active, offsetof(config_flash_header_t, committed)));
+    ESP_LOGI(TAG, "Committed config v%u to slot %d", slots[active].header->digest.version, active);
+    return ESP_OK;
+}
+
+esp_err_t config_flash_rollback(void) {
+    ARG_CHECK(config_flash_pending(), "no pending config");
+
+    int rejected = active;
+    ESP_ERROR_CHECK(config_flash_mark(rejected, offsetof(config_flash_header_t, rejected)));
+    ESP_LOGW(TAG, "Rejected config v%u in slot %d", slots[rejected].header->digest.version, rejected);
+    config_flash_unmap(rejected);
+
+    active = -1;
+    for (int slot = 0; slot < CONFIG_FLASH_SLOTS; ++slot) {
+        if (config_flash_committed(slot)) {
+            active = slot;
+        }
+    }
+    return ESP_OK;
+}
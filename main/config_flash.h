@@ -0,0 +1,48 @@
+#ifndef HYDROPONICS_CONFIG_FLASH_H
+#define HYDROPONICS_CONFIG_FLASH_H
+
+#include <stdbool.h>
+
+#include "esp_err.h"
+
+#include "config.h"
+
+#define CONFIG_FLASH_PARTITION  "config"
+#define CONFIG_FLASH_MAGIC      0x46435948 // "HYCF"
+#define CONFIG_FLASH_FORMAT     2
+#define CONFIG_FLASH_SLOTS      2          // The partition is split in equal slots.
+#define CONFIG_FLASH_MARK_CLEAR 0xFFFFFFFF // Erased flash, marks are set by clearing the bits in place.
+#define CONFIG_FLASH_MARK_SET   0x00000000
+
+typedef struct {
+    uint32_t magic;         /*!< CONFIG_FLASH_MAGIC, written last so an interrupted write is never valid. */
+    uint16_t format;        /*!< CONFIG_FLASH_FORMAT of the slot. */
+    uint16_t data_offset;   /*!< Offset of the packed config from the start of the slot. */
+    config_digest_t digest;
+    uint32_t committed;     /*!< CONFIG_FLASH_MARK_SET once the config survived its health window. */
+    uint32_t rejected;      /*!< CONFIG_FLASH_MARK_SET once the config was rolled back. */
+} config_flash_header_t;
+
+// Finds and maps the config slots and verifies them against their digests. A config that was still pending when the
+// device rebooted never passed its health window and is rejected in favour of the last committed one.
+esp_err_t config_flash_init(void);
+
+// Returns the packed config of the active slot read straight from the mapped flash, valid until the next
+// `config_flash_stage` or `config_flash_rollback`. Returns ESP_ERR_NOT_FOUND when nothing was ever stored. A deleted
+// config has a digest but no data.
+esp_err_t config_flash_read(const uint8_t **data, config_digest_t *digest);
+
+// Writes the config to the spare slot and makes it the active, pending, one. The last committed slot is kept untouched
+// so it can be restored. `data` can be NULL with a digest of size 0 to record a deleted config.
+esp_err_t config_flash_stage(const uint8_t *data, const config_digest_t *digest);
+
+// Returns true while the active config waits for its health window.
+bool config_flash_pending(void);
+
+// Keeps the pending config for good.
+esp_err_t config_flash_commit(void);
+
+// Rejects the pending config and goes back to the last committed slot, if any.
+esp_err_t config_flash_rollback(void);
+
+#endif //HYDROPONICS_CONFIG_FLASH_H
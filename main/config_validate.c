@@ -0,0 +1,91 @@
+#include <string.h>
+
+#include "esp_err.h"
+#include "esp_log.h"
+
+#include "buses.h"
+#include "config_validate.h"
+#include "cron.h"
+#include "error.h"
+
+static const char *const TAG = "config_validate";
+
+static bool config_validate_outputs(const char *name, size_t n_output, const Hydroponics__Output *output) {
+    for (size_t i = 0; i < n_output; ++i) {
+        if (!IS_EXT_GPIO(output[i]) && !IS_EXT_TUYA(output[i])) {
+            ESP_LOGE(TAG, "%s: output %d is not mapped to any bus", name, output[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool config_validate_state(const char *name, Hydroponics__OutputState state) {
+    if (protobuf_c_enum_descriptor_get_value(&hydroponics__output_state__descriptor, state) == NULL) {
+        ESP_LOGE(TAG, "%s: unknown output state %d", name, state);
+        return false;
+    }
+    return true;
+}
+
+static bool config_validate_task(const Hydroponics__Task *task, size_t *n_expression) {
+    if (task->name == NULL || task->name[0] == '\0') {
+        ESP_LOGE(TAG, "Task without a name");
+        return false;
+    }
+    if (task->n_output == 0) {
+        ESP_LOGE(TAG, "%s: task without outputs", task->name);
+        return false;
+    }
+    if (!config_validate_outputs(task->name, task->n_output, task->output)) {
+        return false;
+    }
+    for (size_t j = 0; j < task->n_cron; ++j) {
+        const Hydroponics__Task__Cron *cron = task->cron[j];
+        if (!config_validate_state(task->name, cron->state)) {
+            return false;
+        }
+        for (size_t k = 0; k < cron->n_expression; ++k) {
+            cron_expr expr = {0};
+            if (cron_parse(cron->expression[k], &expr) != ESP_OK) {
+                ESP_LOGE(TAG, "%s: invalid cron expression '%s'", task->name, cron->expression[k]);
+                return false;
+            }
+        }
+        *n_expression += cron->n_expression;
+    }
+    return true;
+}
+
+esp_err_t config_validate(const Hydroponics__Config *config) {
+    ARG_CHECK(config != NULL, ERR_PARAM_NULL);
+
+    size_t n_expression = 0;
+    for (size_t i = 0; i < config->n_task; ++i) {
+        const Hydroponics__Task *task = config->task[i];
+        if (!config_validate_task(task, &n_expression)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        // Every task owns a cron group named after it.
+        for (size_t j = 0; j < i; ++j) {
+            if (strcmp(config->task[j]->name, task->name) == 0) {
+                ESP_LOGE(TAG, "%s: duplicated task name", task->name);
+                return ESP_ERR_INVALID_ARG;
+            }
+        }
+    }
+    // Leave room for the monitoring jobs and impulses, the pool is shared.
+    if (n_expression > CONFIG_ESP_CRON_MAX_JOBS / 2) {
+        ESP_LOGE(TAG, "%u cron expressions do not fit in a pool of %d jobs", (unsigned int) n_expression,
+                 CONFIG_ESP_CRON_MAX_JOBS);
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < config->n_startup_state; ++i) {
+        const Hydroponics__StartupState *s = config->startup_state[i];
+        if (!config_validate_state("startup_state", s->state)
+            || !config_validate_outputs("startup_state", s->n_output, s->output)) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,13 @@
+#ifndef HYDROPONICS_CONFIG_VALIDATE_H
+#define HYDROPONICS_CONFIG_VALIDATE_H
+
+#include "esp_err.h"
+
+#include "config.pb-c.h"
+
+// Checks everything the config subscribers would otherwise only find out while applying it: every cron expression
+// parses, task names are unique, every output is mapped to a known bus and all schedules fit in the cron pool.
+// Returns ESP_ERR_INVALID_ARG and logs the first problem found.
+esp_err_t config_validate(const Hydroponics__Config *config);
+
+#endif //HYDROPONICS_CONFIG_VALIDATE_H
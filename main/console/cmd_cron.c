@@ -0,0 +1,53 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "esp_err.h"
+#include "esp_console.h"
+
+#include "cron.h"
+#include "utils.h"
+
+static int list(int argc, char **argv) {
+    cron_info_t *infos = calloc(CONFIG_ESP_CRON_MAX_JOBS, sizeof(cron_info_t));
+    if (infos == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    size_t count = 0;
+    esp_err_t err = cron_dump(infos, CONFIG_ESP_CRON_MAX_JOBS, &count);
+    if (err != ESP_OK) {
+        SAFE_FREE(infos);
+        return err;
+    }
+    printf("%-20s %-20s %-19s %6s %4s %4s %7s %7s   lateness <10ms|<100ms|<1s|<10s|more\n", "Name", "Expression",
+           "Next", "Runs", "Skip", "Miss", "Last ms", "Max ms");
+    for (size_t i = 0; i < count; ++i) {
+        const cron_info_t *info = &infos[i];
+        char next[20] = "never";
+        if (info->next_execution.tv_sec >= 0) {
+            struct tm t = {0};
+            localtime_r(&info->next_execution.tv_sec, &t);
+            strftime(next, sizeof(next), "%F %T", &t);
+        }
+        const cron_stats_t *s = &info->stats;
+        printf("%-20s %-20s %-19s %6u %4u %4u %7u %7u   %u|%u|%u|%u|%u\n", info->name,
+               info->expression[0] ? info->expression : "(oneshot)", next, s->runs, s->overruns, s->misfires,
+               s->last_duration_ms, s->max_duration_ms, s->lateness[0], s->lateness[1], s->lateness[2],
+               s->lateness[3], s->lateness[4]);
+    }
+    SAFE_FREE(infos);
+    return ESP_OK;
+}
+
+esp_err_t cmd_cron_init(void) {
+    const esp_console_cmd_t cron_cmd = {
+            .command = "cron",
+            .help = "List the scheduled cron jobs and their statistics",
+            .hint = NULL,
+            .func = &list,
+            .argtable = NULL,
+    };
+    ESP_ERROR_CHECK(esp_console_cmd_register(&cron_cmd));
+
+    return ESP_OK;
+}
@@ -0,0 +1,8 @@
+#ifndef HYDROPONICS_CONSOLE_CMD_CRON_H
+#define HYDROPONICS_CONSOLE_CMD_CRON_H
+
+#include "esp_err.h"
+
+esp_err_t cmd_cron_init(void);
+
+#endif //HYDROPONICS_CONSOLE_CMD_CRON_H
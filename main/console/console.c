@@ -10,6 +10,7 @@
 #include "linenoise/linenoise.h"
 
 #include "console.h"
+#include "cmd_cron.h"
 #include "cmd_ezo.h"
 
 /* Prompt to be printed before each line. */
@@ -94,6 +95,7 @@ esp_err_t console_init(void) {
     linenoiseHistorySetMaxLen(100);
 
     esp_console_register_help_command();
+    ESP_ERROR_CHECK(cmd_cron_init());
     ESP_ERROR_CHECK(cmd_ezo_init());
 
     /* Figure out if the terminal supports escape sequences */
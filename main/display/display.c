@@ -12,6 +12,7 @@
 #include "context.h"
 #include "driver/lcd/u8g2_esp32_hal.h"
 #include "error.h"
+#include "sensors/sensors.h"
 
 #define I2C_ADDRESS_OLED 0x78  /*!< Slave address for OLED display. */
 
@@ -74,6 +75,13 @@ static esp_err_t display_draw(context_t *context, bool connected, bool time_upda
     len += snprintf_append(buf, len, sizeof(buf), " %.2f", pha);
     u8g2_DrawStr(&u8g2, 0, 31, buf);
 
+    // Number of unhealthy sensors, their last value stays on screen.
+    size_t unhealthy = sensors_unhealthy();
+    if (unhealthy > 0) {
+        snprintf(buf, sizeof(buf), "!%d", unhealthy);
+        u8g2_DrawStr(&u8g2, u8g2_GetDisplayWidth(&u8g2) - (6 * 6), 31, buf);
+    }
+
     snprintf(buf, sizeof(buf), "%c%c%c", connected ? 'W' : '*', time_updated ? 'T' : '*', iot_connected ? 'G' : '*');
     u8g2_DrawStr(&u8g2, u8g2_GetDisplayWidth(&u8g2) - (6 * 3), 31, buf);
 
@@ -105,7 +105,7 @@ static void config_callback(const Hydroponics__Config *config) {
         setup_lerp(VALUE_PH_B, config->controller->phb, 5.8f, 6.8f);
         setup_lerp(VALUE_EC_B, config->controller->ecb, 1000.f, 2000.f);
     }
-    hydroponics__config__free_unpacked((Hydroponics__Config *) config, NULL);
+    context_config_release(config);
 }
 
 static void IRAM_ATTR button_callback(void *data) {
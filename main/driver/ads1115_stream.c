@@ -0,0 +1,103 @@
+#include <string.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "ads1115_stream.h"
+#include "error.h"
+
+typedef struct {
+    int16_t values[ADS1115_STREAM_RING_LEN];
+    uint16_t position;
+    uint16_t len;
+} ads1115_stream_ring_t;
+
+static const char *const TAG = "ads1115_stream";
+static const uint32_t PERIOD_US[ADS1115_STREAM_SPS_MAX] = {125000, 62500, 31250, 15625, 7813, 4000, 2106, 1163};
+
+static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+static ads1115_stream_ring_t rings[ADS1115_STREAM_MAX_CHANNELS] = {0};
+static ads1115_stream_stats_t stats = {0};
+static size_t channels = 0;
+
+uint32_t ads1115_stream_period_us(ads1115_stream_sps_t sps) {
+    return sps < ADS1115_STREAM_SPS_MAX ? PERIOD_US[sps] : PERIOD_US[0];
+}
+
+esp_err_t ads1115_stream_init(const ads1115_stream_config_t *config) {
+    ARG_CHECK(config != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(config->channels > 0 && config->channels <= ADS1115_STREAM_MAX_CHANNELS, "invalid number of channels");
+    ARG_CHECK(config->sps < ADS1115_STREAM_SPS_MAX, "invalid sps");
+
+    memset(rings, 0, sizeof(rings));
+    memset(&stats, 0, sizeof(stats));
+    channels = config->channels;
+    ESP_LOGI(TAG, "[0x%.2x] Streaming %d channels every %uus", config->address, channels,
+             ads1115_stream_period_us(config->sps));
+    return ads1115_stream_start(config);
+}
+
+void ads1115_stream_push(size_t channel, int16_t raw, int64_t ready_us) {
+    if (channel >= channels) {
+        return;
+    }
+    uint32_t latency_us = (uint32_t) (esp_timer_get_time() - ready_us);
+
+    portENTER_CRITICAL(&spinlock);
+    ads1115_stream_ring_t *ring = &rings[channel];
+    ring->values[ring->position] = raw;
+    ring->position = (ring->position + 1) % ADS1115_STREAM_RING_LEN;
+    if (ring->len < ADS1115_STREAM_RING_LEN) {
+        ring->len++;
+    }
+    stats.conversions++;
+    stats.last_latency_us = latency_us;
+    if (latency_us > stats.max_latency_us) {
+        stats.max_latency_us = latency_us;
+    }
+    portEXIT_CRITICAL(&spinlock);
+}
+
+void ads1115_stream_error(void) {
+    portENTER_CRITICAL(&spinlock);
+    stats.errors++;
+    portEXIT_CRITICAL(&spinlock);
+}
+
+void ads1115_stream_missed(void) {
+    portENTER_CRITICAL(&spinlock);
+    stats.missed++;
+    portEXIT_CRITICAL(&spinlock);
+}
+
+esp_err_t ads1115_stream_average(size_t channel, int16_t *raw) {
+    ARG_CHECK(channel < ADS1115_STREAM_MAX_CHANNELS, "invalid channel");
+    ARG_CHECK(raw != NULL, ERR_PARAM_NULL);
+
+    int32_t sum = 0;
+    portENTER_CRITICAL(&spinlock);
+    const ads1115_stream_ring_t *ring = &rings[channel];
+    uint16_t len = ring->len;
+    for (uint16_t i = 0; i < len; ++i) {
+        sum += ring->values[i];
+    }
+    portEXIT_CRITICAL(&spinlock);
+
+    if (len == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    *raw = (int16_t) (sum / len);
+    return ESP_OK;
+}
+
+esp_err_t ads1115_stream_get_stats(ads1115_stream_stats_t *out) {
+    ARG_CHECK(out != NULL, ERR_PARAM_NULL);
+
+    portENTER_CRITICAL(&spinlock);
+    *out = stats;
+    portEXIT_CRITICAL(&spinlock);
+    return ESP_OK;
+}
@@ -0,0 +1,83 @@
+#ifndef HYDROPONICS_DRIVER_ADS1115_STREAM_H
+#define HYDROPONICS_DRIVER_ADS1115_STREAM_H
+
+#include "driver/gpio.h"
+
+#include "esp_err.h"
+
+#define ADS1115_STREAM_MAX_CHANNELS 4
+#define ADS1115_STREAM_RING_LEN 16
+
+typedef enum {
+    ADS1115_STREAM_MUX_0_1 = 0,
+    ADS1115_STREAM_MUX_0_3 = 1,
+    ADS1115_STREAM_MUX_1_3 = 2,
+    ADS1115_STREAM_MUX_2_3 = 3,
+    ADS1115_STREAM_MUX_0_GND = 4,
+    ADS1115_STREAM_MUX_1_GND = 5,
+    ADS1115_STREAM_MUX_2_GND = 6,
+    ADS1115_STREAM_MUX_3_GND = 7,
+} ads1115_stream_mux_t;
+
+typedef enum {
+    ADS1115_STREAM_FSR_6_144 = 0,
+    ADS1115_STREAM_FSR_4_096 = 1,
+    ADS1115_STREAM_FSR_2_048 = 2,
+    ADS1115_STREAM_FSR_1_024 = 3,
+    ADS1115_STREAM_FSR_0_512 = 4,
+    ADS1115_STREAM_FSR_0_256 = 5,
+} ads1115_stream_fsr_t;
+
+typedef enum {
+    ADS1115_STREAM_SPS_8 = 0,
+    ADS1115_STREAM_SPS_16 = 1,
+    ADS1115_STREAM_SPS_32 = 2,
+    ADS1115_STREAM_SPS_64 = 3,
+    ADS1115_STREAM_SPS_128 = 4,
+    ADS1115_STREAM_SPS_250 = 5,
+    ADS1115_STREAM_SPS_475 = 6,
+    ADS1115_STREAM_SPS_860 = 7,
+    ADS1115_STREAM_SPS_MAX,
+} ads1115_stream_sps_t;
+
+typedef struct {
+    uint8_t address;
+    gpio_num_t alert_gpio;                           /*!< GPIO wired to ALERT/RDY, GPIO_NUM_NC to poll. */
+    ads1115_stream_fsr_t fsr;
+    ads1115_stream_sps_t sps;
+    size_t channels;
+    ads1115_stream_mux_t mux[ADS1115_STREAM_MAX_CHANNELS]; /*!< Channels sampled in round-robin. */
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+    float simulate[ADS1115_STREAM_MAX_CHANNELS];
+    float threshold[ADS1115_STREAM_MAX_CHANNELS];
+    bool (*simulate_raw)(size_t channel, int16_t *raw); /*!< Optional, false falls back to the fixed values. */
+#endif
+} ads1115_stream_config_t;
+
+typedef struct {
+    uint32_t conversions;
+    uint32_t missed;          /*!< Conversions collected without a data ready interrupt. */
+    uint32_t errors;
+    uint32_t last_latency_us; /*!< Time between data ready and the conversion being in the ring. */
+    uint32_t max_latency_us;
+} ads1115_stream_stats_t;
+
+esp_err_t ads1115_stream_init(const ads1115_stream_config_t *config);
+
+// Average of the conversions currently in the ring of `channel`. ESP_ERR_NOT_FOUND until the first one arrives.
+esp_err_t ads1115_stream_average(size_t channel, int16_t *raw);
+
+esp_err_t ads1115_stream_get_stats(ads1115_stream_stats_t *stats);
+
+// Backend hooks, implemented by ads1115_stream_hw.c and ads1115_stream_sim.c.
+esp_err_t ads1115_stream_start(const ads1115_stream_config_t *config);
+
+void ads1115_stream_push(size_t channel, int16_t raw, int64_t ready_us);
+
+void ads1115_stream_error(void);
+
+void ads1115_stream_missed(void);
+
+uint32_t ads1115_stream_period_us(ads1115_stream_sps_t sps);
+
+#endif //HYDROPONICS_DRIVER_ADS1115_STREAM_H
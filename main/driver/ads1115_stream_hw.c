@@ -0,0 +1,112 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "driver/gpio.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "ads1115_stream.h"
+#include "error.h"
+#include "i2c_bus.h"
+
+#define ADS1115_REG_CONVERSION 0x00
+#define ADS1115_REG_CONFIG     0x01
+#define ADS1115_REG_LO_THRESH  0x02
+#define ADS1115_REG_HI_THRESH  0x03
+
+#define ADS1115_CONFIG_MUX_SHIFT 12
+#define ADS1115_CONFIG_PGA_SHIFT 9
+#define ADS1115_CONFIG_DR_SHIFT  5
+#define ADS1115_CONFIG_MODE_CONTINUOUS 0x0000
+#define ADS1115_CONFIG_COMP_QUE_1      0x0000 /*!< Assert ALERT/RDY after every conversion. */
+
+static const char *const TAG = "ads1115_stream";
+
+static struct {
+    ads1115_stream_config_t config;
+    i2c_bus_device_handle_t dev;
+    TaskHandle_t task;
+    volatile int64_t ready_us;
+} stream = {0};
+
+static void IRAM_ATTR ads1115_stream_isr(void *arg) {
+    ARG_UNUSED(arg);
+    stream.ready_us = esp_timer_get_time();
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(stream.task, &woken);
+    if (woken == pdTRUE) {
+        portYIELD_FROM_ISR();
+    }
+}
+
+static esp_err_t ads1115_stream_write_reg(uint8_t reg, uint16_t value) {
+    uint8_t buf[2] = {value >> 8, value & 0xff};
+    return i2c_bus_write_reg_read(stream.dev, reg, buf, sizeof(buf), NULL, 0);
+}
+
+// Writing the config register restarts the conversion, the next data ready already belongs to `mux`.
+static esp_err_t ads1115_stream_select(ads1115_stream_mux_t mux) {
+    uint16_t config = ((uint16_t) mux << ADS1115_CONFIG_MUX_SHIFT)
+                      | ((uint16_t) stream.config.fsr << ADS1115_CONFIG_PGA_SHIFT)
+                      | ((uint16_t) stream.config.sps << ADS1115_CONFIG_DR_SHIFT)
+                      | ADS1115_CONFIG_MODE_CONTINUOUS
+                      | ADS1115_CONFIG_COMP_QUE_1;
+    return ads1115_stream_write_reg(ADS1115_REG_CONFIG, config);
+}
+
+static void ads1115_stream_task(void *arg) {
+    ARG_UNUSED(arg);
+    // Give up waiting for the interrupt after two conversions and read anyway, the pin might not be wired.
+    TickType_t timeout = pdMS_TO_TICKS(2 * ads1115_stream_period_us(stream.config.sps) / 1000 + 10);
+    size_t channel = 0;
+
+    ESP_ERROR_CHECK(ads1115_stream_select(stream.config.mux[channel]));
+    while (true) {
+        if (ulTaskNotifyTake(pdTRUE, timeout) == 0) {
+            stream.ready_us = esp_timer_get_time();
+            ads1115_stream_missed();
+        }
+        int64_t ready_us = stream.ready_us;
+        uint8_t buf[2] = {0};
+        esp_err_t err = i2c_bus_write_reg_read(stream.dev, ADS1115_REG_CONVERSION, NULL, 0, buf, sizeof(buf));
+        if (err == ESP_OK) {
+            ads1115_stream_push(channel, (int16_t) ((buf[0] << 8) | buf[1]), ready_us);
+        } else {
+            ESP_LOGD(TAG, "read err: %s", esp_err_to_name(err));
+            ads1115_stream_error();
+        }
+        if (stream.config.channels > 1) {
+            channel = (channel + 1) % stream.config.channels;
+            if (ads1115_stream_select(stream.config.mux[channel]) != ESP_OK) {
+                ads1115_stream_error();
+            }
+            // A conversion of the previous channel can complete while selecting, its data ready is not this channel's.
+            ulTaskNotifyTake(pdTRUE, 0);
+        }
+    }
+}
+
+esp_err_t ads1115_stream_start(const ads1115_stream_config_t *config) {
+    ARG_CHECK(config != NULL, ERR_PARAM_NULL);
+
+    stream.config = *config;
+    ESP_ERROR_CHECK(i2c_bus_add_device("ads1115", config->address, I2C_BUS_PRIORITY_NORMAL, &stream.dev));
+    // Hi_thresh MSB set and Lo_thresh MSB cleared turns ALERT/RDY into a conversion ready pin.
+    ESP_ERROR_CHECK(ads1115_stream_write_reg(ADS1115_REG_HI_THRESH, 0x8000));
+    ESP_ERROR_CHECK(ads1115_stream_write_reg(ADS1115_REG_LO_THRESH, 0x0000));
+
+    xTaskCreatePinnedToCore(ads1115_stream_task, "ads1115", 2048, NULL, configMAX_PRIORITIES - 6, &stream.task,
+                            tskNO_AFFINITY);
+    if (config->alert_gpio != GPIO_NUM_NC) {
+        gpio_config_t io_conf = {
+                .pin_bit_mask = 1ULL << config->alert_gpio,
+                .mode = GPIO_MODE_INPUT,
+                .pull_up_en = GPIO_PULLUP_ENABLE,
+                .intr_type = GPIO_INTR_NEGEDGE,
+        };
+        ESP_ERROR_CHECK(gpio_config(&io_conf));
+        ESP_ERROR_CHECK(gpio_isr_handler_add(config->alert_gpio, ads1115_stream_isr, NULL));
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,39 @@
+#include <stdlib.h>
+
+#include "esp_err.h"
+#include "esp_timer.h"
+
+#include "ads1115_stream.h"
+#include "error.h"
+#include "simulation.h"
+
+static struct {
+    ads1115_stream_config_t config;
+    esp_timer_handle_t timer;
+    size_t channel;
+} stream = {0};
+
+// Stands in for the data ready interrupt, one conversion per channel in round-robin at the configured data rate.
+static void ads1115_stream_timer(void *arg) {
+    ARG_UNUSED(arg);
+    size_t channel = stream.channel;
+    int16_t raw;
+    if (stream.config.simulate_raw == NULL || !stream.config.simulate_raw(channel, &raw)) {
+        raw = (int16_t) WITH_THRESHOLD(stream.config.simulate[channel], stream.config.threshold[channel]);
+    }
+    ads1115_stream_push(channel, raw, esp_timer_get_time());
+    stream.channel = (channel + 1) % stream.config.channels;
+}
+
+esp_err_t ads1115_stream_start(const ads1115_stream_config_t *config) {
+    ARG_CHECK(config != NULL, ERR_PARAM_NULL);
+
+    stream.config = *config;
+    esp_timer_create_args_t args = {
+            .callback = ads1115_stream_timer,
+            .name = "ads1115",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &stream.timer));
+    ESP_ERROR_CHECK(esp_timer_start_periodic(stream.timer, ads1115_stream_period_us(config->sps)));
+    return ESP_OK;
+}
@@ -5,7 +5,7 @@
 #include "buses.h"
 #include "error.h"
 #include "ext_gpio.h"
-#include "i2c.h"
+#include "i2c_bus.h"
 
 #define EXT_GPIO_INITIAL_PORT_A 0xff  // Set all to ON since the relays are active-low.
 #define EXT_GPIO_INITIAL_PORT_B 0x00  // Set all to OFF.
@@ -131,22 +131,21 @@ typedef struct regs {
 } ext_gpio_status_t;
 
 static ext_gpio_status_t status = {0};
+static i2c_bus_device_handle_t dev;
 
 #define A_OR_B(num, a, b)  ((num) < 8 ? (a) : (b))
 #define PIN_MASK(gpio_num) (BIT(((gpio_num) % 8)))
 
 static esp_err_t ext_gpio_read(ext_gpio_reg_t reg_addr, uint8_t *data, size_t data_len) {
     ESP_LOGD(TAG, "READ 0x%02x -> 0x%02x", (EXT_GPIO_ADDRESS << 1) | I2C_MASTER_READ, reg_addr);
-    ESP_ERROR_CHECK(i2c_master_write_reg_read(I2C_MASTER_NUM, EXT_GPIO_ADDRESS, reg_addr, NULL, 0, data, data_len,
-                                              pdMS_TO_TICKS(I2C_TIMEOUT_MS)));
+    ESP_ERROR_CHECK(i2c_bus_write_reg_read(dev, reg_addr, NULL, 0, data, data_len));
     ESP_LOG_BUFFER_HEX_LEVEL(TAG, data, data_len, ESP_LOG_DEBUG);
     return ESP_OK;
 }
 
 static esp_err_t ext_gpio_write(ext_gpio_reg_t reg_addr, const uint8_t *data, size_t data_len) {
     ESP_LOGD(TAG, "WRITE 0x%02x -> 0x%02x", (EXT_GPIO_ADDRESS << 1) | I2C_MASTER_WRITE, reg_addr);
-    ESP_ERROR_CHECK(i2c_master_write_reg_read(I2C_MASTER_NUM, EXT_GPIO_ADDRESS, reg_addr, data, data_len, NULL, 0,
-                                              pdMS_TO_TICKS(I2C_TIMEOUT_MS)));
+    ESP_ERROR_CHECK(i2c_bus_write_reg_read(dev, reg_addr, data, data_len, NULL, 0));
     ESP_LOG_BUFFER_HEX_LEVEL(TAG, data, data_len, ESP_LOG_DEBUG);
     return ESP_OK;
 }
@@ -196,6 +195,9 @@ static esp_err_t ext_gpio_check_reset(void) {
 }
 
 esp_err_t ext_gpio_init(void) {
+    // Relays must never wait behind sensor reads or display frames.
+    ESP_ERROR_CHECK(i2c_bus_add_device(TAG, EXT_GPIO_ADDRESS, I2C_BUS_PRIORITY_HIGH, &dev));
+
     // Reset the bank access to BANK=0.
     ESP_ERROR_CHECK(ext_gpio_write_reg(EXT_GPIO_REG_IOCONA, 0x00));
     ESP_ERROR_CHECK(ext_gpio_write_reg(EXT_GPIO_REG_IOCONB, 0x00));
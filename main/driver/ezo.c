@@ -1,6 +1,10 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 
 #include "driver/i2c.h"
 #include "esp_log.h"
@@ -9,16 +13,22 @@
 #include "context.h"
 #include "error.h"
 #include "ezo.h"
+#include "utils.h"
 
-#define MAX_SENSORS 5
 
 static const char *TAG = "ezo";
-static ezo_sensor_t *sensors[MAX_SENSORS] = {0};
+static ezo_sensor_t *sensors[EZO_MAX_SENSORS] = {0};
 static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
 
 static esp_err_t ezo_register(ezo_sensor_t *sensor) {
     portENTER_CRITICAL(&spinlock);
-    for (int n = 0; n < MAX_SENSORS; n++) {
+    for (int n = 0; n < EZO_MAX_SENSORS; n++) {
+        if (sensors[n] == sensor) {
+            portEXIT_CRITICAL(&spinlock);
+            return ESP_OK;
+        }
+    }
+    for (int n = 0; n < EZO_MAX_SENSORS; n++) {
         if (sensors[n] == NULL) {
             sensors[n] = sensor;
             portEXIT_CRITICAL(&spinlock);
@@ -31,7 +41,7 @@ static esp_err_t ezo_register(ezo_sensor_t *sensor) {
 
 static void ezo_unregister(ezo_sensor_t *sensor) {
     portENTER_CRITICAL(&spinlock);
-    for (int n = 0; n < MAX_SENSORS; n++) {
+    for (int n = 0; n < EZO_MAX_SENSORS; n++) {
         if (sensors[n] == sensor) {
             sensors[n] = NULL;
         }
@@ -47,14 +57,30 @@ esp_err_t ezo_init(ezo_sensor_t *sensor) {
     }
     memset(sensor->type, 0, sizeof(sensor->type));
     memset(sensor->version, 0, sizeof(sensor->version));
-    sensor->lock = xSemaphoreCreateMutex();
+    // Retried by the sensors runtime until the module answers, the lock and the bus device are only created once.
+    if (sensor->lock == NULL) {
+        sensor->lock = xSemaphoreCreateMutex();
+        CHECK_NO_MEM(sensor->lock);
+    }
+    esp_err_t err = ESP_OK;
+    if (sensor->dev == NULL) {
+        err = i2c_bus_add_device(sensor->desc, sensor->address, I2C_BUS_PRIORITY_NORMAL, &sensor->dev);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
 
     // Allow the device to sleep a little bit just in case we were in the middle of a read operation before the reset.
     // If we don't, then sometimes we read the probe value instead of what was requested.
     vTaskDelay(pdMS_TO_TICKS(sensor->delay_read_ms));
 
-    // Read type and version information.
-    ESP_ERROR_CHECK(ezo_device_info(sensor));
+    // Read type and version information. A missing module only takes its own sensor down, the caller marks it failed.
+    err = ezo_device_info(sensor);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "[0x%.2x] No EZO module %s with probe %s: %s", sensor->address, sensor->desc, sensor->probe,
+                 esp_err_to_name(err));
+        return err;
+    }
     ESP_LOGI(TAG, "[0x%.2x] Found EZO-%s module (v%s) %s with probe %s", sensor->address, sensor->type, sensor->version,
              sensor->desc, sensor->probe);
 
@@ -74,7 +100,7 @@ esp_err_t ezo_free(ezo_sensor_t *sensor) {
 
 ezo_sensor_t *ezo_find(const char *desc) {
     portENTER_CRITICAL(&spinlock);
-    for (int n = 0; n < MAX_SENSORS; n++) {
+    for (int n = 0; n < EZO_MAX_SENSORS; n++) {
         ezo_sensor_t *sensor = sensors[n];
         if (sensor != NULL && strncasecmp(sensor->desc, desc, sizeof(sensor->desc)) == 0) {
             portEXIT_CRITICAL(&spinlock);
@@ -85,6 +111,129 @@ ezo_sensor_t *ezo_find(const char *desc) {
     return NULL;
 }
 
+size_t ezo_list(ezo_sensor_t **list, size_t max) {
+    size_t count = 0;
+    portENTER_CRITICAL(&spinlock);
+    for (int n = 0; n < EZO_MAX_SENSORS && count < max; n++) {
+        if (sensors[n] != NULL) {
+            list[count++] = sensors[n];
+        }
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return count;
+}
+
+static esp_err_t ezo_vstart(ezo_sensor_t *sensor, uint16_t delay_ms, const char *cmd_fmt, va_list va) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(cmd_fmt != NULL, ERR_PARAM_NULL);
+
+    vsnprintf(sensor->buf, EZO_MAX_BUFFER_LEN, cmd_fmt, va);
+    return ezo_write(sensor, delay_ms);
+}
+
+esp_err_t ezo_start(ezo_sensor_t *sensor, uint16_t delay_ms, const char *cmd_fmt, ...) {
+    va_list va;
+    va_start(va, cmd_fmt);
+    esp_err_t err = ezo_vstart(sensor, delay_ms, cmd_fmt, va);
+    va_end(va);
+    return err;
+}
+
+esp_err_t ezo_send_command(ezo_sensor_t *sensor, uint16_t delay_ms, const char *cmd_fmt, ...) {
+    va_list va;
+    va_start(va, cmd_fmt);
+    esp_err_t err = ezo_vstart(sensor, delay_ms, cmd_fmt, va);
+    va_end(va);
+    if (err != ESP_OK) {
+        return err;
+    }
+    while ((err = ezo_collect(sensor)) == ESP_ERR_NOT_FINISHED) {
+        TickType_t now = xTaskGetTickCount();
+        if ((int32_t) (sensor->ready - now) > 0) {
+            vTaskDelay(sensor->ready - now);
+        }
+    }
+    return err;
+}
+
+esp_err_t ezo_parse_response(ezo_sensor_t *sensor, uint8_t fields, const char *response_fmt, ...) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+
+    if (response_fmt == NULL && fields == 0) {
+        // Commands like T or Cal only reply with the status code.
+        return sensor->bytes_read == 0 ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
+    }
+    if (sensor->bytes_read <= 0) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    // Make sure the buffer ends with a \0 to avoid vsscanf scanning our whole memory.
+    sensor->buf[EZO_MAX_BUFFER_LEN - 1] = '\0';
+    va_list va;
+    va_start(va, response_fmt);
+    int scanned_fields = vsscanf(sensor->buf, response_fmt, va);
+    va_end(va);
+
+    if (scanned_fields != fields) {
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    return ESP_OK;
+}
+
+// Never blocks on the lock, a calibration or command holding the module just makes the caller skip this sample.
+static esp_err_t ezo_start_locked(ezo_sensor_t *sensor, uint16_t delay_ms, const char *cmd_fmt, ...) {
+    if (xSemaphoreTake(sensor->lock, 0) != pdTRUE) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    va_list va;
+    va_start(va, cmd_fmt);
+    esp_err_t err = ezo_vstart(sensor, delay_ms, cmd_fmt, va);
+    va_end(va);
+    if (err != ESP_OK) {
+        xSemaphoreGive(sensor->lock);
+    }
+    return err;
+}
+
+esp_err_t ezo_start_read(ezo_sensor_t *sensor) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    return ezo_start_locked(sensor, sensor->delay_read_ms, "R");
+}
+
+esp_err_t ezo_collect_read(ezo_sensor_t *sensor, float *value) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(value != NULL, ERR_PARAM_NULL);
+
+    esp_err_t err = ezo_collect(sensor);
+    if (err == ESP_ERR_NOT_FINISHED) {
+        return err;
+    }
+    if (err == ESP_OK) {
+        err = ezo_parse_response(sensor, 1, "%f", value);
+    }
+    xSemaphoreGive(sensor->lock);
+    return err;
+}
+
+esp_err_t ezo_start_temperature(ezo_sensor_t *sensor, float temp) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(CONTEXT_VALUE_IS_VALID(temp), "temperature is not valid");
+    return ezo_start_locked(sensor, sensor->delay_ms, "T,%.2f", temp);
+}
+
+esp_err_t ezo_collect_ack(ezo_sensor_t *sensor) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+
+    esp_err_t err = ezo_collect(sensor);
+    if (err == ESP_ERR_NOT_FINISHED) {
+        return err;
+    }
+    if (err == ESP_OK) {
+        err = ezo_parse_response(sensor, 0, NULL);
+    }
+    xSemaphoreGive(sensor->lock);
+    return err;
+}
+
 float ezo_read_and_print(ezo_sensor_t *sensor, float temp, int precision, const char *unit) {
     if (sensor->address == EZO_INVALID_ADDRESS) {
         return CONTEXT_UNKNOWN_VALUE;
@@ -98,3 +247,132 @@ float ezo_read_and_print(ezo_sensor_t *sensor, float temp, int precision, const
     ESP_LOGD(TAG, "%s %.*f %s", sensor->type, precision, value, unit);
     return value;
 }
+
+esp_err_t ezo_export_calibration(ezo_sensor_t *sensor, char **buffer, size_t *size) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(buffer != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(size != NULL, ERR_PARAM_NULL);
+
+    int rows = 0;
+    int bytes = 0;
+    char *buf = NULL;
+    size_t len = 0;
+    xSemaphoreTake(sensor->lock, portMAX_DELAY);
+    esp_err_t err = ezo_send_command(sensor, sensor->delay_ms, "Export,?");
+    if (err == ESP_OK) {
+        err = ezo_parse_response(sensor, 2, "%d,%d", &rows, &bytes);
+    }
+    if (err == ESP_OK && (rows <= 0 || bytes <= 0)) {
+        err = ESP_ERR_INVALID_RESPONSE;
+    }
+    // One row per line plus the \0.
+    size_t max_size = bytes + rows + 1;
+    if (err == ESP_OK && (buf = calloc(1, max_size)) == NULL) {
+        err = ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; err == ESP_OK && i < rows; ++i) {
+        err = ezo_send_command(sensor, sensor->delay_ms, "Export");
+        if (err != ESP_OK) {
+            break;
+        }
+        if (sensor->bytes_read == 0 || len + sensor->bytes_read + 1 >= max_size) {
+            err = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+        memcpy(&buf[len], sensor->buf, sensor->bytes_read);
+        len += sensor->bytes_read;
+        buf[len++] = '\n';
+    }
+    if (err == ESP_OK) {
+        err = ezo_send_command(sensor, sensor->delay_ms, "Export");
+    }
+    if (err == ESP_OK && strcmp(sensor->buf, "*DONE") != 0) {
+        err = ESP_ERR_INVALID_RESPONSE;
+    }
+    xSemaphoreGive(sensor->lock);
+
+    if (err != ESP_OK) {
+        SAFE_FREE(buf);
+        return err;
+    }
+    buf[len] = '\0';
+    *buffer = buf;
+    *size = len;
+    return ESP_OK;
+}
+
+esp_err_t ezo_import_calibration(ezo_sensor_t *sensor, const char *buffer, size_t size) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(buffer != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(size > 0, ERR_PARAM_LE_ZERO);
+
+    esp_err_t err = ESP_OK;
+    xSemaphoreTake(sensor->lock, portMAX_DELAY);
+    for (size_t start = 0; err == ESP_OK && start < size;) {
+        const char *eol = memchr(&buffer[start], '\n', size - start);
+        size_t end = eol != NULL ? eol - buffer : size;
+        int len = (int) (end - start);
+        if (len > 0) {
+            err = ezo_send_command(sensor, sensor->delay_ms, "Import,%.*s", len, &buffer[start]);
+            if (err == ESP_OK) {
+                err = ezo_parse_response(sensor, 0, NULL);
+            }
+        }
+        start = end + 1;
+    }
+    // The module reboots to apply the imported calibration.
+    vTaskDelay(pdMS_TO_TICKS(EZO_DELAY_MS_REBOOT));
+    xSemaphoreGive(sensor->lock);
+    return err;
+}
+
+esp_err_t ezo_calibration_mode(ezo_sensor_t *sensor, ezo_calibration_mode_t *mode) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(mode != NULL, ERR_PARAM_NULL);
+
+    int points = 0;
+    xSemaphoreTake(sensor->lock, portMAX_DELAY);
+    esp_err_t err = ezo_send_command(sensor, sensor->delay_ms, "Cal,?");
+    if (err == ESP_OK) {
+        err = ezo_parse_response(sensor, 1, "?Cal,%d", &points);
+    }
+    xSemaphoreGive(sensor->lock);
+    if (err == ESP_OK) {
+        *mode = (ezo_calibration_mode_t) points;
+    }
+    return err;
+}
+
+static const char *EZO_CALIBRATION_STEPS[EZO_CALIBRATION_STEP_MAX] = {
+        "Cal,dry",
+        "Cal,%.2f",
+        "Cal,low,%.2f",
+        "Cal,mid,%.2f",
+        "Cal,high,%.2f",
+        "Cal,clear",
+};
+
+esp_err_t ezo_calibration_step(ezo_sensor_t *sensor, ezo_calibration_step_t step, float value) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(step < EZO_CALIBRATION_STEP_MAX, "parameter >= EZO_CALIBRATION_MAX");
+
+    xSemaphoreTake(sensor->lock, portMAX_DELAY);
+    esp_err_t err = ezo_send_command(sensor, sensor->delay_calibration_ms, EZO_CALIBRATION_STEPS[step], value);
+    if (err == ESP_OK) {
+        err = ezo_parse_response(sensor, 0, NULL);
+    }
+    xSemaphoreGive(sensor->lock);
+    return err;
+}
+
+esp_err_t ezo_protocol_lock(ezo_sensor_t *sensor, bool lock) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+
+    xSemaphoreTake(sensor->lock, portMAX_DELAY);
+    esp_err_t err = ezo_send_command(sensor, sensor->delay_ms, "Plock,%d", lock ? 1 : 0);
+    if (err == ESP_OK) {
+        err = ezo_parse_response(sensor, 0, NULL);
+    }
+    xSemaphoreGive(sensor->lock);
+    return err;
+}
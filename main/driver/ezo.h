@@ -5,13 +5,26 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 
+#include "i2c_bus.h"
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+#include "simulation.h"
+#endif
+
 #define EZO_MAX_BUFFER_LEN 32
 #define EZO_DELAY_MS_SHORT 300
 #define EZO_DELAY_MS_SLOW 600
 #define EZO_DELAY_MS_SLOWEST 900
+#define EZO_DELAY_MS_REBOOT 1000
 #define EZO_MAX_RETRIES 4
+#define EZO_RETRY_MS 20
 
 #define EZO_INVALID_ADDRESS 0xff
+#define EZO_MAX_SENSORS 5
+
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+#define EZO_SIM_CALIBRATION_ROW 12
+#define EZO_SIM_CALIBRATION_LEN (EZO_SIM_CALIBRATION_ROW * 8 + 1)
+#endif
 
 typedef enum {
     EZO_SENSOR_RESPONSE_UNKNOWN = 0,
@@ -60,10 +73,16 @@ typedef struct {
     size_t bytes_read;
     ezo_sensor_response_t status;
     xSemaphoreHandle lock;
+    i2c_bus_device_handle_t dev;
+    TickType_t ready;   /*!< Tick at which the reply of the last command is expected. */
+    uint8_t retries;    /*!< Number of times the last command replied with processing. */
     bool pause;
 #ifdef CONFIG_ESP_SENSOR_SIMULATE
+    simulation_channel_t channel;
     float simulate;
     float threshold;
+    char calibration_blob[EZO_SIM_CALIBRATION_LEN]; /*!< Calibration rows kept by the simulated module. */
+    size_t calibration_cursor;                      /*!< Next row to export, or rows imported so far. */
 #endif
 } ezo_sensor_t;
 
@@ -73,6 +92,18 @@ esp_err_t ezo_free(ezo_sensor_t *sensor);
 
 ezo_sensor_t *ezo_find(const char *desc);
 
+// Fills `list` with up to `max` registered sensors and returns how many were written.
+size_t ezo_list(ezo_sensor_t **list, size_t max);
+
+// Writes the command in `sensor->buf` and marks the reply as expected `delay_ms` from now. Does not block.
+esp_err_t ezo_write(ezo_sensor_t *sensor, uint16_t delay_ms);
+
+// Polls for the reply of the last command. Returns ESP_ERR_NOT_FINISHED while the module is still processing, in
+// which case `sensor->ready` is moved to the next time it is worth asking again.
+esp_err_t ezo_collect(ezo_sensor_t *sensor);
+
+esp_err_t ezo_start(ezo_sensor_t *sensor, uint16_t delay_ms, const char *cmd_fmt, ...) __printflike(3, 4);
+
 esp_err_t ezo_send_command(ezo_sensor_t *sensor, uint16_t delay_ms, const char *cmd_fmt, ...) __printflike(3, 4);
 
 esp_err_t ezo_parse_response(ezo_sensor_t *sensor, uint8_t fields, const char *response_fmt, ...) __scanflike(3, 4);
@@ -81,14 +112,30 @@ esp_err_t ezo_read(ezo_sensor_t *sensor, float *value);
 
 esp_err_t ezo_read_temperature(ezo_sensor_t *sensor, float *value, float temp);
 
+// Split phase commands: `ezo_start_*` takes the sensor lock without waiting and issues the command, `ezo_collect_*`
+// releases it once it returns anything other than ESP_ERR_NOT_FINISHED. Both must be called from the same task.
+// `ezo_start_*` returns ESP_ERR_INVALID_STATE while another command, e.g. a calibration, holds the module.
+esp_err_t ezo_start_read(ezo_sensor_t *sensor);
+
+esp_err_t ezo_collect_read(ezo_sensor_t *sensor, float *value);
+
+// Stores the compensation temperature in the module, used by every following plain read.
+esp_err_t ezo_start_temperature(ezo_sensor_t *sensor, float temp);
+
+esp_err_t ezo_collect_ack(ezo_sensor_t *sensor);
+
 float ezo_read_and_print(ezo_sensor_t *sensor, float temp, int precision, const char *unit);
 
 esp_err_t ezo_device_info(ezo_sensor_t *sensor);
 
 esp_err_t ezo_status(ezo_sensor_t *sensor, ezo_status_t *status, float *voltage);
 
+// Exports the calibration rows as '\n' separated lines into a newly allocated `buffer` that the caller must free.
 esp_err_t ezo_export_calibration(ezo_sensor_t *sensor, char **buffer, size_t *size);
 
+// Imports rows previously exported by `ezo_export_calibration`. The module reboots once the last row is imported.
+esp_err_t ezo_import_calibration(ezo_sensor_t *sensor, const char *buffer, size_t size);
+
 esp_err_t ezo_calibration_mode(ezo_sensor_t *sensor, ezo_calibration_mode_t *mode);
 
 esp_err_t ezo_calibration_step(ezo_sensor_t *sensor, ezo_calibration_step_t step, float value);
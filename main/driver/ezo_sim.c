@@ -1,3 +1,4 @@
+#include <stdio.h>
 #include <string.h>
 
 #include "freertos/FreeRTOS.h"
@@ -12,18 +13,121 @@
 
 static const char *TAG = "ezo";
 
-esp_err_t ezo_send_command(ezo_sensor_t *sensor, uint16_t delay_ms, const char *cmd_fmt, ...) {
-    ARG_UNUSED(sensor);
-    ARG_UNUSED(delay_ms);
-    ARG_UNUSED(cmd_fmt);
-    return ESP_FAIL;
+esp_err_t ezo_write(ezo_sensor_t *sensor, uint16_t delay_ms) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(delay_ms > 0, ERR_PARAM_LE_ZERO);
+
+    sensor->status = EZO_SENSOR_RESPONSE_UNKNOWN;
+    sensor->bytes_read = 0;
+    sensor->retries = 0;
+    sensor->ready = xTaskGetTickCount() + pdMS_TO_TICKS(delay_ms);
+    return ESP_OK;
 }
 
-esp_err_t ezo_parse_response(ezo_sensor_t *sensor, uint8_t fields, const char *response_fmt, ...) {
-    ARG_UNUSED(sensor);
-    ARG_UNUSED(fields);
-    ARG_UNUSED(response_fmt);
-    return ESP_FAIL;
+// Every calibration point is kept as one fixed size row "<step><value>", the same rows are exported and imported.
+static ezo_calibration_mode_t ezo_sim_calibration_mode(const ezo_sensor_t *sensor) {
+    int points = 0;
+    for (const char *row = sensor->calibration_blob; *row != '\0'; row += EZO_SIM_CALIBRATION_ROW) {
+        if (strncmp(row, "00", 2) != 0) {
+            points++;
+        }
+    }
+    return points > EZO_CALIBRATION_MODE_THREE_POINTS ? EZO_CALIBRATION_MODE_THREE_POINTS : points;
+}
+
+static ezo_sensor_response_t ezo_sim_calibration_add(ezo_sensor_t *sensor, ezo_calibration_step_t step, float value) {
+    size_t len = strlen(sensor->calibration_blob);
+    if (len + EZO_SIM_CALIBRATION_ROW >= EZO_SIM_CALIBRATION_LEN) {
+        return EZO_SENSOR_RESPONSE_SYNTAX_ERROR;
+    }
+    snprintf(&sensor->calibration_blob[len], EZO_SIM_CALIBRATION_LEN - len, "%02d%010.3f", step, value);
+    return EZO_SENSOR_RESPONSE_SUCCESS;
+}
+
+static ezo_sensor_response_t ezo_sim_calibration(ezo_sensor_t *sensor) {
+    char *cmd = sensor->buf;
+    size_t rows = strlen(sensor->calibration_blob) / EZO_SIM_CALIBRATION_ROW;
+    float value = 0.f;
+    if (strcmp(cmd, "Cal,?") == 0) {
+        snprintf(cmd, EZO_MAX_BUFFER_LEN, "?Cal,%d", ezo_sim_calibration_mode(sensor));
+    } else if (strcmp(cmd, "Cal,clear") == 0) {
+        sensor->calibration_blob[0] = '\0';
+        cmd[0] = '\0';
+    } else if (strncmp(cmd, "Cal,", 4) == 0) {
+        ezo_calibration_step_t step;
+        if (strcmp(cmd, "Cal,dry") == 0) {
+            step = EZO_CALIBRATION_STEP_DRY;
+        } else if (sscanf(cmd, "Cal,low,%f", &value) == 1) {
+            step = EZO_CALIBRATION_STEP_LOW;
+        } else if (sscanf(cmd, "Cal,mid,%f", &value) == 1) {
+            step = EZO_CALIBRATION_STEP_MID;
+        } else if (sscanf(cmd, "Cal,high,%f", &value) == 1) {
+            step = EZO_CALIBRATION_STEP_HIGH;
+        } else if (sscanf(cmd, "Cal,%f", &value) == 1) {
+            step = EZO_CALIBRATION_STEP_SINGLE;
+        } else {
+            return EZO_SENSOR_RESPONSE_SYNTAX_ERROR;
+        }
+        cmd[0] = '\0';
+        return ezo_sim_calibration_add(sensor, step, value);
+    } else if (strcmp(cmd, "Export,?") == 0) {
+        sensor->calibration_cursor = 0;
+        snprintf(cmd, EZO_MAX_BUFFER_LEN, "%u,%u", (unsigned) rows, (unsigned) (rows * EZO_SIM_CALIBRATION_ROW));
+    } else if (strcmp(cmd, "Export") == 0) {
+        if (sensor->calibration_cursor < rows) {
+            snprintf(cmd, EZO_MAX_BUFFER_LEN, "%.*s", EZO_SIM_CALIBRATION_ROW,
+                     &sensor->calibration_blob[sensor->calibration_cursor++ * EZO_SIM_CALIBRATION_ROW]);
+        } else {
+            snprintf(cmd, EZO_MAX_BUFFER_LEN, "*DONE");
+        }
+    } else if (strncmp(cmd, "Import,", 7) == 0) {
+        // The first imported row replaces whatever calibration the module had.
+        if (sensor->calibration_cursor++ == 0) {
+            sensor->calibration_blob[0] = '\0';
+        }
+        size_t len = strlen(sensor->calibration_blob);
+        if (strlen(&cmd[7]) != EZO_SIM_CALIBRATION_ROW || len + EZO_SIM_CALIBRATION_ROW >= EZO_SIM_CALIBRATION_LEN) {
+            return EZO_SENSOR_RESPONSE_SYNTAX_ERROR;
+        }
+        strlcpy(&sensor->calibration_blob[len], &cmd[7], EZO_SIM_CALIBRATION_LEN - len);
+        cmd[0] = '\0';
+    } else {
+        return EZO_SENSOR_RESPONSE_SYNTAX_ERROR;
+    }
+    return EZO_SENSOR_RESPONSE_SUCCESS;
+}
+
+esp_err_t ezo_collect(ezo_sensor_t *sensor) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+
+    // Same timing as the real modules, asking too early only gets a processing reply.
+    if ((int32_t) (xTaskGetTickCount() - sensor->ready) < 0) {
+        return ESP_ERR_NOT_FINISHED;
+    }
+    // Only consecutive Export or Import commands walk the calibration rows.
+    bool rows = strncmp(sensor->buf, "Export", 6) == 0 || strncmp(sensor->buf, "Import,", 7) == 0;
+    if (!rows) {
+        sensor->calibration_cursor = 0;
+    }
+    if (rows || strncmp(sensor->buf, "Cal,", 4) == 0) {
+        sensor->status = ezo_sim_calibration(sensor);
+    } else if (sensor->buf[0] == 'R') {
+        float value = simulation_read(sensor->channel, sensor->simulate, sensor->threshold);
+        snprintf(sensor->buf, EZO_MAX_BUFFER_LEN, "%.3f", value);
+        sensor->status = EZO_SENSOR_RESPONSE_SUCCESS;
+    } else if (strcmp(sensor->buf, "I") == 0) {
+        snprintf(sensor->buf, EZO_MAX_BUFFER_LEN, "?I,sim,x.xx");
+        sensor->status = EZO_SENSOR_RESPONSE_SUCCESS;
+    } else {
+        sensor->buf[0] = '\0';
+        sensor->status = EZO_SENSOR_RESPONSE_SUCCESS;
+    }
+    if (sensor->status != EZO_SENSOR_RESPONSE_SUCCESS) {
+        sensor->buf[0] = '\0';
+        return ESP_FAIL;
+    }
+    sensor->bytes_read = strlen(sensor->buf);
+    return ESP_OK;
 }
 
 esp_err_t ezo_read(ezo_sensor_t *sensor, float *value) {
@@ -33,7 +137,7 @@ esp_err_t ezo_read(ezo_sensor_t *sensor, float *value) {
     vTaskDelay(pdMS_TO_TICKS(sensor->delay_read_ms));
     xSemaphoreGive(sensor->lock);
 
-    *value = WITH_THRESHOLD(sensor->simulate, sensor->threshold);
+    *value = simulation_read(sensor->channel, sensor->simulate, sensor->threshold);
     return ESP_OK;
 }
 
@@ -45,7 +149,7 @@ esp_err_t ezo_read_temperature(ezo_sensor_t *sensor, float *value, float temp) {
     vTaskDelay(pdMS_TO_TICKS(sensor->delay_read_ms));
     xSemaphoreGive(sensor->lock);
 
-    *value = WITH_THRESHOLD(sensor->simulate, sensor->threshold);
+    *value = simulation_read(sensor->channel, sensor->simulate, sensor->threshold);
     return ESP_OK;
 }
 
@@ -63,29 +167,3 @@ esp_err_t ezo_status(ezo_sensor_t *sensor, ezo_status_t *status, float *voltage)
     ARG_UNUSED(voltage);
     return ESP_FAIL;
 }
-
-esp_err_t ezo_export_calibration(ezo_sensor_t *sensor, char **buffer, size_t *size) {
-    ARG_UNUSED(sensor);
-    ARG_UNUSED(buffer);
-    ARG_UNUSED(size);
-    return ESP_FAIL;
-}
-
-esp_err_t ezo_calibration_mode(ezo_sensor_t *sensor, ezo_calibration_mode_t *mode) {
-    ARG_UNUSED(sensor);
-    ARG_UNUSED(mode);
-    return ESP_FAIL;
-}
-
-esp_err_t ezo_calibration_step(ezo_sensor_t *sensor, ezo_calibration_step_t step, float value) {
-    ARG_UNUSED(sensor);
-    ARG_UNUSED(step);
-    ARG_UNUSED(value);
-    return ESP_FAIL;
-}
-
-esp_err_t ezo_protocol_lock(ezo_sensor_t *sensor, bool lock) {
-    ARG_UNUSED(sensor);
-    ARG_UNUSED(lock);
-    return ESP_FAIL;
-}
\ No newline at end of file
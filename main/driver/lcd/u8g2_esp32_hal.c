@@ -6,12 +6,14 @@
 
 #include "buses.h"
 #include "error.h"
+#include "i2c_bus.h"
 #include "utils.h"
 #include "u8g2_esp32_hal.h"
 
 static const char *TAG = "u8g2_hal";
 
 static i2c_cmd_handle_t handle_i2c;      // I2C handle.
+static i2c_bus_device_handle_t bus_dev;  // I2C bus device, frames have the lowest priority.
 static u8g2_esp32_hal_t u8g2_esp32_hal;  // HAL state data.
 
 /* Initialize the ESP32 HAL. */
@@ -51,13 +53,17 @@ uint8_t u8g2_esp32_i2c_byte_cb(u8x8_t *u8x8, uint8_t msg, uint8_t arg_int, void
         case U8X8_MSG_BYTE_END_TRANSFER: {
             ESP_LOGD(TAG, "End I2C transfer.");
             ESP_ERROR_CHECK(i2c_master_stop(handle_i2c));
-            ESP_ERROR_CHECK(i2c_master_cmd_begin(I2C_MASTER_NUM, handle_i2c, pdMS_TO_TICKS(I2C_TIMEOUT_MS)));
+            ESP_ERROR_CHECK(i2c_bus_cmd_begin(bus_dev, handle_i2c, I2C_TIMEOUT_MS));
             i2c_cmd_link_delete(handle_i2c);
             break;
         }
 
         case U8X8_MSG_BYTE_INIT: {
             // Initialization is done by the buses_init.
+            if (bus_dev == NULL) {
+                ESP_ERROR_CHECK(i2c_bus_add_device("u8g2", u8x8_GetI2CAddress(u8x8) >> 1, I2C_BUS_PRIORITY_LOW,
+                                                   &bus_dev));
+            }
             break;
         }
 
@@ -5,6 +5,7 @@
 #include "config.h"
 #include "context.h"
 #include "console/console.h"
+#include "crashlog.h"
 #include "cron.h"
 #include "display/ext_display.h"
 #include "driver/ext_gpio.h"
@@ -16,6 +17,8 @@
 #include "sensors/ezo_ph.h"
 #include "sensors/ezo_rtd.h"
 #include "sensors/humidity_pressure.h"
+#include "sensors/sampling.h"
+#include "sensors/sensors.h"
 #include "sensors/tank.h"
 #include "storage.h"
 #include "tasks/io.h"
@@ -26,15 +29,23 @@
 #include "display/display.h"
 #include "driver/status.h" /*TODO(sobrinho): Adapt this module to support the RGB led.*/
 #endif
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+#include "simulation.h"
+#endif
 
 static context_t *context;
 
 void app_main() {
+    ESP_ERROR_CHECK(crashlog_init());
     context = context_create();
     ESP_ERROR_CHECK(syslog_init(context));
     ESP_ERROR_CHECK(storage_init(context));
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     ESP_ERROR_CHECK(config_init(context));
+    ESP_ERROR_CHECK(sampling_init(context));
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+    ESP_ERROR_CHECK(simulation_init());
+#endif
     ESP_ERROR_CHECK(wifi_init(context, context->config.ssid, context->config.password));
     ESP_ERROR_CHECK(ntp_init(context));
     buses_init();
@@ -53,6 +64,7 @@ void app_main() {
     ESP_ERROR_CHECK(ezo_ph_init(context));
     ESP_ERROR_CHECK(ezo_rtd_init(context));
     ESP_ERROR_CHECK(tank_init(context));
+    ESP_ERROR_CHECK(sensors_init(context));
     ESP_ERROR_CHECK(monitor_init(context));
     ESP_ERROR_CHECK(console_init());
 }
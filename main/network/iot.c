@@ -12,8 +12,11 @@
 #include "commands.pb-c.h"
 #include "config.h"
 #include "context.h"
+#include "crashlog.h"
+#include "driver/ezo.h"
 #include "error.h"
-#include "i2c.h"
+#include "ezo_calibration.h"
+#include "i2c_bus.h"
 #include "iot.h"
 #include "mqtt.h"
 #include "state.h"
@@ -46,22 +49,39 @@ typedef struct {
 static const char *const TAG = "iot";
 static RingbufHandle_t ring = NULL;
 
+// Addresses owned by a driver go through its device so the counters stay per device. Everything else shares one raw
+// device, the bus only has I2C_BUS_MAX_DEVICES slots.
+static i2c_bus_device_handle_t iot_i2c_device(uint8_t addr) {
+    static i2c_bus_device_handle_t raw = NULL;
+    i2c_bus_device_handle_t dev = i2c_bus_find_device(addr);
+    if (dev != NULL) {
+        return dev;
+    }
+    if (raw == NULL && i2c_bus_add_device("iot", I2C_NO_DEVICE, I2C_BUS_PRIORITY_NORMAL, &raw) != ESP_OK) {
+        return NULL;
+    }
+    return raw;
+}
+
 static esp_err_t iot_handle_command_i2c(const Hydroponics__CommandI2c *i2c) {
     const uint8_t addr = i2c->address & 0x7f;
-    const TickType_t wait = pdMS_TO_TICKS(I2C_TIMEOUT_MS);
     ESP_LOGI(TAG, "i2c[0x%02x] reg: 0x%02x", i2c->address, i2c->reg_address);
     ESP_LOG_BUFFER_HEX_LEVEL(TAG, i2c->write.data, i2c->write.len, ESP_LOG_INFO);
 
+    i2c_bus_device_handle_t dev = iot_i2c_device(addr);
+    if (dev == NULL) {
+        ESP_LOGI(TAG, "i2c[0x%02x] err: no free bus devices", i2c->address);
+        return ESP_OK;
+    }
     esp_err_t err = ESP_OK;
     if (i2c->read_len > 0) {
         uint8_t read[i2c->read_len];
         memset(read, 0, i2c->read_len);
-        err = i2c_master_write_reg_read(I2C_MASTER_NUM, addr, i2c->reg_address, i2c->write.data, i2c->write.len, read,
-                                        i2c->read_len, wait);
+        err = i2c_bus_write_reg_read_at(dev, addr, i2c->reg_address, i2c->write.data, i2c->write.len, read,
+                                        i2c->read_len);
         ESP_LOG_BUFFER_HEX_LEVEL(TAG, read, i2c->read_len, ESP_LOG_INFO);
     } else {
-        err = i2c_master_write_reg_read(I2C_MASTER_NUM, addr, i2c->reg_address, i2c->write.data, i2c->write.len, NULL,
-                                        0, wait);
+        err = i2c_bus_write_reg_read_at(dev, addr, i2c->reg_address, i2c->write.data, i2c->write.len, NULL, 0);
     }
     if (err != ESP_OK) {
         ESP_LOGI(TAG, "i2c[0x%02x] err: %s", i2c->address, esp_err_to_name(err));
@@ -69,6 +89,33 @@ static esp_err_t iot_handle_command_i2c(const Hydroponics__CommandI2c *i2c) {
     return ESP_OK;
 }
 
+static void iot_handle_command_calibration_one(Hydroponics__CommandCalibration__Action action, ezo_sensor_t *sensor) {
+    bool snapshot = action == HYDROPONICS__COMMAND_CALIBRATION__ACTION__SNAPSHOT;
+    esp_err_t err = snapshot ? ezo_calibration_snapshot(sensor) : ezo_calibration_restore(sensor);
+    ESP_LOGI(TAG, "calibration[%s] %s: %s", sensor->desc, snapshot ? "snapshot" : "restore", esp_err_to_name(err));
+}
+
+static esp_err_t iot_handle_command_calibration(const Hydroponics__CommandCalibration *calibration) {
+    // Failures are only logged per module, a missing or blank module must not stop the others.
+    if (calibration->n_sensor == 0) {
+        ezo_sensor_t *sensors[EZO_MAX_SENSORS];
+        size_t size = ezo_list(sensors, EZO_MAX_SENSORS);
+        for (size_t i = 0; i < size; ++i) {
+            iot_handle_command_calibration_one(calibration->action, sensors[i]);
+        }
+        return ESP_OK;
+    }
+    for (size_t i = 0; i < calibration->n_sensor; ++i) {
+        ezo_sensor_t *sensor = ezo_find(calibration->sensor[i]);
+        if (sensor == NULL) {
+            ESP_LOGW(TAG, "calibration[%s] unknown module", calibration->sensor[i]);
+            continue;
+        }
+        iot_handle_command_calibration_one(calibration->action, sensor);
+    }
+    return ESP_OK;
+}
+
 static esp_err_t iot_handle_command(context_t *context, const uint8_t *command, size_t size) {
     ARG_UNUSED(context);
     if (command == NULL || size == 0) {
@@ -103,6 +150,10 @@ static esp_err_t iot_handle_command(context_t *context, const uint8_t *command,
                 ESP_ERROR_CHECK(iot_handle_command_i2c(cmd->i2c));
                 break;
             }
+            case HYDROPONICS__COMMAND__COMMAND_CALIBRATION: {
+                ESP_ERROR_CHECK(iot_handle_command_calibration(cmd->calibration));
+                break;
+            }
             case HYDROPONICS__COMMAND__COMMAND__NOT_SET:
                 // Fall-through.
             default:
@@ -139,8 +190,24 @@ static esp_err_t iot_handle_publish_telemetry(context_t *context) {
     return ESP_OK;
 }
 
+// Reports the digest after every delivery, duplicates included, so the cloud knows what the device runs.
+static esp_err_t iot_handle_config(context_t *context, const uint8_t *data, size_t size) {
+    esp_err_t err = config_update(context, data, size);
+    if (err != ESP_OK) {
+        return err;
+    }
+    config_digest_t digest;
+    ESP_ERROR_CHECK(config_get_digest(&digest));
+    // The config is applied either way, the next delivery reports the digest again.
+    err = state_push_config(&digest);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Config state not published: %s", esp_err_to_name(err));
+    }
+    return ESP_OK;
+}
+
 static const mqtt_config_t config = {
-        .handle_config = config_update,
+        .handle_config = iot_handle_config,
         .handle_command = iot_handle_command,
         .handle_publish_telemetry = iot_handle_publish_telemetry,
 };
@@ -188,6 +255,13 @@ esp_err_t iot_init(context_t *context) {
 
     xTaskCreatePinnedToCore(iot_task, "iot", 3072, context, tskIDLE_PRIORITY + 5, NULL, tskNO_AFFINITY);
     ESP_ERROR_CHECK(mqtt_init(context, &config));
+
+    // Queued until the connection is up, syslog already sent its copy.
+    const crashlog_previous_t *previous = crashlog_previous();
+    if (previous != NULL) {
+        ESP_ERROR_CHECK(state_push_reboot(previous));
+        crashlog_free_previous();
+    }
     return ESP_OK;
 }
 
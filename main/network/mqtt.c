@@ -157,7 +157,7 @@ static iotc_time_t mqtt_refresh_time(void) {
         if (config != NULL && config->sampling != NULL) {
             refresh = config->sampling->mqtt_ms / 1000;
         }
-        hydroponics__config__free_unpacked((Hydroponics__Config *) config, NULL);
+        context_config_release(config);
     }
     return refresh < 5 ? 30 : refresh;
 }
@@ -4,11 +4,18 @@
 
 #include "esp_log.h"
 
+#include "cron.h"
 #include "error.h"
 #include "ntp.h"
 
 static const char *TAG = "ntp";
 
+static void ntp_time_sync_callback(struct timeval *tv) {
+    ARG_UNUSED(tv);
+    // Periodic syncs may step the clock, let the scheduler recompute its deadlines.
+    cron_time_changed();
+}
+
 static void ntp_task(void *arg) {
     context_t *context = (context_t *) arg;
     ARG_ERROR_CHECK(context != NULL, ERR_PARAM_NULL);
@@ -23,6 +30,7 @@ static void ntp_task(void *arg) {
 
     sntp_setoperatingmode(SNTP_OPMODE_POLL);
     sntp_setservername(0, "us.pool.ntp.org");
+    sntp_set_time_sync_notification_cb(ntp_time_sync_callback);
     sntp_init();
 
     // Wait for time to be set.
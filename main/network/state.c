@@ -1,4 +1,5 @@
 #include <string.h>
+#include <sys/param.h>
 #include <time.h>
 
 #include "timespec.h"
@@ -7,6 +8,9 @@
 #include "error.h"
 #include "iot.h"
 #include "state.h"
+#include "utils.h"
+
+#define STATE_ITEM_MAX_SIZE 1536 // Fits a single item of the iot ring buffer.
 
 static const char *const TAG = "state";
 
@@ -80,6 +84,189 @@ esp_err_t state_push_tasks(const TaskStatus_t *task_status, size_t size, uint32_
     return ESP_OK;
 }
 
+esp_err_t state_push_cron(const cron_info_t *infos, size_t size) {
+    ARG_CHECK(infos != NULL, ERR_PARAM_NULL);
+    if (size == 0) {
+        return ESP_OK;
+    }
+
+    // The job list can be long, keep it off the caller's stack.
+    Hydroponics__StateCron__Job *job = calloc(size, sizeof(Hydroponics__StateCron__Job));
+    Hydroponics__StateCron__Job **pjob = calloc(size, sizeof(Hydroponics__StateCron__Job *));
+    if (job == NULL || pjob == NULL) {
+        SAFE_FREE(job);
+        SAFE_FREE(pjob);
+        return ESP_ERR_NO_MEM;
+    }
+    for (int i = 0; i < size; ++i) {
+        hydroponics__state_cron__job__init(&job[i]);
+
+        const cron_info_t *info = &infos[i];
+        job[i].name = (char *) info->name;
+        job[i].expression = (char *) info->expression;
+        job[i].next_execution = info->next_execution.tv_sec < 0 ? 0 : timespec_to_ms(info->next_execution);
+        job[i].runs = info->stats.runs;
+        job[i].overruns = info->stats.overruns;
+        job[i].misfires = info->stats.misfires;
+        job[i].last_lag_ms = info->stats.last_lag_ms;
+        job[i].last_duration_ms = info->stats.last_duration_ms;
+        job[i].max_duration_ms = info->stats.max_duration_ms;
+        job[i].n_lateness = CRON_LATENESS_BUCKETS;
+        job[i].lateness = (uint32_t *) info->stats.lateness;
+
+        pjob[i] = &job[i];
+    }
+
+    Hydroponics__StateCron cron = HYDROPONICS__STATE_CRON__INIT;
+
+    Hydroponics__State state = HYDROPONICS__STATE__INIT;
+    Hydroponics__State *pstate = &state;
+    state.timestamp = state_timestamp();
+    state.state_case = HYDROPONICS__STATE__STATE_CRON;
+    state.cron = &cron;
+
+    Hydroponics__States msg = HYDROPONICS__STATES__INIT;
+    msg.n_state = 1;
+    msg.state = &pstate;
+
+    // Long job lists are split over several states, each fits a single item of the iot ring buffer.
+    esp_err_t err = ESP_OK;
+    for (size_t first = 0; first < size && err == ESP_OK; first += cron.n_job) {
+        cron.job = &pjob[first];
+        cron.n_job = 0;
+        size_t packed = hydroponics__states__get_packed_size(&msg);
+        while (first + cron.n_job < size) {
+            // A job also takes its tag and length, at most 3 bytes.
+            packed += protobuf_c_message_get_packed_size(&pjob[first + cron.n_job]->base) + 3;
+            if (cron.n_job > 0 && packed > STATE_ITEM_MAX_SIZE) {
+                break;
+            }
+            cron.n_job++;
+        }
+        // The lengths of the enclosing messages grow too.
+        while (cron.n_job > 1 && hydroponics__states__get_packed_size(&msg) > STATE_ITEM_MAX_SIZE) {
+            cron.n_job--;
+        }
+        ESP_LOGW(TAG, "Created cron state: 0x%p", &msg);
+        err = iot_publish_state(&msg);
+    }
+    SAFE_FREE(job);
+    SAFE_FREE(pjob);
+    return err;
+}
+
+esp_err_t state_push_health(const sensors_health_t *health, size_t size) {
+    ARG_CHECK(health != NULL, ERR_PARAM_NULL);
+    if (size == 0) {
+        return ESP_OK;
+    }
+
+    Hydroponics__StateHealth__Sensor sensor[size];
+    Hydroponics__StateHealth__Sensor *psensor[size];
+    for (int i = 0; i < size; ++i) {
+        hydroponics__state_health__sensor__init(&sensor[i]);
+
+        const health_t *h = &health[i].health;
+        sensor[i].name = (char *) health[i].name;
+        sensor[i].status = (Hydroponics__StateHealth__Status) h->status;
+        sensor[i].fault = (Hydroponics__StateHealth__Fault) h->fault;
+        sensor[i].samples = h->samples;
+        sensor[i].errors = h->errors;
+        sensor[i].recoveries = h->recoveries;
+        sensor[i].consecutive = h->consecutive;
+        sensor[i].last_good_ms = h->last_good_ms;
+
+        psensor[i] = &sensor[i];
+    }
+
+    Hydroponics__StateHealth state_health = HYDROPONICS__STATE_HEALTH__INIT;
+    state_health.n_sensor = size;
+    state_health.sensor = psensor;
+
+    Hydroponics__State state = HYDROPONICS__STATE__INIT;
+    Hydroponics__State *pstate = &state;
+    state.timestamp = state_timestamp();
+    state.state_case = HYDROPONICS__STATE__STATE_HEALTH;
+    state.health = &state_health;
+
+    Hydroponics__States msg = HYDROPONICS__STATES__INIT;
+    msg.n_state = 1;
+    msg.state = &pstate;
+
+    ESP_LOGW(TAG, "Created health state: 0x%p", &msg);
+    return iot_publish_state(&msg);
+}
+
+esp_err_t state_push_config(const config_digest_t *digest) {
+    ARG_CHECK(digest != NULL, ERR_PARAM_NULL);
+
+    Hydroponics__StateConfig config = HYDROPONICS__STATE_CONFIG__INIT;
+    config.version = digest->version;
+    config.size = digest->size;
+    config.sha256.data = (uint8_t *) digest->sha256;
+    config.sha256.len = digest->size > 0 ? CONFIG_DIGEST_LEN : 0;
+
+    Hydroponics__State state = HYDROPONICS__STATE__INIT;
+    Hydroponics__State *pstate = &state;
+    state.timestamp = state_timestamp();
+    state.state_case = HYDROPONICS__STATE__STATE_CONFIG;
+    state.config = &config;
+
+    Hydroponics__States msg = HYDROPONICS__STATES__INIT;
+    msg.n_state = 1;
+    msg.state = &pstate;
+
+    ESP_LOGW(TAG, "Created config state: 0x%p", &msg);
+    return iot_publish_state(&msg);
+}
+
+// The oldest lines are left out until the state fits.
+esp_err_t state_push_reboot(const crashlog_previous_t *previous) {
+    ARG_CHECK(previous != NULL, ERR_PARAM_NULL);
+
+    ProtobufCBinaryData line[MAX(previous->n_lines, 1)];
+    for (int i = 0; i < previous->n_lines; ++i) {
+        line[i].data = (uint8_t *) previous->lines[i].data;
+        line[i].len = previous->lines[i].len;
+    }
+    Hydroponics__StateReboot__Event event[MAX(previous->n_events, 1)];
+    Hydroponics__StateReboot__Event *pevent[MAX(previous->n_events, 1)];
+    for (int i = 0; i < previous->n_events; ++i) {
+        hydroponics__state_reboot__event__init(&event[i]);
+        event[i].timestamp_ms = previous->events[i].timestamp_ms;
+        event[i].bits = previous->events[i].bits & ~CRASHLOG_EVENT_SET;
+        event[i].set = (previous->events[i].bits & CRASHLOG_EVENT_SET) != 0;
+        pevent[i] = &event[i];
+    }
+
+    Hydroponics__StateReboot reboot = HYDROPONICS__STATE_REBOOT__INIT;
+    reboot.reason = (Hydroponics__StateReboot__Reason) previous->reason;
+    reboot.boot_count = previous->boot_count;
+    reboot.n_line = previous->n_lines;
+    reboot.line = line;
+    reboot.n_event = previous->n_events;
+    reboot.event = pevent;
+
+    Hydroponics__State state = HYDROPONICS__STATE__INIT;
+    Hydroponics__State *pstate = &state;
+    state.timestamp = state_timestamp();
+    state.state_case = HYDROPONICS__STATE__STATE_REBOOT;
+    state.reboot = &reboot;
+
+    Hydroponics__States msg = HYDROPONICS__STATES__INIT;
+    msg.n_state = 1;
+    msg.state = &pstate;
+
+    while (reboot.n_line > 0 && hydroponics__states__get_packed_size(&msg) > STATE_ITEM_MAX_SIZE) {
+        reboot.line++;
+        reboot.n_line--;
+    }
+
+    ESP_LOGW(TAG, "Created reboot state: 0x%p", &msg);
+    ESP_ERROR_CHECK(iot_publish_state(&msg));
+    return ESP_OK;
+}
+
 esp_err_t state_push_telemetry(size_t size, const Hydroponics__StateTelemetry__Type *types, const float *values) {
     ARG_CHECK(values != NULL, ERR_PARAM_NULL);
     if (size == 0) {
@@ -1,16 +1,31 @@
 #ifndef HYDROPONICS_NETWORK_STATE_BUILDER_H
 #define HYDROPONICS_NETWORK_STATE_BUILDER_H
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
 #include "esp_err.h"
 
 #include "state.pb-c.h"
 
+#include "config.h"
 #include "context.h"
+#include "crashlog.h"
+#include "cron.h"
+#include "sensors/sensors.h"
 
 esp_err_t state_push_memory(uint32_t min_free, uint32_t free);
 
 esp_err_t state_push_tasks(const TaskStatus_t *task_status, size_t size, uint32_t total_runtime_percentage);
 
+esp_err_t state_push_cron(const cron_info_t *infos, size_t size);
+
+esp_err_t state_push_health(const sensors_health_t *health, size_t size);
+
+esp_err_t state_push_config(const config_digest_t *digest);
+
+esp_err_t state_push_reboot(const crashlog_previous_t *previous);
+
 esp_err_t state_push_telemetry(size_t size, const Hydroponics__StateTelemetry__Type *types, const float *values);
 
 esp_err_t state_push_output(size_t size, const size_t *buckets, const Hydroponics__Output *outputs,
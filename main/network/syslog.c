@@ -1,25 +1,68 @@
+#include <stdatomic.h>
 #include <stdio.h>
 #include <string.h>
+#include <sys/param.h>
 #include <sys/socket.h>
 
 #include "freertos/FreeRTOS.h"
-#include "freertos/ringbuf.h"
-#include "freertos/semphr.h"
+#include "freertos/task.h"
 
 #include "esp_err.h"
+#include "esp_timer.h"
+#include "soc/soc_memory_layout.h"
 
 #include "context.h"
+#include "crashlog.h"
 #include "error.h"
 #include "syslog.h"
+#include "syslog_binary.h"
+#include "syslog_ring.h"
 #include "utils.h"
 
-#define SYSLOG_BUF_MAX_SIZE     (8 * 1024)
+#define SYSLOG_LINE_MAX_SIZE    256
+#define SYSLOG_LINE_BUFFERS     (portNUM_PROCESSORS + 2) // One per core, spares for tasks preempted while logging.
 #define SYSLOG_SOCKET_MAX_SIZE  1400
 #define SYSLOG_RETRY_TIME_TICKS (pdMS_TO_TICKS(3000))
-#define SYSLOG_DONT_WAIT        0
+#define SYSLOG_POLL_TICKS       (pdMS_TO_TICKS(100))
+#define SYSLOG_RECORD_HEADER    (sizeof(uint32_t) + 2)               // Sequence number, PRI and flags ahead of the line.
+#define SYSLOG_RECORD_CRASHLOG  0x01                                 // Logged by the previous boot, see crashlog.h.
+#define SYSLOG_RING_RESERVE     (SYSLOG_RING_SIZE / 4)               // Only errors and warnings may use the rest.
+#define SYSLOG_SEQUENCE_MAX     2147483647                           // RFC5424 sequenceId, wraps back to 1.
+#define SYSLOG_FACILITY_USER    (1 << 3)
+#define SYSLOG_TAG_BUCKETS      16
+#define SYSLOG_APP_NAME         "hydroponics"
+#define SYSLOG_SD_DROPS         "drops@32473"
+#define SYSLOG_MSGID_CRASHLOG   "crashlog"
+
+typedef enum {
+    SYSLOG_SEVERITY_ERROR = 3,
+    SYSLOG_SEVERITY_WARNING = 4,
+    SYSLOG_SEVERITY_INFO = 6,
+    SYSLOG_SEVERITY_DEBUG = 7,
+} syslog_severity_t;
+
+typedef struct {
+    _Atomic bool busy;
+    char record[SYSLOG_RECORD_HEADER + SYSLOG_LINE_MAX_SIZE];
+} syslog_line_t;
+
+typedef struct {
+    const char *tag;   /*!< NULL while free. The last bucket is shared by the tags that did not get one. */
+    uint32_t tokens;   /*!< In thousandths of a line. */
+    int64_t refilled;  /*!< esp_timer_get_time() of the last refill. */
+} syslog_bucket_t;
 
 static const char *const TAG = "syslog";
-static RingbufHandle_t ring;
+static syslog_line_t lines[SYSLOG_LINE_BUFFERS] = {0};
+static char packet[SYSLOG_SOCKET_MAX_SIZE];
+static size_t packet_len = 0;
+static TaskHandle_t task = NULL;
+
+static _Atomic uint32_t sequence = 0;
+static _Atomic uint32_t busy = 0;    /*!< Lines that found every line buffer in use. */
+static _Atomic uint32_t limited = 0;
+static syslog_bucket_t buckets[SYSLOG_TAG_BUCKETS] = {0};
+static portMUX_TYPE buckets_spinlock = portMUX_INITIALIZER_UNLOCKED;
 
 static struct sockaddr_in dest_addr = {0};
 static int socket_fd = -1;
@@ -70,29 +113,225 @@ static esp_err_t syslog_send(const char *buf, size_t len) {
     return ESP_ERR_INVALID_STATE;
 }
 
+// Starts with the buffer of the current core, it is only taken when a task logging on this core got preempted.
+static syslog_line_t *syslog_line_claim(void) {
+    int first = xPortGetCoreID();
+    for (int i = 0; i < SYSLOG_LINE_BUFFERS; ++i) {
+        syslog_line_t *line = &lines[(first + i) % SYSLOG_LINE_BUFFERS];
+        if (!atomic_exchange_explicit(&line->busy, true, memory_order_acquire)) {
+            return line;
+        }
+    }
+    return NULL;
+}
+
+// Formats once into a static buffer shared by the UART and the network.
+static size_t syslog_format_text(char *buf, size_t max, const char *fmt, va_list va, va_list copy) {
+    int written = vsnprintf(buf, max, fmt, va);
+    size_t len = written > 0 ? written : 0;
+    if (len >= max) {
+        // Too long for a line, e.g. the config dump. The UART still gets all of it, the network a truncated copy.
+        vprintf(fmt, copy);
+        len = max - 1;
+        buf[len - 1] = '\n';
+    } else if (len > 0) {
+        fwrite(buf, 1, len, stdout);
+    }
+    return len;
+}
+
+#ifdef CONFIG_ESP_SYSLOG_BINARY
+// Only the raw arguments are sent, tools/syslog_decode.py formats the line against the ELF.
+static size_t syslog_format_binary(char *buf, size_t max, const char *fmt, va_list va, va_list copy) {
+    size_t len = syslog_binary_encode((uint8_t *) buf, max, fmt, va);
+    if (len > 0) {
+#ifdef CONFIG_ESP_SYSLOG_BINARY_ECHO
+        vprintf(fmt, copy);
+#endif
+        return len;
+    }
+    // Formats built at runtime are not in the ELF, send them as text.
+    len = syslog_binary_encode_text((uint8_t *) buf, max, fmt, copy);
+#ifdef CONFIG_ESP_SYSLOG_BINARY_ECHO
+    fwrite(&buf[SYSLOG_BINARY_HEADER], 1, len - SYSLOG_BINARY_HEADER, stdout);
+#endif
+    return len;
+}
+#endif
+
+// ESP_LOGx formats start with the level letter, after the color if any, then the timestamp and the tag, see
+// LOG_FORMAT() and LOG_SYSTEM_TIME_FORMAT(). Anything else, e.g. a bare esp_log_write(), is info without a tag.
+static syslog_severity_t syslog_parse_origin(const char *fmt, va_list va, const char **tag) {
+    *tag = NULL;
+    if (fmt[0] == '\033') {
+        fmt = strchr(fmt, 'm');
+        if (fmt == NULL) {
+            return SYSLOG_SEVERITY_INFO;
+        }
+        fmt++;
+    }
+    syslog_severity_t severity;
+    switch (fmt[0]) {
+        case 'E':
+            severity = SYSLOG_SEVERITY_ERROR;
+            break;
+        case 'W':
+            severity = SYSLOG_SEVERITY_WARNING;
+            break;
+        case 'I':
+            severity = SYSLOG_SEVERITY_INFO;
+            break;
+        case 'D':
+        case 'V':
+            severity = SYSLOG_SEVERITY_DEBUG;
+            break;
+        default:
+            return SYSLOG_SEVERITY_INFO;
+    }
+    va_list copy;
+    va_copy(copy, va);
+    if (strncmp(&fmt[1], " (%u) %s: ", 10) == 0 || strncmp(&fmt[1], " (%d) %s: ", 10) == 0) {
+        (void) va_arg(copy, uint32_t);
+        *tag = va_arg(copy, const char *);
+    } else if (strncmp(&fmt[1], " (%s) %s: ", 10) == 0) {
+        (void) va_arg(copy, const char *);
+        *tag = va_arg(copy, const char *);
+    } else {
+        severity = SYSLOG_SEVERITY_INFO;
+    }
+    va_end(copy);
+    return severity;
+}
+
+// Token bucket per tag so a chatty component can not fill the ring. Only tags in flash get their own bucket, the
+// pointer has to stay valid.
+static bool syslog_rate_allow(const char *tag) {
+    if (CONFIG_ESP_SYSLOG_RATE_LIMIT == 0) {
+        return true;
+    }
+    const uint32_t burst = CONFIG_ESP_SYSLOG_RATE_BURST * 1000;
+    const int64_t now = esp_timer_get_time();
+    const bool own = tag != NULL && esp_ptr_in_drom(tag);
+    bool allow = false;
+
+    portENTER_CRITICAL(&buckets_spinlock);
+    syslog_bucket_t *bucket = &buckets[SYSLOG_TAG_BUCKETS - 1];
+    for (int i = 0; own && i < SYSLOG_TAG_BUCKETS - 1; ++i) {
+        if (buckets[i].tag == NULL) {
+            buckets[i] = (syslog_bucket_t) {.tag = tag, .tokens = burst, .refilled = now};
+        }
+        if (buckets[i].tag == tag || strcmp(buckets[i].tag, tag) == 0) {
+            bucket = &buckets[i];
+            break;
+        }
+    }
+    if (bucket->refilled == 0) {
+        bucket->tokens = burst;
+    } else {
+        int64_t refill = (now - bucket->refilled) * CONFIG_ESP_SYSLOG_RATE_LIMIT / 1000;
+        bucket->tokens = MIN(bucket->tokens + MIN(refill, (int64_t) burst), burst);
+    }
+    bucket->refilled = now;
+    if (bucket->tokens >= 1000) {
+        bucket->tokens -= 1000;
+        allow = true;
+    }
+    portEXIT_CRITICAL(&buckets_spinlock);
+    return allow;
+}
+
+static inline uint32_t syslog_next_sequence(void) {
+    return atomic_fetch_add(&sequence, 1) % SYSLOG_SEQUENCE_MAX + 1;
+}
+
+static void syslog_record_header(char *record, uint32_t number, uint8_t pri, uint8_t flags) {
+    memcpy(record, &number, sizeof(number));
+    record[sizeof(number)] = (char) pri;
+    record[sizeof(number) + 1] = (char) flags;
+}
+
+// Nothing is allocated, the line buffers are static. Every line takes a sequence number, the ones that never reach
+// the network show up as gaps that the drop counters sent along explain.
 static int syslog_printf(const char *fmt, va_list va) {
-    char *buffer = NULL;
-    int written = vasprintf(&buffer, fmt, va);
-    if (written == -1) {
-        LOCAL_LOG(E, "Failed to log '%s'", fmt);
-        goto fail;
+    const uint32_t number = syslog_next_sequence();
+    const char *tag = NULL;
+    const syslog_severity_t severity = syslog_parse_origin(fmt, va, &tag);
+    const bool important = severity <= SYSLOG_SEVERITY_WARNING;
+    if (!important && !syslog_rate_allow(tag)) {
+        atomic_fetch_add(&limited, 1);
+        return vprintf(fmt, va);
     }
-    if (written == 0) {
-        goto fail;
+    syslog_line_t *line = syslog_line_claim();
+    if (line == NULL) {
+        // Every buffer is in use, at least keep the line on the UART.
+        atomic_fetch_add(&busy, 1);
+        return vprintf(fmt, va);
     }
-    if (written >= SYSLOG_BUF_MAX_SIZE) {
-        LOCAL_LOG(E, "Failed to log '%s'", fmt);
-        printf("%.*s", written, buffer);
-        goto fail;
+    const uint8_t pri = SYSLOG_FACILITY_USER | severity;
+    syslog_record_header(line->record, number, pri, 0);
+
+    char *buf = &line->record[SYSLOG_RECORD_HEADER];
+    va_list copy;
+    va_copy(copy, va);
+#ifdef CONFIG_ESP_SYSLOG_BINARY
+    size_t len = syslog_format_binary(buf, SYSLOG_LINE_MAX_SIZE, fmt, va, copy);
+#else
+    size_t len = syslog_format_text(buf, SYSLOG_LINE_MAX_SIZE, fmt, va, copy);
+#endif
+    va_end(copy);
+    if (len > 0) {
+        crashlog_append(pri, buf, len);
     }
-    printf("%.*s", written, buffer);
-    if (xRingbufferSend(ring, buffer, written, SYSLOG_DONT_WAIT) != pdTRUE) {
-        LOCAL_LOG(E, "Failed append to log");
-        goto fail;
+
+    // Errors and warnings may use the reserve, so they still get through while info and debug lines pile up.
+    bool was_empty = false;
+    if (len > 0 && syslog_ring_push(line->record, SYSLOG_RECORD_HEADER + len, important ? 0 : SYSLOG_RING_RESERVE,
+                                    &was_empty) && was_empty && task != NULL) {
+        xTaskNotifyGive(task);
     }
-    fail:
-    SAFE_FREE(buffer);
-    return written;
+    atomic_store_explicit(&line->busy, false, memory_order_release);
+    return len;
+}
+
+// Appends a record to the packet as an octet counted RFC5424 message (RFC6587), `LEN SP MSG`. The first message of
+// every packet carries the drop counters so a lost packet does not lose them.
+static bool syslog_pack(const uint8_t *record, size_t len, void *arg) {
+    ARG_UNUSED(arg);
+    uint32_t number;
+    memcpy(&number, record, sizeof(number));
+    const uint8_t pri = record[sizeof(number)];
+    const char *msgid = record[sizeof(number) + 1] & SYSLOG_RECORD_CRASHLOG ? SYSLOG_MSGID_CRASHLOG : "-";
+    const char *msg = (const char *) &record[SYSLOG_RECORD_HEADER];
+    size_t msg_len = len - SYSLOG_RECORD_HEADER;
+#ifndef CONFIG_ESP_SYSLOG_BINARY
+    if (msg_len > 0 && msg[msg_len - 1] == '\n') {
+        msg_len--;
+    }
+#endif
+
+    char header[128];
+    int header_len;
+    if (packet_len == 0) {
+        syslog_stats_t stats = {0};
+        syslog_get_stats(&stats);
+        header_len = snprintf(header, sizeof(header),
+                              "<%u>1 - - " SYSLOG_APP_NAME " - %s [meta sequenceId=\"%u\"]"
+                              "[" SYSLOG_SD_DROPS " dropped=\"%u\" limited=\"%u\"] ",
+                              pri, msgid, number, stats.dropped, stats.limited);
+    } else {
+        header_len = snprintf(header, sizeof(header),
+                              "<%u>1 - - " SYSLOG_APP_NAME " - %s [meta sequenceId=\"%u\"] ", pri, msgid, number);
+    }
+    char count[12];
+    int count_len = snprintf(count, sizeof(count), "%u ", (unsigned) (header_len + msg_len));
+    if (packet_len + count_len + header_len + msg_len > sizeof(packet)) {
+        return false;
+    }
+    memcpy(&packet[packet_len], count, count_len);
+    memcpy(&packet[packet_len + count_len], header, header_len);
+    memcpy(&packet[packet_len + count_len + header_len], msg, msg_len);
+    packet_len += count_len + header_len + msg_len;
+    return true;
 }
 
 static void syslog_task(void *arg) {
@@ -105,8 +344,7 @@ static void syslog_task(void *arg) {
     dest_addr.sin_port = htons(context->config.syslog_port);
     dest_addr.sin_addr.s_addr = inet_addr(context->config.syslog_hostname);
 
-    void *item = NULL;
-    size_t to_send = 0;
+    uint32_t consumed = 0;
     while (true) {
         // Wait for the network to be up.
         xEventGroupWaitBits(context->event_group, CONTEXT_EVENT_NETWORK, pdFALSE, pdTRUE, portMAX_DELAY);
@@ -117,37 +355,66 @@ static void syslog_task(void *arg) {
         ESP_ERROR_CHECK(syslog_connect());
 
         while (true) {
-            if (item == NULL) {
-                item = xRingbufferReceiveUpTo(ring, &to_send, portMAX_DELAY, SYSLOG_SOCKET_MAX_SIZE);
+            if (consumed == 0) {
+                packet_len = 0;
+                consumed = syslog_ring_visit(syslog_pack, NULL);
             }
-            if (item == NULL || to_send == 0) {
-                // Nothing in the stream, try again in a few seconds.
-                break;
+            if (consumed == 0) {
+                // Producers only wake us up when the ring was empty, poll for lines published out of order.
+                ulTaskNotifyTake(pdTRUE, SYSLOG_POLL_TICKS);
+                continue;
             }
-            esp_err_t err = syslog_send(item, to_send);
-            if (err != ESP_OK) {
-                // Disconnect and try again in a few seconds.
+            if (packet_len > 0 && syslog_send(packet, packet_len) != ESP_OK) {
+                // Keep the packet, disconnect and try again in a few seconds.
                 syslog_disconnect();
                 break;
             }
-            vRingbufferReturnItem(ring, item);
-            item = NULL;
-            to_send = 0;
+            syslog_ring_release(consumed);
+            consumed = 0;
         }
         // Try again in a few seconds.
         vTaskDelayUntil(&last_wake_time, SYSLOG_RETRY_TIME_TICKS);
     }
 }
 
+esp_err_t syslog_get_stats(syslog_stats_t *stats) {
+    ARG_CHECK(stats != NULL, ERR_PARAM_NULL);
+    syslog_ring_stats_t ring = {0};
+    syslog_ring_stats(&ring);
+    stats->lines = atomic_load(&sequence);
+    stats->dropped = ring.dropped + atomic_load(&busy);
+    stats->limited = atomic_load(&limited);
+    return ESP_OK;
+}
+
+// Queues what the previous boot logged right before the reset, with its own MSGID. The lines were already on the
+// UART back then.
+static void syslog_replay(const crashlog_previous_t *previous) {
+    ESP_LOGW(TAG, "Reset reason: %s    boot: %u    lines: %u    events: %u", crashlog_reason_name(previous->reason),
+             previous->boot_count, (unsigned int) previous->n_lines, (unsigned int) previous->n_events);
+    for (int i = 0; i < previous->n_events; ++i) {
+        const crashlog_event_t *event = &previous->events[i];
+        ESP_LOGW(TAG, "Event at %u ms: %s 0x%06x", event->timestamp_ms,
+                 event->bits & CRASHLOG_EVENT_SET ? "set" : "cleared", event->bits & ~CRASHLOG_EVENT_SET);
+    }
+    char record[SYSLOG_RECORD_HEADER + CRASHLOG_LINE_SIZE];
+    for (int i = 0; i < previous->n_lines; ++i) {
+        const crashlog_line_t *line = &previous->lines[i];
+        syslog_record_header(record, syslog_next_sequence(), line->pri, SYSLOG_RECORD_CRASHLOG);
+        memcpy(&record[SYSLOG_RECORD_HEADER], line->data, line->len);
+        syslog_ring_push(record, SYSLOG_RECORD_HEADER + line->len, 0, NULL);
+    }
+}
+
 esp_err_t syslog_init(context_t *context) {
     ARG_CHECK(context != NULL, ERR_PARAM_NULL);
 
-    ring = xRingbufferCreate(SYSLOG_BUF_MAX_SIZE, RINGBUF_TYPE_BYTEBUF);
-    CHECK_NO_MEM(ring);
-
     // Setup the new remote logging.
     esp_log_set_vprintf(syslog_printf);
+    if (crashlog_previous() != NULL) {
+        syslog_replay(crashlog_previous());
+    }
 
-    xTaskCreatePinnedToCore(syslog_task, "syslog", 2048, context, 5, NULL, tskNO_AFFINITY);
+    xTaskCreatePinnedToCore(syslog_task, "syslog", 2048, context, 5, &task, tskNO_AFFINITY);
     return ESP_OK;
 }
@@ -1,12 +1,21 @@
 #ifndef HYDROPONICS_NETWORK_SYSLOG_H
 #define HYDROPONICS_NETWORK_SYSLOG_H
 
+#include <stdint.h>
 #include <sys/cdefs.h>
 
 #include "esp_err.h"
 
 #include "context.h"
 
+typedef struct {
+    uint32_t lines;   /*!< Lines logged, the last sequence number before it wraps. */
+    uint32_t dropped; /*!< Lines that did not fit in the ring or found every line buffer in use. */
+    uint32_t limited; /*!< Lines over the rate of their tag, only printed on the UART. */
+} syslog_stats_t;
+
 esp_err_t syslog_init(context_t *context);
 
+esp_err_t syslog_get_stats(syslog_stats_t *stats);
+
 #endif //HYDROPONICS_NETWORK_SYSLOG_H
@@ -0,0 +1,215 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+
+#include "soc/soc_memory_layout.h"
+
+#include "syslog_binary.h"
+
+typedef enum {
+    SYSLOG_ARG_NONE = 0,
+    SYSLOG_ARG_UNSIGNED,
+    SYSLOG_ARG_SIGNED,
+    SYSLOG_ARG_UNSIGNED_LONG_LONG,
+    SYSLOG_ARG_SIGNED_LONG_LONG,
+    SYSLOG_ARG_POINTER,
+    SYSLOG_ARG_DOUBLE,
+    SYSLOG_ARG_STRING,
+} syslog_arg_t;
+
+typedef struct {
+    uint8_t *buf;
+    size_t max;
+    size_t len;
+    bool overflow;
+} syslog_writer_t;
+
+static void syslog_write(syslog_writer_t *w, const void *data, size_t len) {
+    if (w->overflow || w->len + len > w->max) {
+        w->overflow = true;
+        return;
+    }
+    memcpy(&w->buf[w->len], data, len);
+    w->len += len;
+}
+
+// Timestamps, counters and most readings are small, they take 1 to 3 bytes instead of 4 or 8.
+static void syslog_write_varint(syslog_writer_t *w, uint64_t value) {
+    uint8_t bytes[10];
+    size_t len = 0;
+    do {
+        bytes[len] = (value & 0x7f) | (value > 0x7f ? 0x80 : 0);
+        value >>= 7;
+        len++;
+    } while (value > 0);
+    syslog_write(w, bytes, len);
+}
+
+static void syslog_write_signed(syslog_writer_t *w, int64_t value) {
+    syslog_write_varint(w, ((uint64_t) value << 1) ^ (uint64_t) (value >> 63)); // Zigzag.
+}
+
+static void syslog_write_string(syslog_writer_t *w, const char *s) {
+    if (s != NULL && esp_ptr_in_drom(s)) {
+        // Tags and constant strings are resolved by the decoder as well.
+        const uint16_t ref = SYSLOG_BINARY_STRING_REF;
+        const uint32_t addr = (uint32_t) (uintptr_t) s;
+        syslog_write(w, &ref, sizeof(ref));
+        syslog_write(w, &addr, sizeof(addr));
+        return;
+    }
+    if (s == NULL) {
+        s = "(null)";
+    }
+    size_t left = w->max > w->len + sizeof(uint16_t) ? w->max - w->len - sizeof(uint16_t) : 0;
+    uint16_t len = MIN(MIN(strlen(s), left), SYSLOG_BINARY_STRING_REF - 1);
+    syslog_write(w, &len, sizeof(len));
+    syslog_write(w, s, len);
+}
+
+// Walks a single conversion starting after the '%', returns the argument it takes and moves `fmt` past it. `star`
+// counts the '*' widths and precisions that come first as int arguments.
+static syslog_arg_t syslog_parse_conversion(const char **fmt, int *star) {
+    const char *c = *fmt;
+    size_t size = sizeof(int); // Of the integer argument, shorter ones are promoted to int.
+    *star = 0;
+    while (*c != '\0' && strchr("-+ #0", *c) != NULL) {
+        c++;
+    }
+    for (int part = 0; part < 2; ++part) {
+        if (part == 1) {
+            if (*c != '.') {
+                break;
+            }
+            c++;
+        }
+        if (*c == '*') {
+            (*star)++;
+            c++;
+        }
+        while (*c >= '0' && *c <= '9') {
+            c++;
+        }
+    }
+    if (c[0] == 'l' && c[1] == 'l') {
+        size = sizeof(long long);
+        c += 2;
+    } else if (*c == 'l') {
+        size = sizeof(long);
+        c++;
+    } else if (*c == 'j') {
+        size = sizeof(intmax_t);
+        c++;
+    } else if (*c == 'z') {
+        size = sizeof(size_t);
+        c++;
+    } else if (*c == 't') {
+        size = sizeof(ptrdiff_t);
+        c++;
+    }
+    while (*c != '\0' && strchr("hL", *c) != NULL) {
+        c++;
+    }
+    const bool wide = size > sizeof(int);
+    *fmt = *c != '\0' ? c + 1 : c;
+    switch (*c) {
+        case 'd':
+        case 'i':
+            return wide ? SYSLOG_ARG_SIGNED_LONG_LONG : SYSLOG_ARG_SIGNED;
+        case 'u':
+        case 'o':
+        case 'x':
+        case 'X':
+            return wide ? SYSLOG_ARG_UNSIGNED_LONG_LONG : SYSLOG_ARG_UNSIGNED;
+        case 'c':
+            return SYSLOG_ARG_UNSIGNED;
+        case 'p':
+            return SYSLOG_ARG_POINTER;
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            return SYSLOG_ARG_DOUBLE;
+        case 's':
+            return SYSLOG_ARG_STRING;
+        default:
+            return SYSLOG_ARG_NONE;
+    }
+}
+
+size_t syslog_binary_encode(uint8_t *buf, size_t max, const char *fmt, va_list va) {
+    if (fmt == NULL || !esp_ptr_in_drom(fmt) || max < SYSLOG_BINARY_HEADER) {
+        return 0;
+    }
+    syslog_writer_t w = {.buf = buf, .max = max, .len = sizeof(uint16_t)};
+    const uint32_t addr = (uint32_t) (uintptr_t) fmt;
+    syslog_write(&w, &addr, sizeof(addr));
+
+    for (const char *c = fmt; *c != '\0' && !w.overflow;) {
+        if (*c++ != '%') {
+            continue;
+        }
+        if (*c == '%') {
+            c++;
+            continue;
+        }
+        int star = 0;
+        syslog_arg_t arg = syslog_parse_conversion(&c, &star);
+        for (int i = 0; i < star; ++i) {
+            syslog_write_signed(&w, va_arg(va, int));
+        }
+        switch (arg) {
+            case SYSLOG_ARG_UNSIGNED:
+                syslog_write_varint(&w, va_arg(va, unsigned int));
+                break;
+            case SYSLOG_ARG_SIGNED:
+                syslog_write_signed(&w, va_arg(va, int));
+                break;
+            case SYSLOG_ARG_UNSIGNED_LONG_LONG:
+                syslog_write_varint(&w, va_arg(va, unsigned long long));
+                break;
+            case SYSLOG_ARG_SIGNED_LONG_LONG:
+                syslog_write_signed(&w, va_arg(va, long long));
+                break;
+            case SYSLOG_ARG_POINTER:
+                syslog_write_varint(&w, (uintptr_t) va_arg(va, void *));
+                break;
+            case SYSLOG_ARG_DOUBLE: {
+                const double value = va_arg(va, double);
+                syslog_write(&w, &value, sizeof(value));
+                break;
+            }
+            case SYSLOG_ARG_STRING:
+                syslog_write_string(&w, va_arg(va, const char *));
+                break;
+            case SYSLOG_ARG_NONE:
+                break;
+        }
+    }
+    if (w.overflow) {
+        return 0;
+    }
+    const uint16_t size = w.len - sizeof(uint16_t);
+    memcpy(buf, &size, sizeof(size));
+    return w.len;
+}
+
+size_t syslog_binary_encode_text(uint8_t *buf, size_t max, const char *fmt, va_list va) {
+    if (max <= SYSLOG_BINARY_HEADER) {
+        return 0;
+    }
+    int written = vsnprintf((char *) &buf[SYSLOG_BINARY_HEADER], max - SYSLOG_BINARY_HEADER, fmt, va);
+    size_t len = written > 0 ? MIN((size_t) written, max - SYSLOG_BINARY_HEADER - 1) : 0;
+    const uint16_t size = sizeof(uint32_t) + len;
+    const uint32_t addr = SYSLOG_BINARY_TEXT;
+    memcpy(buf, &size, sizeof(size));
+    memcpy(&buf[sizeof(uint16_t)], &addr, sizeof(addr));
+    return SYSLOG_BINARY_HEADER + len;
+}
@@ -0,0 +1,26 @@
+#ifndef HYDROPONICS_NETWORK_SYSLOG_BINARY_H
+#define HYDROPONICS_NETWORK_SYSLOG_BINARY_H
+
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// A record is, little endian:
+//   uint16_t size   Bytes that follow this field.
+//   uint32_t format Address of the format string in the flash, resolved against the ELF by tools/syslog_decode.py.
+//                   SYSLOG_BINARY_TEXT when the line follows already formatted.
+//   Arguments       In order. Integers, chars and pointers are LEB128 varints, zigzag encoded when signed. Doubles
+//                   take 8 bytes. Strings are a uint16_t length and their bytes, or SYSLOG_BINARY_STRING_REF and the
+//                   uint32_t address of a string in flash.
+#define SYSLOG_BINARY_TEXT       0
+#define SYSLOG_BINARY_STRING_REF 0xffff
+#define SYSLOG_BINARY_HEADER     (sizeof(uint16_t) + sizeof(uint32_t))
+
+// Encodes the arguments without formatting them. Returns the record size, 0 when the format is not in flash or the
+// record does not fit in `max`.
+size_t syslog_binary_encode(uint8_t *buf, size_t max, const char *fmt, va_list va);
+
+// Fallback for formats built at runtime, the record carries the formatted line. Always succeeds, truncating the line.
+size_t syslog_binary_encode_text(uint8_t *buf, size_t max, const char *fmt, va_list va);
+
+#endif //HYDROPONICS_NETWORK_SYSLOG_BINARY_H
@@ -0,0 +1,105 @@
+#include <stdatomic.h>
+#include <string.h>
+
+#include "syslog_ring.h"
+
+#define SYSLOG_RING_MASK    (SYSLOG_RING_SIZE - 1)
+#define SYSLOG_RING_ALIGN   sizeof(uint32_t)
+#define SYSLOG_RING_READY   0x1       // Set in the header once the line is fully copied.
+#define SYSLOG_RING_PADDING 0xfffe    // Length of the filler record that skips the end of the buffer.
+
+_Static_assert((SYSLOG_RING_SIZE & SYSLOG_RING_MASK) == 0, "SYSLOG_RING_SIZE must be a power of 2");
+
+// Records are a 32 bit header, (len << 16) | READY, followed by the data padded to 4 bytes. They never wrap, a filler
+// record takes the rest of the buffer instead. `head` and `tail` are free running byte counters.
+static uint8_t buffer[SYSLOG_RING_SIZE] __attribute__((aligned(4)));
+static _Atomic uint32_t head = 0; /*!< Bytes reserved by producers. */
+static _Atomic uint32_t tail = 0; /*!< Bytes released by the consumer. */
+static _Atomic uint32_t pushed = 0;
+static _Atomic uint32_t dropped = 0;
+
+static inline _Atomic uint32_t *syslog_ring_header(uint32_t offset) {
+    return (_Atomic uint32_t *) &buffer[offset & SYSLOG_RING_MASK];
+}
+
+static inline uint32_t syslog_ring_record_size(size_t len) {
+    return (sizeof(uint32_t) + len + SYSLOG_RING_ALIGN - 1) & ~(SYSLOG_RING_ALIGN - 1);
+}
+
+bool syslog_ring_push(const void *record, size_t len, size_t reserve, bool *was_empty) {
+    uint32_t size = syslog_ring_record_size(len);
+    if (len >= SYSLOG_RING_PADDING || size > SYSLOG_RING_SIZE / 2) {
+        atomic_fetch_add(&dropped, 1);
+        return false;
+    }
+    uint32_t reserved = atomic_load_explicit(&head, memory_order_relaxed);
+    uint32_t pad, next;
+    do {
+        uint32_t left = SYSLOG_RING_SIZE - (reserved & SYSLOG_RING_MASK);
+        pad = left < size ? left : 0;
+        next = reserved + pad + size;
+        uint32_t released = atomic_load_explicit(&tail, memory_order_acquire);
+        if (next - released + reserve > SYSLOG_RING_SIZE) {
+            atomic_fetch_add(&dropped, 1);
+            return false;
+        }
+        if (was_empty != NULL) {
+            *was_empty = reserved == released;
+        }
+    } while (!atomic_compare_exchange_weak_explicit(&head, &reserved, next, memory_order_acq_rel,
+                                                    memory_order_relaxed));
+
+    if (pad > 0) {
+        atomic_store_explicit(syslog_ring_header(reserved), (SYSLOG_RING_PADDING << 16) | SYSLOG_RING_READY,
+                              memory_order_release);
+    }
+    uint32_t start = reserved + pad;
+    memcpy(&buffer[(start + sizeof(uint32_t)) & SYSLOG_RING_MASK], record, len);
+    atomic_store_explicit(syslog_ring_header(start), ((uint32_t) len << 16) | SYSLOG_RING_READY,
+                          memory_order_release);
+    atomic_fetch_add(&pushed, 1);
+    return true;
+}
+
+uint32_t syslog_ring_visit(syslog_ring_visitor_t visit, void *arg) {
+    uint32_t offset = atomic_load_explicit(&tail, memory_order_relaxed);
+    uint32_t reserved = atomic_load_explicit(&head, memory_order_acquire);
+    uint32_t consumed = 0;
+    while (offset != reserved) {
+        uint32_t header = atomic_load_explicit(syslog_ring_header(offset), memory_order_acquire);
+        if ((header & SYSLOG_RING_READY) == 0) {
+            // Still being written, lines are only handed out in order.
+            break;
+        }
+        uint32_t len = header >> 16;
+        uint32_t size = len == SYSLOG_RING_PADDING ? SYSLOG_RING_SIZE - (offset & SYSLOG_RING_MASK)
+                                                   : syslog_ring_record_size(len);
+        if (len != SYSLOG_RING_PADDING && !visit(&buffer[(offset + sizeof(uint32_t)) & SYSLOG_RING_MASK], len, arg)) {
+            break;
+        }
+        offset += size;
+        consumed += size;
+    }
+    return consumed;
+}
+
+void syslog_ring_release(uint32_t consumed) {
+    uint32_t offset = atomic_load_explicit(&tail, memory_order_relaxed);
+    uint32_t end = offset + consumed;
+    // Producers publish by setting READY, a header can land anywhere in an old record so clear them whole before the
+    // space can be reserved again.
+    while (offset != end) {
+        uint32_t header = atomic_load_explicit(syslog_ring_header(offset), memory_order_relaxed);
+        uint32_t len = header >> 16;
+        uint32_t size = len == SYSLOG_RING_PADDING ? SYSLOG_RING_SIZE - (offset & SYSLOG_RING_MASK)
+                                                   : syslog_ring_record_size(len);
+        memset(&buffer[offset & SYSLOG_RING_MASK], 0, size);
+        offset += size;
+    }
+    atomic_store_explicit(&tail, end, memory_order_release);
+}
+
+void syslog_ring_stats(syslog_ring_stats_t *stats) {
+    stats->pushed = atomic_load(&pushed);
+    stats->dropped = atomic_load(&dropped);
+}
@@ -0,0 +1,32 @@
+#ifndef HYDROPONICS_NETWORK_SYSLOG_RING_H
+#define HYDROPONICS_NETWORK_SYSLOG_RING_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define SYSLOG_RING_SIZE (8 * 1024) // Power of 2.
+
+typedef struct {
+    uint32_t pushed;
+    uint32_t dropped; /*!< Records that did not fit, e.g. while the network is down. */
+} syslog_ring_stats_t;
+
+// Returns false to stop at this record, it is handed out again on the next visit.
+typedef bool (*syslog_ring_visitor_t)(const uint8_t *record, size_t len, void *arg);
+
+// Appends a record without taking any lock, safe to call from any number of tasks on both cores. Returns false and
+// counts a drop when it would leave less than `reserve` bytes free. `was_empty` tells the caller the consumer may be
+// sleeping.
+bool syslog_ring_push(const void *record, size_t len, size_t reserve, bool *was_empty);
+
+// Hands out the published records, in order, until the visitor stops or a record is still being written. Returns the
+// bytes visited, they must be handed to `syslog_ring_release` once the records are no longer needed. Single consumer
+// only.
+uint32_t syslog_ring_visit(syslog_ring_visitor_t visit, void *arg);
+
+void syslog_ring_release(uint32_t consumed);
+
+void syslog_ring_stats(syslog_ring_stats_t *stats);
+
+#endif //HYDROPONICS_NETWORK_SYSLOG_RING_H
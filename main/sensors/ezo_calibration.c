@@ -0,0 +1,196 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "esp_log.h"
+#include "esp_err.h"
+
+#include "error.h"
+#include "driver/ezo.h"
+#include "ezo_calibration.h"
+#include "storage.h"
+#include "utils.h"
+
+#define EZO_CALIBRATION_KEY_LEN 16 // NVS keys are limited to 15 characters.
+
+static const char *const TAG = "ezo_calibration";
+
+static void ezo_calibration_key(const ezo_sensor_t *sensor, char *key) {
+    snprintf(key, EZO_CALIBRATION_KEY_LEN, STORAGE_KEY_EZO_CAL_FMT, sensor->desc);
+}
+
+// Returns the whole record in a newly allocated `buf` that the caller must free, or ESP_ERR_NOT_FOUND.
+static esp_err_t ezo_calibration_load(const ezo_sensor_t *sensor, uint8_t **buf) {
+    char key[EZO_CALIBRATION_KEY_LEN];
+    ezo_calibration_key(sensor, key);
+
+    size_t len = 0;
+    *buf = NULL;
+    esp_err_t err = storage_get_blob(key, buf, &len);
+    if (err != ESP_OK) {
+        SAFE_FREE(*buf);
+        return err;
+    }
+    if (*buf == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    const ezo_calibration_header_t *header = (const ezo_calibration_header_t *) *buf;
+    if (len < sizeof(ezo_calibration_header_t) || header->format != EZO_CALIBRATION_FORMAT
+        || len != sizeof(ezo_calibration_header_t) + header->size) {
+        ESP_LOGW(TAG, "[%s] ignoring snapshot with an unknown format", sensor->desc);
+        SAFE_FREE(*buf);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t ezo_calibration_take(ezo_sensor_t *sensor) {
+    ezo_calibration_mode_t mode = EZO_CALIBRATION_MODE_NONE;
+    esp_err_t err = ezo_calibration_mode(sensor, &mode);
+    if (err != ESP_OK) {
+        return err;
+    }
+    // Never replace a good snapshot with a blank module.
+    if (mode == EZO_CALIBRATION_MODE_NONE) {
+        ESP_LOGW(TAG, "[%s] module is not calibrated, keeping the previous snapshot", sensor->desc);
+        return ESP_ERR_INVALID_STATE;
+    }
+    char *rows = NULL;
+    size_t size = 0;
+    err = ezo_export_calibration(sensor, &rows, &size);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (size > UINT16_MAX) {
+        SAFE_FREE(rows);
+        return ESP_ERR_INVALID_SIZE;
+    }
+    uint32_t generation = 0;
+    uint8_t *previous = NULL;
+    if (ezo_calibration_load(sensor, &previous) == ESP_OK) {
+        generation = ((const ezo_calibration_header_t *) previous)->generation;
+        SAFE_FREE(previous);
+    }
+
+    size_t len = sizeof(ezo_calibration_header_t) + size;
+    uint8_t *record = calloc(1, len);
+    if (record == NULL) {
+        SAFE_FREE(rows);
+        return ESP_ERR_NO_MEM;
+    }
+    ezo_calibration_header_t *header = (ezo_calibration_header_t *) record;
+    header->format = EZO_CALIBRATION_FORMAT;
+    header->mode = mode;
+    header->size = size;
+    header->generation = generation + 1;
+    strlcpy(header->type, sensor->type, sizeof(header->type));
+    strlcpy(header->version, sensor->version, sizeof(header->version));
+    memcpy(&record[sizeof(ezo_calibration_header_t)], rows, size);
+    SAFE_FREE(rows);
+
+    char key[EZO_CALIBRATION_KEY_LEN];
+    ezo_calibration_key(sensor, key);
+    err = storage_set_blob(key, record, len);
+    SAFE_FREE(record);
+    if (err == ESP_OK) {
+        // A calibration is too expensive to redo to leave it in the write cache.
+        err = storage_flush();
+    }
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "[%s] stored snapshot #%u with %d points (%u bytes)", sensor->desc, generation + 1, mode, size);
+    }
+    return err;
+}
+
+static esp_err_t ezo_calibration_apply(ezo_sensor_t *sensor) {
+    uint8_t *record = NULL;
+    esp_err_t err = ezo_calibration_load(sensor, &record);
+    if (err != ESP_OK) {
+        return err;
+    }
+    const ezo_calibration_header_t *header = (const ezo_calibration_header_t *) record;
+    if (strncmp(header->type, sensor->type, sizeof(header->type)) != 0) {
+        ESP_LOGW(TAG, "[%s] snapshot was taken on a %.8s module, not %s", sensor->desc, header->type, sensor->type);
+        SAFE_FREE(record);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    if (strncmp(header->version, sensor->version, sizeof(header->version)) != 0) {
+        ESP_LOGW(TAG, "[%s] snapshot was taken on firmware v%.8s, module has v%s", sensor->desc, header->version,
+                 sensor->version);
+    }
+    const ezo_calibration_mode_t expected = header->mode;
+    const uint32_t generation = header->generation;
+    if (header->size > 0) {
+        err = ezo_import_calibration(sensor, (const char *) &record[sizeof(ezo_calibration_header_t)], header->size);
+    }
+    SAFE_FREE(record);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    ezo_calibration_mode_t mode = EZO_CALIBRATION_MODE_NONE;
+    err = ezo_calibration_mode(sensor, &mode);
+    if (err == ESP_OK && mode != expected) {
+        ESP_LOGE(TAG, "[%s] restored %d points but snapshot #%u had %d", sensor->desc, mode, generation, expected);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (err == ESP_OK) {
+        ESP_LOGI(TAG, "[%s] restored snapshot #%u with %d points", sensor->desc, generation, mode);
+    }
+    return err;
+}
+
+// The sampler skips paused modules instead of counting the busy lock against their health.
+static esp_err_t ezo_calibration_paused(ezo_sensor_t *sensor, esp_err_t (*fn)(ezo_sensor_t *)) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    if (sensor->address == EZO_INVALID_ADDRESS) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    xSemaphoreTake(sensor->lock, portMAX_DELAY);
+    bool pause = sensor->pause;
+    sensor->pause = true;
+    xSemaphoreGive(sensor->lock);
+
+    esp_err_t err = fn(sensor);
+
+    xSemaphoreTake(sensor->lock, portMAX_DELAY);
+    sensor->pause = pause;
+    xSemaphoreGive(sensor->lock);
+    return err;
+}
+
+esp_err_t ezo_calibration_snapshot(ezo_sensor_t *sensor) {
+    return ezo_calibration_paused(sensor, ezo_calibration_take);
+}
+
+esp_err_t ezo_calibration_restore(ezo_sensor_t *sensor) {
+    return ezo_calibration_paused(sensor, ezo_calibration_apply);
+}
+
+esp_err_t ezo_calibration_check(ezo_sensor_t *sensor) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    if (sensor->address == EZO_INVALID_ADDRESS) {
+        return ESP_OK;
+    }
+    ezo_calibration_mode_t mode = EZO_CALIBRATION_MODE_NONE;
+    esp_err_t err = ezo_calibration_mode(sensor, &mode);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "[%s] unable to read the calibration: %s", sensor->desc, esp_err_to_name(err));
+        return ESP_OK;
+    }
+    if (mode != EZO_CALIBRATION_MODE_NONE) {
+        if (mode < sensor->calibration) {
+            ESP_LOGW(TAG, "[%s] calibrated with %d points, expected %d", sensor->desc, mode, sensor->calibration);
+        }
+        return ESP_OK;
+    }
+    ESP_LOGW(TAG, "[%s] module is not calibrated, restoring the last snapshot", sensor->desc);
+    err = ezo_calibration_restore(sensor);
+    if (err == ESP_ERR_NOT_FOUND) {
+        ESP_LOGW(TAG, "[%s] no snapshot to restore", sensor->desc);
+    } else if (err != ESP_OK) {
+        ESP_LOGE(TAG, "[%s] restore failed: %s", sensor->desc, esp_err_to_name(err));
+    }
+    // A blank module still reads, the rest of the system keeps going.
+    return ESP_OK;
+}
@@ -0,0 +1,28 @@
+#ifndef HYDROPONICS_SENSORS_EZO_CALIBRATION_H
+#define HYDROPONICS_SENSORS_EZO_CALIBRATION_H
+
+#include "esp_err.h"
+
+#include "driver/ezo.h"
+
+#define EZO_CALIBRATION_FORMAT 1
+
+typedef struct {
+    uint8_t format;      /*!< EZO_CALIBRATION_FORMAT of the record. */
+    uint8_t mode;        /*!< Calibration points reported by the module when the snapshot was taken. */
+    uint16_t size;       /*!< Bytes of exported rows following the header. */
+    uint32_t generation; /*!< Incremented on every snapshot of the same module. */
+    char type[8];        /*!< Module type, a snapshot is only restored on the same type. */
+    char version[8];     /*!< Module firmware version. */
+} ezo_calibration_header_t;
+
+// Exports the calibration of a calibrated module and stores it in NVS, replacing the previous snapshot.
+esp_err_t ezo_calibration_snapshot(ezo_sensor_t *sensor);
+
+// Imports the stored snapshot into the module. Returns ESP_ERR_NOT_FOUND when there is no snapshot.
+esp_err_t ezo_calibration_restore(ezo_sensor_t *sensor);
+
+// Restores the snapshot when the module reports no calibration at all, e.g. after it was replaced.
+esp_err_t ezo_calibration_check(ezo_sensor_t *sensor);
+
+#endif //HYDROPONICS_SENSORS_EZO_CALIBRATION_H
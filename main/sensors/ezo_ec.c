@@ -1,12 +1,10 @@
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-
 #include "esp_log.h"
 #include "esp_err.h"
 
 #include "context.h"
 #include "error.h"
 #include "driver/ezo.h"
+#include "ezo_sampler.h"
 
 static const char *const TAG = "ezo_ec";
 static ezo_sensor_t ec = {
@@ -18,31 +16,20 @@ static ezo_sensor_t ec = {
         .delay_calibration_ms = EZO_DELAY_MS_SLOWEST,
         .calibration = EZO_CALIBRATION_MODE_TWO_POINTS,
 #ifdef CONFIG_ESP_SENSOR_SIMULATE
+        .channel = SIMULATION_CHANNEL_EC,
         .simulate = 1500.f,
         .threshold = 15.f,
 #endif
 };
+static const health_limits_t health = {.min = 0.f, .max = 200000.f, .stuck = 60, .retries = 3};
 
-static void ezo_ec_task(void *arg) {
-    context_t *context = (context_t *) arg;
-    ARG_ERROR_CHECK(context != NULL, ERR_PARAM_NULL);
-    // Give it a little time to initialize.
-    vTaskDelay(pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_EC_MS));
-    ESP_ERROR_CHECK(ezo_init(&ec));
-
-    while (true) {
-        if (ec.pause) {
-            vTaskDelay(pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_EC_MS));
-            continue;
-        }
-        TickType_t last_wake_time = xTaskGetTickCount();
-        float temp = context->sensors.temp.probe;
-        ESP_ERROR_CHECK(context_set_ec(context, 0, ezo_read_and_print(&ec, temp, 0, "uS/cm")));
-        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_EC_MS));
-    }
+static esp_err_t ezo_ec_callback(context_t *context, ezo_sensor_t *sensor, float value) {
+    ARG_UNUSED(sensor);
+    ESP_LOGD(TAG, "EC %.0f uS/cm", value);
+    return context_set_ec(context, 0, value);
 }
 
 esp_err_t ezo_ec_init(context_t *context) {
-    xTaskCreatePinnedToCore(ezo_ec_task, "ezo_ec", 3072, context, tskIDLE_PRIORITY + 7, NULL, tskNO_AFFINITY);
-    return ESP_OK;
+    ARG_UNUSED(context);
+    return ezo_sampler_add(&ec, SAMPLING_EC, true, &health, ezo_ec_callback);
 }
@@ -1,12 +1,10 @@
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-
 #include "esp_log.h"
 #include "esp_err.h"
 
 #include "context.h"
 #include "error.h"
 #include "driver/ezo.h"
+#include "ezo_sampler.h"
 
 static const char *TAG = "ezo_ph";
 static ezo_sensor_t ph = {
@@ -18,34 +16,22 @@ static ezo_sensor_t ph = {
         .delay_calibration_ms = EZO_DELAY_MS_SLOWEST,
         .calibration = EZO_CALIBRATION_MODE_THREE_POINTS,
 #ifdef CONFIG_ESP_SENSOR_SIMULATE
+        .channel = SIMULATION_CHANNEL_PH,
         .simulate = 5.7f,
         .threshold = 0.05f,
 #endif
 };
+static const health_limits_t health = {.min = 0.f, .max = 14.f, .stuck = 60, .retries = 3};
 
-static void ezo_ph_task(void *arg) {
-    context_t *context = (context_t *) arg;
-    ARG_ERROR_CHECK(context != NULL, ERR_PARAM_NULL);
-    // Give it a little time to initialize.
-    vTaskDelay(pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_PH_MS));
-    ESP_ERROR_CHECK(ezo_init(&ph));
-
-    while (true) {
-        if (ph.pause) {
-            vTaskDelay(pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_PH_MS));
-            continue;
-        }
-        TickType_t last_wake_time = xTaskGetTickCount();
-
-        float temp = context->sensors.temp.probe;
-        ESP_ERROR_CHECK(context_set_ph(context, 0, ezo_read_and_print(&ph, temp, 2, "")));
-        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_PH_MS));
-    }
+static esp_err_t ezo_ph_callback(context_t *context, ezo_sensor_t *sensor, float value) {
+    ARG_UNUSED(sensor);
+    ESP_LOGD(TAG, "PH %.2f", value);
+    return context_set_ph(context, 0, value);
 }
 
 esp_err_t ezo_ph_init(context_t *context) {
-    xTaskCreatePinnedToCore(ezo_ph_task, "ezo_ph", 3072, context, tskIDLE_PRIORITY + 8, NULL, tskNO_AFFINITY);
-    return ESP_OK;
+    ARG_UNUSED(context);
+    return ezo_sampler_add(&ph, SAMPLING_PH, true, &health, ezo_ph_callback);
 }
 
 esp_err_t ezo_ph_slope(float *acidPercentage, float *basePercentage) {
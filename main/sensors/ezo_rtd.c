@@ -1,12 +1,10 @@
-#include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
-
 #include "esp_log.h"
 #include "esp_err.h"
 
 #include "context.h"
 #include "error.h"
 #include "driver/ezo.h"
+#include "ezo_sampler.h"
 
 static const char *TAG = "ezo_rtd";
 static ezo_sensor_t rtd = {
@@ -18,35 +16,21 @@ static ezo_sensor_t rtd = {
         .delay_calibration_ms = EZO_DELAY_MS_SLOW,
         .calibration = EZO_CALIBRATION_MODE_ONE_POINT,
 #ifdef CONFIG_ESP_SENSOR_SIMULATE
+        .channel = SIMULATION_CHANNEL_WATER_TEMP,
         .simulate = 19.0f,
         .threshold = 0.2f,
 #endif
 };
+// The module reads -1023 without a probe.
+static const health_limits_t health = {.min = -20.f, .max = 125.f, .stuck = 60, .retries = 3};
 
-static void ezo_rtd_task(void *arg) {
-    context_t *context = (context_t *) arg;
-    ARG_ERROR_CHECK(context != NULL, ERR_PARAM_NULL);
-    // Give it a little time to initialize.
-    vTaskDelay(pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_RTD_MS));
-    ESP_ERROR_CHECK(ezo_init(&rtd));
-
-    float value = 0.f;
-    while (true) {
-        if (rtd.pause) {
-            vTaskDelay(pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_RTD_MS));
-            continue;
-        }
-        TickType_t last_wake_time = xTaskGetTickCount();
-
-        ESP_ERROR_CHECK(ezo_read(&rtd, &value));
-        ESP_LOGD(TAG, "RTD %.2f", value);
-        ESP_ERROR_CHECK(context_set_temp_probe(context, value));
-
-        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_RTD_MS));
-    }
+static esp_err_t ezo_rtd_callback(context_t *context, ezo_sensor_t *sensor, float value) {
+    ARG_UNUSED(sensor);
+    ESP_LOGD(TAG, "RTD %.2f", value);
+    return context_set_temp_probe(context, value);
 }
 
 esp_err_t ezo_rtd_init(context_t *context) {
-    xTaskCreatePinnedToCore(ezo_rtd_task, "ezo_rtd", 2560, context, tskIDLE_PRIORITY + 9, NULL, tskNO_AFFINITY);
-    return ESP_OK;
+    ARG_UNUSED(context);
+    return ezo_sampler_add(&rtd, SAMPLING_RTD, false, &health, ezo_rtd_callback);
 }
@@ -0,0 +1,158 @@
+#include <math.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "esp_log.h"
+#include "esp_err.h"
+
+#include "context.h"
+#include "error.h"
+#include "driver/ezo.h"
+#include "ezo_calibration.h"
+#include "ezo_sampler.h"
+#include "sensors.h"
+
+#define EZO_SAMPLER_MAX_SENSORS 4
+#define EZO_SAMPLER_COMPENSATION_THRESHOLD (CONFIG_ESP_SENSOR_EZO_COMPENSATION_CENTI_C / 100.f)
+
+typedef enum {
+    EZO_SAMPLER_STEP_COMPENSATE = 0,
+    EZO_SAMPLER_STEP_READ = 1,
+} ezo_sampler_step_t;
+
+typedef struct {
+    ezo_sensor_t *sensor;
+    bool compensate;
+    float temp;         /*!< Compensation temperature last stored in the module. */
+    float pending;      /*!< Compensation temperature being sent. */
+    float value;
+    ezo_sampler_step_t step;
+    ezo_sampler_callback_t callback;
+    sensors_driver_t driver;
+} ezo_sampler_entry_t;
+
+static const char *const TAG = "ezo_sampler";
+static ezo_sampler_entry_t entries[EZO_SAMPLER_MAX_SENSORS] = {0};
+static size_t entries_size = 0;
+
+static esp_err_t ezo_sampler_init(context_t *context, void *arg) {
+    ARG_UNUSED(context);
+    ezo_sampler_entry_t *entry = (ezo_sampler_entry_t *) arg;
+    esp_err_t err = ezo_init(entry->sensor);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return ezo_calibration_check(entry->sensor);
+}
+
+// Only talks to the module when the probe temperature moved enough, reads are then plain and short R commands.
+static bool ezo_sampler_needs_compensation(context_t *context, ezo_sampler_entry_t *entry) {
+    float temp = context->sensors.temp.probe;
+    if (!entry->compensate || !CONTEXT_VALUE_IS_VALID(temp)) {
+        return false;
+    }
+    if (CONTEXT_VALUE_IS_VALID(entry->temp) && fabsf(temp - entry->temp) < EZO_SAMPLER_COMPENSATION_THRESHOLD) {
+        return false;
+    }
+    entry->pending = temp;
+    return true;
+}
+
+static esp_err_t ezo_sampler_start(context_t *context, void *arg, TickType_t *ready) {
+    ezo_sampler_entry_t *entry = (ezo_sampler_entry_t *) arg;
+    ezo_sensor_t *sensor = entry->sensor;
+    if (sensor->address == EZO_INVALID_ADDRESS || sensor->pause) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t err;
+    if (ezo_sampler_needs_compensation(context, entry)) {
+        entry->step = EZO_SAMPLER_STEP_COMPENSATE;
+        err = ezo_start_temperature(sensor, entry->pending);
+    } else {
+        entry->step = EZO_SAMPLER_STEP_READ;
+        err = ezo_start_read(sensor);
+    }
+    if (err == ESP_OK) {
+        // Only the lock holder writes it, e.g. a calibration running on the module.
+        *ready = sensor->ready;
+    }
+    return err;
+}
+
+static esp_err_t ezo_sampler_poll(context_t *context, void *arg, TickType_t *ready) {
+    ARG_UNUSED(context);
+    ezo_sampler_entry_t *entry = (ezo_sampler_entry_t *) arg;
+    ezo_sensor_t *sensor = entry->sensor;
+    esp_err_t err;
+    if (entry->step == EZO_SAMPLER_STEP_COMPENSATE) {
+        err = ezo_collect_ack(sensor);
+        if (err == ESP_OK) {
+            ESP_LOGD(TAG, "[%s] compensating for %.2f C", sensor->desc, entry->pending);
+            entry->temp = entry->pending;
+        } else if (err != ESP_ERR_NOT_FINISHED) {
+            // Still worth a read, the module keeps the previous compensation.
+            ESP_LOGW(TAG, "[%s] compensation failed: %s", sensor->desc, esp_err_to_name(err));
+        }
+        if (err != ESP_ERR_NOT_FINISHED) {
+            entry->step = EZO_SAMPLER_STEP_READ;
+            err = ezo_start_read(sensor);
+            if (err != ESP_OK) {
+                return err;
+            }
+            err = ESP_ERR_NOT_FINISHED;
+        }
+    } else {
+        err = ezo_collect_read(sensor, &entry->value);
+    }
+    *ready = sensor->ready;
+    return err;
+}
+
+// A module that stops answering usually went through a brown out, it also lost the compensation temperature.
+static esp_err_t ezo_sampler_reset(context_t *context, void *arg) {
+    ARG_UNUSED(context);
+    ezo_sampler_entry_t *entry = (ezo_sampler_entry_t *) arg;
+    entry->temp = CONTEXT_UNKNOWN_VALUE;
+    return ezo_device_info(entry->sensor);
+}
+
+static float ezo_sampler_value(void *arg) {
+    return ((ezo_sampler_entry_t *) arg)->value;
+}
+
+static esp_err_t ezo_sampler_collect(context_t *context, void *arg) {
+    ezo_sampler_entry_t *entry = (ezo_sampler_entry_t *) arg;
+    ESP_LOGD(TAG, "[%s] %.2f", entry->sensor->desc, entry->value);
+    return entry->callback(context, entry->sensor, entry->value);
+}
+
+esp_err_t ezo_sampler_add(ezo_sensor_t *sensor, sampling_sensor_t sampling, bool compensate,
+                          const health_limits_t *health, ezo_sampler_callback_t callback) {
+    ARG_CHECK(sensor != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(health != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(sampling < SAMPLING_MAX, "invalid sampling sensor");
+    ARG_CHECK(callback != NULL, ERR_PARAM_NULL);
+    if (entries_size >= EZO_SAMPLER_MAX_SENSORS) {
+        return ESP_ERR_NO_MEM;
+    }
+    ezo_sampler_entry_t *entry = &entries[entries_size++];
+    entry->sensor = sensor;
+    entry->compensate = compensate;
+    entry->temp = CONTEXT_UNKNOWN_VALUE;
+    entry->callback = callback;
+    entry->driver = (sensors_driver_t) {
+            .name = sensor->desc,
+            .sampling = sampling,
+            .arg = entry,
+            .i2c = true,
+            .health = *health,
+            .init = ezo_sampler_init,
+            .start = ezo_sampler_start,
+            .poll = ezo_sampler_poll,
+            .collect = ezo_sampler_collect,
+            .reset = ezo_sampler_reset,
+            .value = ezo_sampler_value,
+    };
+    // The modules share a sampling phase, the runtime starts them together and they convert in parallel.
+    return sensors_register(&entry->driver);
+}
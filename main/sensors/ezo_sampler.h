@@ -0,0 +1,17 @@
+#ifndef HYDROPONICS_SENSORS_EZO_SAMPLER_H
+#define HYDROPONICS_SENSORS_EZO_SAMPLER_H
+
+#include "esp_err.h"
+
+#include "context.h"
+#include "driver/ezo.h"
+#include "health.h"
+#include "sampling.h"
+
+typedef esp_err_t (*ezo_sampler_callback_t)(context_t *context, ezo_sensor_t *sensor, float value);
+
+// Registers the sensor as a driver of the sensor runtime. Must be called before `sensors_init`.
+esp_err_t ezo_sampler_add(ezo_sensor_t *sensor, sampling_sensor_t sampling, bool compensate,
+                          const health_limits_t *health, ezo_sampler_callback_t callback);
+
+#endif //HYDROPONICS_SENSORS_EZO_SAMPLER_H
@@ -1,5 +1,4 @@
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 
 #include "esp_err.h"
 #include "esp_log.h"
@@ -9,9 +8,12 @@
 #include "context.h"
 #include "error.h"
 #include "humidity_pressure.h"
+#include "sampling.h"
+#include "sensors.h"
 
 static const char *TAG = "bme280";
 static struct bme280_dev dev;
+static struct bme280_data comp_data;
 
 static void humidity_pressure_publish(context_t *context, struct bme280_data *comp_data) {
 #ifdef BME280_FLOAT_ENABLE
@@ -27,42 +29,73 @@ static void humidity_pressure_publish(context_t *context, struct bme280_data *co
     ESP_ERROR_CHECK(context_set_temp_indoor_humidity_pressure(context, indoor, humidity, pressure));
 }
 
-static void humidity_pressure_task(void *arg) {
-    context_t *context = (context_t *) arg;
-    ARG_ERROR_CHECK(context != NULL, ERR_PARAM_NULL);
-
-    struct bme280_data comp_data;
-    while (true) {
-        TickType_t last_wake_time = xTaskGetTickCount();
+static esp_err_t humidity_pressure_driver_init(context_t *context, void *arg) {
+    ARG_UNUSED(context);
+    ARG_UNUSED(arg);
+    int8_t ret = humidity_pressure_hal_init(&dev);
+    if (ret != BME280_OK) {
+        ESP_LOGE(TAG, "error initializing BME280 err: %d", ret);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
 
-        int8_t ret;
+static esp_err_t humidity_pressure_start(context_t *context, void *arg, TickType_t *ready) {
+    ARG_UNUSED(context);
+    ARG_UNUSED(arg);
 #ifdef HUMIDITY_FORCED_MODE
-        ret = bme280_set_sensor_mode(BME280_FORCED_MODE, &dev);
-        if (ret != BME280_OK) {
-            ESP_LOGE(TAG, "bme280_set_sensor_mode err: %d", ret);
-            break;
-        }
-        /* Wait for the measurement to complete and print data @25Hz */
-        dev.delay_ms(70);
-#endif
-        ret = humidity_pressure_hal_read(BME280_ALL, &comp_data, &dev);
-        if (ret != BME280_OK) {
-            ESP_LOGE(TAG, "bme280_get_sensor_data err: %d", ret);
-            break;
-        }
-
-        humidity_pressure_publish(context, &comp_data);
-        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_HUMIDITY_MS));
+    int8_t ret = bme280_set_sensor_mode(BME280_FORCED_MODE, &dev);
+    if (ret != BME280_OK) {
+        ESP_LOGE(TAG, "bme280_set_sensor_mode err: %d", ret);
+        return ESP_FAIL;
     }
-    vTaskDelete(NULL);
+    /* The measurement completes within 70ms. */
+    *ready += pdMS_TO_TICKS(70);
+#endif
+    return ESP_OK;
 }
 
-esp_err_t humidity_pressure_init(context_t *context) {
-    int8_t ret = humidity_pressure_hal_init(&dev);
+static esp_err_t humidity_pressure_poll(context_t *context, void *arg, TickType_t *ready) {
+    ARG_UNUSED(context);
+    ARG_UNUSED(arg);
+    ARG_UNUSED(ready);
+    int8_t ret = humidity_pressure_hal_read(BME280_ALL, &comp_data, &dev);
     if (ret != BME280_OK) {
-        ESP_LOGE(TAG, "error initializing BME280 err: %d", ret);
+        ESP_LOGE(TAG, "bme280_get_sensor_data err: %d", ret);
+        return ESP_FAIL;
     }
+    return ESP_OK;
+}
 
-    xTaskCreatePinnedToCore(humidity_pressure_task, TAG, 2048, context, tskIDLE_PRIORITY + 10, NULL, tskNO_AFFINITY);
+static esp_err_t humidity_pressure_collect(context_t *context, void *arg) {
+    ARG_UNUSED(arg);
+    humidity_pressure_publish(context, &comp_data);
     return ESP_OK;
 }
+
+static float humidity_pressure_value(void *arg) {
+    ARG_UNUSED(arg);
+#ifdef BME280_FLOAT_ENABLE
+    return (float) comp_data.temperature;
+#else
+    return comp_data.temperature / 100.f;
+#endif
+}
+
+static const sensors_driver_t driver = {
+        .name = "bme280",
+        .sampling = SAMPLING_HUMIDITY,
+        .i2c = true,
+        .health = {.min = -40.f, .max = 85.f, .stuck = 60, .retries = 3},
+        .init = humidity_pressure_driver_init,
+        .start = humidity_pressure_start,
+        .poll = humidity_pressure_poll,
+        .collect = humidity_pressure_collect,
+        .reset = humidity_pressure_driver_init,
+        .value = humidity_pressure_value,
+};
+
+esp_err_t humidity_pressure_init(context_t *context) {
+    ARG_UNUSED(context);
+    return sensors_register(&driver);
+}
@@ -10,9 +10,11 @@
 
 #include "buses.h"
 #include "error.h"
+#include "i2c_bus.h"
 #include "utils.h"
 
 static const uint8_t BME280_ADDR = BME280_I2C_ADDR_PRIM;
+static i2c_bus_device_handle_t bus_dev;
 
 static int8_t humidity_pressure_hal_i2c_read(uint8_t reg_addr, uint8_t *reg_data, uint32_t len, void *intf_ptr) {
     uint8_t dev_id = *(uint8_t *) intf_ptr;
@@ -31,7 +33,7 @@ static int8_t humidity_pressure_hal_i2c_read(uint8_t reg_addr, uint8_t *reg_data
     i2c_master_read_byte(cmd, reg_data + len - 1, I2C_MASTER_NACK);
     i2c_master_stop(cmd);
 
-    esp_err_t err = i2c_master_cmd_begin(I2C_MASTER_NUM, cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+    esp_err_t err = i2c_bus_cmd_begin(bus_dev, cmd, I2C_TIMEOUT_MS);
     i2c_cmd_link_delete(cmd);
 
     return (err == ESP_OK) ? BME280_OK : BME280_E_COMM_FAIL;
@@ -48,7 +50,7 @@ static int8_t humidity_pressure_hal_i2c_write(uint8_t reg_addr, const uint8_t *r
     i2c_master_write(cmd, reg_data, len, I2C_WRITE_ACK_CHECK);
     i2c_master_stop(cmd);
 
-    esp_err_t err = i2c_master_cmd_begin(I2C_MASTER_NUM, cmd, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+    esp_err_t err = i2c_bus_cmd_begin(bus_dev, cmd, I2C_TIMEOUT_MS);
     i2c_cmd_link_delete(cmd);
 
     return (err == ESP_OK) ? BME280_OK : BME280_E_COMM_FAIL;
@@ -64,6 +66,10 @@ int8_t humidity_pressure_hal_read(uint8_t sensor_comp, struct bme280_data *comp_
 }
 
 int8_t humidity_pressure_hal_init(struct bme280_dev *dev) {
+    // Also called to reset the sensor, the bus device is only added once.
+    if (bus_dev == NULL && i2c_bus_add_device("bme280", BME280_ADDR, I2C_BUS_PRIORITY_NORMAL, &bus_dev) != ESP_OK) {
+        return BME280_E_DEV_NOT_FOUND;
+    }
     dev->intf_ptr = (void *) &BME280_ADDR;
     dev->intf = BME280_I2C_INTF;
     dev->read = humidity_pressure_hal_i2c_read;
@@ -0,0 +1,141 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/task.h"
+
+#include "esp_err.h"
+#include "esp_log.h"
+
+#include "config.h"
+#include "context.h"
+#include "error.h"
+#include "sampling.h"
+
+#define SAMPLING_ALL_BITS ((1U << SAMPLING_MAX) - 1)
+
+static const char *TAG = "sampling";
+static const char *const NAMES[SAMPLING_MAX] = {"humidity", "temperature", "tank", "ec", "rtd", "ph"};
+static const uint32_t DEFAULTS_MS[SAMPLING_MAX] = {
+        CONFIG_ESP_SAMPLING_HUMIDITY_MS,
+        CONFIG_ESP_SAMPLING_TEMPERATURE_MS,
+        CONFIG_ESP_SAMPLING_TANK_MS,
+        CONFIG_ESP_SAMPLING_EC_MS,
+        CONFIG_ESP_SAMPLING_RTD_MS,
+        CONFIG_ESP_SAMPLING_PH_MS,
+};
+
+// The EZO modules share a phase, their sampler pipelines them in a single sweep.
+static const uint8_t PHASES[SAMPLING_MAX] = {0, 1, 2, 3, 3, 3};
+
+static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+static EventGroupHandle_t changed = NULL;
+static struct {
+    uint32_t period_ms;
+    TickType_t period;
+    TickType_t next;
+} slots[SAMPLING_MAX] = {0};
+
+// Must hold the spinlock. Every sensor restarts from the same epoch, shifted by its phase so different sensors never
+// start on the same tick, which keeps them from queueing behind each other on the bus.
+static void sampling_rebase(const uint32_t periods_ms[SAMPLING_MAX], TickType_t epoch) {
+    for (int i = 0; i < SAMPLING_MAX; ++i) {
+        slots[i].period_ms = periods_ms[i];
+        slots[i].period = pdMS_TO_TICKS(periods_ms[i]);
+        slots[i].next = epoch + pdMS_TO_TICKS((PHASES[i] * SAMPLING_STAGGER_MS) % periods_ms[i]);
+    }
+}
+
+static uint32_t sampling_value(int32_t value_ms, sampling_sensor_t sensor) {
+    if (value_ms <= 0) {
+        return DEFAULTS_MS[sensor];
+    }
+    return value_ms < SAMPLING_MIN_MS ? SAMPLING_MIN_MS : value_ms;
+}
+
+static void sampling_config_callback(const Hydroponics__Config *config) {
+    uint32_t periods_ms[SAMPLING_MAX];
+    const Hydroponics__Sampling *sampling = config != NULL ? config->sampling : NULL;
+    periods_ms[SAMPLING_HUMIDITY] = sampling_value(sampling ? sampling->humidity_ms : 0, SAMPLING_HUMIDITY);
+    periods_ms[SAMPLING_TEMPERATURE] = sampling_value(sampling ? sampling->temperature_ms : 0, SAMPLING_TEMPERATURE);
+    periods_ms[SAMPLING_TANK] = sampling_value(sampling ? sampling->tank_ms : 0, SAMPLING_TANK);
+    periods_ms[SAMPLING_EC] = sampling_value(sampling ? sampling->ec_probe_ms : 0, SAMPLING_EC);
+    periods_ms[SAMPLING_RTD] = sampling_value(sampling ? sampling->ec_probe_temp_ms : 0, SAMPLING_RTD);
+    periods_ms[SAMPLING_PH] = sampling_value(sampling ? sampling->ph_probe_ms : 0, SAMPLING_PH);
+    context_config_release(config);
+
+    bool updated = false;
+    portENTER_CRITICAL(&spinlock);
+    for (int i = 0; i < SAMPLING_MAX; ++i) {
+        updated |= slots[i].period_ms != periods_ms[i];
+    }
+    if (updated) {
+        sampling_rebase(periods_ms, xTaskGetTickCount());
+    }
+    portEXIT_CRITICAL(&spinlock);
+    if (!updated) {
+        return;
+    }
+    for (int i = 0; i < SAMPLING_MAX; ++i) {
+        ESP_LOGI(TAG, "  %-12s %6d ms", NAMES[i], periods_ms[i]);
+    }
+    xEventGroupSetBits(changed, SAMPLING_ALL_BITS);
+}
+
+esp_err_t sampling_init(context_t *context) {
+    ARG_CHECK(context != NULL, ERR_PARAM_NULL);
+
+    changed = xEventGroupCreate();
+    CHECK_NO_MEM(changed);
+    portENTER_CRITICAL(&spinlock);
+    sampling_rebase(DEFAULTS_MS, xTaskGetTickCount());
+    portEXIT_CRITICAL(&spinlock);
+
+    const Hydroponics__Config *config = NULL;
+    ESP_ERROR_CHECK(context_get_config(context, &config));
+    sampling_config_callback(config);
+    ESP_ERROR_CHECK(config_register(sampling_config_callback));
+    return ESP_OK;
+}
+
+uint32_t sampling_period_ms(sampling_sensor_t sensor) {
+    portENTER_CRITICAL(&spinlock);
+    uint32_t period_ms = slots[sensor].period_ms;
+    portEXIT_CRITICAL(&spinlock);
+    return period_ms;
+}
+
+bool sampling_take(sampling_sensor_t sensor, TickType_t now) {
+    portENTER_CRITICAL(&spinlock);
+    bool due = (int32_t) (now - slots[sensor].next) >= 0;
+    if (due) {
+        slots[sensor].next += slots[sensor].period;
+        if ((int32_t) (now - slots[sensor].next) >= 0) {
+            // Fell behind by more than a period, skip the missed slots but keep the phase.
+            TickType_t behind = now - slots[sensor].next;
+            slots[sensor].next += (behind / slots[sensor].period + 1) * slots[sensor].period;
+        }
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return due;
+}
+
+TickType_t sampling_next(sampling_sensor_t sensor) {
+    portENTER_CRITICAL(&spinlock);
+    TickType_t next = slots[sensor].next;
+    portEXIT_CRITICAL(&spinlock);
+    return next;
+}
+
+void sampling_wait(sampling_sensor_t sensor) {
+    const EventBits_t bit = 1U << sensor;
+    while (true) {
+        TickType_t now = xTaskGetTickCount();
+        if (sampling_take(sensor, now)) {
+            xEventGroupClearBits(changed, bit);
+            return;
+        }
+        TickType_t next = sampling_next(sensor);
+        if ((int32_t) (next - now) > 0) {
+            xEventGroupWaitBits(changed, bit, pdTRUE, pdFALSE, next - now);
+        }
+    }
+}
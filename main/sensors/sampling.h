@@ -0,0 +1,36 @@
+#ifndef HYDROPONICS_SENSORS_SAMPLING_H
+#define HYDROPONICS_SENSORS_SAMPLING_H
+
+#include "freertos/FreeRTOS.h"
+
+#include "esp_err.h"
+
+#include "context.h"
+
+#define SAMPLING_MIN_MS     100
+#define SAMPLING_STAGGER_MS 100 /*!< Phase offset between consecutive sensors. */
+
+typedef enum {
+    SAMPLING_HUMIDITY = 0,
+    SAMPLING_TEMPERATURE = 1,
+    SAMPLING_TANK = 2,
+    SAMPLING_EC = 3,
+    SAMPLING_RTD = 4,
+    SAMPLING_PH = 5,
+    SAMPLING_MAX,
+} sampling_sensor_t;
+
+esp_err_t sampling_init(context_t *context);
+
+uint32_t sampling_period_ms(sampling_sensor_t sensor);
+
+// True when the current slot of `sensor` started, in which case the next slot is scheduled.
+bool sampling_take(sampling_sensor_t sensor, TickType_t now);
+
+// Tick at which the next slot of `sensor` starts.
+TickType_t sampling_next(sampling_sensor_t sensor);
+
+// Blocks until the next slot of `sensor`. Wakes up early and reschedules if the periods are reconfigured meanwhile.
+void sampling_wait(sampling_sensor_t sensor);
+
+#endif //HYDROPONICS_SENSORS_SAMPLING_H
@@ -0,0 +1,297 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "esp_err.h"
+#include "esp_log.h"
+
+#include "buses.h"
+#include "context.h"
+#include "error.h"
+#include "health.h"
+#include "sampling.h"
+#include "sensors.h"
+
+#define SENSORS_MAX_SLEEP_MS  1000 /*!< Upper bound of a sleep, picks up sampling changes. */
+#define SENSORS_STALE_PERIODS 5    /*!< Sampling periods without a good sample before a sensor is stale. */
+
+typedef enum {
+    SENSORS_STATE_IDLE = 0,
+    SENSORS_STATE_BUSY = 1,
+    SENSORS_STATE_INIT = 2,     /*!< Init failed, retried on the slots the recovery ladder allows. */
+} sensors_state_t;
+
+typedef struct {
+    const sensors_driver_t *driver;
+    sensors_state_t state;
+    TickType_t ready;
+    uint8_t skipped;    /*!< Slots without an init attempt since the failed sensor was last retried. */
+    health_t health;    /*!< Written by the sensors task, read by anyone under the spinlock. */
+} sensors_entry_t;
+
+static const char *TAG = "sensors";
+static sensors_entry_t entries[SENSORS_MAX_DRIVERS] = {0};
+static size_t entries_size = 0;
+static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+
+esp_err_t sensors_register(const sensors_driver_t *driver) {
+    ARG_CHECK(driver != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(driver->start != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(driver->poll != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(driver->sampling < SAMPLING_MAX, "invalid sampling sensor");
+    if (entries_size >= SENSORS_MAX_DRIVERS) {
+        return ESP_ERR_NO_MEM;
+    }
+    sensors_entry_t *entry = &entries[entries_size++];
+    entry->driver = driver;
+    health_init(&entry->health, &driver->health, 0);
+    return ESP_OK;
+}
+
+static uint64_t sensors_now_ms(void) {
+    return (uint64_t) xTaskGetTickCount() * portTICK_PERIOD_MS;
+}
+
+static bool sensors_is_ready(TickType_t ready, TickType_t now) {
+    return (int32_t) (now - ready) >= 0;
+}
+
+static void sensors_recover(context_t *context, sensors_entry_t *entry, health_action_t action) {
+    const sensors_driver_t *driver = entry->driver;
+    esp_err_t err = ESP_OK;
+    switch (action) {
+        case HEALTH_ACTION_RETRY:
+            // Nothing to do, the next slot tries again.
+            return;
+        case HEALTH_ACTION_RESET_DEVICE:
+            // A device that never came up is reset by its next init.
+            if (driver->reset == NULL || entry->state == SENSORS_STATE_INIT) {
+                return;
+            }
+            ESP_LOGW(TAG, "[%s] %s, resetting the device", driver->name, health_fault_name(entry->health.fault));
+            err = driver->reset(context, driver->arg);
+            break;
+        case HEALTH_ACTION_RESET_BUS:
+            if (!driver->i2c) {
+                return;
+            }
+            ESP_LOGW(TAG, "[%s] %s, recovering the bus", driver->name, health_fault_name(entry->health.fault));
+            err = buses_recover();
+            break;
+        case HEALTH_ACTION_ALERT:
+            ESP_LOGE(TAG, "[%s] %s, failed after %d faults", driver->name, health_fault_name(entry->health.fault),
+                     entry->health.consecutive);
+            return;
+        default:
+            return;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "[%s] recovery err: %s", driver->name, esp_err_to_name(err));
+    }
+}
+
+static void sensors_fault(context_t *context, sensors_entry_t *entry, health_fault_t fault) {
+    uint64_t now_ms = sensors_now_ms();
+    portENTER_CRITICAL(&spinlock);
+    health_action_t action = health_fault(&entry->health, fault, now_ms);
+    portEXIT_CRITICAL(&spinlock);
+    sensors_recover(context, entry, action);
+}
+
+static void sensors_finish(context_t *context, sensors_entry_t *entry, esp_err_t err) {
+    const sensors_driver_t *driver = entry->driver;
+    entry->state = SENSORS_STATE_IDLE;
+    if (err == ESP_ERR_INVALID_STATE) {
+        // Paused or taken by a calibration halfway through, like at the start there is nothing to report.
+        return;
+    }
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "[%s] err: %s", driver->name, esp_err_to_name(err));
+        sensors_fault(context, entry, HEALTH_FAULT_ERROR);
+        return;
+    }
+    health_action_t action = HEALTH_ACTION_NONE;
+    uint64_t now_ms = sensors_now_ms();
+    float value = driver->value != NULL ? driver->value(driver->arg) : 0.f;
+    portENTER_CRITICAL(&spinlock);
+    if (driver->value != NULL) {
+        action = health_value(&entry->health, value, now_ms);
+    } else {
+        health_success(&entry->health, now_ms);
+    }
+    bool good = health_is_good(&entry->health);
+    portEXIT_CRITICAL(&spinlock);
+    if (!good) {
+        // Never publish a value that is known to be wrong.
+        ESP_LOGW(TAG, "[%s] %s value: %.2f", driver->name, health_fault_name(entry->health.fault), value);
+        sensors_recover(context, entry, action);
+        return;
+    }
+    if (action == HEALTH_ACTION_ALERT) {
+        ESP_LOGW(TAG, "[%s] stuck at %.2f for %u samples", driver->name, value, driver->health.stuck);
+    }
+    if (driver->collect != NULL) {
+        err = driver->collect(context, driver->arg);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "[%s] collect err: %s", driver->name, esp_err_to_name(err));
+        }
+    }
+}
+
+// Runs `init` at the start of a slot, at every slot while climbing the recovery ladder and once every
+// SENSORS_STALE_PERIODS slots after it alerted, as init blocks the other sensors. Returns whether the driver is now
+// initialized.
+static bool sensors_try_init(context_t *context, sensors_entry_t *entry) {
+    const sensors_driver_t *driver = entry->driver;
+    portENTER_CRITICAL(&spinlock);
+    bool failed = entry->health.step == HEALTH_ACTION_ALERT;
+    portEXIT_CRITICAL(&spinlock);
+    if (failed && ++entry->skipped < SENSORS_STALE_PERIODS) {
+        return false;
+    }
+    entry->skipped = 0;
+    esp_err_t err = driver->init != NULL ? driver->init(context, driver->arg) : ESP_OK;
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "[%s] init err: %s", driver->name, esp_err_to_name(err));
+        sensors_fault(context, entry, HEALTH_FAULT_ERROR);
+        return false;
+    }
+    ESP_LOGI(TAG, "[%s] initialized", driver->name);
+    entry->state = SENSORS_STATE_IDLE;
+    return true;
+}
+
+// Starts every driver whose slot began and polls every busy driver that is ready. Returns the next tick worth waking up.
+static TickType_t sensors_step(context_t *context, TickType_t now) {
+    for (size_t i = 0; i < entries_size; ++i) {
+        sensors_entry_t *entry = &entries[i];
+        if (entry->state == SENSORS_STATE_BUSY || !sampling_take(entry->driver->sampling, now)) {
+            continue;
+        }
+        if (entry->state == SENSORS_STATE_INIT && !sensors_try_init(context, entry)) {
+            continue;
+        }
+        entry->ready = now;
+        esp_err_t err = entry->driver->start(context, entry->driver->arg, &entry->ready);
+        if (err == ESP_ERR_NOT_FOUND || err == ESP_ERR_INVALID_STATE) {
+            // Missing, paused or busy device, nothing to report until it comes back.
+            uint64_t now_ms = sensors_now_ms();
+            portENTER_CRITICAL(&spinlock);
+            entry->health.last_good_ms = now_ms;
+            portEXIT_CRITICAL(&spinlock);
+            continue;
+        }
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "[%s] start err: %s", entry->driver->name, esp_err_to_name(err));
+            sensors_fault(context, entry, HEALTH_FAULT_ERROR);
+            continue;
+        }
+        entry->state = SENSORS_STATE_BUSY;
+    }
+    // Drivers started together convert in parallel, poll them only once they can have something.
+    TickType_t wake = now + pdMS_TO_TICKS(SENSORS_MAX_SLEEP_MS);
+    for (size_t i = 0; i < entries_size; ++i) {
+        sensors_entry_t *entry = &entries[i];
+        if (entry->state == SENSORS_STATE_BUSY && sensors_is_ready(entry->ready, now)) {
+            esp_err_t err = entry->driver->poll(context, entry->driver->arg, &entry->ready);
+            if (err != ESP_ERR_NOT_FINISHED) {
+                sensors_finish(context, entry, err);
+            }
+        }
+        TickType_t next;
+        if (entry->state == SENSORS_STATE_BUSY) {
+            next = entry->ready;
+        } else {
+            next = sampling_next(entry->driver->sampling);
+        }
+        if ((int32_t) (next - wake) < 0) {
+            wake = next;
+        }
+    }
+    return wake;
+}
+
+// Catches the sensors that stopped producing without reporting any error, e.g. an ADC that stopped converting.
+static void sensors_check(context_t *context) {
+    for (size_t i = 0; i < entries_size; ++i) {
+        sensors_entry_t *entry = &entries[i];
+        if (entry->state == SENSORS_STATE_INIT) {
+            // Every failed init is already a fault.
+            continue;
+        }
+        uint64_t now_ms = sensors_now_ms();
+        // Follows the sampling period, which can change at runtime.
+        uint32_t stale_ms = SENSORS_STALE_PERIODS * sampling_period_ms(entry->driver->sampling);
+        portENTER_CRITICAL(&spinlock);
+        entry->health.limits.stale_ms = stale_ms;
+        uint64_t last_good_ms = entry->health.last_good_ms;
+        health_action_t action = health_check(&entry->health, now_ms);
+        portEXIT_CRITICAL(&spinlock);
+        if (action != HEALTH_ACTION_NONE) {
+            ESP_LOGW(TAG, "[%s] no good sample for %llu ms", entry->driver->name, now_ms - last_good_ms);
+            sensors_recover(context, entry, action);
+        }
+    }
+}
+
+static void sensors_task(void *arg) {
+    context_t *context = (context_t *) arg;
+    ARG_ERROR_CHECK(context != NULL, ERR_PARAM_NULL);
+
+    for (size_t i = 0; i < entries_size; ++i) {
+        const sensors_driver_t *driver = entries[i].driver;
+        esp_err_t err = driver->init != NULL ? driver->init(context, driver->arg) : ESP_OK;
+        uint64_t now_ms = sensors_now_ms();
+        portENTER_CRITICAL(&spinlock);
+        health_init(&entries[i].health, &driver->health, now_ms);
+        portEXIT_CRITICAL(&spinlock);
+        if (err != ESP_OK) {
+            // A module plugged in late or a bus that was stuck at boot comes back on the next slots.
+            ESP_LOGE(TAG, "[%s] init err: %s, retrying", driver->name, esp_err_to_name(err));
+            entries[i].state = SENSORS_STATE_INIT;
+            sensors_fault(context, &entries[i], HEALTH_FAULT_ERROR);
+        }
+    }
+    while (true) {
+        TickType_t now = xTaskGetTickCount();
+        TickType_t wake = sensors_step(context, now);
+        sensors_check(context);
+        now = xTaskGetTickCount();
+        if ((int32_t) (wake - now) > 0) {
+            vTaskDelay(wake - now);
+        }
+    }
+}
+
+esp_err_t sensors_init(context_t *context) {
+    ARG_CHECK(context != NULL, ERR_PARAM_NULL);
+    ESP_LOGI(TAG, "Running %d sensor drivers", entries_size);
+    xTaskCreatePinnedToCore(sensors_task, "sensors", 3584, context, tskIDLE_PRIORITY + 10, NULL, tskNO_AFFINITY);
+    return ESP_OK;
+}
+
+esp_err_t sensors_get_health(sensors_health_t *health, size_t max, size_t *count) {
+    ARG_CHECK(health != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(count != NULL, ERR_PARAM_NULL);
+
+    *count = 0;
+    portENTER_CRITICAL(&spinlock);
+    for (size_t i = 0; i < entries_size && *count < max; ++i) {
+        health[*count].name = entries[i].driver->name;
+        health[*count].health = entries[i].health;
+        (*count)++;
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return ESP_OK;
+}
+
+size_t sensors_unhealthy(void) {
+    size_t count = 0;
+    portENTER_CRITICAL(&spinlock);
+    for (size_t i = 0; i < entries_size; ++i) {
+        if (entries[i].health.status != HEALTH_STATUS_OK) {
+            count++;
+        }
+    }
+    portEXIT_CRITICAL(&spinlock);
+    return count;
+}
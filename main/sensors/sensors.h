@@ -0,0 +1,54 @@
+#ifndef HYDROPONICS_SENSORS_SENSORS_H
+#define HYDROPONICS_SENSORS_SENSORS_H
+
+#include "freertos/FreeRTOS.h"
+
+#include "esp_err.h"
+
+#include "context.h"
+#include "health.h"
+#include "sampling.h"
+
+#define SENSORS_MAX_DRIVERS 8
+
+/*
+ * A sensor driver is a non-blocking state machine run by the single acquisition task. Every slot of `sampling` calls
+ * `start`, then `poll` from the tick stored in `ready` until it stops returning ESP_ERR_NOT_FINISHED and finally
+ * `collect` to publish the values. `init` runs from the acquisition task and, like `reset`, is allowed to block. A failed
+ * `init` is a fault retried on the slots of the recovery ladder until it succeeds, so it must be safe to call again.
+ * ESP_ERR_NOT_FOUND from `start` and ESP_ERR_INVALID_STATE from `start` or `poll` skip the slot without a fault, for
+ * missing, paused or busy devices.
+ *
+ * Failures, out of range and stale values are tracked against `health` and escalate through retrying, `reset`,
+ * recovering the I2C bus (only for `i2c` drivers) and finally alerting. Stuck values only alert.
+ */
+typedef struct {
+    const char *name;
+    sampling_sensor_t sampling;
+    void *arg;
+    bool i2c;
+    health_limits_t health;
+    esp_err_t (*init)(context_t *context, void *arg);
+    esp_err_t (*start)(context_t *context, void *arg, TickType_t *ready);
+    esp_err_t (*poll)(context_t *context, void *arg, TickType_t *ready);
+    esp_err_t (*collect)(context_t *context, void *arg);
+    esp_err_t (*reset)(context_t *context, void *arg);   /*!< Optional. */
+    float (*value)(void *arg);                           /*!< Optional, main value of the last poll. */
+} sensors_driver_t;
+
+typedef struct {
+    const char *name;
+    health_t health;
+} sensors_health_t;
+
+// Must be called before `sensors_init`, the driver must outlive the runtime.
+esp_err_t sensors_register(const sensors_driver_t *driver);
+
+esp_err_t sensors_init(context_t *context);
+
+esp_err_t sensors_get_health(sensors_health_t *health, size_t max, size_t *count);
+
+// Number of sensors currently not healthy.
+size_t sensors_unhealthy(void);
+
+#endif //HYDROPONICS_SENSORS_SENSORS_H
@@ -1,23 +1,32 @@
-#include <math.h>
-
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 
 #include "esp_log.h"
 
-#include "ads1115.h"
-
+#include "ads1115_stream.h"
 #include "buses.h"
+#include "calibration.h"
+#include "config.h"
 #include "context.h"
 #include "error.h"
+#include "sampling.h"
+#include "sensors.h"
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+#include "simulation.h"
+#endif
 #include "tank.h"
-#include "utils.h"
 
-#define NO_OF_SAMPLES 16UL
 #define COEFFICIENTS_MAX 4
+// The default curve goes from 108% at INT16_MIN down to empty around 19400. It is only tabulated up to where it leaves
+// the health limits of the driver, a reading past that still clamps out of range.
+#define DEFAULT_RAW_MIN INT16_MIN
+#define DEFAULT_RAW_MAX 26000
 
 static const char *const TAG = "tank";
 
+// From https://docs.google.com/spreadsheets/d/1LZo2zjm7wT2C7UeA40zMUXK-daBry_TDRjhAEd-a5a8/view
+//                                                 x^3                   x^2                    x                    b
+static const double DEFAULT_REGRESSION[COEFFICIENTS_MAX] = {-0.00000000000000185, -0.00000000021752058, -0.00002203925836691, 0.52318676617797200};
+
 typedef enum {
     TANK_I2C_ADDRESS_GND = UINT8_C(0x48),
     TANK_I2C_ADDRESS_VDD = UINT8_C(0x49),
@@ -27,58 +36,185 @@ typedef enum {
 } tank_i2c_address_t;
 
 typedef const struct {
-    const char *name;                    /*!< Tank description, used for logging. */
-    ads1115_mux_t device_mux;            /*!< ADC channel mux. Should be a differential channel. */
-    double regression[COEFFICIENTS_MAX]; /*!< Linear regression coefficients. */
+    const char *name;                           /*!< Tank description, used for logging. */
+    int index;                                  /*!< Tank index in the context. */
+    Hydroponics__Calibration__Sensor sensor;    /*!< Calibration entry in the config. */
+    ads1115_stream_mux_t device_mux;            /*!< ADC channel mux. Should be a differential channel. */
 } tank_t;
 
 static struct {
     const tank_i2c_address_t address;
-    tank_t tanks;
-    ads1115_t handle;
+    tank_t tanks[CONFIG_ESP_SENSOR_TANKS];
+    calibration_t calibration[CONFIG_ESP_SENSOR_TANKS];
 } config = {
         .address = TANK_I2C_ADDRESS_GND,
         .tanks = {
-                .name = "Tank",
-                .device_mux = ADS1115_MUX_0_1,
-                // From https://docs.google.com/spreadsheets/d/1LZo2zjm7wT2C7UeA40zMUXK-daBry_TDRjhAEd-a5a8/view
-                //                      x^3                   x^2                    x                    b
-                .regression = {-0.00000000000000185, -0.00000000021752058, -0.00002203925836691, 0.52318676617797200},
+                {
+                        .name = "Tank A",
+                        .index = CONFIG_TANK_A,
+                        .sensor = HYDROPONICS__CALIBRATION__SENSOR__TANK_A,
+                        .device_mux = ADS1115_STREAM_MUX_0_1,
+                },
+#if CONFIG_ESP_SENSOR_TANKS > 1
+                {
+                        .name = "Tank B",
+                        .index = CONFIG_TANK_B,
+                        .sensor = HYDROPONICS__CALIBRATION__SENSOR__TANK_B,
+                        .device_mux = ADS1115_STREAM_MUX_2_3,
+                },
+#endif
         },
 };
+static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+static struct {
+    uint32_t conversions;
+    float levels[CONFIG_ESP_SENSOR_TANKS];
+} readings = {0};
+
+static esp_err_t tank_calibration_default(calibration_t *cal) {
+    return calibration_from_polynomial(DEFAULT_REGRESSION, COEFFICIENTS_MAX, DEFAULT_RAW_MIN, DEFAULT_RAW_MAX,
+                                       CALIBRATION_MAX_POINTS, cal);
+}
+
+static esp_err_t tank_calibration_fit(const Hydroponics__Calibration *entry, calibration_t *cal) {
+    ARG_CHECK(entry->n_point <= CALIBRATION_MAX_POINTS, "too many points: %d", entry->n_point);
+    calibration_point_t points[CALIBRATION_MAX_POINTS];
+    for (size_t i = 0; i < entry->n_point; ++i) {
+        points[i].raw = entry->point[i]->raw;
+        points[i].value = entry->point[i]->value;
+    }
+    calibration_type_t type = entry->type == HYDROPONICS__CALIBRATION__TYPE__POLYNOMIAL
+                              ? CALIBRATION_TYPE_POLYNOMIAL
+                              : CALIBRATION_TYPE_PIECEWISE;
+    return calibration_fit(points, entry->n_point, type, entry->degree, cal);
+}
+
+static void tank_config_callback(const Hydroponics__Config *new_config) {
+    for (int i = 0; i < CONFIG_ESP_SENSOR_TANKS; ++i) {
+        tank_t *tank = &config.tanks[i];
+        const Hydroponics__Calibration *entry = NULL;
+        for (size_t j = 0; new_config != NULL && j < new_config->n_calibration; ++j) {
+            if (new_config->calibration[j]->sensor == tank->sensor) {
+                entry = new_config->calibration[j];
+            }
+        }
+        calibration_t cal;
+        esp_err_t err = entry != NULL ? tank_calibration_fit(entry, &cal) : ESP_ERR_NOT_FOUND;
+        if (err != ESP_OK) {
+            if (entry != NULL) {
+                ESP_LOGW(TAG, "%s: invalid calibration, using the default curve", tank->name);
+            }
+            ESP_ERROR_CHECK(tank_calibration_default(&cal));
+        }
+        portENTER_CRITICAL(&spinlock);
+        config.calibration[i] = cal;
+        portEXIT_CRITICAL(&spinlock);
+        ESP_LOGI(TAG, "%s: %s calibration with %d points", tank->name, err == ESP_OK ? "config" : "default", cal.n);
+    }
+    context_config_release(new_config);
+}
 
-static void tank_task(void *arg) {
-    context_t *context = (context_t *) arg;
-    ARG_ERROR_CHECK(context != NULL, ERR_PARAM_NULL);
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+// Only the first tank is modelled, its level goes through the inverse of its own curve to get back a raw reading.
+static bool tank_simulate_raw(size_t channel, int16_t *raw) {
+    if (channel != 0) {
+        return false;
+    }
+    int32_t level = CALIBRATION_FROM_FLOAT(simulation_read(SIMULATION_CHANNEL_TANK_LEVEL, 0.f, 0.002f));
+    portENTER_CRITICAL(&spinlock);
+    *raw = (int16_t) calibration_invert(&config.calibration[0], level);
+    portEXIT_CRITICAL(&spinlock);
+    return true;
+}
+#endif
 
-    while (true) {
-        TickType_t last_wake_time = xTaskGetTickCount();
-        if (config.tanks.name == NULL) {
+static esp_err_t tank_start(context_t *context, void *arg, TickType_t *ready) {
+    ARG_UNUSED(context);
+    ARG_UNUSED(arg);
+    ARG_UNUSED(ready);
+    return ESP_OK;
+}
+
+// The ADC streams in the background, only the averaged ring is consumed here.
+static esp_err_t tank_poll(context_t *context, void *arg, TickType_t *ready) {
+    ARG_UNUSED(context);
+    ARG_UNUSED(arg);
+    ARG_UNUSED(ready);
+    // The rings keep their last conversions forever, a stream that stopped converting must not look healthy.
+    ads1115_stream_stats_t stats = {0};
+    ESP_ERROR_CHECK(ads1115_stream_get_stats(&stats));
+    if (stats.conversions == readings.conversions) {
+        return ESP_ERR_TIMEOUT;
+    }
+    readings.conversions = stats.conversions;
+    for (int i = 0; i < CONFIG_ESP_SENSOR_TANKS; ++i) {
+        int16_t raw = 0;
+        readings.levels[i] = CONTEXT_UNKNOWN_VALUE;
+        if (ads1115_stream_average(i, &raw) != ESP_OK) {
             continue;
         }
-        int64_t scratch = 0;
-        ads1115_set_mux(&config.handle, config.tanks.device_mux);
-        for (int i = 0; i < NO_OF_SAMPLES; i++) {
-            scratch += ads1115_get_raw(&config.handle);
+        portENTER_CRITICAL(&spinlock);
+        int32_t level = calibration_eval(&config.calibration[i], raw);
+        portEXIT_CRITICAL(&spinlock);
+        readings.levels[i] = CALIBRATION_TO_FLOAT(level);
+        ESP_LOGD(TAG, "%s: %d / %.1f %%", config.tanks[i].name, raw, readings.levels[i] * 100);
+    }
+    return ESP_OK;
+}
+
+static esp_err_t tank_collect(context_t *context, void *arg) {
+    ARG_UNUSED(arg);
+    for (int i = 0; i < CONFIG_ESP_SENSOR_TANKS; ++i) {
+        if (CONTEXT_VALUE_IS_VALID(readings.levels[i])) {
+            ESP_ERROR_CHECK(context_set_tank(context, config.tanks[i].index, readings.levels[i]));
         }
-        // Average the value and run linear regression.
-        int32_t raw = (int32_t) (scratch / NO_OF_SAMPLES);
-        double average = lin_regression(config.tanks.regression, COEFFICIENTS_MAX, raw);
-        ESP_ERROR_CHECK(context_set_tank(context, CONFIG_TANK_A, average));
-        ESP_LOGD(TAG, "%s: %d / %.1f %%", config.tanks.name, raw, average * 100);
-        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_TANK_MS));
     }
+    return ESP_OK;
+}
+
+static float tank_value(void *arg) {
+    ARG_UNUSED(arg);
+    return readings.levels[0];
 }
 
+static const sensors_driver_t driver = {
+        .name = "tank",
+        .sampling = SAMPLING_TANK,
+        .i2c = true,
+        // The calibration extrapolates a little past empty and full.
+        .health = {.min = -0.2f, .max = 1.2f, .retries = 3},
+        .start = tank_start,
+        .poll = tank_poll,
+        .collect = tank_collect,
+        .value = tank_value,
+};
+
 esp_err_t tank_init(context_t *context) {
-    // Setup the ADCs.
-    if (config.address != TANK_I2C_ADDRESS_NONE) {
-        config.handle = ads1115_config(I2C_MASTER_NUM, config.address);
-        ads1115_set_mode(&config.handle, ADS1115_MODE_SINGLE);
-        ads1115_set_sps(&config.handle, ADS1115_SPS_64);
-        ads1115_set_pga(&config.handle, ADS1115_FSR_0_512);
-        ads1115_set_max_ticks(&config.handle, pdMS_TO_TICKS(I2C_TIMEOUT_MS));
+    if (config.address == TANK_I2C_ADDRESS_NONE) {
+        return ESP_OK;
     }
-    xTaskCreatePinnedToCore(tank_task, "tank", 2560, context, 15, NULL, tskNO_AFFINITY);
-    return ESP_OK;
+    // Setup the ADC in continuous mode, sampling every tank in round-robin.
+    ads1115_stream_config_t stream = {
+            .address = config.address,
+            .alert_gpio = ADS1115_ALERT_GPIO,
+            .fsr = ADS1115_STREAM_FSR_0_512,
+            .sps = ADS1115_STREAM_SPS_64,
+            .channels = CONFIG_ESP_SENSOR_TANKS,
+    };
+    for (int i = 0; i < CONFIG_ESP_SENSOR_TANKS; ++i) {
+        stream.mux[i] = config.tanks[i].device_mux;
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+        stream.simulate[i] = 1000.f;
+        stream.threshold[i] = 20.f;
+#endif
+    }
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+    stream.simulate_raw = tank_simulate_raw;
+#endif
+    const Hydroponics__Config *current = NULL;
+    ESP_ERROR_CHECK(context_get_config(context, &current));
+    tank_config_callback(current);
+    ESP_ERROR_CHECK(config_register(tank_config_callback));
+    ESP_ERROR_CHECK(ads1115_stream_init(&stream));
+    return sensors_register(&driver);
 }
@@ -1,46 +1,191 @@
+#include <string.h>
+
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 
 #include "esp_log.h"
 
 #include "buses.h"
+#include "config.h"
 #include "context.h"
 #include "error.h"
+#include "sampling.h"
+#include "sensors.h"
 #include "temperature.h"
+#include "utils.h"
+
+#define TEMPERATURE_DEFAULT_RESOLUTION DS18B20_RESOLUTION_12_BIT
+#define TEMPERATURE_POWER_ON_RESET     85.f /*!< Scratchpad value of a probe that reset before converting. */
+
+typedef struct {
+    char rom[OWB_ROM_CODE_LEN];
+    Hydroponics__OneWireProbe__Channel channel;
+    DS18B20_RESOLUTION resolution;
+} temperature_binding_t;
 
 static const char *TAG = "temperature";
 static temperature_t dev = {0};
+static portMUX_TYPE spinlock = portMUX_INITIALIZER_UNLOCKED;
+static struct {
+    temperature_binding_t bindings[OWB_MAX_DEVICES];
+    size_t size;
+    bool pending;
+} binding = {0};
+static struct {
+    int order[OWB_MAX_DEVICES];
+    int next;
+    int samples;
+    int errors;
+    TickType_t started;
+} conversion = {0};
+
+static uint32_t temperature_conversion_ms(DS18B20_RESOLUTION resolution) {
+    switch (resolution) {
+        case DS18B20_RESOLUTION_9_BIT:
+            return 94;
+        case DS18B20_RESOLUTION_10_BIT:
+            return 188;
+        case DS18B20_RESOLUTION_11_BIT:
+            return 375;
+        default:
+            return 750;
+    }
+}
+
+static void temperature_config_callback(const Hydroponics__Config *config) {
+    portENTER_CRITICAL(&spinlock);
+    binding.size = 0;
+    for (size_t i = 0; config != NULL && i < config->n_one_wire_probe && binding.size < OWB_MAX_DEVICES; ++i) {
+        const Hydroponics__OneWireProbe *probe = config->one_wire_probe[i];
+        temperature_binding_t *b = &binding.bindings[binding.size++];
+        strlcpy(b->rom, probe->rom, sizeof(b->rom));
+        b->channel = probe->channel;
+        b->resolution = probe->resolution >= DS18B20_RESOLUTION_9_BIT && probe->resolution <= DS18B20_RESOLUTION_12_BIT
+                        ? (DS18B20_RESOLUTION) probe->resolution
+                        : TEMPERATURE_DEFAULT_RESOLUTION;
+    }
+    binding.pending = true;
+    portEXIT_CRITICAL(&spinlock);
+    context_config_release(config);
+}
 
-static void temperature_task(void *arg) {
-    context_t *context = (context_t *) arg;
-    ARG_ERROR_CHECK(context != NULL, ERR_PARAM_NULL);
-
-    int errors_count[OWB_MAX_DEVICES] = {0};
-    int sample_count = 0;
-
-    while (true) {
-        TickType_t last_wake_time = xTaskGetTickCount();
-        temperature_hal_read(&dev);
-        ESP_LOGD(TAG, "Temperature readings (degrees C): sample %d", ++sample_count);
-        if (dev.num_devices > 0) {
-            for (int i = 0; i < dev.num_devices; i++) {
-                if (dev.errors[i] != DS18B20_OK) {
-                    ++errors_count[i];
-                }
-                ESP_LOGD(TAG, "  %d: %.1f    %d errors", i, dev.readings[i], errors_count[i]);
+// Runs in the sensor task since changing the resolution talks to the bus.
+static void temperature_apply_bindings(void) {
+    temperature_binding_t bindings[OWB_MAX_DEVICES];
+    portENTER_CRITICAL(&spinlock);
+    bool pending = binding.pending;
+    size_t size = binding.size;
+    memcpy(bindings, binding.bindings, sizeof(bindings));
+    binding.pending = false;
+    portEXIT_CRITICAL(&spinlock);
+    if (!pending) {
+        return;
+    }
+    for (int i = 0; i < dev.num_devices; ++i) {
+        temperature_probe_t *probe = &dev.probes[i];
+        // Without any binding, keep the old behaviour of publishing the first probe as the water temperature.
+        Hydroponics__OneWireProbe__Channel channel = size == 0 && i == 0
+                                                     ? HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__WATER
+                                                     : HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__NONE;
+        DS18B20_RESOLUTION resolution = TEMPERATURE_DEFAULT_RESOLUTION;
+        for (size_t j = 0; j < size; ++j) {
+            if (strncasecmp(bindings[j].rom, probe->rom, sizeof(probe->rom)) == 0) {
+                channel = bindings[j].channel;
+                resolution = bindings[j].resolution;
             }
-            ESP_ERROR_CHECK(context_set_temp_water(context, dev.readings[0]));
         }
-        vTaskDelayUntil(&last_wake_time, pdMS_TO_TICKS(CONFIG_ESP_SAMPLING_TEMPERATURE_MS));
+        probe->channel = channel;
+        if (probe->resolution != resolution && temperature_hal_set_resolution(&dev, i, resolution) != ESP_OK) {
+            ESP_LOGW(TAG, "  %s: failed to set %d bit resolution", probe->rom, resolution);
+        }
+        ESP_LOGI(TAG, "  %s: %s at %d bits", probe->rom,
+                 enum_from_value(&hydroponics__one_wire_probe__channel__descriptor, probe->channel), probe->resolution);
+    }
+}
+
+static void temperature_publish(context_t *context, const temperature_probe_t *probe) {
+    switch (probe->channel) {
+        case HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__WATER:
+            ESP_ERROR_CHECK(context_set_temp_water(context, probe->reading));
+            break;
+        default:
+            break;
+    }
+}
+
+static TickType_t temperature_ready(const temperature_probe_t *probe) {
+    return conversion.started + pdMS_TO_TICKS(temperature_conversion_ms(probe->resolution));
+}
+
+static esp_err_t temperature_start(context_t *context, void *arg, TickType_t *ready) {
+    ARG_UNUSED(context);
+    ARG_UNUSED(arg);
+    temperature_apply_bindings();
+    if (dev.num_devices == 0) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_err_t err = temperature_hal_convert(&dev);
+    if (err != ESP_OK) {
+        return err;
+    }
+    conversion.started = xTaskGetTickCount();
+    conversion.next = 0;
+    conversion.errors = 0;
+
+    // Collect the low resolution probes first, each one as soon as its own conversion is done.
+    for (int i = 0; i < dev.num_devices; ++i) {
+        int j = i;
+        while (j > 0 && dev.probes[conversion.order[j - 1]].resolution > dev.probes[i].resolution) {
+            conversion.order[j] = conversion.order[j - 1];
+            j--;
+        }
+        conversion.order[j] = i;
+    }
+    ESP_LOGD(TAG, "Temperature readings (degrees C): sample %d", ++conversion.samples);
+    *ready = temperature_ready(&dev.probes[conversion.order[0]]);
+    return ESP_OK;
+}
+
+static esp_err_t temperature_poll(context_t *context, void *arg, TickType_t *ready) {
+    ARG_UNUSED(arg);
+    int index = conversion.order[conversion.next++];
+    temperature_probe_t *probe = &dev.probes[index];
+    temperature_hal_read(&dev, index);
+    if (probe->error != DS18B20_OK || probe->reading == TEMPERATURE_POWER_ON_RESET) {
+        ++probe->errors;
+        ++conversion.errors;
+        ESP_LOGD(TAG, "  %s: error    %d errors", probe->rom, probe->errors);
+    } else {
+        ESP_LOGD(TAG, "  %s: %.2f    %d errors", probe->rom, probe->reading, probe->errors);
+        temperature_publish(context, probe);
+    }
+    if (conversion.next < dev.num_devices) {
+        *ready = temperature_ready(&dev.probes[conversion.order[conversion.next]]);
+        return ESP_ERR_NOT_FINISHED;
     }
+    return conversion.errors == 0 ? ESP_OK : ESP_ERR_INVALID_RESPONSE;
 }
 
+static const sensors_driver_t driver = {
+        .name = "temperature",
+        .sampling = SAMPLING_TEMPERATURE,
+        .health = {.retries = 3},
+        .start = temperature_start,
+        .poll = temperature_poll,
+};
+
 esp_err_t temperature_init(context_t *context) {
     // Setup the GPIOs.
     gpio_set_direction(ONE_WRITE_GPIO, GPIO_MODE_INPUT_OUTPUT);
 
     ESP_ERROR_CHECK(temperature_hal_init(&dev));
-
-    xTaskCreatePinnedToCore(temperature_task, "temperature", 2048, context, 15, NULL, tskNO_AFFINITY);
-    return ESP_OK;
+    // Probes power up at 12 bits unless their EEPROM says otherwise, force a known state.
+    for (int i = 0; i < dev.num_devices; ++i) {
+        dev.probes[i].resolution = DS18B20_RESOLUTION_INVALID;
+    }
+    const Hydroponics__Config *config = NULL;
+    ESP_ERROR_CHECK(context_get_config(context, &config));
+    temperature_config_callback(config);
+    ESP_ERROR_CHECK(config_register(temperature_config_callback));
+    return sensors_register(&driver);
 }
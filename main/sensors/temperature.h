@@ -7,23 +7,40 @@
 #include "owb_rmt.h"
 #include "ds18b20.h"
 
+#include "config.pb-c.h"
 #include "context.h"
 
-#define OWB_MAX_DEVICES 2
+#define OWB_MAX_DEVICES 8
+#define OWB_ROM_CODE_LEN 17
+
+typedef struct {
+    char rom[OWB_ROM_CODE_LEN];                  /*!< ROM code as 16 hex digits. */
+    Hydroponics__OneWireProbe__Channel channel;  /*!< Context channel the reading is published to. */
+    DS18B20_RESOLUTION resolution;
+    float reading;
+    DS18B20_ERROR error;
+    uint32_t errors;
+} temperature_probe_t;
 
 typedef struct {
     owb_rmt_driver_info rmt_driver_info;
     OneWireBus *owb;
     DS18B20_Info *devices[OWB_MAX_DEVICES];
     int num_devices;
-    float readings[OWB_MAX_DEVICES];
-    DS18B20_ERROR errors[OWB_MAX_DEVICES];
+    temperature_probe_t probes[OWB_MAX_DEVICES];
 } temperature_t;
 
 esp_err_t temperature_init(context_t *context);
 
+// Searches the bus and fills the ROM code of every probe found.
 esp_err_t temperature_hal_init(temperature_t *dev);
 
-void temperature_hal_read(temperature_t *dev);
+esp_err_t temperature_hal_set_resolution(temperature_t *dev, int index, DS18B20_RESOLUTION resolution);
+
+// Starts a conversion on every probe at once and returns without waiting for it.
+esp_err_t temperature_hal_convert(temperature_t *dev);
+
+// Reads the scratchpad of a single probe, its conversion must be complete.
+void temperature_hal_read(temperature_t *dev, int index);
 
 #endif //HYDROPONICS_SENSORS_TEMPERATURE_H
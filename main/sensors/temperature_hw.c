@@ -7,8 +7,6 @@
 #include "buses.h"
 #include "temperature.h"
 
-#define DS18B20_RESOLUTION DS18B20_RESOLUTION_12_BIT
-
 static const char *TAG = "temperature";
 
 #define OWB_STATUS_CHECK(x, reason) do {            \
@@ -28,10 +26,10 @@ esp_err_t temperature_hal_init(temperature_t *dev) {
     OneWireBus_SearchState search_state = {0};
     bool found = false;
     OWB_STATUS_CHECK(owb_search_first(dev->owb, &search_state, &found), ESP_ERR_NOT_FOUND);
-    while (found) {
-        char rom_code_s[17];
-        owb_string_from_rom_code(search_state.rom_code, rom_code_s, sizeof(rom_code_s));
-        ESP_LOGI(TAG, "  %d : %s", dev->num_devices, rom_code_s);
+    while (found && dev->num_devices < OWB_MAX_DEVICES) {
+        temperature_probe_t *probe = &dev->probes[dev->num_devices];
+        owb_string_from_rom_code(search_state.rom_code, probe->rom, sizeof(probe->rom));
+        ESP_LOGI(TAG, "  %d : %s", dev->num_devices, probe->rom);
         device_rom_codes[dev->num_devices] = search_state.rom_code;
         dev->num_devices++;
         owb_search_next(dev->owb, &search_state, &found);
@@ -50,24 +48,31 @@ esp_err_t temperature_hal_init(temperature_t *dev) {
             ds18b20_init(ds18b20_info, dev->owb, device_rom_codes[i]);    // associate with bus and device.
         }
         ds18b20_use_crc(ds18b20_info, true);                         // enable CRC check for temperature readings.
-        ds18b20_set_resolution(ds18b20_info, DS18B20_RESOLUTION);
     }
     return ESP_OK;
 }
 
-void temperature_hal_read(temperature_t *dev) {
+esp_err_t temperature_hal_set_resolution(temperature_t *dev, int index, DS18B20_RESOLUTION resolution) {
+    if (index < 0 || index >= dev->num_devices) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!ds18b20_set_resolution(dev->devices[index], resolution)) {
+        return ESP_FAIL;
+    }
+    dev->probes[index].resolution = resolution;
+    return ESP_OK;
+}
+
+esp_err_t temperature_hal_convert(temperature_t *dev) {
     if (dev->num_devices <= 0) {
-        return;
+        return ESP_ERR_NOT_FOUND;
     }
     ds18b20_convert_all(dev->owb);
-    // All devices use the same resolution so use the first device to determine the delay
-    ds18b20_wait_for_conversion(dev->devices[0]);
-
-    // Read the results immediately after conversion otherwise it may fail.
-    memset(dev->readings, 0, sizeof(dev->readings));
-    memset(dev->errors, 0, sizeof(dev->errors));
+    return ESP_OK;
+}
 
-    for (int i = 0; i < dev->num_devices; i++) {
-        dev->errors[i] = ds18b20_read_temp(dev->devices[i], &dev->readings[i]);
-    }
+void temperature_hal_read(temperature_t *dev, int index) {
+    temperature_probe_t *probe = &dev->probes[index];
+    probe->reading = 0.f;
+    probe->error = ds18b20_read_temp(dev->devices[index], &probe->reading);
 }
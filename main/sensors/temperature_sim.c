@@ -1,16 +1,46 @@
+#include <stdio.h>
+#include <math.h>
+
 #include "esp_log.h"
 
 #include "simulation.h"
 #include "temperature.h"
 
+#define SIM_DEVICES 2
+
 static const char *TAG = "temperature";
+static const float SIM_TEMPERATURE[SIM_DEVICES] = {19.f, 23.f};
+// The first probe sits in the tank, the second one is left in the air.
+static const simulation_channel_t SIM_CHANNEL[SIM_DEVICES] = {SIMULATION_CHANNEL_WATER_TEMP, SIMULATION_CHANNEL_NONE};
 
 esp_err_t temperature_hal_init(temperature_t *dev) {
-    dev->num_devices = 1;
+    dev->num_devices = SIM_DEVICES;
+    for (int i = 0; i < dev->num_devices; ++i) {
+        snprintf(dev->probes[i].rom, sizeof(dev->probes[i].rom), "%02x000000000000%02x", i + 1, 0x28);
+        ESP_LOGI(TAG, "  %d : %s", i, dev->probes[i].rom);
+    }
     ESP_LOGI(TAG, "Found %d sensor%s", dev->num_devices, dev->num_devices == 1 ? "" : "s");
     return ESP_OK;
 }
 
-void temperature_hal_read(temperature_t *dev) {
-    dev->readings[0] = WITH_THRESHOLD(19, 0.1);
+esp_err_t temperature_hal_set_resolution(temperature_t *dev, int index, DS18B20_RESOLUTION resolution) {
+    if (index < 0 || index >= dev->num_devices) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    dev->probes[index].resolution = resolution;
+    return ESP_OK;
+}
+
+esp_err_t temperature_hal_convert(temperature_t *dev) {
+    return dev->num_devices > 0 ? ESP_OK : ESP_ERR_NOT_FOUND;
+}
+
+void temperature_hal_read(temperature_t *dev, int index) {
+    temperature_probe_t *probe = &dev->probes[index];
+    // Quantize like the real probe, 0.0625 C at 12 bits and twice as coarse for every bit less.
+    int bits = probe->resolution >= DS18B20_RESOLUTION_9_BIT ? probe->resolution : DS18B20_RESOLUTION_12_BIT;
+    float step = 0.0625f * (float) (1 << (DS18B20_RESOLUTION_12_BIT - bits));
+    float value = simulation_read(SIM_CHANNEL[index % SIM_DEVICES], SIM_TEMPERATURE[index % SIM_DEVICES], 0.1f);
+    probe->reading = roundf(value / step) * step;
+    probe->error = DS18B20_OK;
 }
@@ -0,0 +1,98 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "esp_log.h"
+#include "esp_timer.h"
+
+#include "error.h"
+#include "plant.h"
+#include "simulation.h"
+#include "utils.h"
+
+static const char *const TAG = "simulation";
+static struct {
+    SemaphoreHandle_t lock;
+    plant_t plant;
+    int64_t start_us;
+    bool irrigation[2];
+} sim = {0};
+
+uint64_t simulation_now_ms(void) {
+    return (uint64_t) (esp_timer_get_time() - sim.start_us) / 1000 * CONFIG_ESP_SENSOR_SIMULATE_SPEED;
+}
+
+esp_err_t simulation_init(void) {
+    plant_params_t params = PLANT_PARAMS_DEFAULT;
+    params.seed = CONFIG_ESP_SENSOR_SIMULATE_SEED;
+    ESP_ERROR_CHECK(plant_init(&sim.plant, &params));
+    sim.start_us = esp_timer_get_time();
+    sim.lock = xSemaphoreCreateMutex();
+    CHECK_NO_MEM(sim.lock);
+    ESP_LOGI(TAG, "Simulating the plant at %dx with seed %d", CONFIG_ESP_SENSOR_SIMULATE_SPEED,
+             CONFIG_ESP_SENSOR_SIMULATE_SEED);
+    return ESP_OK;
+}
+
+void simulation_set_output(Hydroponics__Output output, Hydroponics__OutputState state) {
+    if (sim.lock == NULL) {
+        return;
+    }
+    bool on = state == HYDROPONICS__OUTPUT_STATE__ON;
+    xSemaphoreTake(sim.lock, portMAX_DELAY);
+    // Changes only apply from now on, catch up with the old outputs first.
+    ESP_ERROR_CHECK(plant_advance(&sim.plant, simulation_now_ms()));
+    switch (output) {
+        case HYDROPONICS__OUTPUT__EXT_GPIO_A_0:
+            plant_set_output(&sim.plant, PLANT_OUTPUT_FILL, on);
+            break;
+        case HYDROPONICS__OUTPUT__EXT_GPIO_A_1:
+            plant_set_output(&sim.plant, PLANT_OUTPUT_MIXER, on);
+            break;
+        case HYDROPONICS__OUTPUT__EXT_GPIO_A_5:
+            plant_set_output(&sim.plant, PLANT_OUTPUT_PH_DOWN, on);
+            break;
+        case HYDROPONICS__OUTPUT__EXT_GPIO_A_6:
+            plant_set_output(&sim.plant, PLANT_OUTPUT_PH_UP, on);
+            break;
+        case HYDROPONICS__OUTPUT__EXT_GPIO_A_7:
+            plant_set_output(&sim.plant, PLANT_OUTPUT_NUTRIENTS, on);
+            break;
+        case HYDROPONICS__OUTPUT__EXT_TUYA_OUT_2:
+        case HYDROPONICS__OUTPUT__EXT_TUYA_OUT_3:
+            sim.irrigation[output - HYDROPONICS__OUTPUT__EXT_TUYA_OUT_2] = on;
+            plant_set_output(&sim.plant, PLANT_OUTPUT_IRRIGATION, sim.irrigation[0] || sim.irrigation[1]);
+            break;
+        default:
+            break;
+    }
+    xSemaphoreGive(sim.lock);
+    ESP_LOGD(TAG, "%s = %s", enum_from_value(&hydroponics__output__descriptor, output),
+             enum_from_value(&hydroponics__output_state__descriptor, state));
+}
+
+float simulation_read(simulation_channel_t channel, float value, float threshold) {
+    if (sim.lock == NULL) {
+        return value;
+    }
+    xSemaphoreTake(sim.lock, portMAX_DELAY);
+    ESP_ERROR_CHECK(plant_advance(&sim.plant, simulation_now_ms()));
+    switch (channel) {
+        case SIMULATION_CHANNEL_EC:
+            value = plant_ec(&sim.plant);
+            break;
+        case SIMULATION_CHANNEL_PH:
+            value = plant_ph(&sim.plant);
+            break;
+        case SIMULATION_CHANNEL_WATER_TEMP:
+            value = plant_temp(&sim.plant);
+            break;
+        case SIMULATION_CHANNEL_TANK_LEVEL:
+            value = plant_level(&sim.plant);
+            break;
+        default:
+            break;
+    }
+    value += plant_noise(&sim.plant, threshold);
+    xSemaphoreGive(sim.lock);
+    return value;
+}
@@ -1,6 +1,31 @@
 #ifndef HYDROPONICS_SIMULATION_H
 #define HYDROPONICS_SIMULATION_H
 
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#include "config.pb-c.h"
+
 #define WITH_THRESHOLD(value, threshold) ((value) + (float) (random() % (long) ((threshold) * 1024 * 2)) / 1024.f - (threshold))
 
+typedef enum {
+    SIMULATION_CHANNEL_NONE = 0,       /*!< Not modelled, the fixed value is used. */
+    SIMULATION_CHANNEL_EC = 1,
+    SIMULATION_CHANNEL_PH = 2,
+    SIMULATION_CHANNEL_WATER_TEMP = 3,
+    SIMULATION_CHANNEL_TANK_LEVEL = 4, /*!< Fraction of the tank capacity. */
+} simulation_channel_t;
+
+esp_err_t simulation_init(void);
+
+// Feeds the outputs to the model, called by the io task for every output change.
+void simulation_set_output(Hydroponics__Output output, Hydroponics__OutputState state);
+
+// Virtual milliseconds since boot, CONFIG_ESP_SENSOR_SIMULATE_SPEED times faster than the wall clock.
+uint64_t simulation_now_ms(void);
+
+// Returns the modelled `channel` or `value` when it is not modelled, plus deterministic noise within `threshold`.
+float simulation_read(simulation_channel_t channel, float value, float threshold);
+
 #endif //HYDROPONICS_SIMULATION_H
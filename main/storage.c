@@ -1,13 +1,292 @@
+#include <string.h>
+#include <sys/param.h>
+#include <sys/queue.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
 #include "esp_err.h"
+#include "esp_log.h"
+#include "esp_system.h"
+#include "esp_timer.h"
 #include "nvs_flash.h"
 #include "nvs.h"
 
 #include "context.h"
 #include "error.h"
 #include "storage.h"
+#include "utils.h"
+
+#define STORAGE_FLUSH_DELAY_MS     2000  // Quiet time before dirty entries are written.
+#define STORAGE_FLUSH_MAX_DELAY_MS 10000 // Upper bound for a key that keeps being written.
+#define STORAGE_NVS_ENTRY_SIZE     32
+#define STORAGE_NVS_PAGE_ENTRIES   126
+#define STORAGE_CACHE_MAX_BYTES    4096  // Clean entries past this are evicted, least recently used first.
+
+typedef enum {
+    STORAGE_TYPE_STRING = 0,
+    STORAGE_TYPE_BLOB = 1,
+} storage_type_t;
+
+typedef struct entry {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    storage_type_t type;
+    bool missing;    /*!< Not in NVS, either never stored or deleted. */
+    bool dirty;      /*!< Differs from NVS until the next flush. */
+    uint8_t *data;   /*!< Strings keep their terminator, like nvs_get_str. */
+    size_t len;
+    TAILQ_ENTRY(entry) next;
+} entry_t;
+
+typedef TAILQ_HEAD(head, entry) head_t;
 
 static const char *TAG = "storage";
 static nvs_handle_t handle;
+static SemaphoreHandle_t lock = NULL;
+static head_t head;
+static esp_timer_handle_t flush_timer = NULL;
+static TaskHandle_t flush_task = NULL;
+static size_t cache_bytes = 0; /*!< Entries and their data. */
+static int64_t dirty_since_us = 0; /*!< When the oldest unflushed write happened, 0 when everything is flushed. */
+static storage_stats_t stats = {0};
+static uint32_t entries_written = 0;
+
+static inline size_t storage_entry_bytes(const entry_t *e) {
+    return sizeof(entry_t) + e->len;
+}
+
+// Moves the entry to the head, the tail is evicted first.
+static entry_t *storage_find(const char *key) {
+    entry_t *e = NULL;
+    TAILQ_FOREACH(e, &head, next) {
+        if (strncmp(e->key, key, sizeof(e->key)) == 0) {
+            TAILQ_REMOVE(&head, e, next);
+            TAILQ_INSERT_HEAD(&head, e, next);
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static entry_t *storage_entry(const char *key) {
+    entry_t *e = storage_find(key);
+    if (e != NULL) {
+        return e;
+    }
+    e = calloc(1, sizeof(entry_t));
+    if (e == NULL) {
+        return NULL;
+    }
+    strlcpy(e->key, key, sizeof(e->key));
+    e->missing = true;
+    TAILQ_INSERT_HEAD(&head, e, next);
+    cache_bytes += storage_entry_bytes(e);
+    return e;
+}
+
+static void storage_forget(entry_t *e) {
+    TAILQ_REMOVE(&head, e, next);
+    cache_bytes -= storage_entry_bytes(e);
+    SAFE_FREE(e->data);
+    SAFE_FREE(e);
+}
+
+static void storage_set_data(entry_t *e, uint8_t *data, size_t len) {
+    cache_bytes -= e->len;
+    SAFE_FREE(e->data);
+    e->data = data;
+    e->len = len;
+    cache_bytes += len;
+}
+
+// Dirty entries stay until they are flushed, a clean one is read again from NVS when needed.
+static void storage_evict(void) {
+    entry_t *e = TAILQ_LAST(&head, head);
+    while (e != NULL && cache_bytes > STORAGE_CACHE_MAX_BYTES) {
+        entry_t *prev = TAILQ_PREV(e, head, next);
+        if (!e->dirty) {
+            storage_forget(e);
+            stats.evictions++;
+        }
+        e = prev;
+    }
+}
+
+// Every item costs a header entry plus its data, blobs also write an index entry.
+static uint32_t storage_entries(storage_type_t type, size_t len) {
+    return 1 + (len + STORAGE_NVS_ENTRY_SIZE - 1) / STORAGE_NVS_ENTRY_SIZE + (type == STORAGE_TYPE_BLOB ? 1 : 0);
+}
+
+static esp_err_t storage_write(const entry_t *e) {
+    if (e->missing) {
+        esp_err_t err = nvs_erase_key(handle, e->key);
+        return err == ESP_ERR_NVS_NOT_FOUND ? ESP_OK : err;
+    }
+    esp_err_t err = e->type == STORAGE_TYPE_STRING ? nvs_set_str(handle, e->key, (const char *) e->data)
+                                                   : nvs_set_blob(handle, e->key, e->data, e->len);
+    if (err == ESP_OK) {
+        entries_written += storage_entries(e->type, e->len);
+        stats.bytes_written = entries_written * STORAGE_NVS_ENTRY_SIZE;
+        stats.erases = entries_written / STORAGE_NVS_PAGE_ENTRIES;
+    }
+    return err;
+}
+
+static esp_err_t storage_flush_locked(void) {
+    size_t written = 0;
+    entry_t *e = NULL;
+    TAILQ_FOREACH(e, &head, next) {
+        if (!e->dirty) {
+            continue;
+        }
+        esp_err_t err = storage_write(e);
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Unable to write '%s': %s", e->key, esp_err_to_name(err));
+            return err;
+        }
+        e->dirty = false;
+        written++;
+    }
+    dirty_since_us = 0;
+    storage_evict();
+    if (written == 0) {
+        return ESP_OK;
+    }
+    stats.commits++;
+    return nvs_commit(handle);
+}
+
+// NVS writes can stall for a page erase, they are kept out of the esp_timer task.
+static void storage_flush_callback(void *arg) {
+    ARG_UNUSED(arg);
+    xTaskNotifyGive(flush_task);
+}
+
+static void storage_flush_task(void *arg) {
+    ARG_UNUSED(arg);
+    while (true) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        esp_err_t err = storage_flush();
+        if (err != ESP_OK) {
+            ESP_LOGE(TAG, "Flush failed: %s", esp_err_to_name(err));
+        }
+    }
+}
+
+static void storage_shutdown(void) {
+    esp_err_t err = storage_flush();
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Flush failed: %s", esp_err_to_name(err));
+    }
+}
+
+// Every write pushes the flush back, up to STORAGE_FLUSH_MAX_DELAY_MS after the first unflushed one.
+static void storage_schedule_flush(void) {
+    int64_t now = esp_timer_get_time();
+    if (dirty_since_us == 0) {
+        dirty_since_us = now;
+    }
+    int64_t left_us = (int64_t) STORAGE_FLUSH_MAX_DELAY_MS * 1000 - (now - dirty_since_us);
+    int64_t delay_us = MIN((int64_t) STORAGE_FLUSH_DELAY_MS * 1000, MAX(left_us, 0));
+    esp_timer_stop(flush_timer);
+    ESP_ERROR_CHECK(esp_timer_start_once(flush_timer, delay_us));
+}
+
+// Reads a key through the cache, a key that is not in NVS is cached as missing.
+static esp_err_t storage_load(const char *key, storage_type_t type, entry_t **out) {
+    entry_t *e = storage_find(key);
+    if (e == NULL) {
+        e = storage_entry(key);
+        if (e == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        size_t len = 0;
+        esp_err_t err = type == STORAGE_TYPE_STRING ? nvs_get_str(handle, key, NULL, &len)
+                                                    : nvs_get_blob(handle, key, NULL, &len);
+        if (err == ESP_OK) {
+            uint8_t *data = malloc(MAX(len, 1));
+            err = data == NULL ? ESP_ERR_NO_MEM
+                               : type == STORAGE_TYPE_STRING ? nvs_get_str(handle, key, (char *) data, &len)
+                                                             : nvs_get_blob(handle, key, data, &len);
+            storage_set_data(e, data, len);
+            e->type = type;
+            e->missing = false;
+        }
+        if (err != ESP_OK && err != ESP_ERR_NVS_NOT_FOUND) {
+            storage_forget(e);
+            return err;
+        }
+    }
+    *out = e;
+    return !e->missing && e->type != type ? ESP_ERR_NVS_TYPE_MISMATCH : ESP_OK;
+}
+
+static esp_err_t storage_get(const char *key, storage_type_t type, uint8_t **buf, size_t *length) {
+    ARG_CHECK(key != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(buf != NULL, ERR_PARAM_NULL);
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    entry_t *e = NULL;
+    esp_err_t err = storage_load(key, type, &e);
+    if (err != ESP_OK || e->missing) {
+        // Like NVS, a missing key leaves the buffer untouched so callers can keep their default.
+        storage_evict();
+        xSemaphoreGive(lock);
+        return err;
+    }
+    *buf = malloc(e->len);
+    if (*buf == NULL) {
+        xSemaphoreGive(lock);
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(*buf, e->data, e->len);
+    if (length != NULL) {
+        *length = e->len;
+    }
+    storage_evict();
+    xSemaphoreGive(lock);
+    return ESP_OK;
+}
+
+static esp_err_t storage_set(const char *key, storage_type_t type, const uint8_t *buf, size_t length) {
+    ARG_CHECK(key != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(strlen(key) < NVS_KEY_NAME_MAX_SIZE, "key '%s' is too long", key);
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    stats.writes++;
+    stats.bytes_requested += length;
+    entry_t *e = NULL;
+    esp_err_t err = storage_load(key, type, &e);
+    if (err != ESP_OK && err != ESP_ERR_NVS_TYPE_MISMATCH) {
+        xSemaphoreGive(lock);
+        return err;
+    }
+    if (err == ESP_OK && !e->missing && e->len == length && memcmp(e->data, buf, length) == 0) {
+        // Same value, nothing to write.
+        stats.coalesced++;
+        xSemaphoreGive(lock);
+        return ESP_OK;
+    }
+    uint8_t *data = malloc(MAX(length, 1));
+    if (data == NULL) {
+        xSemaphoreGive(lock);
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(data, buf, length);
+    if (e->dirty) {
+        // Overwritten before it ever reached the flash.
+        stats.coalesced++;
+    }
+    storage_set_data(e, data, length);
+    e->type = type;
+    e->missing = false;
+    e->dirty = true;
+    storage_schedule_flush();
+    storage_evict();
+    xSemaphoreGive(lock);
+    return ESP_OK;
+}
 
 esp_err_t storage_init(context_t *context) {
     ARG_UNUSED(context);
@@ -20,65 +299,78 @@ esp_err_t storage_init(context_t *context) {
     }
     ESP_ERROR_CHECK(err);
     ESP_ERROR_CHECK(nvs_open("storage", NVS_READWRITE, &handle));
+
+    TAILQ_INIT(&head);
+    lock = xSemaphoreCreateMutex();
+    CHECK_NO_MEM(lock);
+    esp_timer_create_args_t args = {
+            .callback = storage_flush_callback,
+            .name = "storage",
+    };
+    ESP_ERROR_CHECK(esp_timer_create(&args, &flush_timer));
+    xTaskCreatePinnedToCore(storage_flush_task, "storage", 3072, NULL, tskIDLE_PRIORITY + 5, &flush_task,
+                            tskNO_AFFINITY);
+    CHECK_NO_MEM(flush_task);
+    // Pending writes must survive esp_restart().
+    ESP_ERROR_CHECK(esp_register_shutdown_handler(storage_shutdown));
     return ESP_OK;
 }
 
 esp_err_t storage_get_string(const char *key, char **buf, size_t *length) {
-    ARG_CHECK(buf != NULL, ERR_PARAM_NULL);
-    size_t len = 0;
-    esp_err_t err = nvs_get_str(handle, key, NULL, &len);
-    switch (err) {
-        case ESP_OK:
-            *buf = malloc(len);
-            if (*buf == NULL) {
-                return ESP_ERR_NO_MEM;
-            }
-            if (length != NULL) {
-                *length = len;
-            }
-            return nvs_get_str(handle, key, *buf, &len);
-        case ESP_ERR_NVS_NOT_FOUND:
-            return ESP_OK;
-        default:
-            return err;
-    }
+    return storage_get(key, STORAGE_TYPE_STRING, (uint8_t **) buf, length);
 }
 
 esp_err_t storage_set_string(const char *key, const char *buf) {
-    esp_err_t err = nvs_set_str(handle, key, buf);
-    return err == ESP_OK ? nvs_commit(handle) : err;
+    ARG_CHECK(buf != NULL, ERR_PARAM_NULL);
+    return storage_set(key, STORAGE_TYPE_STRING, (const uint8_t *) buf, strlen(buf) + 1);
 }
 
 esp_err_t storage_get_blob(const char *key, uint8_t **buf, size_t *length) {
-    ARG_CHECK(buf != NULL, ERR_PARAM_NULL);
-    size_t len = 0;
-    esp_err_t err = nvs_get_blob(handle, key, NULL, &len);
-    switch (err) {
-        case ESP_OK:
-            *buf = malloc(len);
-            if (*buf == NULL) {
-                return ESP_ERR_NO_MEM;
-            }
-            if (length != NULL) {
-                *length = len;
-            }
-            return nvs_get_blob(handle, key, *buf, &len);
-        case ESP_ERR_NVS_NOT_FOUND:
-            return ESP_OK;
-        default:
-            return err;
-    }
+    return storage_get(key, STORAGE_TYPE_BLOB, buf, length);
 }
 
 esp_err_t storage_set_blob(const char *key, const uint8_t *buf, size_t length) {
-    esp_err_t err = nvs_set_blob(handle, key, buf, length);
-    return err == ESP_OK ? nvs_commit(handle) : err;
+    ARG_CHECK(buf != NULL || length == 0, ERR_PARAM_NULL);
+    return storage_set(key, STORAGE_TYPE_BLOB, buf, length);
 }
 
 esp_err_t storage_delete(const char *key) {
-    esp_err_t err = nvs_erase_key(handle, key);
-    if (err == ESP_ERR_NVS_NOT_FOUND) {
-        return ESP_OK;
+    ARG_CHECK(key != NULL, ERR_PARAM_NULL);
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    stats.writes++;
+    entry_t *e = storage_entry(key);
+    if (e == NULL) {
+        xSemaphoreGive(lock);
+        return ESP_ERR_NO_MEM;
+    }
+    if (e->dirty) {
+        stats.coalesced++;
     }
-    return err == ESP_OK ? nvs_commit(handle) : err;
+    // Unknown keys are erased anyway, they may be in NVS without ever being read.
+    storage_set_data(e, NULL, 0);
+    e->missing = true;
+    e->dirty = true;
+    storage_schedule_flush();
+    xSemaphoreGive(lock);
+    return ESP_OK;
+}
+
+esp_err_t storage_flush(void) {
+    ARG_CHECK(lock != NULL, "storage not initialized");
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    esp_timer_stop(flush_timer);
+    esp_err_t err = storage_flush_locked();
+    xSemaphoreGive(lock);
+    return err;
+}
+
+esp_err_t storage_get_stats(storage_stats_t *out) {
+    ARG_CHECK(out != NULL, ERR_PARAM_NULL);
+
+    xSemaphoreTake(lock, portMAX_DELAY);
+    *out = stats;
+    xSemaphoreGive(lock);
+    return ESP_OK;
 }
@@ -9,6 +9,17 @@
 #define STORAGE_KEY_WIFI_PASSWORD "wifi_password"
 #define STORAGE_KEY_CONFIG_HASH   "config_hash"
 #define STORAGE_KEY_CONFIG        "config"
+#define STORAGE_KEY_EZO_CAL_FMT   "cal_%s" // Followed by the module description.
+
+typedef struct {
+    uint32_t writes;          /*!< storage_set_* and storage_delete calls. */
+    uint32_t coalesced;       /*!< Writes that never reached the flash, unchanged or overwritten before a flush. */
+    uint32_t commits;
+    uint32_t bytes_requested; /*!< Payload of every storage_set_* call. */
+    uint32_t bytes_written;   /*!< NVS entries written to the flash, including their headers. */
+    uint32_t erases;          /*!< Estimated page erases, from the entries written. */
+    uint32_t evictions;       /*!< Clean entries dropped from the cache, read again from NVS when needed. */
+} storage_stats_t;
 
 esp_err_t storage_init(context_t *context);
 
@@ -22,4 +33,10 @@ esp_err_t storage_set_blob(const char *key, const uint8_t *buf, size_t length);
 
 esp_err_t storage_delete(const char *key);
 
+// Writes are cached in RAM and flushed once the key stops changing, at most a few seconds later, or on esp_restart().
+// Call it after a write that must survive a power loss.
+esp_err_t storage_flush(void);
+
+esp_err_t storage_get_stats(storage_stats_t *stats);
+
 #endif //HYDROPONICS_DRIVER_STORAGE_H
@@ -1,12 +1,15 @@
+#include <stdio.h>
 #include <string.h>
 #include <sys/queue.h>
 
 #include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
 
 #include "esp_err.h"
 
 #include "buses.h"
 #include "config.h"
+#include "config_diff.h"
 #include "context.h"
 #include "cron.h"
 #include "driver/ext_gpio.h"
@@ -14,9 +17,14 @@
 #include "io.h"
 #include "network/iot.h"
 #include "network/state.h"
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+#include "simulation.h"
+#endif
 #include "tasks/tuya_io.h"
 #include "utils.h"
 
+#define IO_GROUP_LEN 16
+
 typedef struct {
     Hydroponics__OutputState state;
     size_t n_output;
@@ -27,6 +35,7 @@ typedef struct {
 typedef struct entry {
     cron_handle_t handle;
     io_cron_args_t *cron_args;
+    char group[IO_GROUP_LEN];   /*!< Cron group of the task that owns the schedule, empty for impulses. */
     TAILQ_ENTRY(entry) next;
 } entry_t;
 
@@ -54,6 +63,8 @@ typedef struct {
 static const char *TAG = "io";
 static QueueHandle_t queue;
 static head_t head;
+static SemaphoreHandle_t head_lock = NULL; /*!< Guards head, cron workers run the callbacks concurrently. */
+static const Hydroponics__Config *applied = NULL; /*!< Config the outputs and schedules currently follow. */
 
 static esp_err_t io_cron_args_create(io_cron_args_t **cron_args, const size_t n_output,
                                      const Hydroponics__Output *output, const Hydroponics__OutputState state) {
@@ -95,33 +106,42 @@ static void io_generic_set(Hydroponics__Output output, Hydroponics__OutputState
     } else {
         ESP_LOGE(TAG, "Unknown output: %d", output);
     }
+#ifdef CONFIG_ESP_SENSOR_SIMULATE
+    simulation_set_output(output, state);
+#endif
 
     size_t buckets = 1;
     // FIXME: ESP_ERROR_CHECK(state_push_output(1, &buckets, &output, &state));
 }
 
 static void io_cron_callback(cron_handle_t handle, const char *name, void *data) {
-    io_cron_args_t *args = (io_cron_args_t *) data;
+    ARG_UNUSED(data);
+    xSemaphoreTake(head_lock, portMAX_DELAY);
+    // The io task may have replaced the schedule while this run was queued, its args are gone then.
+    entry_t *e = NULL;
+    TAILQ_FOREACH(e, &head, next) {
+        if (e->handle == handle) {
+            break;
+        }
+    }
+    if (e == NULL) {
+        xSemaphoreGive(head_lock);
+        return;
+    }
+    io_cron_args_t *args = e->cron_args;
     for (int i = 0; i < args->n_output; ++i) {
         ESP_LOGI(TAG, "io_cron_callback name: %s action: %3s output: %s", name,
                  enum_from_value(&hydroponics__output_state__descriptor, args->state),
                  enum_from_value(&hydroponics__output__descriptor, args->output[i]));
         io_generic_set(args->output[i], args->state);
     }
-    if (!args->single_shot) {
-        return;
-    }
-    entry_t *e = NULL, *tmp = NULL;
-    TAILQ_FOREACH_SAFE(e, &head, next, tmp) {
-        if (e->handle == handle) {
-            ESP_ERROR_CHECK(cron_delete(e->handle));
-            handle = INVALID_CRON_HANDLE;
-            ESP_ERROR_CHECK(io_cron_args_destroy(e->cron_args));
-            args = NULL;
-
-            TAILQ_REMOVE(&head, e, next);
-        }
+    if (args->single_shot) {
+        // Oneshots are destroyed by cron after the run, only the bookkeeping is left.
+        ESP_ERROR_CHECK(io_cron_args_destroy(args));
+        TAILQ_REMOVE(&head, e, next);
+        SAFE_FREE(e);
     }
+    xSemaphoreGive(head_lock);
 }
 
 static void io_config_callback(const Hydroponics__Config *config) {
@@ -129,6 +149,12 @@ static void io_config_callback(const Hydroponics__Config *config) {
     xQueueSend(queue, &cmd, portMAX_DELAY);
 }
 
+static void io_set_startup_state(const Hydroponics__StartupState *s) {
+    for (int j = 0; j < s->n_output; ++j) {
+        io_generic_set(s->output[j], s->state);
+    }
+}
+
 static void io_set_default_state(const Hydroponics__Config *config) {
     if (config == NULL || config->n_startup_state <= 0) {
         return;
@@ -143,9 +169,7 @@ static void io_set_default_state(const Hydroponics__Config *config) {
         buckets[i] = s->n_output;
         output_states[i] = s->state;
         max_outputs += s->n_output;
-        for (int j = 0; j < s->n_output; ++j) {
-            io_generic_set(s->output[j], s->state);
-        }
+        io_set_startup_state(s);
     }
     Hydroponics__Output outputs[max_outputs];
     max_outputs = 0;
@@ -163,67 +187,178 @@ static esp_err_t io_cron_add(const char *name, const char *expression, const siz
                              const Hydroponics__Output *output, const Hydroponics__OutputState state,
                              uint32_t delay_ms) {
     io_cron_args_t *cron_args = NULL;
-    cron_handle_t handle = INVALID_CRON_HANDLE;
     ESP_ERROR_CHECK(io_cron_args_create(&cron_args, n_output, output, state));
+    entry_t *e = calloc(1, sizeof(entry_t));
+    if (e == NULL) {
+        ESP_LOGE(TAG, "Error allocating entry_t for task %s", name);
+        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+    }
+    e->cron_args = cron_args;
+
+    // Held until the entry is tracked, a short oneshot can fire before cron hands the handle back.
+    xSemaphoreTake(head_lock, portMAX_DELAY);
     if (delay_ms > 0) {
         cron_args->single_shot = true;
         // Cleanup previous delayed schedules.
-        entry_t *e = NULL, *tmp = NULL;
-        TAILQ_FOREACH_SAFE(e, &head, next, tmp) {
-            if (cron_args->n_output == e->cron_args->n_output &&
-                memcmp(cron_args->output, e->cron_args->output,
-                       cron_args->n_output * sizeof(e->cron_args->output)) == 0) {
-                ESP_ERROR_CHECK(cron_delete(e->handle));
-                ESP_ERROR_CHECK(io_cron_args_destroy(e->cron_args));
-                TAILQ_REMOVE(&head, e, next);
+        entry_t *p = NULL, *tmp = NULL;
+        TAILQ_FOREACH_SAFE(p, &head, next, tmp) {
+            if (p->cron_args->single_shot && cron_args->n_output == p->cron_args->n_output &&
+                memcmp(cron_args->output, p->cron_args->output,
+                       cron_args->n_output * sizeof(Hydroponics__Output)) == 0) {
+                ESP_ERROR_CHECK(cron_delete(p->handle));
+                ESP_ERROR_CHECK(io_cron_args_destroy(p->cron_args));
+                TAILQ_REMOVE(&head, p, next);
+                SAFE_FREE(p);
                 ESP_LOGI(TAG, "Replaced single shot");
             }
         }
-        ESP_ERROR_CHECK(cron_schedule_in(name, delay_ms, io_cron_callback, cron_args, &handle));
+        // Outputs must not wait behind slow monitoring jobs.
+        ESP_ERROR_CHECK(cron_schedule_in_with_priority(name, delay_ms, CRON_PRIORITY_HIGH, io_cron_callback,
+                                                       cron_args, &e->handle));
     } else {
-        ESP_ERROR_CHECK(cron_create(name, expression, io_cron_callback, cron_args, &handle));
-    }
-    entry_t *e = calloc(1, sizeof(entry_t));
-    if (e == NULL) {
-        ESP_LOGE(TAG, "Error allocating entry_t for task %s", name);
-        ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+        ESP_ERROR_CHECK(cron_create_with_priority(name, expression, CRON_PRIORITY_HIGH, io_cron_callback, cron_args,
+                                                  &e->handle));
     }
-    e->handle = handle;
-    e->cron_args = cron_args;
     TAILQ_INSERT_HEAD(&head, e, next);
+    xSemaphoreGive(head_lock);
 
     return ESP_OK;
 }
 
+// Every task owns a cron group named after it, so a task can be rescheduled without touching the others. Task names
+// are expected to be unique.
+static void io_task_group(const char *name, char *group) {
+    uint32_t hash = 2166136261u; // FNV-1a.
+    for (const char *c = name != NULL ? name : ""; *c != '\0'; ++c) {
+        hash = (hash ^ (uint8_t) *c) * 16777619u;
+    }
+    snprintf(group, IO_GROUP_LEN, "%s_%08x", TAG, hash);
+}
+
+static size_t io_count_expressions(const Hydroponics__Task *task) {
+    size_t n = 0;
+    for (int j = 0; task != NULL && j < task->n_cron; ++j) {
+        n += task->cron[j]->n_expression;
+    }
+    return n;
+}
+
+// Replaces the schedules of a single task, a NULL task removes them.
+static esp_err_t io_replace_task(const char *group, const Hydroponics__Task *task) {
+    size_t n = io_count_expressions(task);
+    cron_spec_t *specs = calloc(n, sizeof(cron_spec_t));
+    cron_expr *exprs = calloc(n, sizeof(cron_expr));
+    cron_handle_t *handles = calloc(n, sizeof(cron_handle_t));
+    if (n > 0 && (specs == NULL || exprs == NULL || handles == NULL)) {
+        SAFE_FREE(specs);
+        SAFE_FREE(exprs);
+        SAFE_FREE(handles);
+        return ESP_ERR_NO_MEM;
+    }
+
+    // Parse everything up front, the whole group is then swapped in a single cron operation.
+    size_t count = 0;
+    for (int j = 0; task != NULL && j < task->n_cron; ++j) {
+        const Hydroponics__Task__Cron *cron = task->cron[j];
+        for (int k = 0; k < cron->n_expression; ++k) {
+            if (cron_parse(cron->expression[k], &exprs[count]) != ESP_OK) {
+                ESP_LOGE(TAG, "Skipping task %s expression: %s", task->name, cron->expression[k]);
+                continue;
+            }
+            io_cron_args_t *cron_args = NULL;
+            ESP_ERROR_CHECK(io_cron_args_create(&cron_args, task->n_output, task->output, cron->state));
+            specs[count] = (cron_spec_t) {
+                    .name = task->name,
+                    .expression = cron->expression[k],
+                    .expr = &exprs[count],
+                    .callback = io_cron_callback,
+                    .data = cron_args,
+                    // Outputs must not wait behind slow monitoring jobs.
+                    .priority = CRON_PRIORITY_HIGH,
+                    .misfire = CRON_MISFIRE_FIRE_ONCE,
+            };
+            count++;
+        }
+    }
+
+    xSemaphoreTake(head_lock, portMAX_DELAY);
+    esp_err_t err = cron_replace_group(group, specs, count, handles);
+    if (err == ESP_OK) {
+        // The previous schedules of the group are gone, release them and track the new ones.
+        entry_t *e = NULL, *tmp = NULL;
+        TAILQ_FOREACH_SAFE(e, &head, next, tmp) {
+            if (strcmp(e->group, group) == 0) {
+                ESP_ERROR_CHECK(io_cron_args_destroy(e->cron_args));
+                TAILQ_REMOVE(&head, e, next);
+                SAFE_FREE(e);
+            }
+        }
+        for (size_t i = 0; i < count; ++i) {
+            e = calloc(1, sizeof(entry_t));
+            if (e == NULL) {
+                ESP_LOGE(TAG, "Error allocating entry_t for task %s", specs[i].name);
+                ESP_ERROR_CHECK(ESP_ERR_NO_MEM);
+            }
+            e->handle = handles[i];
+            e->cron_args = specs[i].data;
+            strlcpy(e->group, group, sizeof(e->group));
+            TAILQ_INSERT_HEAD(&head, e, next);
+        }
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            ESP_ERROR_CHECK(io_cron_args_destroy(specs[i].data));
+        }
+    }
+    xSemaphoreGive(head_lock);
+    SAFE_FREE(specs);
+    SAFE_FREE(exprs);
+    SAFE_FREE(handles);
+    return err;
+}
+
+// Only the sections that changed are applied. Outputs are only driven for the startup states that were added or
+// changed, a config that only touches e.g. the sampling periods leaves every output and schedule alone.
 static void io_apply_config(const Hydroponics__Config *config) {
     ESP_LOGI(TAG, "Applying config...");
+    config_diff_t diff = {0};
+    ESP_ERROR_CHECK(config_diff(applied, config, &diff));
+    config_diff_dump(TAG, &diff);
 
-    // Clear previous registrations.
-    entry_t *e = NULL, *tmp = NULL;
-    TAILQ_FOREACH_SAFE(e, &head, next, tmp) {
-        ESP_ERROR_CHECK(cron_delete(e->handle));
-        ESP_ERROR_CHECK(io_cron_args_destroy(e->cron_args));
-        TAILQ_REMOVE(&head, e, next);
-    }
-    io_set_default_state(config);
-    if (config != NULL && config->n_task > 0) {
-        // Register the new tasks.
-        for (int i = 0; i < config->n_task; ++i) {
-            const Hydroponics__Task *task = config->task[i];
-            for (int j = 0; j < task->n_cron; ++j) {
-                const Hydroponics__Task__Cron *cron = task->cron[j];
-                for (int k = 0; k < cron->n_expression; ++k) {
-                    ESP_ERROR_CHECK(io_cron_add(task->name, cron->expression[k], task->n_output, task->output,
-                                                cron->state, 0));
-                }
+    if (applied == NULL) {
+        io_set_default_state(config);
+    } else {
+        const config_diff_section_t *startup = config_diff_section(&diff, CONFIG_SECTION_STARTUP_STATE);
+        for (size_t i = 0; i < startup->n_entry; ++i) {
+            if (startup->entry[i].kind != CONFIG_DIFF_REMOVED) {
+                io_set_startup_state(config->startup_state[startup->entry[i].new_index]);
             }
         }
     }
-    // Free the copied config proto.
-    if (config != NULL) {
-        hydroponics__config__free_unpacked((Hydroponics__Config *) config, NULL);
-        config = NULL;
+
+    char group[IO_GROUP_LEN];
+    const config_diff_section_t *tasks = config_diff_section(&diff, CONFIG_SECTION_TASK);
+    for (size_t i = 0; i < tasks->n_entry; ++i) {
+        const config_diff_entry_t *entry = &tasks->entry[i];
+        esp_err_t err = ESP_OK;
+        if (entry->kind == CONFIG_DIFF_REMOVED) {
+            io_task_group(applied->task[entry->old_index]->name, group);
+            err = io_replace_task(group, NULL);
+        } else {
+            const Hydroponics__Task *task = config->task[entry->new_index];
+            io_task_group(task->name, group);
+            err = io_replace_task(group, task);
+        }
+        if (err != ESP_OK) {
+            ESP_ERROR_CHECK(config_report_failure(TAG, err));
+        }
+    }
+    config_diff_free(&diff);
+
+    // Keep the copied config proto, the next one is compared against it.
+    if (applied != NULL) {
+        context_config_release(applied);
     }
+    applied = config;
 }
 
 static void io_task(void *arg) {
@@ -266,6 +401,8 @@ static void io_task(void *arg) {
 
 esp_err_t io_init(context_t *context) {
     TAILQ_INIT(&head);
+    head_lock = xSemaphoreCreateMutex();
+    CHECK_NO_MEM(head_lock);
 
     queue = xQueueCreate(32, sizeof(op_t));
     CHECK_NO_MEM(queue);
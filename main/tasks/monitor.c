@@ -9,13 +9,19 @@
 
 #include "cron.h"
 #include "error.h"
+#include "i2c_bus.h"
 #include "monitor.h"
 #include "network/state.h"
+#include "network/syslog.h"
+#include "sensors/sensors.h"
+#include "storage.h"
 #include "utils.h"
 
 #define MONITOR_CRON_MEMORY "0 * * * * *"    // Once every minute.
 #define MONITOR_CRON_WIFI   "*/30 * * * * *" // Once every 30s.
 #define MONITOR_CRON_TASKS  "0 */2 * * * *"  // Once every 2 minutes.
+#define MONITOR_CRON_CRON   "0 */5 * * * *"  // Once every 5 minutes.
+#define MONITOR_CRON_HEALTH "30 * * * * *"   // Once every minute.
 
 static const char *const TAG = "monitor";
 static const uint8_t STATES[] = {'R', '*', 'B', 'S', 'D', '?'};
@@ -92,6 +98,7 @@ static void monitor_tasks_callback(cron_handle_t handle, const char *name, void
         // FIXME: disabled ESP_ERROR_CHECK(monitor_post_state(tasks, size, total_runtime_percentage));
     }
     SAFE_FREE(tasks);
+    i2c_bus_dump();
 }
 
 static void monitor_memory_callback(cron_handle_t handle, const char *name, void *data) {
@@ -103,6 +110,19 @@ static void monitor_memory_callback(cron_handle_t handle, const char *name, void
     uint32_t free = esp_get_free_heap_size();
     ESP_LOGI(TAG, "Minimum free heap: %d    free heap: %d", min_free, free);
 
+    syslog_stats_t syslog = {0};
+    if (syslog_get_stats(&syslog) == ESP_OK && (syslog.dropped > 0 || syslog.limited > 0)) {
+        ESP_LOGW(TAG, "Syslog lines: %u    dropped: %u    limited: %u", syslog.lines, syslog.dropped, syslog.limited);
+    }
+
+    storage_stats_t stats = {0};
+    if (storage_get_stats(&stats) == ESP_OK && stats.bytes_requested > 0) {
+        ESP_LOGI(TAG, "NVS writes: %u    coalesced: %u    commits: %u    erases: ~%u    evicted: %u    "
+                      "amplification: %.2f",
+                 stats.writes, stats.coalesced, stats.commits, stats.erases, stats.evictions,
+                 (float) stats.bytes_written / (float) stats.bytes_requested);
+    }
+
     // FIXME: ESP_ERROR_CHECK(state_push_memory(min_free, free));
 }
 
@@ -118,10 +138,71 @@ static void monitor_wifi_callback(cron_handle_t handle, const char *name, void *
     ESP_LOGI(TAG, "Wifi rssi: %d", record.rssi);
 }
 
+static void monitor_cron_callback(cron_handle_t handle, const char *name, void *data) {
+    ARG_UNUSED(handle);
+    ARG_UNUSED(name);
+    ARG_UNUSED(data);
+
+    cron_info_t *infos = calloc(CONFIG_ESP_CRON_MAX_JOBS, sizeof(cron_info_t));
+    if (infos == NULL) {
+        ESP_LOGE(TAG, "Error allocating memory for the cron monitor");
+        return;
+    }
+    size_t count = 0;
+    if (cron_dump(infos, CONFIG_ESP_CRON_MAX_JOBS, &count) == ESP_OK) {
+        uint32_t overruns = 0, misfires = 0;
+        for (size_t i = 0; i < count; ++i) {
+            overruns += infos[i].stats.overruns;
+            misfires += infos[i].stats.misfires;
+        }
+        ESP_LOGI(TAG, "Cron jobs: %u    overruns: %u    misfires: %u", count, overruns, misfires);
+        // Dropped like any other report when the iot buffer is full.
+        esp_err_t err = state_push_cron(infos, count);
+        if (err != ESP_OK) {
+            ESP_LOGW(TAG, "Cron state not published: %s", esp_err_to_name(err));
+        }
+    }
+    SAFE_FREE(infos);
+}
+
+static void monitor_health_callback(cron_handle_t handle, const char *name, void *data) {
+    ARG_UNUSED(handle);
+    ARG_UNUSED(name);
+    ARG_UNUSED(data);
+
+    sensors_health_t health[SENSORS_MAX_DRIVERS];
+    size_t count = 0;
+    esp_err_t err = sensors_get_health(health, SENSORS_MAX_DRIVERS, &count);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Sensors health not available: %s", esp_err_to_name(err));
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        const health_t *h = &health[i].health;
+        if (h->status != HEALTH_STATUS_OK) {
+            ESP_LOGW(TAG, "Sensor %s: %s (%s)    errors: %u    recoveries: %u", health[i].name,
+                     health_status_name(h->status), health_fault_name(h->fault), h->errors, h->recoveries);
+        }
+    }
+    // Dropped like any other report when the iot buffer is full.
+    err = state_push_health(health, count);
+    if (err != ESP_OK) {
+        ESP_LOGW(TAG, "Health state not published: %s", esp_err_to_name(err));
+    }
+}
+
 esp_err_t monitor_init(context_t *context) {
     ARG_UNUSED(context);
-    ESP_ERROR_CHECK(cron_create("monitor_wifi", MONITOR_CRON_WIFI, monitor_wifi_callback, NULL, NULL));
-    ESP_ERROR_CHECK(cron_create("monitor_memory", MONITOR_CRON_MEMORY, monitor_memory_callback, NULL, NULL));
-    ESP_ERROR_CHECK(cron_create("monitor_tasks", MONITOR_CRON_TASKS, monitor_tasks_callback, NULL, NULL));
+    // Missed samples are worthless, just wait for the next one.
+    ESP_ERROR_CHECK(cron_create_with_misfire("monitor_wifi", MONITOR_CRON_WIFI, CRON_PRIORITY_NORMAL, CRON_MISFIRE_SKIP,
+                                             monitor_wifi_callback, NULL, NULL));
+    ESP_ERROR_CHECK(cron_create_with_misfire("monitor_memory", MONITOR_CRON_MEMORY, CRON_PRIORITY_NORMAL,
+                                             CRON_MISFIRE_SKIP, monitor_memory_callback, NULL, NULL));
+    ESP_ERROR_CHECK(cron_create_with_misfire("monitor_tasks", MONITOR_CRON_TASKS, CRON_PRIORITY_NORMAL,
+                                             CRON_MISFIRE_SKIP, monitor_tasks_callback, NULL, NULL));
+    ESP_ERROR_CHECK(cron_create_with_misfire("monitor_cron", MONITOR_CRON_CRON, CRON_PRIORITY_NORMAL, CRON_MISFIRE_SKIP,
+                                             monitor_cron_callback, NULL, NULL));
+    ESP_ERROR_CHECK(cron_create_with_misfire("monitor_health", MONITOR_CRON_HEALTH, CRON_PRIORITY_NORMAL,
+                                             CRON_MISFIRE_SKIP, monitor_health_callback, NULL, NULL));
     return ESP_OK;
 }
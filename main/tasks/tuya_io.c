@@ -165,7 +165,7 @@ static void tuya_task(void *arg) {
             switch (op.type) {
                 case OP_CONFIG: { // Re-load config.
                     if (config != NULL) {
-                        hydroponics__config__free_unpacked((Hydroponics__Config *) config, NULL);
+                        context_config_release(config);
                     }
                     config = op.config.config;
                     break;
@@ -0,0 +1,157 @@
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ccronexpr.h"
+
+// Host stand-in for esp-ccronexpr, which is not part of the tree. Parses the numeric subset the configs use:
+// six fields of `*`, values, ranges and steps separated by commas. Names, `?`, `L` and `W` are refused.
+#define CRON_SEARCH_STEPS 100000
+
+typedef struct {
+    uint8_t *bits;
+    int min;
+    int max;
+} field_t;
+
+static void set_bit(uint8_t *bits, int n) {
+    bits[n / 8] |= (uint8_t) (1 << (n % 8));
+}
+
+static bool has_bit(const uint8_t *bits, int n) {
+    return (bits[n / 8] & (1 << (n % 8))) != 0;
+}
+
+static bool day_matches(const cron_expr *expr, const struct tm *tm) {
+    bool dow = has_bit(expr->days_of_week, tm->tm_wday) || (tm->tm_wday == 0 && has_bit(expr->days_of_week, 7));
+    return has_bit(expr->months, tm->tm_mon + 1) && has_bit(expr->days_of_month, tm->tm_mday) && dow;
+}
+
+static const char *parse_number(const char *s, int *value) {
+    if (!isdigit((unsigned char) *s)) {
+        return NULL;
+    }
+    char *end = NULL;
+    long v = strtol(s, &end, 10);
+    if (v > 1000) {
+        return NULL;
+    }
+    *value = (int) v;
+    return end;
+}
+
+static const char *parse_item(const char *s, const field_t *f) {
+    int from = f->min, to = f->max, step = 1;
+    if (*s == '*') {
+        s++;
+    } else {
+        if ((s = parse_number(s, &from)) == NULL) {
+            return NULL;
+        }
+        to = from;
+        if (*s == '-' && (s = parse_number(s + 1, &to)) == NULL) {
+            return NULL;
+        }
+    }
+    if (*s == '/') {
+        if ((s = parse_number(s + 1, &step)) == NULL || step == 0) {
+            return NULL;
+        }
+        if (from == to) {
+            to = f->max;
+        }
+    }
+    if (from < f->min || to > f->max || from > to) {
+        return NULL;
+    }
+    for (int i = from; i <= to; i += step) {
+        set_bit(f->bits, i);
+    }
+    return s;
+}
+
+void cron_parse_expr(const char *expression, cron_expr *target, const char **error) {
+    *error = NULL;
+    if (expression == NULL) {
+        *error = "Invalid NULL expression";
+        return;
+    }
+    memset(target, 0, sizeof(*target));
+    const field_t fields[] = {
+            {target->seconds, 0, 59},
+            {target->minutes, 0, 59},
+            {target->hours, 0, 23},
+            {target->days_of_month, 1, 31},
+            {target->months, 1, 12},
+            {target->days_of_week, 0, 7},
+    };
+    const char *s = expression;
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+        while (*s == ' ') {
+            s++;
+        }
+        do {
+            if ((s = parse_item(*s == ',' ? s + 1 : s, &fields[i])) == NULL) {
+                *error = "Invalid field";
+                return;
+            }
+        } while (*s == ',');
+        if (*s != ' ' && *s != '\0') {
+            *error = "Invalid field";
+            return;
+        }
+    }
+    while (*s == ' ') {
+        s++;
+    }
+    if (*s != '\0') {
+        *error = "Invalid number of fields, expression must consist of 6 fields";
+    }
+}
+
+// Below a day the search moves on time_t, so a local hour repeated when DST ends matches twice like on the device.
+time_t cron_next(cron_expr *expr, time_t date) {
+    time_t t = date + 1;
+    for (int i = 0; i < CRON_SEARCH_STEPS; ++i) {
+        struct tm tm;
+        localtime_r(&t, &tm);
+        if (!day_matches(expr, &tm)) {
+            tm.tm_mday++;
+            tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+            tm.tm_isdst = -1;
+            t = mktime(&tm);
+        } else if (!has_bit(expr->hours, tm.tm_hour)) {
+            t += 3600 - tm.tm_min * 60 - tm.tm_sec;
+        } else if (!has_bit(expr->minutes, tm.tm_min)) {
+            t += 60 - tm.tm_sec;
+        } else if (!has_bit(expr->seconds, tm.tm_sec)) {
+            t++;
+        } else {
+            return t;
+        }
+    }
+    return (time_t) -1;
+}
+
+time_t cron_prev(cron_expr *expr, time_t date) {
+    time_t t = date - 1;
+    for (int i = 0; i < CRON_SEARCH_STEPS; ++i) {
+        struct tm tm;
+        localtime_r(&t, &tm);
+        if (!day_matches(expr, &tm)) {
+            tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+            tm.tm_isdst = -1;
+            t = mktime(&tm) - 1;
+        } else if (!has_bit(expr->hours, tm.tm_hour)) {
+            t -= tm.tm_min * 60 + tm.tm_sec + 1;
+        } else if (!has_bit(expr->minutes, tm.tm_min)) {
+            t -= tm.tm_sec + 1;
+        } else if (!has_bit(expr->seconds, tm.tm_sec)) {
+            t--;
+        } else {
+            return t;
+        }
+    }
+    return (time_t) -1;
+}
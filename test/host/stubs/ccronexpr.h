@@ -0,0 +1,25 @@
+#ifndef HYDROPONICS_TEST_HOST_CCRONEXPR_H
+#define HYDROPONICS_TEST_HOST_CCRONEXPR_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Same layout as esp-ccronexpr, the fields are bit sets.
+typedef struct {
+    uint8_t seconds[8];
+    uint8_t minutes[8];
+    uint8_t hours[3];
+    uint8_t days_of_week[1];
+    uint8_t days_of_month[4];
+    uint8_t months[2];
+} cron_expr;
+
+void cron_parse_expr(const char *expression, cron_expr *target, const char **error);
+
+// First match after `date` in local time, -1 if there is none within a few years.
+time_t cron_next(cron_expr *expr, time_t date);
+
+// Last match before `date` in local time, -1 if there is none within a few years.
+time_t cron_prev(cron_expr *expr, time_t date);
+
+#endif //HYDROPONICS_TEST_HOST_CCRONEXPR_H
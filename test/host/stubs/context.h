@@ -0,0 +1,53 @@
+#ifndef HYDROPONICS_TEST_HOST_CONTEXT_H
+#define HYDROPONICS_TEST_HOST_CONTEXT_H
+
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+#include "esp_err.h"
+
+// Not every test links the generated messages.
+typedef struct Hydroponics__Config Hydroponics__Config;
+
+#define CONTEXT_UNKNOWN_VALUE INT16_MIN
+#define CONTEXT_VALUE_IS_VALID(x) ((x) != CONTEXT_UNKNOWN_VALUE)
+
+// Stands in for the context component, only the fields and bits the units under test use. The real one needs the
+// rotary encoder submodule.
+typedef enum {
+    CONTEXT_EVENT_NETWORK = 1 << 11,     /*!< Updated network state. */
+    CONTEXT_EVENT_TIME = 1 << 12,        /*!< Updated network time. */
+    CONTEXT_EVENT_BASE_CONFIG = 1 << 13, /*!< Updated base config. */
+} context_event_t;
+
+typedef struct context {
+    EventGroupHandle_t event_group;
+
+    struct {
+        const char *syslog_hostname;
+        uint16_t syslog_port;
+    } config;
+
+    struct {
+        struct {
+            volatile float probe;
+        } temp;
+    } sensors;
+} context_t;
+
+// Defined by the tests that need them.
+esp_err_t context_set_temp_probe(context_t *context, float temp);
+
+esp_err_t context_set_temp_water(context_t *context, float temp);
+
+esp_err_t context_set_ec(context_t *context, int tank, float value);
+
+esp_err_t context_set_ph(context_t *context, int tank, float value);
+
+esp_err_t context_get_config(context_t *context, const Hydroponics__Config **config);
+
+void context_config_release(const Hydroponics__Config *config);
+
+#endif //HYDROPONICS_TEST_HOST_CONTEXT_H
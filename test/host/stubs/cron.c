@@ -0,0 +1,20 @@
+#include "esp_log.h"
+
+#include "cron.h"
+#include "error.h"
+
+// Only the parser of the cron component, the scheduler needs FreeRTOS. Same as components/hydroponics-cron/cron.c.
+static const char *const TAG = "cron";
+
+esp_err_t cron_parse(const char *expression, cron_expr *expr) {
+    ARG_CHECK(expression != NULL, ERR_PARAM_NULL);
+    ARG_CHECK(expr != NULL, ERR_PARAM_NULL);
+
+    const char *error = NULL;
+    cron_parse_expr(expression, expr, &error);
+    if (error != NULL) {
+        ESP_LOGE(TAG, "Could not parse %s, error: %s", expression, error);
+        return ESP_ERR_INVALID_ARG;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,6 @@
+#ifndef HYDROPONICS_TEST_HOST_DRIVER_ADC_H
+#define HYDROPONICS_TEST_HOST_DRIVER_ADC_H
+
+// Only referenced from macros the host units do not expand.
+
+#endif //HYDROPONICS_TEST_HOST_DRIVER_ADC_H
@@ -0,0 +1,66 @@
+#ifndef HYDROPONICS_TEST_HOST_DRIVER_I2C_H
+#define HYDROPONICS_TEST_HOST_DRIVER_I2C_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "esp_err.h"
+
+// Command links are recorded by stubs/i2c.c for a simulated transport to play back, there is no driver.
+typedef int i2c_port_t;
+typedef struct host_i2c_cmd *i2c_cmd_handle_t;
+
+typedef enum {
+    I2C_MASTER_WRITE = 0,
+    I2C_MASTER_READ = 1,
+} i2c_rw_t;
+
+typedef enum {
+    I2C_MASTER_ACK = 0,
+    I2C_MASTER_NACK = 1,
+    I2C_MASTER_LAST_NACK = 2,
+} i2c_ack_type_t;
+
+typedef enum {
+    HOST_I2C_START,
+    HOST_I2C_WRITE,   /*!< `data` and `len`, a single byte is kept in `byte`. */
+    HOST_I2C_READ,
+    HOST_I2C_STOP,
+} host_i2c_op_type_t;
+
+typedef struct {
+    host_i2c_op_type_t type;
+    uint8_t byte;
+    const uint8_t *data;
+    uint8_t *read;
+    size_t len;
+} host_i2c_op_t;
+
+#define HOST_I2C_MAX_OPS 16
+
+struct host_i2c_cmd {
+    size_t n_ops;
+    host_i2c_op_t ops[HOST_I2C_MAX_OPS];
+};
+
+i2c_cmd_handle_t i2c_cmd_link_create(void);
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd);
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd);
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en);
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data, size_t data_len, bool ack_en);
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data, size_t data_len, i2c_ack_type_t ack);
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd);
+
+// Always fails on the host, pass a simulated transport instead.
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks);
+
+#endif //HYDROPONICS_TEST_HOST_DRIVER_I2C_H
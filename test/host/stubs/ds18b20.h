@@ -0,0 +1,35 @@
+#ifndef HYDROPONICS_TEST_HOST_DS18B20_H
+#define HYDROPONICS_TEST_HOST_DS18B20_H
+
+#include <stdbool.h>
+
+#include "owb.h"
+
+// Stands in for the esp32-ds18b20 submodule, only the types the simulated probes need.
+typedef enum {
+    DS18B20_ERROR_UNKNOWN = -1,
+    DS18B20_OK = 0,
+    DS18B20_ERROR_DEVICE,
+    DS18B20_ERROR_CRC,
+    DS18B20_ERROR_OWB,
+    DS18B20_ERROR_NULL,
+} DS18B20_ERROR;
+
+typedef enum {
+    DS18B20_RESOLUTION_INVALID = -1,
+    DS18B20_RESOLUTION_9_BIT = 9,
+    DS18B20_RESOLUTION_10_BIT = 10,
+    DS18B20_RESOLUTION_11_BIT = 11,
+    DS18B20_RESOLUTION_12_BIT = 12,
+} DS18B20_RESOLUTION;
+
+typedef struct {
+    bool init;
+    bool solo;
+    bool use_crc;
+    const OneWireBus *bus;
+    OneWireBus_ROMCode rom_code;
+    DS18B20_RESOLUTION resolution;
+} DS18B20_Info;
+
+#endif //HYDROPONICS_TEST_HOST_DS18B20_H
@@ -0,0 +1,15 @@
+#ifndef HYDROPONICS_TEST_HOST_ESP_ATTR_H
+#define HYDROPONICS_TEST_HOST_ESP_ATTR_H
+
+// RTC slow memory survives a reset but not a power cycle. On the host its variables are gathered in their own
+// section, a test carries it across the boots it runs in forked children.
+#define RTC_NOINIT_ATTR __attribute__((section("rtc_noinit")))
+#define IRAM_ATTR
+
+// Host only. Copies the section to memory shared with the parent and the next boots, e.g. right before a reset.
+void host_rtc_save(void);
+
+// Host only. Copies what the last boot saved back into the section.
+void host_rtc_restore(void);
+
+#endif //HYDROPONICS_TEST_HOST_ESP_ATTR_H
@@ -0,0 +1,37 @@
+#ifndef HYDROPONICS_TEST_HOST_ESP_LOG_H
+#define HYDROPONICS_TEST_HOST_ESP_LOG_H
+
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Only errors and warnings are printed, the rest would drown the test output.
+#define ESP_LOGE(tag, fmt, ...) fprintf(stderr, "E %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) fprintf(stderr, "W %s: " fmt "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) do { if (0) printf(fmt, ##__VA_ARGS__); (void) (tag); } while (0)
+#define ESP_LOGD(tag, fmt, ...) ESP_LOGI(tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) ESP_LOGI(tag, fmt, ##__VA_ARGS__)
+
+typedef enum {
+    ESP_LOG_NONE,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+typedef int (*vprintf_like_t)(const char *, va_list);
+
+// Without colors, what the ESP_LOGx macros hand to esp_log_write.
+#define LOG_FORMAT(letter, format) #letter " (%u) %s: " format "\n"
+
+uint32_t esp_log_timestamp(void);
+
+// Goes through the function set with esp_log_set_vprintf, vprintf by default. The ESP_LOGx above do not.
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) __printflike(3, 4);
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func);
+
+#endif //HYDROPONICS_TEST_HOST_ESP_LOG_H
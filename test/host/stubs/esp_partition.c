@@ -0,0 +1,160 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "esp_partition.h"
+
+#define HOST_PARTITION_MAX_MAPS 8
+
+static esp_partition_t partition;
+static int fd = -1;
+static int budget = -1;
+static struct {
+    void *addr;
+    size_t len;
+} maps[HOST_PARTITION_MAX_MAPS];
+
+static void host_partition_power(void) {
+    if (budget == 0) {
+        _exit(0);
+    }
+    if (budget > 0) {
+        budget--;
+    }
+}
+
+void host_partition_create(const char *label, size_t size) {
+    host_partition_destroy();
+    char path[] = "/tmp/host_partition_XXXXXX";
+    fd = mkstemp(path);
+    if (fd < 0 || ftruncate(fd, (off_t) size) != 0) {
+        perror("host_partition_create");
+        abort();
+    }
+    unlink(path);
+    memset(&partition, 0, sizeof(partition));
+    partition.type = ESP_PARTITION_TYPE_DATA;
+    partition.subtype = ESP_PARTITION_SUBTYPE_ANY;
+    partition.size = size;
+    strncpy(partition.label, label, sizeof(partition.label) - 1);
+    budget = -1;
+    esp_partition_erase_range(&partition, 0, size);
+}
+
+// Mappings stay valid until the unit unmaps them, like the flash cache keeps mapping the pages.
+void host_partition_destroy(void) {
+    if (fd >= 0) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+void host_partition_power_loss_after(int n) {
+    budget = n;
+}
+
+void host_partition_corrupt(size_t offset, uint8_t mask) {
+    uint8_t b = 0;
+    if (pread(fd, &b, 1, (off_t) offset) != 1) {
+        abort();
+    }
+    b ^= mask;
+    if (pwrite(fd, &b, 1, (off_t) offset) != 1) {
+        abort();
+    }
+}
+
+size_t host_partition_mapped(void) {
+    size_t n = 0;
+    for (size_t i = 0; i < HOST_PARTITION_MAX_MAPS; ++i) {
+        n += maps[i].addr != NULL;
+    }
+    return n;
+}
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label) {
+    if (fd < 0 || type != partition.type || (label != NULL && strcmp(label, partition.label) != 0)) {
+        return NULL;
+    }
+    return &partition;
+}
+
+esp_err_t esp_partition_read(const esp_partition_t *p, size_t src_offset, void *dst, size_t size) {
+    if (p != &partition || src_offset + size > partition.size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return pread(fd, dst, size, (off_t) src_offset) == (ssize_t) size ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_write(const esp_partition_t *p, size_t dst_offset, const void *src, size_t size) {
+    if (p != &partition || dst_offset + size > partition.size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_partition_power();
+    uint8_t *buf = malloc(size);
+    if (buf == NULL || pread(fd, buf, size, (off_t) dst_offset) != (ssize_t) size) {
+        abort();
+    }
+    for (size_t i = 0; i < size; ++i) {
+        buf[i] &= ((const uint8_t *) src)[i];
+    }
+    ssize_t written = pwrite(fd, buf, size, (off_t) dst_offset);
+    free(buf);
+    return written == (ssize_t) size ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *p, size_t offset, size_t size) {
+    if (p != &partition || offset % HOST_FLASH_SECTOR_SIZE != 0 || size % HOST_FLASH_SECTOR_SIZE != 0
+        || offset + size > partition.size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_partition_power();
+    uint8_t sector[HOST_FLASH_SECTOR_SIZE];
+    memset(sector, 0xff, sizeof(sector));
+    for (size_t o = offset; o < offset + size; o += HOST_FLASH_SECTOR_SIZE) {
+        if (pwrite(fd, sector, sizeof(sector), (off_t) o) != (ssize_t) sizeof(sector)) {
+            return ESP_FAIL;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_mmap(const esp_partition_t *p, size_t offset, size_t size, spi_flash_mmap_memory_t memory,
+                             const void **out_ptr, spi_flash_mmap_handle_t *out_handle) {
+    (void) memory;
+    if (p != &partition || offset + size > partition.size) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    // mmap wants page aligned offsets, the flash cache maps whole 64 KB pages anyway.
+    size_t page = (size_t) sysconf(_SC_PAGESIZE);
+    size_t base = offset / page * page;
+    for (size_t i = 0; i < HOST_PARTITION_MAX_MAPS; ++i) {
+        if (maps[i].addr != NULL) {
+            continue;
+        }
+        size_t len = size + (offset - base);
+        void *addr = mmap(NULL, len, PROT_READ, MAP_SHARED, fd, (off_t) base);
+        if (addr == MAP_FAILED) {
+            return ESP_FAIL;
+        }
+        maps[i].addr = addr;
+        maps[i].len = len;
+        *out_ptr = (const uint8_t *) addr + (offset - base);
+        *out_handle = (spi_flash_mmap_handle_t) i + 1;
+        return ESP_OK;
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+void spi_flash_munmap(spi_flash_mmap_handle_t handle) {
+    size_t i = handle - 1;
+    if (handle == 0 || i >= HOST_PARTITION_MAX_MAPS || maps[i].addr == NULL) {
+        fprintf(stderr, "spi_flash_munmap: invalid handle %u\n", handle);
+        abort();
+    }
+    munmap(maps[i].addr, maps[i].len);
+    maps[i].addr = NULL;
+}
@@ -0,0 +1,58 @@
+#ifndef HYDROPONICS_TEST_HOST_ESP_PARTITION_H
+#define HYDROPONICS_TEST_HOST_ESP_PARTITION_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+#include "esp_spi_flash.h"
+
+#define HOST_FLASH_SECTOR_SIZE 4096
+
+typedef enum {
+    ESP_PARTITION_TYPE_APP = 0x00,
+    ESP_PARTITION_TYPE_DATA = 0x01,
+} esp_partition_type_t;
+
+typedef enum {
+    ESP_PARTITION_SUBTYPE_ANY = 0xff,
+} esp_partition_subtype_t;
+
+typedef struct {
+    esp_partition_type_t type;
+    esp_partition_subtype_t subtype;
+    uint32_t address;
+    uint32_t size;
+    char label[17];
+    bool encrypted;
+} esp_partition_t;
+
+const esp_partition_t *esp_partition_find_first(esp_partition_type_t type, esp_partition_subtype_t subtype,
+                                                const char *label);
+
+esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset, void *dst, size_t size);
+
+esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offset, const void *src, size_t size);
+
+esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t offset, size_t size);
+
+esp_err_t esp_partition_mmap(const esp_partition_t *partition, size_t offset, size_t size,
+                             spi_flash_mmap_memory_t memory, const void **out_ptr, spi_flash_mmap_handle_t *out_handle);
+
+// Host only. One partition backed by a temporary file, it is mapped with mmap like the flash cache maps the real one.
+// Writes can only clear bits and erases set whole sectors to 0xff, as on NOR flash.
+void host_partition_create(const char *label, size_t size);
+
+void host_partition_destroy(void);
+
+// Cuts the power after the next `n` writes or erases: the process exits on the one after. Meant for a forked child,
+// the parent sees the flash as it was left. -1 to stop.
+void host_partition_power_loss_after(int n);
+
+// Flips bits under the flash, e.g. to simulate a worn cell.
+void host_partition_corrupt(size_t offset, uint8_t mask);
+
+size_t host_partition_mapped(void);
+
+#endif //HYDROPONICS_TEST_HOST_ESP_PARTITION_H
@@ -0,0 +1,39 @@
+#include <stddef.h>
+
+#include "esp_system.h"
+
+#define HOST_SHUTDOWN_HANDLERS 5
+
+static shutdown_handler_t handlers[HOST_SHUTDOWN_HANDLERS];
+static esp_reset_reason_t reset_reason = ESP_RST_POWERON;
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler) {
+    for (size_t i = 0; i < HOST_SHUTDOWN_HANDLERS; ++i) {
+        if (handlers[i] == handler) {
+            return ESP_ERR_INVALID_STATE;
+        }
+        if (handlers[i] == NULL) {
+            handlers[i] = handler;
+            return ESP_OK;
+        }
+    }
+    return ESP_ERR_NO_MEM;
+}
+
+esp_reset_reason_t esp_reset_reason(void) {
+    return reset_reason;
+}
+
+void host_set_reset_reason(esp_reset_reason_t reason) {
+    reset_reason = reason;
+}
+
+// Last registered runs first, like esp_restart.
+void host_shutdown(void) {
+    for (int i = HOST_SHUTDOWN_HANDLERS - 1; i >= 0; --i) {
+        if (handlers[i] != NULL) {
+            handlers[i]();
+            handlers[i] = NULL;
+        }
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef HYDROPONICS_TEST_HOST_ESP_SYSTEM_H
+#define HYDROPONICS_TEST_HOST_ESP_SYSTEM_H
+
+#include "esp_err.h"
+
+typedef enum {
+    ESP_RST_UNKNOWN,
+    ESP_RST_POWERON,
+    ESP_RST_EXT,
+    ESP_RST_SW,
+    ESP_RST_PANIC,
+    ESP_RST_INT_WDT,
+    ESP_RST_TASK_WDT,
+    ESP_RST_WDT,
+    ESP_RST_DEEPSLEEP,
+    ESP_RST_BROWNOUT,
+    ESP_RST_SDIO,
+} esp_reset_reason_t;
+
+typedef void (*shutdown_handler_t)(void);
+
+esp_err_t esp_register_shutdown_handler(shutdown_handler_t handler);
+
+esp_reset_reason_t esp_reset_reason(void);
+
+// Host only. Sets what esp_reset_reason returns, power on by default.
+void host_set_reset_reason(esp_reset_reason_t reason);
+
+// Host only. Runs the shutdown handlers like esp_restart() does and forgets them.
+void host_shutdown(void);
+
+#endif //HYDROPONICS_TEST_HOST_ESP_SYSTEM_H
@@ -0,0 +1,114 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#include "esp_timer.h"
+
+#define HOST_TIMER_MAX 16
+
+struct host_timer {
+    esp_timer_create_args_t args;
+    bool armed;
+    int64_t due_us;
+    uint64_t period_us;
+};
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct host_timer *timers[HOST_TIMER_MAX];
+static int64_t now_us = 0;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle) {
+    struct host_timer *timer = calloc(1, sizeof(struct host_timer));
+    if (timer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    timer->args = *args;
+    pthread_mutex_lock(&mutex);
+    for (size_t i = 0; i < HOST_TIMER_MAX; ++i) {
+        if (timers[i] == NULL) {
+            timers[i] = timer;
+            *out_handle = timer;
+            pthread_mutex_unlock(&mutex);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&mutex);
+    free(timer);
+    return ESP_ERR_NO_MEM;
+}
+
+static esp_err_t host_timer_start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us) {
+    pthread_mutex_lock(&mutex);
+    bool armed = timer->armed;
+    if (!armed) {
+        timer->armed = true;
+        timer->due_us = now_us + (int64_t) timeout_us;
+        timer->period_us = period_us;
+    }
+    pthread_mutex_unlock(&mutex);
+    return armed ? ESP_ERR_INVALID_STATE : ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return host_timer_start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us) {
+    return host_timer_start(timer, period_us, period_us);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&mutex);
+    bool armed = timer->armed;
+    timer->armed = false;
+    pthread_mutex_unlock(&mutex);
+    return armed ? ESP_OK : ESP_ERR_INVALID_STATE;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    pthread_mutex_lock(&mutex);
+    for (size_t i = 0; i < HOST_TIMER_MAX; ++i) {
+        if (timers[i] == timer) {
+            timers[i] = NULL;
+        }
+    }
+    pthread_mutex_unlock(&mutex);
+    free(timer);
+    return ESP_OK;
+}
+
+int64_t esp_timer_get_time(void) {
+    pthread_mutex_lock(&mutex);
+    int64_t now = now_us;
+    pthread_mutex_unlock(&mutex);
+    return now;
+}
+
+// Steps from one due timer to the next so periodic timers and timers started by callbacks fire in order.
+void host_timer_advance(int64_t us) {
+    pthread_mutex_lock(&mutex);
+    const int64_t end_us = now_us + us;
+    while (true) {
+        struct host_timer *next = NULL;
+        for (size_t i = 0; i < HOST_TIMER_MAX; ++i) {
+            struct host_timer *t = timers[i];
+            if (t != NULL && t->armed && t->due_us <= end_us && (next == NULL || t->due_us < next->due_us)) {
+                next = t;
+            }
+        }
+        if (next == NULL) {
+            break;
+        }
+        now_us = next->due_us > now_us ? next->due_us : now_us;
+        if (next->period_us > 0) {
+            next->due_us += (int64_t) next->period_us;
+        } else {
+            next->armed = false;
+        }
+        pthread_mutex_unlock(&mutex);
+        next->args.callback(next->args.arg);
+        pthread_mutex_lock(&mutex);
+    }
+    now_us = end_us;
+    pthread_mutex_unlock(&mutex);
+}
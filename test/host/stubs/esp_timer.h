@@ -0,0 +1,41 @@
+#ifndef HYDROPONICS_TEST_HOST_ESP_TIMER_H
+#define HYDROPONICS_TEST_HOST_ESP_TIMER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+typedef struct host_timer *esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+
+typedef enum {
+    ESP_TIMER_TASK,
+} esp_timer_dispatch_t;
+
+typedef struct {
+    esp_timer_cb_t callback;
+    void *arg;
+    esp_timer_dispatch_t dispatch_method;
+    const char *name;
+    bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *out_handle);
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us);
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period_us);
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer);
+
+// Host clock, it only moves with host_timer_advance.
+int64_t esp_timer_get_time(void);
+
+// Host only. Moves the clock forward and runs the callbacks that came due, in the calling thread as the esp_timer task
+// would.
+void host_timer_advance(int64_t us);
+
+#endif //HYDROPONICS_TEST_HOST_ESP_TIMER_H
@@ -0,0 +1,349 @@
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+struct host_task {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t notified;
+    TaskFunction_t code;
+    void *arg;
+};
+
+// Mutexes, binary and counting semaphores are all a count guarded by a condition variable.
+struct host_semaphore {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t max;
+    bool is_static;
+};
+
+_Static_assert(sizeof(struct host_semaphore) <= sizeof(StaticSemaphore_t), "StaticSemaphore_t is too small");
+
+// A ring of copied items, `count` and `spaces` are what receivers and senders wait on.
+struct host_queue {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    uint32_t count;
+    uint32_t spaces;
+    size_t item_size;
+    size_t head;
+    uint8_t *items;
+};
+
+struct host_event_group {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    EventBits_t bits;
+};
+
+static __thread struct host_task *current = NULL;
+static struct host_task main_task = {
+        .mutex = PTHREAD_MUTEX_INITIALIZER,
+};
+
+// Timeouts run on the monotonic clock, tests are free to fake the wall clock.
+static void host_cond_init(pthread_cond_t *cond) {
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(cond, &attr);
+    pthread_condattr_destroy(&attr);
+}
+
+__attribute__((constructor)) static void host_main_task_init(void) {
+    host_cond_init(&main_task.cond);
+}
+
+static struct timespec host_deadline(TickType_t ticks) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    ts.tv_sec += ticks / 1000;
+    ts.tv_nsec += (long) (ticks % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
+    return ts;
+}
+
+// Waits on `cond` until `*value` is not 0, false on timeout.
+static bool host_wait(pthread_mutex_t *mutex, pthread_cond_t *cond, const uint32_t *value, TickType_t ticks) {
+    struct timespec deadline = host_deadline(ticks);
+    while (*value == 0) {
+        if (ticks == portMAX_DELAY) {
+            pthread_cond_wait(cond, mutex);
+        } else if (ticks == 0 || pthread_cond_timedwait(cond, mutex, &deadline) == ETIMEDOUT) {
+            return *value != 0;
+        }
+    }
+    return true;
+}
+
+static void *host_task_main(void *arg) {
+    current = arg;
+    current->code(current->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+    (void) name;
+    (void) stack;
+    (void) priority;
+    (void) core;
+    struct host_task *task = calloc(1, sizeof(struct host_task));
+    if (task == NULL) {
+        return pdFAIL;
+    }
+    pthread_mutex_init(&task->mutex, NULL);
+    host_cond_init(&task->cond);
+    task->code = code;
+    task->arg = arg;
+    if (handle != NULL) {
+        *handle = task;
+    }
+    if (pthread_create(&task->thread, NULL, host_task_main, task) != 0) {
+        abort();
+    }
+    pthread_detach(task->thread);
+    return pdPASS;
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return current != NULL ? current : &main_task;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+    pthread_mutex_lock(&task->mutex);
+    task->notified++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->mutex);
+    return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+    xTaskNotifyGive(task);
+    if (woken != NULL) {
+        *woken = pdTRUE;
+    }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+    struct host_task *task = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&task->mutex);
+    host_wait(&task->mutex, &task->cond, &task->notified, ticks);
+    uint32_t value = task->notified;
+    if (value > 0) {
+        task->notified = clear ? 0 : value - 1;
+    }
+    pthread_mutex_unlock(&task->mutex);
+    return value;
+}
+
+void vTaskDelay(TickType_t ticks) {
+    usleep(ticks * 1000);
+}
+
+TickType_t xTaskGetTickCount(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (TickType_t) (ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+void vTaskDelayUntil(TickType_t *previous_wake_time, TickType_t increment) {
+    *previous_wake_time += increment;
+    TickType_t now = xTaskGetTickCount();
+    if ((int32_t) (*previous_wake_time - now) > 0) {
+        vTaskDelay(*previous_wake_time - now);
+    }
+}
+
+static SemaphoreHandle_t host_semaphore_init(struct host_semaphore *sem, uint32_t max, uint32_t count) {
+    pthread_mutex_init(&sem->mutex, NULL);
+    host_cond_init(&sem->cond);
+    sem->count = count;
+    sem->max = max;
+    return sem;
+}
+
+static SemaphoreHandle_t host_semaphore(uint32_t max, uint32_t count) {
+    struct host_semaphore *sem = calloc(1, sizeof(struct host_semaphore));
+    if (sem == NULL) {
+        return NULL;
+    }
+    return host_semaphore_init(sem, max, count);
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return host_semaphore(1, 1);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return host_semaphore(1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer) {
+    struct host_semaphore *sem = (struct host_semaphore *) buffer;
+    *sem = (struct host_semaphore) {.is_static = true};
+    return host_semaphore_init(sem, 1, 0);
+}
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial) {
+    return host_semaphore(max, initial);
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    pthread_mutex_lock(&sem->mutex);
+    bool taken = host_wait(&sem->mutex, &sem->cond, &sem->count, ticks);
+    if (taken) {
+        sem->count--;
+    }
+    pthread_mutex_unlock(&sem->mutex);
+    return taken ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    pthread_mutex_lock(&sem->mutex);
+    bool given = sem->count < sem->max;
+    if (given) {
+        sem->count++;
+    }
+    pthread_cond_signal(&sem->cond);
+    pthread_mutex_unlock(&sem->mutex);
+    return given ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    pthread_mutex_destroy(&sem->mutex);
+    pthread_cond_destroy(&sem->cond);
+    if (!sem->is_static) {
+        free(sem);
+    }
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    struct host_queue *queue = calloc(1, sizeof(struct host_queue));
+    if (queue == NULL) {
+        return NULL;
+    }
+    queue->items = calloc(length, item_size);
+    if (queue->items == NULL) {
+        free(queue);
+        return NULL;
+    }
+    pthread_mutex_init(&queue->mutex, NULL);
+    host_cond_init(&queue->cond);
+    queue->spaces = length;
+    queue->item_size = item_size;
+    return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks) {
+    pthread_mutex_lock(&queue->mutex);
+    bool sent = host_wait(&queue->mutex, &queue->cond, &queue->spaces, ticks);
+    if (sent) {
+        size_t length = queue->count + queue->spaces;
+        memcpy(&queue->items[((queue->head + queue->count) % length) * queue->item_size], item, queue->item_size);
+        queue->count++;
+        queue->spaces--;
+        // Senders and receivers share the condition variable.
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return sent ? pdPASS : pdFAIL;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks) {
+    pthread_mutex_lock(&queue->mutex);
+    bool received = host_wait(&queue->mutex, &queue->cond, &queue->count, ticks);
+    if (received) {
+        size_t length = queue->count + queue->spaces;
+        memcpy(buffer, &queue->items[queue->head * queue->item_size], queue->item_size);
+        queue->head = (queue->head + 1) % length;
+        queue->count--;
+        queue->spaces++;
+        pthread_cond_broadcast(&queue->cond);
+    }
+    pthread_mutex_unlock(&queue->mutex);
+    return received ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue) {
+    pthread_mutex_lock(&queue->mutex);
+    UBaseType_t count = queue->count;
+    pthread_mutex_unlock(&queue->mutex);
+    return count;
+}
+
+void vQueueDelete(QueueHandle_t queue) {
+    pthread_mutex_destroy(&queue->mutex);
+    pthread_cond_destroy(&queue->cond);
+    free(queue->items);
+    free(queue);
+}
+
+EventGroupHandle_t xEventGroupCreate(void) {
+    struct host_event_group *group = calloc(1, sizeof(struct host_event_group));
+    if (group == NULL) {
+        return NULL;
+    }
+    pthread_mutex_init(&group->mutex, NULL);
+    host_cond_init(&group->cond);
+    return group;
+}
+
+EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->mutex);
+    group->bits |= bits;
+    EventBits_t value = group->bits;
+    pthread_cond_broadcast(&group->cond);
+    pthread_mutex_unlock(&group->mutex);
+    return value;
+}
+
+EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    pthread_mutex_lock(&group->mutex);
+    EventBits_t value = group->bits;
+    group->bits &= ~bits;
+    pthread_mutex_unlock(&group->mutex);
+    return value;
+}
+
+EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    pthread_mutex_lock(&group->mutex);
+    EventBits_t value = group->bits;
+    pthread_mutex_unlock(&group->mutex);
+    return value;
+}
+
+// Returns the bits when the wait ended, the caller checks them to tell a timeout.
+EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits, BaseType_t clear, BaseType_t all,
+                                TickType_t ticks) {
+    struct timespec deadline = host_deadline(ticks);
+    pthread_mutex_lock(&group->mutex);
+    while (all ? (group->bits & bits) != bits : (group->bits & bits) == 0) {
+        if (ticks == portMAX_DELAY) {
+            pthread_cond_wait(&group->cond, &group->mutex);
+        } else if (ticks == 0 || pthread_cond_timedwait(&group->cond, &group->mutex, &deadline) == ETIMEDOUT) {
+            break;
+        }
+    }
+    EventBits_t value = group->bits;
+    if (clear && (all ? (value & bits) == bits : (value & bits) != 0)) {
+        group->bits &= ~bits;
+    }
+    pthread_mutex_unlock(&group->mutex);
+    return value;
+}
@@ -0,0 +1,39 @@
+#ifndef HYDROPONICS_TEST_HOST_FREERTOS_H
+#define HYDROPONICS_TEST_HOST_FREERTOS_H
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+// FreeRTOS over pthreads, only what the host units use. A tick is a millisecond.
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define pdFALSE                 ((BaseType_t) 0)
+#define pdTRUE                  ((BaseType_t) 1)
+#define pdPASS                  pdTRUE
+#define pdFAIL                  pdFALSE
+#define portMAX_DELAY           ((TickType_t) 0xffffffff)
+#define portTICK_PERIOD_MS      1
+#define pdMS_TO_TICKS(ms)       ((TickType_t) (ms))
+#define configMAX_PRIORITIES    25
+#define tskIDLE_PRIORITY        0
+#define tskNO_AFFINITY          0x7fffffff
+#define portNUM_PROCESSORS      2
+#define configMAX_TASK_NAME_LEN 16
+
+// A critical section is a mutex, every thread runs on core 0.
+typedef pthread_mutex_t portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED PTHREAD_MUTEX_INITIALIZER
+#define portENTER_CRITICAL(mux)      pthread_mutex_lock(mux)
+#define portEXIT_CRITICAL(mux)       pthread_mutex_unlock(mux)
+
+#define portYIELD_FROM_ISR()
+
+static inline BaseType_t xPortGetCoreID(void) {
+    return 0;
+}
+
+#endif //HYDROPONICS_TEST_HOST_FREERTOS_H
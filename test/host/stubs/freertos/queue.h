@@ -0,0 +1,19 @@
+#ifndef HYDROPONICS_TEST_HOST_FREERTOS_QUEUE_H
+#define HYDROPONICS_TEST_HOST_FREERTOS_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+typedef struct host_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+
+BaseType_t xQueueReceive(QueueHandle_t queue, void *buffer, TickType_t ticks);
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t queue);
+
+void vQueueDelete(QueueHandle_t queue);
+
+#endif //HYDROPONICS_TEST_HOST_FREERTOS_QUEUE_H
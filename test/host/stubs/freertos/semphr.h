@@ -0,0 +1,28 @@
+#ifndef HYDROPONICS_TEST_HOST_FREERTOS_SEMPHR_H
+#define HYDROPONICS_TEST_HOST_FREERTOS_SEMPHR_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_semaphore *SemaphoreHandle_t;
+typedef SemaphoreHandle_t xSemaphoreHandle;
+
+// Room for the host semaphore, checked in freertos.c.
+typedef struct {
+    void *storage[16];
+} StaticSemaphore_t;
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+
+SemaphoreHandle_t xSemaphoreCreateBinaryStatic(StaticSemaphore_t *buffer);
+
+SemaphoreHandle_t xSemaphoreCreateCounting(UBaseType_t max, UBaseType_t initial);
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks);
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem);
+
+void vSemaphoreDelete(SemaphoreHandle_t sem);
+
+#endif //HYDROPONICS_TEST_HOST_FREERTOS_SEMPHR_H
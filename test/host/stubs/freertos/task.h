@@ -0,0 +1,50 @@
+#ifndef HYDROPONICS_TEST_HOST_FREERTOS_TASK_H
+#define HYDROPONICS_TEST_HOST_FREERTOS_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *);
+
+typedef enum {
+    eRunning = 0,
+    eReady,
+    eBlocked,
+    eSuspended,
+    eDeleted,
+    eInvalid,
+} eTaskState;
+
+// Only filled in by the tests, uxTaskGetSystemState is not stubbed.
+typedef struct {
+    TaskHandle_t xHandle;
+    const char *pcTaskName;
+    UBaseType_t xTaskNumber;
+    eTaskState eCurrentState;
+    UBaseType_t uxCurrentPriority;
+    UBaseType_t uxBasePriority;
+    uint32_t ulRunTimeCounter;
+    uint16_t usStackHighWaterMark;
+    BaseType_t xCoreID;
+} TaskStatus_t;
+
+// Tasks are detached threads, priorities and cores are ignored.
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stack, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+
+// An interrupt is whatever thread calls it.
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+
+void vTaskDelay(TickType_t ticks);
+
+TickType_t xTaskGetTickCount(void);
+
+void vTaskDelayUntil(TickType_t *previous_wake_time, TickType_t increment);
+
+#endif //HYDROPONICS_TEST_HOST_FREERTOS_TASK_H
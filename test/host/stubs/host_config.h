@@ -0,0 +1,33 @@
+#ifndef HYDROPONICS_TEST_HOST_HOST_CONFIG_H
+#define HYDROPONICS_TEST_HOST_HOST_CONFIG_H
+
+// Force included in every host unit, stands in for the newlib and ESP-IDF compiler macros.
+#ifndef __printflike
+#define __printflike(a, b) __attribute__((format(printf, a, b)))
+#endif
+#ifndef __scanflike
+#define __scanflike(a, b) __attribute__((format(scanf, a, b)))
+#endif
+#ifndef unlikely
+#define unlikely(x) __builtin_expect(!!(x), 0)
+#endif
+#ifndef likely
+#define likely(x) __builtin_expect(!!(x), 1)
+#endif
+
+// newlib has it, glibc only since 2.38.
+#include <stddef.h>
+size_t strlcpy(char *dst, const char *src, size_t size);
+
+// Kconfig defaults of the units under test, a test can override the pool size.
+#ifndef CONFIG_ESP_CRON_MAX_JOBS
+#define CONFIG_ESP_CRON_MAX_JOBS        64
+#endif
+#define CONFIG_ESP_CRON_WORKERS         2
+#define CONFIG_ESP_CRON_MISFIRE_GRACE_S 300
+#define CONFIG_ESP_CRASHLOG_LINES       16
+#define CONFIG_ESP_CRASHLOG_EVENTS      16
+#define CONFIG_ESP_SYSLOG_RATE_LIMIT    20
+#define CONFIG_ESP_SYSLOG_RATE_BURST    50
+
+#endif //HYDROPONICS_TEST_HOST_HOST_CONFIG_H
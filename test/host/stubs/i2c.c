@@ -0,0 +1,49 @@
+#include <stdlib.h>
+
+#include "driver/i2c.h"
+
+i2c_cmd_handle_t i2c_cmd_link_create(void) {
+    return calloc(1, sizeof(struct host_i2c_cmd));
+}
+
+void i2c_cmd_link_delete(i2c_cmd_handle_t cmd) {
+    free(cmd);
+}
+
+static esp_err_t host_i2c_op(i2c_cmd_handle_t cmd, host_i2c_op_t op) {
+    if (cmd->n_ops == HOST_I2C_MAX_OPS) {
+        return ESP_ERR_NO_MEM;
+    }
+    cmd->ops[cmd->n_ops++] = op;
+    return ESP_OK;
+}
+
+esp_err_t i2c_master_start(i2c_cmd_handle_t cmd) {
+    return host_i2c_op(cmd, (host_i2c_op_t) {.type = HOST_I2C_START});
+}
+
+esp_err_t i2c_master_write_byte(i2c_cmd_handle_t cmd, uint8_t data, bool ack_en) {
+    (void) ack_en;
+    return host_i2c_op(cmd, (host_i2c_op_t) {.type = HOST_I2C_WRITE, .byte = data, .len = 1});
+}
+
+esp_err_t i2c_master_write(i2c_cmd_handle_t cmd, const uint8_t *data, size_t data_len, bool ack_en) {
+    (void) ack_en;
+    return host_i2c_op(cmd, (host_i2c_op_t) {.type = HOST_I2C_WRITE, .data = data, .len = data_len});
+}
+
+esp_err_t i2c_master_read(i2c_cmd_handle_t cmd, uint8_t *data, size_t data_len, i2c_ack_type_t ack) {
+    (void) ack;
+    return host_i2c_op(cmd, (host_i2c_op_t) {.type = HOST_I2C_READ, .read = data, .len = data_len});
+}
+
+esp_err_t i2c_master_stop(i2c_cmd_handle_t cmd) {
+    return host_i2c_op(cmd, (host_i2c_op_t) {.type = HOST_I2C_STOP});
+}
+
+esp_err_t i2c_master_cmd_begin(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks) {
+    (void) port;
+    (void) cmd;
+    (void) ticks;
+    return ESP_ERR_NOT_SUPPORTED;
+}
@@ -0,0 +1,7 @@
+#ifndef HYDROPONICS_TEST_HOST_MBEDTLS_CMAC_H
+#define HYDROPONICS_TEST_HOST_MBEDTLS_CMAC_H
+
+// Only pulled in by utils.h for the block size, see utils.c for the host implementations.
+#define MBEDTLS_AES_BLOCK_SIZE 16
+
+#endif //HYDROPONICS_TEST_HOST_MBEDTLS_CMAC_H
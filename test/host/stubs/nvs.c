@@ -0,0 +1,206 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nvs.h"
+#include "nvs_flash.h"
+
+// In-memory NVS, a single namespace is enough for the host units. Writes land right away like on the device, the
+// commit is only counted unless a file backs the NVS.
+#define HOST_NVS_MAX_KEYS 64
+
+typedef struct {
+    char key[NVS_KEY_NAME_MAX_SIZE];
+    bool blob;
+    uint8_t *data;
+    size_t len;
+} item_t;
+
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+static item_t items[HOST_NVS_MAX_KEYS];
+static host_nvs_stats_t stats;
+static char file[256] = "";
+
+static item_t *host_nvs_find(const char *key) {
+    for (size_t i = 0; i < HOST_NVS_MAX_KEYS; ++i) {
+        if (items[i].data != NULL && strcmp(items[i].key, key) == 0) {
+            return &items[i];
+        }
+    }
+    return NULL;
+}
+
+static esp_err_t host_nvs_set(const char *key, bool blob, const void *value, size_t len) {
+    if (strlen(key) >= NVS_KEY_NAME_MAX_SIZE) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    pthread_mutex_lock(&mutex);
+    stats.writes++;
+    stats.bytes_written += len;
+    item_t *item = host_nvs_find(key);
+    for (size_t i = 0; item == NULL && i < HOST_NVS_MAX_KEYS; ++i) {
+        if (items[i].data == NULL) {
+            item = &items[i];
+        }
+    }
+    if (item == NULL) {
+        pthread_mutex_unlock(&mutex);
+        return ESP_ERR_NVS_NO_FREE_PAGES;
+    }
+    // Never NULL, that marks a free item.
+    uint8_t *data = malloc(len + 1);
+    memcpy(data, value, len);
+    free(item->data);
+    strcpy(item->key, key);
+    item->blob = blob;
+    item->data = data;
+    item->len = len;
+    pthread_mutex_unlock(&mutex);
+    return ESP_OK;
+}
+
+static esp_err_t host_nvs_get(const char *key, bool blob, void *out_value, size_t *length) {
+    pthread_mutex_lock(&mutex);
+    stats.reads++;
+    item_t *item = host_nvs_find(key);
+    esp_err_t err = ESP_OK;
+    if (item == NULL) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (item->blob != blob) {
+        err = ESP_ERR_NVS_TYPE_MISMATCH;
+    } else if (out_value == NULL) {
+        *length = item->len;
+    } else if (*length < item->len) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out_value, item->data, item->len);
+        *length = item->len;
+        stats.bytes_read += item->len;
+    }
+    pthread_mutex_unlock(&mutex);
+    return err;
+}
+
+esp_err_t nvs_flash_init(void) {
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    host_nvs_clear();
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle) {
+    (void) name;
+    (void) open_mode;
+    *out_handle = 1;
+    return ESP_OK;
+}
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value) {
+    (void) handle;
+    return host_nvs_set(key, false, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length) {
+    (void) handle;
+    return host_nvs_get(key, false, out_value, length);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    (void) handle;
+    return host_nvs_set(key, true, value, length);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    (void) handle;
+    return host_nvs_get(key, true, out_value, length);
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    (void) handle;
+    pthread_mutex_lock(&mutex);
+    stats.writes++;
+    item_t *item = host_nvs_find(key);
+    if (item != NULL) {
+        free(item->data);
+        item->data = NULL;
+    }
+    pthread_mutex_unlock(&mutex);
+    return item != NULL ? ESP_OK : ESP_ERR_NVS_NOT_FOUND;
+}
+
+// Every item as its key, type, length and value. Must hold the mutex.
+static esp_err_t host_nvs_save(void) {
+    FILE *f = fopen(file, "wb");
+    if (f == NULL) {
+        return ESP_FAIL;
+    }
+    bool ok = true;
+    for (size_t i = 0; ok && i < HOST_NVS_MAX_KEYS; ++i) {
+        const item_t *item = &items[i];
+        if (item->data == NULL) {
+            continue;
+        }
+        uint32_t len = item->len;
+        ok = fwrite(item->key, sizeof(item->key), 1, f) == 1 && fwrite(&item->blob, sizeof(item->blob), 1, f) == 1
+             && fwrite(&len, sizeof(len), 1, f) == 1 && (len == 0 || fwrite(item->data, len, 1, f) == 1);
+    }
+    return fclose(f) == 0 && ok ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    (void) handle;
+    pthread_mutex_lock(&mutex);
+    stats.commits++;
+    esp_err_t err = file[0] != '\0' ? host_nvs_save() : ESP_OK;
+    pthread_mutex_unlock(&mutex);
+    return err;
+}
+
+host_nvs_stats_t host_nvs_stats(void) {
+    pthread_mutex_lock(&mutex);
+    host_nvs_stats_t s = stats;
+    pthread_mutex_unlock(&mutex);
+    return s;
+}
+
+void host_nvs_clear(void) {
+    pthread_mutex_lock(&mutex);
+    for (size_t i = 0; i < HOST_NVS_MAX_KEYS; ++i) {
+        free(items[i].data);
+        items[i].data = NULL;
+    }
+    pthread_mutex_unlock(&mutex);
+}
+
+esp_err_t host_nvs_open_file(const char *path) {
+    if (strlen(path) >= sizeof(file)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    host_nvs_clear();
+    pthread_mutex_lock(&mutex);
+    strcpy(file, path);
+    FILE *f = fopen(file, "rb");
+    esp_err_t err = ESP_OK;
+    for (size_t i = 0; f != NULL && i < HOST_NVS_MAX_KEYS; ++i) {
+        item_t *item = &items[i];
+        uint32_t len = 0;
+        if (fread(item->key, sizeof(item->key), 1, f) != 1) {
+            break;
+        }
+        if (fread(&item->blob, sizeof(item->blob), 1, f) != 1 || fread(&len, sizeof(len), 1, f) != 1
+            || (item->data = malloc(len + 1)) == NULL || (len > 0 && fread(item->data, len, 1, f) != 1)) {
+            err = ESP_FAIL;
+            break;
+        }
+        item->len = len;
+    }
+    if (f != NULL) {
+        fclose(f);
+    }
+    pthread_mutex_unlock(&mutex);
+    return err;
+}
@@ -0,0 +1,57 @@
+#ifndef HYDROPONICS_TEST_HOST_NVS_H
+#define HYDROPONICS_TEST_HOST_NVS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "esp_err.h"
+
+#define ESP_ERR_NVS_BASE              0x1100
+#define ESP_ERR_NVS_NOT_FOUND         (ESP_ERR_NVS_BASE + 0x02)
+#define ESP_ERR_NVS_TYPE_MISMATCH     (ESP_ERR_NVS_BASE + 0x03)
+#define ESP_ERR_NVS_INVALID_LENGTH    (ESP_ERR_NVS_BASE + 0x0c)
+#define ESP_ERR_NVS_NO_FREE_PAGES     (ESP_ERR_NVS_BASE + 0x0d)
+#define ESP_ERR_NVS_NEW_VERSION_FOUND (ESP_ERR_NVS_BASE + 0x10)
+
+#define NVS_KEY_NAME_MAX_SIZE 16
+
+typedef uint32_t nvs_handle_t;
+
+typedef enum {
+    NVS_READONLY,
+    NVS_READWRITE,
+} nvs_open_mode_t;
+
+esp_err_t nvs_open(const char *name, nvs_open_mode_t open_mode, nvs_handle_t *out_handle);
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value);
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length);
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length);
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length);
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key);
+
+esp_err_t nvs_commit(nvs_handle_t handle);
+
+// Host only. The in-memory NVS counts what reached it.
+typedef struct {
+    uint32_t reads;         /*!< nvs_get_* calls, sizing calls included. */
+    uint32_t writes;        /*!< nvs_set_* and nvs_erase_key calls. */
+    uint32_t commits;
+    uint32_t bytes_read;    /*!< Values copied out by nvs_get_*. */
+    uint32_t bytes_written; /*!< Values passed to nvs_set_*. */
+} host_nvs_stats_t;
+
+host_nvs_stats_t host_nvs_stats(void);
+
+// Drops every key, like a power cycle after nvs_flash_erase.
+void host_nvs_clear(void);
+
+// Backs the NVS with a file. The keys it holds replace the ones in memory and every commit writes them all back, so
+// clearing and opening it again reads what a previous boot committed.
+esp_err_t host_nvs_open_file(const char *path);
+
+#endif //HYDROPONICS_TEST_HOST_NVS_H
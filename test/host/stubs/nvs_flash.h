@@ -0,0 +1,10 @@
+#ifndef HYDROPONICS_TEST_HOST_NVS_FLASH_H
+#define HYDROPONICS_TEST_HOST_NVS_FLASH_H
+
+#include "esp_err.h"
+
+esp_err_t nvs_flash_init(void);
+
+esp_err_t nvs_flash_erase(void);
+
+#endif //HYDROPONICS_TEST_HOST_NVS_FLASH_H
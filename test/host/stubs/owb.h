@@ -0,0 +1,18 @@
+#ifndef HYDROPONICS_TEST_HOST_OWB_H
+#define HYDROPONICS_TEST_HOST_OWB_H
+
+#include <stdint.h>
+
+// Stands in for the esp32-owb submodule, only the types the simulated probes need.
+typedef struct _OneWireBus OneWireBus;
+
+typedef union {
+    struct {
+        uint8_t family[1];
+        uint8_t serial_number[6];
+        uint8_t crc[1];
+    } fields;
+    uint8_t bytes[8];
+} OneWireBus_ROMCode;
+
+#endif //HYDROPONICS_TEST_HOST_OWB_H
@@ -0,0 +1,13 @@
+#ifndef HYDROPONICS_TEST_HOST_OWB_RMT_H
+#define HYDROPONICS_TEST_HOST_OWB_RMT_H
+
+#include "driver/gpio.h"
+
+#include "owb.h"
+
+typedef struct {
+    int tx_channel;
+    int rx_channel;
+} owb_rmt_driver_info;
+
+#endif //HYDROPONICS_TEST_HOST_OWB_RMT_H
@@ -0,0 +1,237 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "protobuf-c/protobuf-c.h"
+
+const char protobuf_c_empty_string[] = "";
+
+static void protobuf_c_unavailable(const char *fn) {
+    fprintf(stderr, "%s is not available on the host\n", fn);
+    abort();
+}
+
+// The encoder walks the descriptors, out is NULL when only the size is needed.
+static inline uint8_t *at(uint8_t *out, size_t n) {
+    return out != NULL ? out + n : NULL;
+}
+
+static size_t put_varint(uint64_t value, uint8_t *out) {
+    size_t n = 0;
+    for (; value >= 0x80; value >>= 7, ++n) {
+        if (out != NULL) {
+            out[n] = (uint8_t) (value | 0x80);
+        }
+    }
+    if (out != NULL) {
+        out[n] = (uint8_t) value;
+    }
+    return n + 1;
+}
+
+static size_t put_fixed(const void *value, size_t size, uint8_t *out) {
+    if (out != NULL) {
+        memcpy(out, value, size);  // Little endian hosts only.
+    }
+    return size;
+}
+
+static unsigned wire_type(ProtobufCType type) {
+    switch (type) {
+        case PROTOBUF_C_TYPE_SFIXED64:
+        case PROTOBUF_C_TYPE_FIXED64:
+        case PROTOBUF_C_TYPE_DOUBLE:
+            return 1;
+        case PROTOBUF_C_TYPE_STRING:
+        case PROTOBUF_C_TYPE_BYTES:
+        case PROTOBUF_C_TYPE_MESSAGE:
+            return 2;
+        case PROTOBUF_C_TYPE_SFIXED32:
+        case PROTOBUF_C_TYPE_FIXED32:
+        case PROTOBUF_C_TYPE_FLOAT:
+            return 5;
+        default:
+            return 0;
+    }
+}
+
+static size_t element_size(ProtobufCType type) {
+    switch (type) {
+        case PROTOBUF_C_TYPE_INT64:
+        case PROTOBUF_C_TYPE_SINT64:
+        case PROTOBUF_C_TYPE_SFIXED64:
+        case PROTOBUF_C_TYPE_UINT64:
+        case PROTOBUF_C_TYPE_FIXED64:
+        case PROTOBUF_C_TYPE_DOUBLE:
+            return 8;
+        case PROTOBUF_C_TYPE_BOOL:
+            return sizeof(protobuf_c_boolean);
+        case PROTOBUF_C_TYPE_STRING:
+            return sizeof(char *);
+        case PROTOBUF_C_TYPE_BYTES:
+            return sizeof(ProtobufCBinaryData);
+        case PROTOBUF_C_TYPE_MESSAGE:
+            return sizeof(ProtobufCMessage *);
+        default:
+            return 4;
+    }
+}
+
+static size_t pack_message(const ProtobufCMessage *message, uint8_t *out);
+
+// One value without its tag.
+static size_t pack_value(ProtobufCType type, const void *member, uint8_t *out) {
+    switch (type) {
+        case PROTOBUF_C_TYPE_INT32:
+        case PROTOBUF_C_TYPE_ENUM:
+            return put_varint((uint64_t) (int64_t) *(const int32_t *) member, out);
+        case PROTOBUF_C_TYPE_SINT32: {
+            int32_t v = *(const int32_t *) member;
+            return put_varint(((uint32_t) v << 1) ^ (uint32_t) (v >> 31), out);
+        }
+        case PROTOBUF_C_TYPE_UINT32:
+            return put_varint(*(const uint32_t *) member, out);
+        case PROTOBUF_C_TYPE_BOOL:
+            return put_varint(*(const protobuf_c_boolean *) member != 0, out);
+        case PROTOBUF_C_TYPE_INT64:
+        case PROTOBUF_C_TYPE_UINT64:
+            return put_varint(*(const uint64_t *) member, out);
+        case PROTOBUF_C_TYPE_SINT64: {
+            int64_t v = *(const int64_t *) member;
+            return put_varint(((uint64_t) v << 1) ^ (uint64_t) (v >> 63), out);
+        }
+        case PROTOBUF_C_TYPE_STRING: {
+            const char *s = *(char *const *) member;
+            size_t len = s != NULL ? strlen(s) : 0;
+            size_t n = put_varint(len, out);
+            return n + put_fixed(s, len, at(out, n));
+        }
+        case PROTOBUF_C_TYPE_BYTES: {
+            const ProtobufCBinaryData *b = member;
+            size_t n = put_varint(b->len, out);
+            return n + put_fixed(b->data, b->len, at(out, n));
+        }
+        case PROTOBUF_C_TYPE_MESSAGE: {
+            const ProtobufCMessage *m = *(ProtobufCMessage *const *) member;
+            size_t len = m != NULL ? pack_message(m, NULL) : 0;
+            size_t n = put_varint(len, out);
+            return n + (m != NULL ? pack_message(m, at(out, n)) : 0);
+        }
+        default:
+            return put_fixed(member, element_size(type), out);
+    }
+}
+
+static bool is_default(ProtobufCType type, const void *member) {
+    switch (type) {
+        case PROTOBUF_C_TYPE_STRING: {
+            const char *s = *(char *const *) member;
+            return s == NULL || s[0] == '\0';
+        }
+        case PROTOBUF_C_TYPE_BYTES:
+            return ((const ProtobufCBinaryData *) member)->len == 0;
+        case PROTOBUF_C_TYPE_MESSAGE:
+            return *(ProtobufCMessage *const *) member == NULL;
+        default: {
+            static const uint8_t zero[8] = {0};
+            return memcmp(member, zero, element_size(type)) == 0;
+        }
+    }
+}
+
+static size_t pack_field(const ProtobufCMessage *message, const ProtobufCFieldDescriptor *f, uint8_t *out) {
+    const uint8_t *base = (const uint8_t *) message;
+    const void *member = base + f->offset;
+    if (f->label == PROTOBUF_C_LABEL_REPEATED) {
+        size_t count = *(const size_t *) (base + f->quantifier_offset);
+        const uint8_t *array = *(uint8_t *const *) member;
+        size_t size = element_size(f->type), n = 0;
+        if (count == 0) {
+            return 0;
+        }
+        if (f->flags & PROTOBUF_C_FIELD_FLAG_PACKED) {
+            size_t len = 0;
+            for (size_t i = 0; i < count; ++i) {
+                len += pack_value(f->type, array + i * size, NULL);
+            }
+            n += put_varint((uint64_t) f->id << 3 | 2, out);
+            n += put_varint(len, at(out, n));
+            for (size_t i = 0; i < count; ++i) {
+                n += pack_value(f->type, array + i * size, at(out, n));
+            }
+            return n;
+        }
+        for (size_t i = 0; i < count; ++i) {
+            n += put_varint((uint64_t) f->id << 3 | wire_type(f->type), at(out, n));
+            n += pack_value(f->type, array + i * size, at(out, n));
+        }
+        return n;
+    }
+    bool present;
+    if (f->flags & PROTOBUF_C_FIELD_FLAG_ONEOF) {
+        present = *(const uint32_t *) (base + f->quantifier_offset) == f->id;
+    } else if (f->label == PROTOBUF_C_LABEL_REQUIRED) {
+        present = true;
+    } else if (f->label == PROTOBUF_C_LABEL_OPTIONAL && f->type != PROTOBUF_C_TYPE_STRING
+               && f->type != PROTOBUF_C_TYPE_MESSAGE) {
+        present = *(const protobuf_c_boolean *) (base + f->quantifier_offset);
+    } else {
+        present = !is_default(f->type, member);
+    }
+    if (!present) {
+        return 0;
+    }
+    size_t n = put_varint((uint64_t) f->id << 3 | wire_type(f->type), out);
+    return n + pack_value(f->type, member, at(out, n));
+}
+
+static size_t pack_message(const ProtobufCMessage *message, uint8_t *out) {
+    size_t n = 0;
+    for (unsigned i = 0; i < message->descriptor->n_fields; ++i) {
+        n += pack_field(message, &message->descriptor->fields[i], at(out, n));
+    }
+    return n;
+}
+
+size_t protobuf_c_message_get_packed_size(const ProtobufCMessage *message) {
+    return pack_message(message, NULL);
+}
+
+size_t protobuf_c_message_pack(const ProtobufCMessage *message, uint8_t *out) {
+    return pack_message(message, out);
+}
+
+size_t protobuf_c_message_pack_to_buffer(const ProtobufCMessage *message, ProtobufCBuffer *buffer) {
+    protobuf_c_unavailable(__FUNCTION__);
+    return 0;
+}
+
+ProtobufCMessage *protobuf_c_message_unpack(const ProtobufCMessageDescriptor *descriptor,
+                                            ProtobufCAllocator *allocator, size_t len, const uint8_t *data) {
+    protobuf_c_unavailable(__FUNCTION__);
+    return NULL;
+}
+
+void protobuf_c_message_free_unpacked(ProtobufCMessage *message, ProtobufCAllocator *allocator) {
+    protobuf_c_unavailable(__FUNCTION__);
+}
+
+const ProtobufCFieldDescriptor *protobuf_c_message_descriptor_get_field(const ProtobufCMessageDescriptor *descriptor,
+                                                                        unsigned value) {
+    for (unsigned i = 0; i < descriptor->n_fields; ++i) {
+        if (descriptor->fields[i].id == value) {
+            return &descriptor->fields[i];
+        }
+    }
+    return NULL;
+}
+
+const ProtobufCEnumValue *protobuf_c_enum_descriptor_get_value(const ProtobufCEnumDescriptor *descriptor, int value) {
+    for (unsigned i = 0; i < descriptor->n_values; ++i) {
+        if (descriptor->values[i].value == value) {
+            return &descriptor->values[i];
+        }
+    }
+    return NULL;
+}
@@ -0,0 +1,159 @@
+#ifndef HYDROPONICS_TEST_HOST_PROTOBUF_C_H
+#define HYDROPONICS_TEST_HOST_PROTOBUF_C_H
+
+// The subset of the protobuf-c runtime the generated code and the units use. The host tests build their messages by
+// hand, packing follows the wire format but unpacking is not available.
+
+#include <assert.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define PROTOBUF_C__BEGIN_DECLS
+#define PROTOBUF_C__END_DECLS
+#define PROTOBUF_C_VERSION_NUMBER 1004000
+#define PROTOBUF_C_MIN_COMPILER_VERSION 1000000
+#define PROTOBUF_C__ENUM_DESCRIPTOR_MAGIC 0x114315af
+#define PROTOBUF_C__MESSAGE_DESCRIPTOR_MAGIC 0x28aaeef9
+#define PROTOBUF_C__FORCE_ENUM_TO_BE_INT_SIZE(x) , _##x##_IS_INT_SIZE = INT_MAX
+
+typedef int protobuf_c_boolean;
+
+typedef enum {
+    PROTOBUF_C_LABEL_REQUIRED,
+    PROTOBUF_C_LABEL_OPTIONAL,
+    PROTOBUF_C_LABEL_REPEATED,
+    PROTOBUF_C_LABEL_NONE,
+} ProtobufCLabel;
+
+typedef enum {
+    PROTOBUF_C_TYPE_INT32,
+    PROTOBUF_C_TYPE_SINT32,
+    PROTOBUF_C_TYPE_SFIXED32,
+    PROTOBUF_C_TYPE_INT64,
+    PROTOBUF_C_TYPE_SINT64,
+    PROTOBUF_C_TYPE_SFIXED64,
+    PROTOBUF_C_TYPE_UINT32,
+    PROTOBUF_C_TYPE_FIXED32,
+    PROTOBUF_C_TYPE_UINT64,
+    PROTOBUF_C_TYPE_FIXED64,
+    PROTOBUF_C_TYPE_FLOAT,
+    PROTOBUF_C_TYPE_DOUBLE,
+    PROTOBUF_C_TYPE_BOOL,
+    PROTOBUF_C_TYPE_ENUM,
+    PROTOBUF_C_TYPE_STRING,
+    PROTOBUF_C_TYPE_BYTES,
+    PROTOBUF_C_TYPE_MESSAGE,
+} ProtobufCType;
+
+typedef enum {
+    PROTOBUF_C_FIELD_FLAG_PACKED = 1,
+    PROTOBUF_C_FIELD_FLAG_DEPRECATED = 2,
+    PROTOBUF_C_FIELD_FLAG_ONEOF = 4,
+} ProtobufCFieldFlag;
+
+typedef struct {
+    size_t len;
+    uint8_t *data;
+} ProtobufCBinaryData;
+
+typedef struct ProtobufCAllocator ProtobufCAllocator;
+typedef struct ProtobufCBuffer ProtobufCBuffer;
+
+typedef struct {
+    const char *name;
+    const char *c_name;
+    int value;
+} ProtobufCEnumValue;
+
+typedef struct {
+    const char *name;
+    unsigned index;
+} ProtobufCEnumValueIndex;
+
+typedef struct {
+    int start_value;
+    unsigned orig_index;
+} ProtobufCIntRange;
+
+typedef struct {
+    uint32_t magic;
+    const char *name;
+    const char *short_name;
+    const char *c_name;
+    const char *package_name;
+    unsigned n_values;
+    const ProtobufCEnumValue *values;
+    unsigned n_value_names;
+    const ProtobufCEnumValueIndex *values_by_name;
+    unsigned n_value_ranges;
+    const ProtobufCIntRange *value_ranges;
+    void *reserved1;
+    void *reserved2;
+    void *reserved3;
+    void *reserved4;
+} ProtobufCEnumDescriptor;
+
+typedef struct {
+    const char *name;
+    uint32_t id;
+    ProtobufCLabel label;
+    ProtobufCType type;
+    unsigned quantifier_offset;
+    unsigned offset;
+    const void *descriptor;
+    const void *default_value;
+    uint32_t flags;
+    unsigned reserved_flags;
+    void *reserved2;
+    void *reserved3;
+} ProtobufCFieldDescriptor;
+
+typedef struct ProtobufCMessage ProtobufCMessage;
+typedef void (*ProtobufCMessageInit)(ProtobufCMessage *);
+
+typedef struct {
+    uint32_t magic;
+    const char *name;
+    const char *short_name;
+    const char *c_name;
+    const char *package_name;
+    size_t sizeof_message;
+    unsigned n_fields;
+    const ProtobufCFieldDescriptor *fields;
+    const unsigned *fields_sorted_by_name;
+    unsigned n_field_ranges;
+    const ProtobufCIntRange *field_ranges;
+    ProtobufCMessageInit message_init;
+    void *reserved1;
+    void *reserved2;
+    void *reserved3;
+} ProtobufCMessageDescriptor;
+
+struct ProtobufCMessage {
+    const ProtobufCMessageDescriptor *descriptor;
+    unsigned n_unknown_fields;
+    void *unknown_fields;
+};
+
+#define PROTOBUF_C_MESSAGE_INIT(descriptor) { descriptor, 0, NULL }
+
+extern const char protobuf_c_empty_string[];
+
+size_t protobuf_c_message_get_packed_size(const ProtobufCMessage *message);
+
+size_t protobuf_c_message_pack(const ProtobufCMessage *message, uint8_t *out);
+
+size_t protobuf_c_message_pack_to_buffer(const ProtobufCMessage *message, ProtobufCBuffer *buffer);
+
+ProtobufCMessage *protobuf_c_message_unpack(const ProtobufCMessageDescriptor *descriptor,
+                                            ProtobufCAllocator *allocator, size_t len, const uint8_t *data);
+
+void protobuf_c_message_free_unpacked(ProtobufCMessage *message, ProtobufCAllocator *allocator);
+
+const ProtobufCFieldDescriptor *protobuf_c_message_descriptor_get_field(const ProtobufCMessageDescriptor *descriptor,
+                                                                        unsigned value);
+
+const ProtobufCEnumValue *protobuf_c_enum_descriptor_get_value(const ProtobufCEnumDescriptor *descriptor, int value);
+
+#endif //HYDROPONICS_TEST_HOST_PROTOBUF_C_H
@@ -0,0 +1,12 @@
+#ifndef HYDROPONICS_TEST_HOST_SOC_MEMORY_LAYOUT_H
+#define HYDROPONICS_TEST_HOST_SOC_MEMORY_LAYOUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// True inside the region given to host_set_drom, the host stand-in for the flash mapped rodata.
+bool esp_ptr_in_drom(const void *p);
+
+void host_set_drom(const void *start, size_t size);
+
+#endif //HYDROPONICS_TEST_HOST_SOC_MEMORY_LAYOUT_H
@@ -0,0 +1,87 @@
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+
+#include "esp_attr.h"
+#include "esp_err.h"
+#include "esp_log.h"
+#include "soc/soc_memory_layout.h"
+
+const char *esp_err_to_name(esp_err_t code) {
+    static char buf[16];
+    snprintf(buf, sizeof(buf), "0x%x", code);
+    return buf;
+}
+
+uint32_t esp_log_timestamp(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) (ts.tv_sec * 1000 + ts.tv_nsec / 1000000);
+}
+
+static vprintf_like_t log_vprintf = vprintf;
+
+void esp_log_write(esp_log_level_t level, const char *tag, const char *format, ...) {
+    (void) level;
+    (void) tag;
+    va_list va;
+    va_start(va, format);
+    log_vprintf(format, va);
+    va_end(va);
+}
+
+vprintf_like_t esp_log_set_vprintf(vprintf_like_t func) {
+    vprintf_like_t previous = log_vprintf;
+    log_vprintf = func;
+    return previous;
+}
+
+static const char *drom_start = NULL;
+static size_t drom_size = 0;
+
+bool esp_ptr_in_drom(const void *p) {
+    return drom_start != NULL && (const char *) p >= drom_start && (const char *) p < drom_start + drom_size;
+}
+
+void host_set_drom(const void *start, size_t size) {
+    drom_start = start;
+    drom_size = size;
+}
+
+size_t strlcpy(char *dst, const char *src, size_t size) {
+    size_t len = strlen(src);
+    if (size > 0) {
+        size_t n = len < size - 1 ? len : size - 1;
+        memcpy(dst, src, n);
+        dst[n] = '\0';
+    }
+    return len;
+}
+
+// Set by the linker when a unit has RTC_NOINIT_ATTR variables.
+extern char __start_rtc_noinit[] __attribute__((weak));
+extern char __stop_rtc_noinit[] __attribute__((weak));
+static char *rtc_shared = NULL;
+
+// Mapped before main, so every forked child shares it.
+__attribute__((constructor)) static void host_rtc_map(void) {
+    size_t size = __stop_rtc_noinit - __start_rtc_noinit;
+    if (size > 0) {
+        rtc_shared = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (rtc_shared == MAP_FAILED) {
+            abort();
+        }
+    }
+}
+
+void host_rtc_save(void) {
+    if (rtc_shared != NULL) {
+        memcpy(rtc_shared, __start_rtc_noinit, __stop_rtc_noinit - __start_rtc_noinit);
+    }
+}
+
+void host_rtc_restore(void) {
+    if (rtc_shared != NULL) {
+        memcpy(__start_rtc_noinit, rtc_shared, __stop_rtc_noinit - __start_rtc_noinit);
+    }
+}
@@ -0,0 +1,49 @@
+#include "timespec.h"
+
+#define NS_PER_S 1000000000L
+
+struct timespec timespec_normalise(struct timespec ts) {
+    ts.tv_sec += ts.tv_nsec / NS_PER_S;
+    ts.tv_nsec %= NS_PER_S;
+    if (ts.tv_nsec < 0) {
+        ts.tv_sec--;
+        ts.tv_nsec += NS_PER_S;
+    }
+    return ts;
+}
+
+struct timespec timespec_add(struct timespec ts1, struct timespec ts2) {
+    ts1.tv_sec += ts2.tv_sec;
+    ts1.tv_nsec += ts2.tv_nsec;
+    return timespec_normalise(ts1);
+}
+
+struct timespec timespec_sub(struct timespec ts1, struct timespec ts2) {
+    ts1.tv_sec -= ts2.tv_sec;
+    ts1.tv_nsec -= ts2.tv_nsec;
+    return timespec_normalise(ts1);
+}
+
+bool timespec_lt(struct timespec ts1, struct timespec ts2) {
+    ts1 = timespec_normalise(ts1);
+    ts2 = timespec_normalise(ts2);
+    return ts1.tv_sec < ts2.tv_sec || (ts1.tv_sec == ts2.tv_sec && ts1.tv_nsec < ts2.tv_nsec);
+}
+
+struct timespec timespec_from_ms(long milliseconds) {
+    struct timespec ts = {.tv_sec = milliseconds / 1000, .tv_nsec = (milliseconds % 1000) * 1000000L};
+    return timespec_normalise(ts);
+}
+
+long timespec_to_ms(struct timespec ts) {
+    return (long) ts.tv_sec * 1000 + ts.tv_nsec / 1000000L;
+}
+
+struct timespec timespec_from_us(int64_t microseconds) {
+    struct timespec ts = {.tv_sec = (time_t) (microseconds / 1000000), .tv_nsec = (long) (microseconds % 1000000) * 1000};
+    return timespec_normalise(ts);
+}
+
+int64_t timespec_to_us(struct timespec ts) {
+    return (int64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
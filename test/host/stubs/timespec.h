@@ -0,0 +1,25 @@
+#ifndef HYDROPONICS_TEST_HOST_TIMESPEC_H
+#define HYDROPONICS_TEST_HOST_TIMESPEC_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+// Host stand-in for esp-timespec, which is not part of the tree. Only the helpers the units use.
+struct timespec timespec_add(struct timespec ts1, struct timespec ts2);
+
+struct timespec timespec_sub(struct timespec ts1, struct timespec ts2);
+
+bool timespec_lt(struct timespec ts1, struct timespec ts2);
+
+struct timespec timespec_normalise(struct timespec ts);
+
+struct timespec timespec_from_ms(long milliseconds);
+
+long timespec_to_ms(struct timespec ts);
+
+struct timespec timespec_from_us(int64_t microseconds);
+
+int64_t timespec_to_us(struct timespec ts);
+
+#endif //HYDROPONICS_TEST_HOST_TIMESPEC_H
@@ -0,0 +1,24 @@
+#include <openssl/sha.h>
+
+#include "esp_err.h"
+
+#include "utils.h"
+
+// Host versions of the utils the units call, the firmware ones sit on mbedtls and FreeRTOS.
+
+size_t round_up(size_t len, uint16_t block_size) {
+    return ((len + block_size - 1) & (-block_size));
+}
+
+esp_err_t sha256(const uint8_t *buf, size_t len, unsigned char output[32]) {
+    if (buf == NULL || len == 0 || output == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    SHA256(buf, len, output);
+    return ESP_OK;
+}
+
+const char *enum_from_value(const ProtobufCEnumDescriptor *descriptor, int value) {
+    const ProtobufCEnumValue *v = protobuf_c_enum_descriptor_get_value(descriptor, value);
+    return v != NULL ? v->name : "???";
+}
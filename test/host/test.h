@@ -0,0 +1,40 @@
+#ifndef HYDROPONICS_TEST_HOST_TEST_H
+#define HYDROPONICS_TEST_HOST_TEST_H
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Failures stop the test binary right away, ctest reports the message.
+#define TEST_ASSERT(a) do {                                                                       \
+      if (!(a)) {                                                                                 \
+        fprintf(stderr, "%s:%d (%s): assertion failed: %s\n", __FILE__, __LINE__, __FUNCTION__, #a); \
+        exit(1);                                                                                  \
+      }                                                                                           \
+    } while(0)
+
+#define TEST_ASSERT_EQUAL(expected, actual) do {                                                  \
+      long long e_ = (long long) (expected), a_ = (long long) (actual);                           \
+      if (e_ != a_) {                                                                             \
+        fprintf(stderr, "%s:%d (%s): %s: expected %lld, got %lld\n", __FILE__, __LINE__,          \
+                __FUNCTION__, #actual, e_, a_);                                                   \
+        exit(1);                                                                                  \
+      }                                                                                           \
+    } while(0)
+
+#define TEST_ASSERT_NEAR(expected, actual, delta) do {                                            \
+      double e_ = (double) (expected), a_ = (double) (actual);                                    \
+      if (fabs(e_ - a_) > (delta)) {                                                              \
+        fprintf(stderr, "%s:%d (%s): %s: expected %f +- %f, got %f\n", __FILE__, __LINE__,        \
+                __FUNCTION__, #actual, e_, (double) (delta), a_);                                 \
+        exit(1);                                                                                  \
+      }                                                                                           \
+    } while(0)
+
+#define RUN_TEST(fn) do {                                                                         \
+      printf("%s\n", #fn);                                                                        \
+      fflush(stdout);                                                                             \
+      fn();                                                                                       \
+    } while(0)
+
+#endif //HYDROPONICS_TEST_HOST_TEST_H
@@ -0,0 +1,159 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+
+#include "driver/gpio.h"
+
+#include "ads1115_stream.h"
+#include "i2c_bus.h"
+#include "test.h"
+
+#define PORT        0
+#define ADDRESS     0x48
+#define ALERT_GPIO  GPIO_NUM_4
+#define CONVERSIONS 400
+
+#define REG_CONVERSION 0x00
+#define REG_CONFIG     0x01
+#define MUX(config)    (((config) >> 12) & 0x7)
+#define VALUE(mux)     ((int16_t) (((mux) - ADS1115_STREAM_MUX_0_GND + 1) * 1000))
+
+// The simulated ADS1115, `conversion` always holds the last completed conversion.
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static uint16_t config = 0;
+static int16_t conversion = 0;
+static gpio_isr_t isr = NULL;
+static void *isr_arg = NULL;
+static _Atomic bool converting = true;
+
+esp_err_t gpio_config(const gpio_config_t *io_conf) {
+    TEST_ASSERT_EQUAL(1ULL << ALERT_GPIO, io_conf->pin_bit_mask);
+    TEST_ASSERT_EQUAL(GPIO_INTR_NEGEDGE, io_conf->intr_type);
+    return ESP_OK;
+}
+
+esp_err_t gpio_isr_handler_add(gpio_num_t gpio, gpio_isr_t handler, void *arg) {
+    TEST_ASSERT_EQUAL(ALERT_GPIO, gpio);
+    pthread_mutex_lock(&lock);
+    isr = handler;
+    isr_arg = arg;
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+// Completes a conversion of the selected channel and pulls ALERT/RDY.
+static void sim_convert(uint16_t mux) {
+    pthread_mutex_lock(&lock);
+    conversion = VALUE(mux);
+    gpio_isr_t handler = isr;
+    pthread_mutex_unlock(&lock);
+    if (handler != NULL) {
+        handler(isr_arg);
+    }
+}
+
+// Worst case for the driver: every channel switch lands right as a conversion of the previous channel completes.
+static esp_err_t sim_transport(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks) {
+    TEST_ASSERT_EQUAL(PORT, port);
+    int reg = -1;
+    bool addressing = false;
+    uint8_t written[2];
+    size_t n_written = 0;
+    for (size_t i = 0; i < cmd->n_ops; ++i) {
+        const host_i2c_op_t *op = &cmd->ops[i];
+        switch (op->type) {
+            case HOST_I2C_START:
+                addressing = true;
+                break;
+            case HOST_I2C_WRITE:
+                for (size_t j = 0; j < op->len; ++j) {
+                    uint8_t byte = op->data != NULL ? op->data[j] : op->byte;
+                    if (addressing) {
+                        TEST_ASSERT_EQUAL(ADDRESS, byte >> 1);
+                        addressing = false;
+                    } else if (reg < 0) {
+                        reg = byte;
+                    } else if (n_written < sizeof(written)) {
+                        written[n_written++] = byte;
+                    }
+                }
+                break;
+            case HOST_I2C_READ:
+                TEST_ASSERT_EQUAL(REG_CONVERSION, reg);
+                TEST_ASSERT_EQUAL(2, op->len);
+                pthread_mutex_lock(&lock);
+                op->read[0] = (uint16_t) conversion >> 8;
+                op->read[1] = (uint16_t) conversion & 0xff;
+                pthread_mutex_unlock(&lock);
+                break;
+            case HOST_I2C_STOP:
+                break;
+        }
+    }
+    if (reg == REG_CONFIG && n_written == 2) {
+        pthread_mutex_lock(&lock);
+        uint16_t previous = config;
+        config = (written[0] << 8) | written[1];
+        pthread_mutex_unlock(&lock);
+        if (previous != 0) {
+            sim_convert(MUX(previous));
+        }
+    }
+    return ESP_OK;
+}
+
+// Converts the selected channel faster than the driver gives up on the interrupt.
+static void *sim_converter(void *arg) {
+    while (atomic_load(&converting)) {
+        pthread_mutex_lock(&lock);
+        uint16_t mux = MUX(config);
+        bool configured = config != 0;
+        pthread_mutex_unlock(&lock);
+        if (configured) {
+            sim_convert(mux);
+        }
+        usleep(2 * 1000);
+    }
+    return NULL;
+}
+
+// A data ready raised by the previous channel while switching never lands in the ring of the next one.
+static void test_channels_keep_their_conversions(void) {
+    ads1115_stream_config_t stream = {
+            .address = ADDRESS,
+            .alert_gpio = ALERT_GPIO,
+            .fsr = ADS1115_STREAM_FSR_0_512,
+            .sps = ADS1115_STREAM_SPS_860,
+            .channels = 2,
+            .mux = {ADS1115_STREAM_MUX_0_GND, ADS1115_STREAM_MUX_1_GND},
+    };
+    pthread_t converter;
+    TEST_ASSERT_EQUAL(0, pthread_create(&converter, NULL, sim_converter, NULL));
+    TEST_ASSERT_EQUAL(ESP_OK, ads1115_stream_init(&stream));
+
+    ads1115_stream_stats_t stats = {0};
+    for (int i = 0; i < 1000 && stats.conversions < CONVERSIONS; ++i) {
+        usleep(10 * 1000);
+        TEST_ASSERT_EQUAL(ESP_OK, ads1115_stream_get_stats(&stats));
+    }
+    atomic_store(&converting, false);
+    pthread_join(converter, NULL);
+    TEST_ASSERT(stats.conversions >= CONVERSIONS);
+    TEST_ASSERT_EQUAL(0, stats.errors);
+
+    for (size_t channel = 0; channel < stream.channels; ++channel) {
+        int16_t raw = 0;
+        TEST_ASSERT_EQUAL(ESP_OK, ads1115_stream_average(channel, &raw));
+        TEST_ASSERT_EQUAL(VALUE(stream.mux[channel]), raw);
+    }
+    printf("  %u conversions, %u without a data ready\n", stats.conversions, stats.missed);
+}
+
+int main(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_init_with_transport(PORT, sim_transport));
+
+    RUN_TEST(test_channels_keep_their_conversions);
+    return 0;
+}
@@ -0,0 +1,138 @@
+#include <stdint.h>
+#include <time.h>
+
+#include "calibration.h"
+#include "test.h"
+
+// Default tank curve of main/sensors/tank.c, highest degree first, and the raw range it is tabulated over.
+static const double TANK_REGRESSION[4] = {-0.00000000000000185, -0.00000000021752058, -0.00002203925836691,
+                                          0.52318676617797200};
+#define TANK_RAW_MIN INT16_MIN
+#define TANK_RAW_MAX 26000
+#define TANK_HEALTH_MIN (-0.2f)
+
+// The floating point evaluation the tank used before the calibration component.
+static double legacy_regression(const double coeff[], size_t coeff_size, double value) {
+    double ret = 0;
+    double x = 1;
+    for (size_t i = 0; i < coeff_size; ++i) {
+        ret += coeff[coeff_size - 1 - i] * x;
+        x = i == 0 ? value : x * value;
+    }
+    return ret;
+}
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void test_piecewise_sorts_interpolates_and_clamps(void) {
+    const calibration_point_t points[] = {{.raw = 300, .value = 3.f}, {.raw = 100, .value = 1.f},
+                                          {.raw = 200, .value = 1.5f}};
+    calibration_t cal;
+    TEST_ASSERT_EQUAL(ESP_OK, calibration_fit(points, 3, CALIBRATION_TYPE_PIECEWISE, 0, &cal));
+    TEST_ASSERT_NEAR(1.f, CALIBRATION_TO_FLOAT(calibration_eval(&cal, 100)), 1e-4);
+    TEST_ASSERT_NEAR(1.25f, CALIBRATION_TO_FLOAT(calibration_eval(&cal, 150)), 1e-4);
+    TEST_ASSERT_NEAR(2.25f, CALIBRATION_TO_FLOAT(calibration_eval(&cal, 250)), 1e-4);
+    TEST_ASSERT_NEAR(1.f, CALIBRATION_TO_FLOAT(calibration_eval(&cal, -1000)), 1e-4);
+    TEST_ASSERT_NEAR(3.f, CALIBRATION_TO_FLOAT(calibration_eval(&cal, 1000)), 1e-4);
+}
+
+static void test_polynomial_reproduces_a_quadratic(void) {
+    calibration_point_t points[8];
+    for (int i = 0; i < 8; ++i) {
+        int32_t raw = -1000 + i * 400;
+        points[i].raw = raw;
+        points[i].value = 2e-7f * raw * raw - 1e-3f * raw + 0.5f;
+    }
+    calibration_t cal;
+    TEST_ASSERT_EQUAL(ESP_OK, calibration_fit(points, 8, CALIBRATION_TYPE_POLYNOMIAL, 2, &cal));
+    for (int32_t raw = -1000; raw <= 1800; raw += 7) {
+        TEST_ASSERT_NEAR(2e-7 * raw * raw - 1e-3 * raw + 0.5, CALIBRATION_TO_FLOAT(calibration_eval(&cal, raw)), 1e-3);
+    }
+}
+
+static void test_invalid_fits_are_rejected(void) {
+    const calibration_point_t duplicated[] = {{.raw = 10, .value = 1.f}, {.raw = 10, .value = 2.f}};
+    calibration_point_t many[CALIBRATION_MAX_POINTS + 1] = {0};
+    calibration_t cal;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, calibration_fit(duplicated, 2, CALIBRATION_TYPE_PIECEWISE, 0, &cal));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, calibration_fit(duplicated, 1, CALIBRATION_TYPE_PIECEWISE, 0, &cal));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, calibration_fit(duplicated, 2, CALIBRATION_TYPE_POLYNOMIAL, 1, &cal));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG,
+                      calibration_fit(many, CALIBRATION_MAX_POINTS + 1, CALIBRATION_TYPE_PIECEWISE, 0, &cal));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG,
+                      calibration_fit(many, CALIBRATION_MAX_POINTS, CALIBRATION_TYPE_POLYNOMIAL, 4, &cal));
+}
+
+static void test_invert_round_trips(void) {
+    calibration_t cal;
+    TEST_ASSERT_EQUAL(ESP_OK, calibration_from_polynomial(TANK_REGRESSION, 4, INT16_MIN, INT16_MAX,
+                                                          CALIBRATION_MAX_POINTS, &cal));
+    for (int32_t raw = INT16_MIN; raw < INT16_MAX; raw += 997) {
+        int32_t value = calibration_eval(&cal, raw);
+        TEST_ASSERT(abs(calibration_invert(&cal, value) - raw) <= 2);
+    }
+}
+
+// The tabulated default curve follows the legacy cubic over its range, readings past it clamp below the health limit.
+static void test_default_tank_curve_matches_the_legacy_cubic(void) {
+    calibration_t cal;
+    TEST_ASSERT_EQUAL(ESP_OK, calibration_from_polynomial(TANK_REGRESSION, 4, TANK_RAW_MIN, TANK_RAW_MAX,
+                                                          CALIBRATION_MAX_POINTS, &cal));
+    double max_err = 0;
+    for (int32_t raw = TANK_RAW_MIN; raw <= TANK_RAW_MAX; ++raw) {
+        double err = fabs(CALIBRATION_TO_FLOAT(calibration_eval(&cal, raw)) - legacy_regression(TANK_REGRESSION, 4, raw));
+        max_err = err > max_err ? err : max_err;
+    }
+    printf("  max error over [%d, %d]: %.5f\n", TANK_RAW_MIN, TANK_RAW_MAX, max_err);
+    // A sixth of a percent of tank level.
+    TEST_ASSERT(max_err < 0.0016);
+    TEST_ASSERT_NEAR(legacy_regression(TANK_REGRESSION, 4, TANK_RAW_MIN),
+                     CALIBRATION_TO_FLOAT(calibration_eval(&cal, TANK_RAW_MIN)), 1e-4);
+    TEST_ASSERT_NEAR(legacy_regression(TANK_REGRESSION, 4, TANK_RAW_MAX),
+                     CALIBRATION_TO_FLOAT(calibration_eval(&cal, TANK_RAW_MAX)), 1e-4);
+    TEST_ASSERT(CALIBRATION_TO_FLOAT(calibration_eval(&cal, INT16_MAX)) < TANK_HEALTH_MIN);
+}
+
+// Timings are only printed, they depend on the host. A host FPU runs the double cubic faster than the binary search,
+// the ESP32 FPU is single precision only and does doubles in software.
+static void test_speed_against_the_legacy_cubic(void) {
+    calibration_t cal;
+    TEST_ASSERT_EQUAL(ESP_OK, calibration_from_polynomial(TANK_REGRESSION, 4, TANK_RAW_MIN, TANK_RAW_MAX,
+                                                          CALIBRATION_MAX_POINTS, &cal));
+    const int rounds = 20;
+    volatile double legacy_sink = 0;
+    int64_t start = now_ns();
+    for (int r = 0; r < rounds; ++r) {
+        for (int32_t raw = INT16_MIN; raw <= INT16_MAX; ++raw) {
+            legacy_sink += legacy_regression(TANK_REGRESSION, 4, raw);
+        }
+    }
+    int64_t legacy_ns = now_ns() - start;
+
+    volatile int64_t curve_sink = 0;
+    start = now_ns();
+    for (int r = 0; r < rounds; ++r) {
+        for (int32_t raw = INT16_MIN; raw <= INT16_MAX; ++raw) {
+            curve_sink += calibration_eval(&cal, raw);
+        }
+    }
+    int64_t curve_ns = now_ns() - start;
+
+    const double evals = (double) rounds * 65536;
+    printf("  legacy cubic: %.2f ns/eval, piecewise Q16: %.2f ns/eval\n", legacy_ns / evals, curve_ns / evals);
+    TEST_ASSERT(legacy_sink != 0 && curve_sink != 0);
+}
+
+int main(void) {
+    RUN_TEST(test_piecewise_sorts_interpolates_and_clamps);
+    RUN_TEST(test_polynomial_reproduces_a_quadratic);
+    RUN_TEST(test_invalid_fits_are_rejected);
+    RUN_TEST(test_invert_round_trips);
+    RUN_TEST(test_default_tank_curve_matches_the_legacy_cubic);
+    RUN_TEST(test_speed_against_the_legacy_cubic);
+    return 0;
+}
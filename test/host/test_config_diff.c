@@ -0,0 +1,189 @@
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "config_diff.h"
+#include "test.h"
+
+#define MAX_TASKS 200
+
+static Hydroponics__Output OUT_A[] = {HYDROPONICS__OUTPUT__EXT_GPIO_A_0};
+static Hydroponics__Output OUT_B[] = {HYDROPONICS__OUTPUT__EXT_GPIO_A_1};
+static char *EVERY_MINUTE[] = {"0 * * * * *"};
+static char *EVERY_HALF[] = {"30 * * * * *"};
+
+static Hydroponics__Task__Cron cron_minute = {
+        PROTOBUF_C_MESSAGE_INIT(&hydroponics__task__cron__descriptor), HYDROPONICS__OUTPUT_STATE__ON, 1, EVERY_MINUTE};
+static Hydroponics__Task__Cron cron_half = {
+        PROTOBUF_C_MESSAGE_INIT(&hydroponics__task__cron__descriptor), HYDROPONICS__OUTPUT_STATE__ON, 1, EVERY_HALF};
+static Hydroponics__Task__Cron *CRON_MINUTE[] = {&cron_minute};
+static Hydroponics__Task__Cron *CRON_HALF[] = {&cron_half};
+
+static Hydroponics__Task tasks[2][MAX_TASKS];
+static Hydroponics__Task *task_ptrs[2][MAX_TASKS];
+static char names[MAX_TASKS][16];
+
+static void task_set(Hydroponics__Task *task, const char *name, Hydroponics__Output *output,
+                     Hydroponics__Task__Cron **cron) {
+    *task = (Hydroponics__Task) HYDROPONICS__TASK__INIT;
+    task->name = (char *) name;
+    task->n_output = 1;
+    task->output = output;
+    task->n_cron = 1;
+    task->cron = cron;
+}
+
+static void test_identical_configs(void) {
+    Hydroponics__Sampling sampling = HYDROPONICS__SAMPLING__INIT;
+    sampling.tank_ms = 1000;
+    Hydroponics__Config a = HYDROPONICS__CONFIG__INIT, b = HYDROPONICS__CONFIG__INIT;
+    a.sampling = &sampling;
+    b.sampling = &sampling;
+    config_diff_t diff;
+    TEST_ASSERT_EQUAL(ESP_OK, config_diff(&a, &b, &diff));
+    for (size_t i = 0; i < diff.n_section; ++i) {
+        TEST_ASSERT(!diff.section[i].changed);
+    }
+    config_diff_free(&diff);
+    TEST_ASSERT_EQUAL(ESP_OK, config_diff(NULL, NULL, &diff));
+    TEST_ASSERT(!config_diff_changed(&diff, CONFIG_SECTION_TASK));
+    config_diff_free(&diff);
+}
+
+static void test_scalar_section_change(void) {
+    Hydroponics__Sampling sa = HYDROPONICS__SAMPLING__INIT, sb = HYDROPONICS__SAMPLING__INIT;
+    sa.tank_ms = 1000;
+    sb.tank_ms = 2000;
+    Hydroponics__Config a = HYDROPONICS__CONFIG__INIT, b = HYDROPONICS__CONFIG__INIT;
+    a.sampling = &sa;
+    b.sampling = &sb;
+    config_diff_t diff;
+    TEST_ASSERT_EQUAL(ESP_OK, config_diff(&a, &b, &diff));
+    TEST_ASSERT(config_diff_changed(&diff, CONFIG_SECTION_SAMPLING));
+    TEST_ASSERT(!config_diff_changed(&diff, CONFIG_SECTION_TASK));
+    TEST_ASSERT(!config_diff_changed(&diff, CONFIG_SECTION_STARTUP_STATE));
+    TEST_ASSERT_EQUAL(0, config_diff_section(&diff, CONFIG_SECTION_SAMPLING)->n_entry);
+    config_diff_free(&diff);
+
+    // Missing and default valued sub-messages are not the same thing on the wire.
+    b.sampling = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, config_diff(&a, &b, &diff));
+    TEST_ASSERT(config_diff_changed(&diff, CONFIG_SECTION_SAMPLING));
+    config_diff_free(&diff);
+}
+
+static const config_diff_entry_t *find_entry(const config_diff_section_t *section, config_diff_kind_t kind,
+                                             int old_index, int new_index) {
+    for (size_t i = 0; i < section->n_entry; ++i) {
+        const config_diff_entry_t *e = &section->entry[i];
+        if (e->kind == kind && e->old_index == old_index && e->new_index == new_index) {
+            return e;
+        }
+    }
+    return NULL;
+}
+
+static void test_tasks_are_matched_by_name(void) {
+    // Old: lights, pump, fan. New: pump (new schedule), lights, mixer.
+    task_set(&tasks[0][0], "lights", OUT_A, CRON_MINUTE);
+    task_set(&tasks[0][1], "pump", OUT_B, CRON_MINUTE);
+    task_set(&tasks[0][2], "fan", OUT_B, CRON_HALF);
+    task_set(&tasks[1][0], "pump", OUT_B, CRON_HALF);
+    task_set(&tasks[1][1], "lights", OUT_A, CRON_MINUTE);
+    task_set(&tasks[1][2], "mixer", OUT_A, CRON_HALF);
+    for (int i = 0; i < 3; ++i) {
+        task_ptrs[0][i] = &tasks[0][i];
+        task_ptrs[1][i] = &tasks[1][i];
+    }
+    Hydroponics__Config a = HYDROPONICS__CONFIG__INIT, b = HYDROPONICS__CONFIG__INIT;
+    a.n_task = 3;
+    a.task = task_ptrs[0];
+    b.n_task = 3;
+    b.task = task_ptrs[1];
+
+    config_diff_t diff;
+    TEST_ASSERT_EQUAL(ESP_OK, config_diff(&a, &b, &diff));
+    const config_diff_section_t *section = config_diff_section(&diff, CONFIG_SECTION_TASK);
+    TEST_ASSERT(section != NULL && section->changed);
+    TEST_ASSERT_EQUAL(3, section->n_entry);
+    TEST_ASSERT(find_entry(section, CONFIG_DIFF_CHANGED, 1, 0) != NULL);
+    TEST_ASSERT(find_entry(section, CONFIG_DIFF_ADDED, -1, 2) != NULL);
+    TEST_ASSERT(find_entry(section, CONFIG_DIFF_REMOVED, 2, -1) != NULL);
+    config_diff_free(&diff);
+
+    // Everything is added from nothing and removed to nothing.
+    TEST_ASSERT_EQUAL(ESP_OK, config_diff(NULL, &a, &diff));
+    section = config_diff_section(&diff, CONFIG_SECTION_TASK);
+    TEST_ASSERT_EQUAL(3, section->n_entry);
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT(find_entry(section, CONFIG_DIFF_ADDED, -1, i) != NULL);
+    }
+    config_diff_free(&diff);
+    TEST_ASSERT_EQUAL(ESP_OK, config_diff(&a, NULL, &diff));
+    section = config_diff_section(&diff, CONFIG_SECTION_TASK);
+    TEST_ASSERT_EQUAL(3, section->n_entry);
+    TEST_ASSERT(find_entry(section, CONFIG_DIFF_REMOVED, 1, -1) != NULL);
+    config_diff_free(&diff);
+}
+
+static void test_reordering_is_not_a_change(void) {
+    task_set(&tasks[0][0], "lights", OUT_A, CRON_MINUTE);
+    task_set(&tasks[0][1], "pump", OUT_B, CRON_HALF);
+    task_ptrs[0][0] = &tasks[0][0];
+    task_ptrs[0][1] = &tasks[0][1];
+    task_ptrs[1][0] = &tasks[0][1];
+    task_ptrs[1][1] = &tasks[0][0];
+    Hydroponics__Config a = HYDROPONICS__CONFIG__INIT, b = HYDROPONICS__CONFIG__INIT;
+    a.n_task = 2;
+    a.task = task_ptrs[0];
+    b.n_task = 2;
+    b.task = task_ptrs[1];
+    config_diff_t diff;
+    TEST_ASSERT_EQUAL(ESP_OK, config_diff(&a, &b, &diff));
+    TEST_ASSERT(!config_diff_changed(&diff, CONFIG_SECTION_TASK));
+    config_diff_free(&diff);
+}
+
+// Reversed order with every 50th task edited, the time is only printed.
+static void test_large_config(void) {
+    for (int i = 0; i < MAX_TASKS; ++i) {
+        snprintf(names[i], sizeof(names[i]), "task%d", i);
+        task_set(&tasks[0][i], names[i], OUT_A, CRON_MINUTE);
+        task_set(&tasks[1][MAX_TASKS - 1 - i], names[i], OUT_A, i % 50 == 0 ? CRON_HALF : CRON_MINUTE);
+        task_ptrs[0][i] = &tasks[0][i];
+        task_ptrs[1][i] = &tasks[1][i];
+    }
+    Hydroponics__Config a = HYDROPONICS__CONFIG__INIT, b = HYDROPONICS__CONFIG__INIT;
+    a.n_task = MAX_TASKS;
+    a.task = task_ptrs[0];
+    b.n_task = MAX_TASKS;
+    b.task = task_ptrs[1];
+
+    config_diff_t diff;
+    clock_t start = clock();
+    const int rounds = 20;
+    for (int i = 0; i < rounds; ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, config_diff(&a, &b, &diff));
+        if (i + 1 < rounds) {
+            config_diff_free(&diff);
+        }
+    }
+    double ms = (double) (clock() - start) * 1000 / CLOCKS_PER_SEC / rounds;
+    printf("  %d tasks: %.3f ms per diff\n", MAX_TASKS, ms);
+    const config_diff_section_t *section = config_diff_section(&diff, CONFIG_SECTION_TASK);
+    TEST_ASSERT_EQUAL(MAX_TASKS / 50, section->n_entry);
+    for (size_t i = 0; i < section->n_entry; ++i) {
+        TEST_ASSERT_EQUAL(CONFIG_DIFF_CHANGED, section->entry[i].kind);
+        TEST_ASSERT_EQUAL(MAX_TASKS - 1 - section->entry[i].old_index, section->entry[i].new_index);
+    }
+    config_diff_free(&diff);
+}
+
+int main(void) {
+    RUN_TEST(test_identical_configs);
+    RUN_TEST(test_scalar_section_change);
+    RUN_TEST(test_tasks_are_matched_by_name);
+    RUN_TEST(test_reordering_is_not_a_change);
+    RUN_TEST(test_large_config);
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <stddef.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "config_flash.h"
+#include "esp_partition.h"
+#include "test.h"
+#include "utils.h"
+
+#define PARTITION_SIZE (64 * 1024)
+#define SLOT_SIZE      (PARTITION_SIZE / CONFIG_FLASH_SLOTS)
+#define DATA_OFFSET    64
+
+static uint8_t config[3][8192];
+
+static config_digest_t digest_of(uint32_t version, const uint8_t *data, uint32_t size) {
+    config_digest_t digest = {.version = version, .size = size};
+    TEST_ASSERT_EQUAL(ESP_OK, sha256(data, size, digest.sha256));
+    return digest;
+}
+
+static void stage(uint32_t version, uint32_t size) {
+    const uint8_t *data = config[version % 3];
+    memset((uint8_t *) data, (int) version, size);
+    config_digest_t digest = digest_of(version, data, size);
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_stage(data, &digest));
+}
+
+static void assert_active(uint32_t version, uint32_t size) {
+    const uint8_t *data = NULL;
+    config_digest_t digest;
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_read(&data, &digest));
+    TEST_ASSERT_EQUAL(version, digest.version);
+    TEST_ASSERT_EQUAL(size, digest.size);
+    for (uint32_t i = 0; i < size; ++i) {
+        TEST_ASSERT_EQUAL(version & 0xff, data[i]);
+    }
+}
+
+// Unlike a restart the mappings of the last run stay around, config_flash_init drops them.
+static void reboot(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_init());
+}
+
+static void format(void) {
+    host_partition_create(CONFIG_FLASH_PARTITION, PARTITION_SIZE);
+    reboot();
+}
+
+static void test_blank_partition(void) {
+    format();
+    const uint8_t *data = NULL;
+    config_digest_t digest;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, config_flash_read(&data, &digest));
+    TEST_ASSERT(!config_flash_pending());
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_flash_rollback());
+
+    host_partition_destroy();
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, config_flash_init());
+}
+
+static void test_stage_commit_and_reboot(void) {
+    format();
+    stage(1, 300);
+    TEST_ASSERT(config_flash_pending());
+    assert_active(1, 300);
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+    TEST_ASSERT(!config_flash_pending());
+    reboot();
+    assert_active(1, 300);
+
+    // The next one goes to the other slot, the newest committed wins at boot.
+    stage(2, 500);
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+    stage(3, 100);
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+    reboot();
+    assert_active(3, 100);
+    TEST_ASSERT_EQUAL(2, host_partition_mapped());
+}
+
+static void test_pending_config_is_rejected_at_boot(void) {
+    format();
+    stage(1, 300);
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+    stage(2, 200);
+    // A pending config replaced by another one takes its slot, v1 stays the fallback.
+    stage(3, 250);
+    assert_active(3, 250);
+    reboot();
+    TEST_ASSERT(!config_flash_pending());
+    assert_active(1, 300);
+    // Rejected for good.
+    reboot();
+    assert_active(1, 300);
+}
+
+static void test_rollback(void) {
+    format();
+    stage(1, 300);
+    // Nothing to go back to.
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_rollback());
+    const uint8_t *data = NULL;
+    config_digest_t digest;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, config_flash_read(&data, &digest));
+
+    stage(1, 300);
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+    stage(2, 400);
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_rollback());
+    assert_active(1, 300);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_flash_rollback());
+    reboot();
+    assert_active(1, 300);
+    TEST_ASSERT_EQUAL(1, host_partition_mapped());
+}
+
+static void test_corrupted_config_is_ignored(void) {
+    format();
+    stage(1, 300);
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+    stage(2, 300);
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+    // v2 is in the second slot.
+    host_partition_corrupt(SLOT_SIZE + DATA_OFFSET + 123, 0x10);
+    reboot();
+    assert_active(1, 300);
+
+    host_partition_corrupt(DATA_OFFSET, 0x01);
+    reboot();
+    const uint8_t *data = NULL;
+    config_digest_t digest;
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, config_flash_read(&data, &digest));
+}
+
+// Cuts the power at every flash operation of a stage, the committed config must survive all of them.
+static void test_power_loss_while_staging(void) {
+    for (int n = 0;; ++n) {
+        format();
+        stage(1, 300);
+        TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+
+        fflush(stdout);
+        pid_t pid = fork();
+        TEST_ASSERT(pid >= 0);
+        if (pid == 0) {
+            host_partition_power_loss_after(n);
+            stage(2, 5000);
+            TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+            _exit(2);
+        }
+        int status = 0;
+        TEST_ASSERT(waitpid(pid, &status, 0) == pid && WIFEXITED(status));
+        reboot();
+        if (WEXITSTATUS(status) == 2) {
+            // Erase, data, header and the commit mark.
+            TEST_ASSERT_EQUAL(4, n);
+            assert_active(2, 5000);
+            break;
+        }
+        TEST_ASSERT_EQUAL(0, WEXITSTATUS(status));
+        // Staged but not committed, rejected like any config that did not survive its health window.
+        assert_active(1, 300);
+        TEST_ASSERT(!config_flash_pending());
+    }
+}
+
+static void test_deleted_config(void) {
+    format();
+    stage(1, 300);
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+    config_digest_t deleted = {.version = 2};
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_stage(NULL, &deleted));
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_commit());
+    reboot();
+    const uint8_t *data = config[0];
+    config_digest_t digest;
+    TEST_ASSERT_EQUAL(ESP_OK, config_flash_read(&data, &digest));
+    TEST_ASSERT_EQUAL(2, digest.version);
+    TEST_ASSERT_EQUAL(0, digest.size);
+    TEST_ASSERT(data == NULL);
+}
+
+static void test_invalid_stage_is_rejected(void) {
+    format();
+    config_digest_t digest = {.version = 1, .size = SLOT_SIZE - DATA_OFFSET + 1};
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_flash_stage(config[0], &digest));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_flash_stage(config[0], NULL));
+    digest.size = 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_flash_stage(NULL, &digest));
+    TEST_ASSERT(!config_flash_pending());
+}
+
+int main(void) {
+    RUN_TEST(test_blank_partition);
+    RUN_TEST(test_stage_commit_and_reboot);
+    RUN_TEST(test_pending_config_is_rejected_at_boot);
+    RUN_TEST(test_rollback);
+    RUN_TEST(test_corrupted_config_is_ignored);
+    RUN_TEST(test_power_loss_while_staging);
+    RUN_TEST(test_deleted_config);
+    RUN_TEST(test_invalid_stage_is_rejected);
+    host_partition_destroy();
+    return 0;
+}
@@ -0,0 +1,119 @@
+#include <stdio.h>
+
+#include "config_validate.h"
+#include "cron.h"
+#include "test.h"
+
+#define MAX_TASKS (CONFIG_ESP_CRON_MAX_JOBS / 2 + 1)
+
+static Hydroponics__Output OUT_GPIO[] = {HYDROPONICS__OUTPUT__EXT_GPIO_A_0, HYDROPONICS__OUTPUT__EXT_GPIO_B_7};
+static Hydroponics__Output OUT_TUYA[] = {HYDROPONICS__OUTPUT__EXT_TUYA_OUT_3};
+static Hydroponics__Output OUT_UNMAPPED[] = {HYDROPONICS__OUTPUT__EXT_GPIO_A_1, 50};
+
+static Hydroponics__Task tasks[MAX_TASKS];
+static Hydroponics__Task *task_ptrs[MAX_TASKS];
+static Hydroponics__Task__Cron crons[MAX_TASKS];
+static Hydroponics__Task__Cron *cron_ptrs[MAX_TASKS];
+static char *expressions[MAX_TASKS][1];
+static char names[MAX_TASKS][16];
+
+// Builds a config of `n` tasks, each with one expression.
+static Hydroponics__Config config_with_tasks(size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        snprintf(names[i], sizeof(names[i]), "task%u", (unsigned int) i);
+        expressions[i][0] = "0 */5 6-22 * * 1-5";
+        crons[i] = (Hydroponics__Task__Cron) HYDROPONICS__TASK__CRON__INIT;
+        crons[i].state = HYDROPONICS__OUTPUT_STATE__ON;
+        crons[i].n_expression = 1;
+        crons[i].expression = expressions[i];
+        cron_ptrs[i] = &crons[i];
+        tasks[i] = (Hydroponics__Task) HYDROPONICS__TASK__INIT;
+        tasks[i].name = names[i];
+        tasks[i].n_output = 2;
+        tasks[i].output = OUT_GPIO;
+        tasks[i].n_cron = 1;
+        tasks[i].cron = &cron_ptrs[i];
+        task_ptrs[i] = &tasks[i];
+    }
+    Hydroponics__Config config = HYDROPONICS__CONFIG__INIT;
+    config.n_task = n;
+    config.task = task_ptrs;
+    return config;
+}
+
+static void test_valid_config(void) {
+    Hydroponics__Config config = HYDROPONICS__CONFIG__INIT;
+    TEST_ASSERT_EQUAL(ESP_OK, config_validate(&config));
+    config = config_with_tasks(3);
+    tasks[2].output = OUT_TUYA;
+    tasks[2].n_output = 1;
+    TEST_ASSERT_EQUAL(ESP_OK, config_validate(&config));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_validate(NULL));
+}
+
+static void test_invalid_cron_expressions(void) {
+    char *invalid[] = {"", "0 * * * *", "* * * * * * *", "60 * * * * *", "0 0 24 * * *", "0 0 0 0 * *",
+                       "0 0 0 * 13 *", "0 0 0 * * 8", "0 10-5 * * * *", "0 */0 * * * *", "0 1,,2 * * * *",
+                       "0 a * * * *"};
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i) {
+        Hydroponics__Config config = config_with_tasks(2);
+        expressions[1][0] = invalid[i];
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_validate(&config));
+    }
+}
+
+static void test_invalid_tasks(void) {
+    Hydroponics__Config config = config_with_tasks(3);
+    tasks[1].name = "";
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_validate(&config));
+
+    config = config_with_tasks(3);
+    tasks[2].name = names[0];
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_validate(&config));
+
+    config = config_with_tasks(3);
+    tasks[0].n_output = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_validate(&config));
+
+    config = config_with_tasks(3);
+    tasks[1].output = OUT_UNMAPPED;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_validate(&config));
+
+    config = config_with_tasks(3);
+    crons[2].state = 7;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_validate(&config));
+}
+
+static void test_invalid_startup_state(void) {
+    Hydroponics__StartupState state = HYDROPONICS__STARTUP_STATE__INIT;
+    Hydroponics__StartupState *states[] = {&state};
+    state.state = HYDROPONICS__OUTPUT_STATE__ON;
+    state.n_output = 2;
+    state.output = OUT_GPIO;
+    Hydroponics__Config config = config_with_tasks(1);
+    config.n_startup_state = 1;
+    config.startup_state = states;
+    TEST_ASSERT_EQUAL(ESP_OK, config_validate(&config));
+    state.output = OUT_UNMAPPED;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_validate(&config));
+    state.output = OUT_GPIO;
+    state.state = -1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_validate(&config));
+}
+
+// Half of the cron pool is left for the monitoring jobs and impulses.
+static void test_schedules_must_fit_in_the_pool(void) {
+    Hydroponics__Config config = config_with_tasks(MAX_TASKS - 1);
+    TEST_ASSERT_EQUAL(ESP_OK, config_validate(&config));
+    config = config_with_tasks(MAX_TASKS);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, config_validate(&config));
+}
+
+int main(void) {
+    RUN_TEST(test_valid_config);
+    RUN_TEST(test_invalid_cron_expressions);
+    RUN_TEST(test_invalid_tasks);
+    RUN_TEST(test_invalid_startup_state);
+    RUN_TEST(test_schedules_must_fit_in_the_pool);
+    return 0;
+}
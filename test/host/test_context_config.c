@@ -0,0 +1,90 @@
+#include <pthread.h>
+
+#include "context_config.h"
+#include "test.h"
+
+#define SUBSCRIBERS 7
+
+static int frees = 0;
+
+// Counts the frees instead, the configs live on the test stack.
+void __wrap_hydroponics__config__free_unpacked(Hydroponics__Config *message, ProtobufCAllocator *allocator) {
+    frees++;
+}
+
+// Every subscriber gets the same instance, it is freed once with the last reference.
+static void test_subscribers_share_one_config(void) {
+    Hydroponics__Config config = HYDROPONICS__CONFIG__INIT;
+    frees = 0;
+    TEST_ASSERT(context_config_share(&config));
+    for (int i = 0; i < SUBSCRIBERS; ++i) {
+        TEST_ASSERT(context_config_acquire(&config));
+    }
+    TEST_ASSERT_EQUAL(1, context_config_shared());
+
+    // Replaced in the context, the subscribers still hold it.
+    context_config_release(&config);
+    for (int i = 0; i < SUBSCRIBERS - 1; ++i) {
+        context_config_release(&config);
+        TEST_ASSERT_EQUAL(0, frees);
+    }
+    context_config_release(&config);
+    TEST_ASSERT_EQUAL(1, frees);
+    TEST_ASSERT_EQUAL(0, context_config_shared());
+    TEST_ASSERT(!context_config_acquire(&config));
+}
+
+// Past the table a config is not shared, every reference is then a private copy freed on its own.
+static void test_full_table_falls_back_to_copies(void) {
+    Hydroponics__Config configs[CONTEXT_CONFIG_SHARED + 1];
+    frees = 0;
+    for (int i = 0; i < CONTEXT_CONFIG_SHARED; ++i) {
+        TEST_ASSERT(context_config_share(&configs[i]));
+    }
+    TEST_ASSERT(!context_config_share(&configs[CONTEXT_CONFIG_SHARED]));
+    TEST_ASSERT(!context_config_acquire(&configs[CONTEXT_CONFIG_SHARED]));
+    context_config_release(&configs[CONTEXT_CONFIG_SHARED]);
+    TEST_ASSERT_EQUAL(1, frees);
+
+    // A released slot is reused.
+    context_config_release(&configs[0]);
+    TEST_ASSERT(context_config_share(&configs[CONTEXT_CONFIG_SHARED]));
+    for (int i = 1; i <= CONTEXT_CONFIG_SHARED; ++i) {
+        context_config_release(&configs[i]);
+    }
+    TEST_ASSERT_EQUAL(CONTEXT_CONFIG_SHARED + 2, frees);
+    TEST_ASSERT_EQUAL(0, context_config_shared());
+}
+
+static Hydroponics__Config contended = HYDROPONICS__CONFIG__INIT;
+
+static void *subscriber(void *arg) {
+    for (int i = 0; i < 10000; ++i) {
+        TEST_ASSERT(context_config_acquire(&contended));
+        context_config_release(&contended);
+    }
+    return NULL;
+}
+
+// Subscribers on other tasks take and drop references while the context holds its own.
+static void test_concurrent_references(void) {
+    frees = 0;
+    TEST_ASSERT(context_config_share(&contended));
+    pthread_t threads[SUBSCRIBERS];
+    for (int i = 0; i < SUBSCRIBERS; ++i) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, subscriber, NULL));
+    }
+    for (int i = 0; i < SUBSCRIBERS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    TEST_ASSERT_EQUAL(0, frees);
+    context_config_release(&contended);
+    TEST_ASSERT_EQUAL(1, frees);
+}
+
+int main(void) {
+    RUN_TEST(test_subscribers_share_one_config);
+    RUN_TEST(test_full_table_falls_back_to_copies);
+    RUN_TEST(test_concurrent_references);
+    return 0;
+}
@@ -0,0 +1,223 @@
+#include <pthread.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "esp_attr.h"
+#include "esp_system.h"
+
+#include "crashlog.h"
+#include "test.h"
+
+#define THREADS       4
+#define THREAD_LINES  200000
+#define BENCH_LINES   500000
+#define PRI_ERROR     ((1 << 3) | 3)
+#define EVENT_NETWORK (1 << 11)
+#define EVENT_CONFIG  (1 << 14)
+
+typedef void (*boot_t)(const crashlog_previous_t *previous);
+
+// Every boot runs in a forked child, DRAM starts over while the RTC section is carried over. Returning from `run` is
+// the reset.
+static void boot(esp_reset_reason_t reason, boot_t run) {
+    fflush(stdout);
+    pid_t pid = fork();
+    TEST_ASSERT(pid >= 0);
+    if (pid == 0) {
+        host_rtc_restore();
+        host_set_reset_reason(reason);
+        TEST_ASSERT_EQUAL(ESP_OK, crashlog_init());
+        TEST_ASSERT(crashlog_previous() != NULL);
+        TEST_ASSERT_EQUAL(reason, crashlog_previous()->reason);
+        run(crashlog_previous());
+        host_rtc_save();
+        fflush(stdout);
+        _exit(0);
+    }
+    int status = 0;
+    TEST_ASSERT(waitpid(pid, &status, 0) == pid && WIFEXITED(status));
+    TEST_ASSERT_EQUAL(0, WEXITSTATUS(status));
+}
+
+static void append(const char *fmt, ...) __printflike(1, 2);
+
+static void append(const char *fmt, ...) {
+    char line[256];
+    va_list va;
+    va_start(va, fmt);
+    int len = vsnprintf(line, sizeof(line), fmt, va);
+    va_end(va);
+    crashlog_append(PRI_ERROR, line, len);
+}
+
+static void assert_line(const crashlog_line_t *line, const char *expected) {
+    TEST_ASSERT_EQUAL(strlen(expected), line->len);
+    TEST_ASSERT(memcmp(line->data, expected, line->len) == 0);
+}
+
+static void log_lines(const crashlog_previous_t *previous) {
+    (void) previous;
+    for (int i = 0; i < 40; ++i) {
+        append("line %d", i);
+    }
+    crashlog_event(EVENT_NETWORK, true);
+    crashlog_event(EVENT_CONFIG, true);
+    crashlog_event(EVENT_NETWORK, false);
+}
+
+static void expect_nothing(const crashlog_previous_t *previous) {
+    TEST_ASSERT_EQUAL(0, previous->n_lines);
+    TEST_ASSERT_EQUAL(0, previous->n_events);
+    TEST_ASSERT_EQUAL(0, previous->boot_count);
+}
+
+static void expect_last_lines(const crashlog_previous_t *previous) {
+    TEST_ASSERT_EQUAL(1, previous->boot_count);
+    // The oldest were overwritten, the rest comes out oldest first.
+    TEST_ASSERT_EQUAL(CONFIG_ESP_CRASHLOG_LINES, previous->n_lines);
+    char expected[16];
+    for (size_t i = 0; i < previous->n_lines; ++i) {
+        snprintf(expected, sizeof(expected), "line %d", (int) (40 - CONFIG_ESP_CRASHLOG_LINES + i));
+        assert_line(&previous->lines[i], expected);
+        TEST_ASSERT_EQUAL(PRI_ERROR, previous->lines[i].pri);
+    }
+    TEST_ASSERT_EQUAL(3, previous->n_events);
+    TEST_ASSERT_EQUAL(EVENT_NETWORK | CRASHLOG_EVENT_SET, previous->events[0].bits);
+    TEST_ASSERT_EQUAL(EVENT_CONFIG | CRASHLOG_EVENT_SET, previous->events[1].bits);
+    TEST_ASSERT_EQUAL(EVENT_NETWORK, previous->events[2].bits);
+    TEST_ASSERT(previous->events[0].timestamp_ms <= previous->events[2].timestamp_ms);
+    TEST_ASSERT_EQUAL(0, strcmp("panic", crashlog_reason_name(previous->reason)));
+}
+
+static void expect_second_boot(const crashlog_previous_t *previous) {
+    // Taken out of RTC memory, the boot after does not report them again.
+    TEST_ASSERT_EQUAL(2, previous->boot_count);
+    TEST_ASSERT_EQUAL(0, previous->n_lines);
+    TEST_ASSERT_EQUAL(0, previous->n_events);
+}
+
+static void log_long_line(const crashlog_previous_t *previous) {
+    (void) previous;
+    char line[300];
+    memset(line, 'x', sizeof(line));
+    crashlog_append(PRI_ERROR, line, sizeof(line));
+    crashlog_append(PRI_ERROR, "", 0);
+}
+
+static void expect_truncated(const crashlog_previous_t *previous) {
+    TEST_ASSERT_EQUAL(2, previous->n_lines);
+    TEST_ASSERT_EQUAL(CRASHLOG_LINE_SIZE, previous->lines[0].len);
+    TEST_ASSERT_EQUAL('x', previous->lines[0].data[CRASHLOG_LINE_SIZE - 1]);
+    TEST_ASSERT_EQUAL(0, previous->lines[1].len);
+}
+
+// Nothing is kept across a power cycle, whatever the RTC memory holds.
+static void test_power_on_starts_empty(void) {
+    boot(ESP_RST_POWERON, log_lines);
+    boot(ESP_RST_POWERON, expect_nothing);
+}
+
+static void test_lines_and_events_survive_a_panic(void) {
+    boot(ESP_RST_POWERON, log_lines);
+    boot(ESP_RST_PANIC, expect_last_lines);
+    boot(ESP_RST_TASK_WDT, expect_second_boot);
+}
+
+static void test_long_lines_are_truncated(void) {
+    boot(ESP_RST_POWERON, log_long_line);
+    boot(ESP_RST_INT_WDT, expect_truncated);
+}
+
+// Every line tells its writer and its number, the length and the filler follow from them.
+static void *append_lines(void *arg) {
+    const int thread = (int) (uintptr_t) arg;
+    char line[CRASHLOG_LINE_SIZE];
+    for (int i = 0; i < THREAD_LINES; ++i) {
+        int len = snprintf(line, sizeof(line), "%d %d ", thread, i);
+        size_t total = len + (size_t) (i * 7 + thread) % (sizeof(line) - len);
+        memset(&line[len], 'a' + (i + thread) % 26, total - len);
+        crashlog_append(PRI_ERROR, line, total);
+    }
+    return NULL;
+}
+
+static void log_concurrently(const crashlog_previous_t *previous) {
+    (void) previous;
+    pthread_t threads[THREADS];
+    for (uintptr_t i = 0; i < THREADS; ++i) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, append_lines, (void *) i));
+    }
+    for (int i = 0; i < THREADS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+}
+
+static void expect_whole_lines(const crashlog_previous_t *previous) {
+    TEST_ASSERT(previous->n_lines > 0 && previous->n_lines <= CONFIG_ESP_CRASHLOG_LINES);
+    uint32_t last = 0;
+    for (size_t n = 0; n < previous->n_lines; ++n) {
+        const crashlog_line_t *line = &previous->lines[n];
+        TEST_ASSERT(line->sequence > last);
+        last = line->sequence;
+        char text[CRASHLOG_LINE_SIZE + 1];
+        memcpy(text, line->data, line->len);
+        text[line->len] = '\0';
+        int thread, i, len;
+        TEST_ASSERT(sscanf(text, "%d %d %n", &thread, &i, &len) == 2);
+        TEST_ASSERT(thread >= 0 && thread < THREADS && i >= 0 && i < THREAD_LINES);
+        TEST_ASSERT_EQUAL(len + (size_t) (i * 7 + thread) % (CRASHLOG_LINE_SIZE - len), line->len);
+        for (size_t j = len; j < line->len; ++j) {
+            TEST_ASSERT_EQUAL('a' + (i + thread) % 26, text[j]);
+        }
+    }
+    // Only the last laps are left.
+    TEST_ASSERT(last > THREADS * THREAD_LINES - THREADS * CONFIG_ESP_CRASHLOG_LINES);
+}
+
+static void test_concurrent_appends_are_not_mixed(void) {
+    boot(ESP_RST_POWERON, log_concurrently);
+    boot(ESP_RST_PANIC, expect_whole_lines);
+}
+
+static double elapsed_ns(const struct timespec *start, const struct timespec *end) {
+    return (double) (end->tv_sec - start->tv_sec) * 1e9 + (double) (end->tv_nsec - start->tv_nsec);
+}
+
+// The append runs for every line right after it was formatted, it has to cost less than the formatting.
+static void bench_append(const crashlog_previous_t *previous) {
+    (void) previous;
+    static const char *const TAG = "sensors";
+    char line[256];
+    int len = 0;
+    struct timespec start, formatted, appended;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int i = 0; i < BENCH_LINES; ++i) {
+        len = snprintf(line, sizeof(line), "I (%u) %s: EC %.2f mS/cm, pH %.2f, tank %d%%\n", (unsigned int) i, TAG,
+                       1.2 + i * 1e-6, 6.1, i % 100);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &formatted);
+    for (int i = 0; i < BENCH_LINES; ++i) {
+        crashlog_append(PRI_ERROR, line, len);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &appended);
+    double format_ns = elapsed_ns(&start, &formatted) / BENCH_LINES;
+    double append_ns = elapsed_ns(&formatted, &appended) / BENCH_LINES;
+    printf("  append %.1f ns for a %d byte line, formatting it %.1f ns\n", append_ns, len, format_ns);
+    TEST_ASSERT(append_ns < format_ns);
+}
+
+static void test_append_cost(void) {
+    boot(ESP_RST_POWERON, bench_append);
+}
+
+int main(void) {
+    RUN_TEST(test_power_on_starts_empty);
+    RUN_TEST(test_lines_and_events_survive_a_panic);
+    RUN_TEST(test_long_lines_are_truncated);
+    RUN_TEST(test_concurrent_appends_are_not_mixed);
+    RUN_TEST(test_append_cost);
+    return 0;
+}
@@ -0,0 +1,555 @@
+#include <malloc.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+#include "freertos/semphr.h"
+
+#include "esp_timer.h"
+
+#include "context.h"
+#include "cron.h"
+#include "test.h"
+
+#define US_PER_S    1000000LL
+#define START_S     1709251200LL // 2024-03-01 00:00:00 UTC.
+#define WAIT_MS     2000
+#define BENCH_JOBS  10000
+#define JITTER_MS   50
+#define GROUP_JOBS  500
+#define MINUTE_US   (60 * US_PER_S)
+#define HOUR_US     (60 * MINUTE_US)
+
+typedef struct {
+    atomic_int runs;
+    SemaphoreHandle_t entered; /*!< Given when a run starts, when set. */
+    SemaphoreHandle_t gate;    /*!< The run waits for it, when set. */
+    _Atomic int64_t ran_ns;    /*!< Host monotonic time of the last run. */
+} job_t;
+
+// The wall clock is the esp_timer clock plus an offset the tests step, the FreeRTOS stub waits on the monotonic one.
+static _Atomic int64_t wall_offset_us = START_S * US_PER_S;
+static context_t context;
+static cron_info_t infos[CONFIG_ESP_CRON_MAX_JOBS];
+
+int __real_clock_gettime(clockid_t id, struct timespec *ts);
+
+int __wrap_clock_gettime(clockid_t id, struct timespec *ts) {
+    if (id != CLOCK_REALTIME) {
+        return __real_clock_gettime(id, ts);
+    }
+    int64_t us = atomic_load(&wall_offset_us) + esp_timer_get_time();
+    ts->tv_sec = (time_t) (us / US_PER_S);
+    ts->tv_nsec = (long) (us % US_PER_S) * 1000;
+    return 0;
+}
+
+// Requests are served at the top of the cron task loop and the due jobs dispatched after. The second dump returns once
+// everything queued before the first one was applied and the jobs due by then were dispatched.
+static void sync_cron(void) {
+    size_t count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, cron_dump(infos, 0, &count));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_dump(infos, 0, &count));
+}
+
+static void advance(int64_t us) {
+    sync_cron();
+    host_timer_advance(us);
+    sync_cron();
+}
+
+static int64_t wall_now_us(void) {
+    return atomic_load(&wall_offset_us) + esp_timer_get_time();
+}
+
+// Moves both clocks forward until the wall clock reads `at_us` past a multiple of `period_us`.
+static void advance_to(int64_t period_us, int64_t at_us) {
+    advance(((at_us - wall_now_us() % period_us) % period_us + period_us) % period_us);
+}
+
+// Steps the wall clock only, like an SNTP sync does, and tells cron about it.
+static void step_clock(int64_t us) {
+    sync_cron();
+    atomic_fetch_add(&wall_offset_us, us);
+    TEST_ASSERT_EQUAL(ESP_OK, cron_time_changed());
+    sync_cron();
+}
+
+static void wait_runs(const job_t *job, int expected) {
+    for (int i = 0; i < WAIT_MS && atomic_load(&job->runs) < expected; ++i) {
+        usleep(1000);
+    }
+    // Leave the workers a moment to show a run too many.
+    usleep(5000);
+    TEST_ASSERT_EQUAL(expected, atomic_load(&job->runs));
+}
+
+static int64_t monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void count_run(cron_handle_t handle, const char *name, void *data) {
+    (void) handle;
+    (void) name;
+    job_t *job = data;
+    atomic_store(&job->ran_ns, monotonic_ns());
+    atomic_fetch_add(&job->runs, 1);
+    if (job->entered != NULL) {
+        xSemaphoreGive(job->entered);
+    }
+    if (job->gate != NULL) {
+        xSemaphoreTake(job->gate, portMAX_DELAY);
+    }
+}
+
+static job_t blocking_job(void) {
+    job_t job = {.entered = xSemaphoreCreateBinary(), .gate = xSemaphoreCreateBinary()};
+    TEST_ASSERT(job.entered != NULL && job.gate != NULL);
+    return job;
+}
+
+static void free_job(job_t *job) {
+    vSemaphoreDelete(job->entered);
+    vSemaphoreDelete(job->gate);
+}
+
+static size_t live_jobs(void) {
+    size_t count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, cron_dump(infos, CONFIG_ESP_CRON_MAX_JOBS, &count));
+    return count;
+}
+
+static const cron_info_t *find_info(cron_handle_t handle) {
+    size_t count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, cron_dump(infos, CONFIG_ESP_CRON_MAX_JOBS, &count));
+    for (size_t i = 0; i < count; ++i) {
+        if (infos[i].handle == handle) {
+            return &infos[i];
+        }
+    }
+    return NULL;
+}
+
+static void test_jobs_fire_when_due(void) {
+    job_t every = {0}, fifth = {0}, in = {0}, at = {0};
+    cron_handle_t handles[4];
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create("every", "* * * * * *", count_run, &every, &handles[0]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create("fifth", "5 * * * * *", count_run, &fifth, &handles[1]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_schedule_in("in", 2500, count_run, &in, &handles[2]));
+    struct timespec when = {0};
+    clock_gettime(CLOCK_REALTIME, &when);
+    when.tv_sec += 3;
+    TEST_ASSERT_EQUAL(ESP_OK, cron_schedule_at("at", when, count_run, &at, &handles[3]));
+    sync_cron();
+
+    const int fifth_runs[] = {0, 0, 0, 0, 1, 1};
+    const int in_runs[] = {0, 0, 1, 1, 1, 1};
+    const int at_runs[] = {0, 0, 1, 1, 1, 1};
+    for (int s = 0; s < 6; ++s) {
+        advance(US_PER_S);
+        wait_runs(&every, s + 1);
+        wait_runs(&fifth, fifth_runs[s]);
+        wait_runs(&in, in_runs[s]);
+        wait_runs(&at, at_runs[s]);
+    }
+    // Oneshots free their slot once run.
+    TEST_ASSERT(find_info(handles[2]) == NULL && find_info(handles[3]) == NULL);
+    TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handles[0]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handles[1]));
+    advance(60 * US_PER_S);
+    TEST_ASSERT_EQUAL(6, atomic_load(&every.runs));
+    TEST_ASSERT_EQUAL(1, atomic_load(&fifth.runs));
+    TEST_ASSERT_EQUAL(0, live_jobs());
+}
+
+// A recycled slot gets a new handle, the old one no longer reaches it.
+static void test_stale_handles(void) {
+    job_t job = {0};
+    cron_handle_t old = INVALID_CRON_HANDLE, handle = INVALID_CRON_HANDLE;
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create("old", "0 0 * * * *", count_run, &job, &old));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_delete(old));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create("new", "0 0 * * * *", count_run, &job, &handle));
+    sync_cron();
+    TEST_ASSERT(old != handle);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, cron_set_priority(old, CRON_PRIORITY_HIGH));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_delete(old));
+    TEST_ASSERT(find_info(handle) != NULL);
+    TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handle));
+    TEST_ASSERT_EQUAL(0, live_jobs());
+}
+
+static void test_pool_runs_out(void) {
+    static cron_handle_t handles[CONFIG_ESP_CRON_MAX_JOBS];
+    job_t job = {0};
+    for (size_t i = 0; i < CONFIG_ESP_CRON_MAX_JOBS; ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, cron_create("fill", "0 0 0 * * *", count_run, &job, &handles[i]));
+    }
+    cron_handle_t handle = INVALID_CRON_HANDLE;
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, cron_create("more", "0 0 0 * * *", count_run, &job, &handle));
+    for (size_t i = 0; i < CONFIG_ESP_CRON_MAX_JOBS; ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handles[i]));
+    }
+    TEST_ASSERT_EQUAL(0, live_jobs());
+}
+
+// Both normal workers stay busy with slow jobs, the high priority one keeps its own worker and a fast job still
+// starts within a few milliseconds of being due. Every occurrence of a job that is still running is skipped.
+static void test_slow_jobs_do_not_delay_others(void) {
+    job_t slow[CONFIG_ESP_CRON_WORKERS];
+    cron_handle_t slow_handles[CONFIG_ESP_CRON_WORKERS];
+    for (int i = 0; i < CONFIG_ESP_CRON_WORKERS; ++i) {
+        slow[i] = blocking_job();
+        TEST_ASSERT_EQUAL(ESP_OK, cron_create("slow", "* * * * * *", count_run, &slow[i], &slow_handles[i]));
+    }
+    job_t fast = {0};
+    cron_handle_t fast_handle = INVALID_CRON_HANDLE;
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create_with_priority("fast", "* * * * * *", CRON_PRIORITY_HIGH, count_run, &fast,
+                                                        &fast_handle));
+    advance(US_PER_S);
+    for (int i = 0; i < CONFIG_ESP_CRON_WORKERS; ++i) {
+        TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(slow[i].entered, WAIT_MS));
+    }
+    wait_runs(&fast, 1);
+
+    int64_t max_jitter_ns = 0;
+    for (int s = 2; s <= 10; ++s) {
+        sync_cron();
+        int64_t due_ns = monotonic_ns();
+        host_timer_advance(US_PER_S);
+        sync_cron();
+        wait_runs(&fast, s);
+        int64_t jitter_ns = atomic_load(&fast.ran_ns) - due_ns;
+        max_jitter_ns = jitter_ns > max_jitter_ns ? jitter_ns : max_jitter_ns;
+    }
+    printf("  fast job started at most %.2f ms after being due\n", (double) max_jitter_ns / 1e6);
+    TEST_ASSERT(max_jitter_ns < JITTER_MS * 1000000LL);
+
+    const cron_info_t *info = find_info(fast_handle);
+    TEST_ASSERT(info != NULL);
+    TEST_ASSERT_EQUAL(10, info->stats.runs);
+    TEST_ASSERT_EQUAL(0, info->stats.overruns);
+    TEST_ASSERT_EQUAL(10, info->stats.lateness[0]);
+    for (int i = 0; i < CONFIG_ESP_CRON_WORKERS; ++i) {
+        info = find_info(slow_handles[i]);
+        TEST_ASSERT(info != NULL);
+        TEST_ASSERT_EQUAL(9, info->stats.overruns);
+        TEST_ASSERT_EQUAL(ESP_OK, cron_delete(slow_handles[i]));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, cron_delete(fast_handle));
+    sync_cron();
+    for (int i = 0; i < CONFIG_ESP_CRON_WORKERS; ++i) {
+        xSemaphoreGive(slow[i].gate);
+        wait_runs(&slow[i], 1);
+    }
+    // The workers release the slots of the jobs deleted while running.
+    for (int i = 0; i < WAIT_MS && live_jobs() > 0; ++i) {
+        usleep(1000);
+    }
+    TEST_ASSERT_EQUAL(0, live_jobs());
+    for (int i = 0; i < CONFIG_ESP_CRON_WORKERS; ++i) {
+        free_job(&slow[i]);
+    }
+}
+
+// Jobs deleted while queued behind a busy worker never run, their data may be gone by then. A oneshot left alone
+// still runs.
+static void test_cancel_queued_jobs(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    advance((US_PER_S - now.tv_nsec / 1000) % US_PER_S);
+
+    job_t blocker = blocking_job(), recurring = {0}, cancelled = {0}, kept = {0};
+    cron_handle_t handles[4];
+    TEST_ASSERT_EQUAL(ESP_OK, cron_schedule_in_with_priority("blocker", 500, CRON_PRIORITY_HIGH, count_run, &blocker,
+                                                             &handles[0]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create_with_priority("recurring", "* * * * * *", CRON_PRIORITY_HIGH, count_run,
+                                                        &recurring, &handles[1]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_schedule_in_with_priority("cancelled", 1000, CRON_PRIORITY_HIGH, count_run,
+                                                             &cancelled, &handles[2]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_schedule_in_with_priority("kept", 1000, CRON_PRIORITY_HIGH, count_run, &kept,
+                                                             &handles[3]));
+    advance(US_PER_S / 2);
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(blocker.entered, WAIT_MS));
+    // The other three are queued behind the blocker on the high priority worker.
+    advance(US_PER_S / 2);
+    TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handles[1]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handles[2]));
+    sync_cron();
+    xSemaphoreGive(blocker.gate);
+    wait_runs(&kept, 1);
+    TEST_ASSERT_EQUAL(0, atomic_load(&recurring.runs));
+    TEST_ASSERT_EQUAL(0, atomic_load(&cancelled.runs));
+    TEST_ASSERT_EQUAL(0, live_jobs());
+    free_job(&blocker);
+}
+
+static size_t group_jobs(const char *prefix) {
+    size_t count = 0, members = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, cron_dump(infos, CONFIG_ESP_CRON_MAX_JOBS, &count));
+    for (size_t i = 0; i < count; ++i) {
+        if (strcmp(infos[i].group, "config") == 0) {
+            TEST_ASSERT(strncmp(infos[i].name, prefix, strlen(prefix)) == 0);
+            members++;
+        }
+    }
+    return members;
+}
+
+// Job 0 runs every second, the others once a day.
+static void fill_specs(cron_spec_t *specs, cron_expr *exprs, char (*names)[32], const char *prefix, job_t *job) {
+    for (size_t i = 0; i < GROUP_JOBS; ++i) {
+        char expression[32];
+        snprintf(expression, sizeof(expression), i == 0 ? "* * * * * *" : "%d %d %d * * *", (int) (i % 60),
+                 (int) (i / 60 % 60), (int) (i % 24));
+        TEST_ASSERT_EQUAL(ESP_OK, cron_parse(expression, &exprs[i]));
+        snprintf(names[i], sizeof(names[i]), "%s_%zu", prefix, i);
+        specs[i] = (cron_spec_t) {.name = names[i], .expr = &exprs[i], .callback = count_run, .data = job};
+    }
+}
+
+// Config pushes swap a whole group in a single request of the cron task, the old jobs stop at once.
+static void test_replace_group(void) {
+    static cron_spec_t specs[GROUP_JOBS];
+    static cron_expr exprs[GROUP_JOBS];
+    static char names[GROUP_JOBS][32];
+    static cron_handle_t handles[GROUP_JOBS];
+    job_t old = {0}, new = {0};
+    fill_specs(specs, exprs, names, "old", &old);
+    TEST_ASSERT_EQUAL(ESP_OK, cron_replace_group("config", specs, GROUP_JOBS, handles));
+    TEST_ASSERT_EQUAL(GROUP_JOBS, group_jobs("old"));
+    advance(US_PER_S);
+    wait_runs(&old, 1);
+
+    // Bad specs and a pool too small for the new group leave the old one alone.
+    specs[1].priority = CRON_PRIORITY_MAX;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, cron_replace_group("config", specs, GROUP_JOBS, handles));
+    specs[1].priority = CRON_PRIORITY_NORMAL;
+    specs[1].misfire = CRON_MISFIRE_MAX;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, cron_replace_group("config", specs, GROUP_JOBS, handles));
+    specs[1].misfire = CRON_MISFIRE_FIRE_ONCE;
+    static cron_spec_t many[CONFIG_ESP_CRON_MAX_JOBS];
+    static cron_handle_t many_handles[CONFIG_ESP_CRON_MAX_JOBS];
+    for (size_t i = 0; i < CONFIG_ESP_CRON_MAX_JOBS; ++i) {
+        many[i] = specs[i % GROUP_JOBS];
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NO_MEM, cron_replace_group("config", many, CONFIG_ESP_CRON_MAX_JOBS, many_handles));
+    TEST_ASSERT_EQUAL(GROUP_JOBS, group_jobs("old"));
+    TEST_ASSERT_EQUAL(GROUP_JOBS, live_jobs());
+
+    fill_specs(specs, exprs, names, "new", &new);
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    TEST_ASSERT_EQUAL(ESP_OK, cron_replace_group("config", specs, GROUP_JOBS, handles));
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    printf("  replaced %d jobs in %.2f ms\n", GROUP_JOBS,
+           (double) (end.tv_sec - start.tv_sec) * 1e3 + (double) (end.tv_nsec - start.tv_nsec) / 1e6);
+    TEST_ASSERT_EQUAL(GROUP_JOBS, group_jobs("new"));
+    TEST_ASSERT_EQUAL(GROUP_JOBS, live_jobs());
+    advance(US_PER_S);
+    wait_runs(&new, 1);
+    TEST_ASSERT_EQUAL(1, atomic_load(&old.runs));
+
+    TEST_ASSERT_EQUAL(ESP_OK, cron_replace_group("config", NULL, 0, NULL));
+    TEST_ASSERT_EQUAL(0, live_jobs());
+}
+
+static uint32_t misfires(cron_handle_t handle) {
+    const cron_info_t *info = find_info(handle);
+    TEST_ASSERT(info != NULL);
+    return info->stats.misfires;
+}
+
+// The wall clock jumps over an hourly occurrence, each policy decides whether it still runs.
+static void test_clock_step_forward(void) {
+    advance_to(HOUR_US, 30 * MINUTE_US);
+    job_t once = {0}, skip = {0}, coalesce = {0};
+    cron_handle_t handles[3];
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create_with_misfire("once", "0 0 * * * *", CRON_PRIORITY_NORMAL,
+                                                       CRON_MISFIRE_FIRE_ONCE, count_run, &once, &handles[0]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create_with_misfire("skip", "0 0 * * * *", CRON_PRIORITY_NORMAL, CRON_MISFIRE_SKIP,
+                                                       count_run, &skip, &handles[1]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create_with_misfire("coalesce", "0 0 * * * *", CRON_PRIORITY_NORMAL,
+                                                       CRON_MISFIRE_COALESCE, count_run, &coalesce, &handles[2]));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, cron_create_with_misfire("bad", "0 0 * * * *", CRON_PRIORITY_NORMAL,
+                                                                    CRON_MISFIRE_MAX, count_run, &once, NULL));
+
+    // Missed half an hour ago, beyond the grace period.
+    step_clock(HOUR_US);
+    wait_runs(&once, 1);
+    wait_runs(&skip, 0);
+    wait_runs(&coalesce, 0);
+    // Missed two minutes ago.
+    step_clock(32 * MINUTE_US);
+    wait_runs(&once, 2);
+    wait_runs(&skip, 0);
+    wait_runs(&coalesce, 1);
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_EQUAL(2, misfires(handles[i]));
+    }
+    // Back on schedule.
+    advance(58 * MINUTE_US);
+    wait_runs(&once, 3);
+    wait_runs(&skip, 1);
+    wait_runs(&coalesce, 2);
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_EQUAL(2, misfires(handles[i]));
+        TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handles[i]));
+    }
+    TEST_ASSERT_EQUAL(0, live_jobs());
+}
+
+// An occurrence that already ran is not repeated when the clock goes back, the job waits for the next new one.
+static void test_clock_step_back(void) {
+    advance_to(MINUTE_US, 30 * US_PER_S);
+    job_t job = {0};
+    cron_handle_t handle = INVALID_CRON_HANDLE;
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create("minute", "0 * * * * *", count_run, &job, &handle));
+    advance(30 * US_PER_S);
+    wait_runs(&job, 1);
+
+    step_clock(-5 * MINUTE_US);
+    advance(6 * MINUTE_US - US_PER_S);
+    wait_runs(&job, 1);
+    advance(US_PER_S);
+    wait_runs(&job, 2);
+    TEST_ASSERT_EQUAL(0, misfires(handle));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handle));
+    TEST_ASSERT_EQUAL(0, live_jobs());
+}
+
+// SNTP syncs on a second a job is due and the cron task sees the sync before it dispatches the job. The job still
+// runs and small corrections over an occurrence are not misfires, larger ones are.
+static void test_sync_on_due_second(void) {
+    advance_to(MINUTE_US, 30 * US_PER_S);
+    job_t job = {0};
+    cron_handle_t handle = INVALID_CRON_HANDLE;
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create_with_misfire("minute", "0 * * * * *", CRON_PRIORITY_NORMAL,
+                                                       CRON_MISFIRE_SKIP, count_run, &job, &handle));
+    sync_cron();
+    // The cron task sleeps for another 30 s of host time, the sync is served first. The step is beyond the tolerance
+    // but the job was due before it.
+    host_timer_advance(30 * US_PER_S);
+    atomic_fetch_add(&wall_offset_us, 5 * US_PER_S);
+    TEST_ASSERT_EQUAL(ESP_OK, cron_time_changed());
+    sync_cron();
+    wait_runs(&job, 1);
+
+    advance_to(MINUTE_US, MINUTE_US - 200 * 1000);
+    step_clock(500 * 1000);
+    wait_runs(&job, 2);
+    TEST_ASSERT_EQUAL(0, misfires(handle));
+
+    advance_to(MINUTE_US, MINUTE_US - 500 * 1000);
+    step_clock(2 * US_PER_S);
+    wait_runs(&job, 2);
+    TEST_ASSERT_EQUAL(1, misfires(handle));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handle));
+    TEST_ASSERT_EQUAL(0, live_jobs());
+}
+
+// Walks a local day in half hour steps, an hourly job runs once per elapsed hour and daily ones once.
+static void run_local_day(int year, int month, int day, int hours) {
+    struct tm tm = {.tm_year = year - 1900, .tm_mon = month - 1, .tm_mday = day, .tm_isdst = -1};
+    time_t midnight = mktime(&tm);
+    step_clock((int64_t) midnight * US_PER_S - wall_now_us());
+
+    job_t hourly = {0}, early = {0}, late = {0};
+    cron_handle_t handles[3];
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create("hourly", "0 30 * * * *", count_run, &hourly, &handles[0]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create("early", "0 30 1 * * *", count_run, &early, &handles[1]));
+    TEST_ASSERT_EQUAL(ESP_OK, cron_create("late", "0 30 3 * * *", count_run, &late, &handles[2]));
+    for (int i = 1; i <= 2 * hours; ++i) {
+        advance(30 * MINUTE_US);
+        wait_runs(&hourly, (i + 1) / 2);
+    }
+    wait_runs(&early, 1);
+    wait_runs(&late, 1);
+    for (int i = 0; i < 3; ++i) {
+        TEST_ASSERT_EQUAL(0, misfires(handles[i]));
+        TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handles[i]));
+    }
+    TEST_ASSERT_EQUAL(0, live_jobs());
+}
+
+// 01:30 happens twice when DST ends and 02:30 never when it starts.
+static void test_dst_transitions(void) {
+    setenv("TZ", "PST8PDT,M3.2.0,M11.1.0", 1);
+    tzset();
+    run_local_day(2024, 3, 10, 23);
+    run_local_day(2024, 11, 3, 25);
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    TEST_ASSERT_EQUAL(ESP_OK, cron_time_changed());
+    sync_cron();
+}
+
+static double elapsed_ns(const struct timespec *start, const struct timespec *end) {
+    return (double) (end->tv_sec - start->tv_sec) * 1e9 + (double) (end->tv_nsec - start->tv_nsec);
+}
+
+// Creates and deletes n jobs spread over the day, each request is a round trip through the cron task queue.
+static void bench_jobs(size_t n, double *create_ns, double *delete_ns) {
+    static cron_handle_t handles[BENCH_JOBS];
+    job_t job = {0};
+    char expression[32];
+    struct timespec start, created, deleted;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (size_t i = 0; i < n; ++i) {
+        snprintf(expression, sizeof(expression), "%d %d %d * * *", (int) (i % 60), (int) (i * 7 % 60),
+                 (int) (i * 13 % 24));
+        TEST_ASSERT_EQUAL(ESP_OK, cron_create("bench", expression, count_run, &job, &handles[i]));
+    }
+    sync_cron();
+    clock_gettime(CLOCK_MONOTONIC, &created);
+    // Delete in creation order, the entries come out of the middle of the heap.
+    for (size_t i = 0; i < n; ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, cron_delete(handles[i]));
+    }
+    sync_cron();
+    clock_gettime(CLOCK_MONOTONIC, &deleted);
+    *create_ns = elapsed_ns(&start, &created) / (double) n;
+    *delete_ns = elapsed_ns(&created, &deleted) / (double) n;
+    TEST_ASSERT_EQUAL(0, atomic_load(&job.runs));
+}
+
+// The cost per job stays flat from 100 to 10k jobs, a sorted list would grow a hundredfold. Scheduling takes no
+// memory after init either.
+static void test_scaling(void) {
+    const size_t sizes[] = {100, 1000, BENCH_JOBS};
+    double create_ns[3], delete_ns[3];
+    bench_jobs(BENCH_JOBS, &create_ns[0], &delete_ns[0]);  // Warm up.
+    size_t before = mallinfo2().uordblks;
+    for (size_t i = 0; i < 3; ++i) {
+        bench_jobs(sizes[i], &create_ns[i], &delete_ns[i]);
+        printf("  %5zu jobs: create %.0f ns, delete %.0f ns per job\n", sizes[i], create_ns[i], delete_ns[i]);
+    }
+    TEST_ASSERT_EQUAL(before, mallinfo2().uordblks);
+    TEST_ASSERT(create_ns[2] < 4 * create_ns[0]);
+    TEST_ASSERT(delete_ns[2] < 4 * delete_ns[0]);
+}
+
+int main(void) {
+    setenv("TZ", "UTC0", 1);
+    tzset();
+    context.event_group = xEventGroupCreate();
+    xEventGroupSetBits(context.event_group, CONTEXT_EVENT_TIME);
+    TEST_ASSERT_EQUAL(ESP_OK, cron_init(&context));
+
+    RUN_TEST(test_jobs_fire_when_due);
+    RUN_TEST(test_stale_handles);
+    RUN_TEST(test_pool_runs_out);
+    RUN_TEST(test_slow_jobs_do_not_delay_others);
+    RUN_TEST(test_cancel_queued_jobs);
+    RUN_TEST(test_replace_group);
+    RUN_TEST(test_clock_step_forward);
+    RUN_TEST(test_clock_step_back);
+    RUN_TEST(test_sync_on_due_second);
+    RUN_TEST(test_dst_transitions);
+    RUN_TEST(test_scaling);
+    return 0;
+}
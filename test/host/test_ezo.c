@@ -0,0 +1,297 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "buses.h"
+#include "config.h"
+#include "context.h"
+#include "driver/ezo.h"
+#include "ezo_calibration.h"
+#include "ezo_ec.h"
+#include "ezo_ph.h"
+#include "ezo_rtd.h"
+#include "sampling.h"
+#include "sensors.h"
+#include "simulation.h"
+#include "test.h"
+
+#define MAX_SWEEPS 32
+#define MAX_WRITES 128
+
+typedef enum {
+    MODULE_EC = 0,
+    MODULE_PH = 1,
+    MODULE_RTD = 2,
+    MODULE_MAX,
+} module_t;
+
+static const char *const NAMES[MODULE_MAX] = {"ec", "ph", "rtd"};
+static const uint16_t DELAYS_MS[MODULE_MAX] = {EZO_DELAY_MS_SLOW, EZO_DELAY_MS_SLOWEST, EZO_DELAY_MS_SLOW};
+
+// What the simulated modules saw, written by the sensors task and read by the test under the lock.
+typedef struct {
+    bool busy;
+    size_t sweeps;               /*!< Completed sweeps. */
+    TickType_t start[MAX_SWEEPS]; /*!< First command of every sweep. */
+    TickType_t done[MAX_SWEEPS];  /*!< Value published by every sweep. */
+    size_t n_writes;
+    char writes[MAX_WRITES][EZO_MAX_BUFFER_LEN];
+} module_log_t;
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static module_log_t modules[MODULE_MAX] = {0};
+static _Atomic float water_temp = 20.f;
+static context_t context = {.sensors.temp.probe = CONTEXT_UNKNOWN_VALUE};
+
+static module_t module_find(const char *desc) {
+    for (module_t i = 0; i < MODULE_MAX; ++i) {
+        if (strcmp(desc, NAMES[i]) == 0) {
+            return i;
+        }
+    }
+    TEST_ASSERT(false);
+    return MODULE_MAX;
+}
+
+// Records every command on its way to the simulated module.
+esp_err_t __real_ezo_write(ezo_sensor_t *sensor, uint16_t delay_ms);
+
+esp_err_t __wrap_ezo_write(ezo_sensor_t *sensor, uint16_t delay_ms) {
+    module_log_t *log = &modules[module_find(sensor->desc)];
+    pthread_mutex_lock(&lock);
+    if (!log->busy && log->sweeps < MAX_SWEEPS) {
+        log->busy = true;
+        log->start[log->sweeps] = xTaskGetTickCount();
+    }
+    if (log->n_writes < MAX_WRITES) {
+        strlcpy(log->writes[log->n_writes++], sensor->buf, EZO_MAX_BUFFER_LEN);
+    }
+    pthread_mutex_unlock(&lock);
+    return __real_ezo_write(sensor, delay_ms);
+}
+
+static esp_err_t published(module_t module) {
+    module_log_t *log = &modules[module];
+    pthread_mutex_lock(&lock);
+    if (log->busy && log->sweeps < MAX_SWEEPS) {
+        log->done[log->sweeps++] = xTaskGetTickCount();
+    }
+    log->busy = false;
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+esp_err_t context_set_temp_probe(context_t *ctx, float temp) {
+    ctx->sensors.temp.probe = temp;
+    return published(MODULE_RTD);
+}
+
+esp_err_t context_set_ec(context_t *ctx, int tank, float value) {
+    TEST_ASSERT_EQUAL(0, tank);
+    return published(MODULE_EC);
+}
+
+esp_err_t context_set_ph(context_t *ctx, int tank, float value) {
+    TEST_ASSERT_EQUAL(0, tank);
+    return published(MODULE_PH);
+}
+
+// No stored config, the sampling periods are the Kconfig defaults of the target.
+esp_err_t context_get_config(context_t *ctx, const Hydroponics__Config **config) {
+    *config = NULL;
+    return ESP_OK;
+}
+
+void context_config_release(const Hydroponics__Config *config) {
+}
+
+esp_err_t config_register(config_callback_t callback) {
+    return ESP_OK;
+}
+
+// The water temperature follows the test, the other channels read their fixed value.
+float simulation_read(simulation_channel_t channel, float value, float threshold) {
+    return channel == SIMULATION_CHANNEL_WATER_TEMP ? atomic_load(&water_temp) : value;
+}
+
+esp_err_t i2c_bus_add_device(const char *name, uint8_t address, i2c_bus_priority_t priority,
+                             i2c_bus_device_handle_t *dev) {
+    *dev = NULL;
+    return ESP_OK;
+}
+
+esp_err_t ezo_calibration_check(ezo_sensor_t *sensor) {
+    return ESP_OK;
+}
+
+esp_err_t buses_recover(void) {
+    return ESP_OK;
+}
+
+static size_t sweeps(module_t module) {
+    pthread_mutex_lock(&lock);
+    size_t n = modules[module].sweeps;
+    pthread_mutex_unlock(&lock);
+    return n;
+}
+
+static void wait_sweeps(size_t n) {
+    for (int i = 0; i < 1000 && (sweeps(MODULE_EC) < n || sweeps(MODULE_PH) < n || sweeps(MODULE_RTD) < n); ++i) {
+        usleep(10 * 1000);
+    }
+    for (module_t i = 0; i < MODULE_MAX; ++i) {
+        TEST_ASSERT(sweeps(i) >= n);
+    }
+}
+
+// The three modules start in the same slot and convert at the same time, a sweep takes the slowest conversion
+// instead of the sum of them.
+static void test_sweep_is_pipelined(void) {
+    // The first sweep has no temperature to compensate for, the second one sends it.
+    wait_sweeps(4);
+    uint32_t serial_ms = 0;
+    for (module_t i = 0; i < MODULE_MAX; ++i) {
+        serial_ms += DELAYS_MS[i];
+    }
+    uint32_t worst_ms = 0;
+    pthread_mutex_lock(&lock);
+    for (size_t sweep = 2; sweep < 4; ++sweep) {
+        TickType_t first = modules[0].start[sweep];
+        TickType_t last = modules[0].done[sweep];
+        for (module_t i = 0; i < MODULE_MAX; ++i) {
+            TEST_ASSERT_NEAR(modules[0].start[sweep], modules[i].start[sweep], 10);
+            TEST_ASSERT(modules[i].done[sweep] - modules[i].start[sweep] >= DELAYS_MS[i]);
+            first = modules[i].start[sweep] < first ? modules[i].start[sweep] : first;
+            last = modules[i].done[sweep] > last ? modules[i].done[sweep] : last;
+        }
+        worst_ms = last - first > worst_ms ? last - first : worst_ms;
+    }
+    pthread_mutex_unlock(&lock);
+    printf("  sweep of %d modules: %u ms, one after the other: %u ms\n", MODULE_MAX, worst_ms, serial_ms);
+    TEST_ASSERT(worst_ms < EZO_DELAY_MS_SLOWEST + 100);
+}
+
+static size_t count_writes(module_t module, const char *prefix, char found[][EZO_MAX_BUFFER_LEN], size_t max) {
+    size_t count = 0;
+    pthread_mutex_lock(&lock);
+    for (size_t i = 0; i < modules[module].n_writes; ++i) {
+        if (strncmp(modules[module].writes[i], prefix, strlen(prefix)) == 0) {
+            if (count < max) {
+                strlcpy(found[count], modules[module].writes[i], EZO_MAX_BUFFER_LEN);
+            }
+            count++;
+        }
+    }
+    pthread_mutex_unlock(&lock);
+    return count;
+}
+
+// The compensation temperature only goes to the modules when the probe moved past the threshold, every read is a plain
+// R instead of an RT with the temperature.
+static void test_compensation_only_on_change(void) {
+    // Below the threshold, the modules keep what they have.
+    atomic_store(&water_temp, 20.05f);
+    wait_sweeps(7);
+    atomic_store(&water_temp, 21.f);
+    wait_sweeps(10);
+
+    const module_t compensated[] = {MODULE_EC, MODULE_PH};
+    for (size_t i = 0; i < sizeof(compensated) / sizeof(compensated[0]); ++i) {
+        char temps[4][EZO_MAX_BUFFER_LEN];
+        TEST_ASSERT_EQUAL(2, count_writes(compensated[i], "T,", temps, 4));
+        TEST_ASSERT(strcmp(temps[0], "T,20.00") == 0);
+        TEST_ASSERT(strcmp(temps[1], "T,21.00") == 0);
+    }
+    TEST_ASSERT_EQUAL(0, count_writes(MODULE_RTD, "T,", NULL, 0));
+
+    size_t reads = 0;
+    size_t commands = 0;
+    pthread_mutex_lock(&lock);
+    for (module_t i = 0; i < MODULE_MAX; ++i) {
+        for (size_t j = 0; j < modules[i].n_writes; ++j) {
+            TEST_ASSERT(strcmp(modules[i].writes[j], "R") == 0 || strncmp(modules[i].writes[j], "T,", 2) == 0);
+        }
+        reads += modules[i].sweeps;
+        commands += modules[i].n_writes;
+    }
+    pthread_mutex_unlock(&lock);
+    printf("  %zu commands for %zu reads, %zu with a compensation command on every read\n", commands, reads,
+           reads + sweeps(MODULE_EC) + sweeps(MODULE_PH));
+}
+
+static health_t module_health(module_t module) {
+    sensors_health_t health[SENSORS_MAX_DRIVERS];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, sensors_get_health(health, SENSORS_MAX_DRIVERS, &count));
+    for (size_t i = 0; i < count; ++i) {
+        if (strcmp(health[i].name, NAMES[module]) == 0) {
+            return health[i].health;
+        }
+    }
+    TEST_ASSERT(false);
+    return health[0].health;
+}
+
+static _Atomic int calibrated = 0;
+
+static void *calibrate(void *arg) {
+    ezo_sensor_t *sensor = arg;
+    const float points[] = {4.f, 7.f, 10.f};
+    const ezo_calibration_step_t steps[] = {EZO_CALIBRATION_STEP_LOW, EZO_CALIBRATION_STEP_MID,
+                                            EZO_CALIBRATION_STEP_HIGH};
+    for (size_t i = 0; i < sizeof(points) / sizeof(points[0]); ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_step(sensor, steps[i], points[i]));
+        atomic_fetch_add(&calibrated, 1);
+    }
+    return NULL;
+}
+
+// A calibration holds the module for seconds, the sweeps meanwhile skip it without counting faults.
+static void test_calibration_alongside_sampling(void) {
+    ezo_sensor_t *ph = ezo_find(NAMES[MODULE_PH]);
+    TEST_ASSERT(ph != NULL);
+    health_t before = module_health(MODULE_PH);
+    size_t ph_before = sweeps(MODULE_PH);
+    size_t ec_before = sweeps(MODULE_EC);
+
+    pthread_t thread;
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, calibrate, ph));
+    pthread_join(thread, NULL);
+    TEST_ASSERT_EQUAL(3, atomic_load(&calibrated));
+    ezo_calibration_mode_t mode = EZO_CALIBRATION_MODE_NONE;
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_mode(ph, &mode));
+    TEST_ASSERT_EQUAL(EZO_CALIBRATION_MODE_THREE_POINTS, mode);
+
+    size_t ec_swept = sweeps(MODULE_EC) - ec_before;
+    size_t ph_swept = sweeps(MODULE_PH) - ph_before;
+    health_t after = module_health(MODULE_PH);
+    printf("  %zu sweeps during the calibration, pH sampled in %zu\n", ec_swept, ph_swept);
+    TEST_ASSERT(ec_swept >= 1);
+    TEST_ASSERT(ph_swept < ec_swept);
+    TEST_ASSERT_EQUAL(before.errors, after.errors);
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_OK, after.status);
+
+    // Back to sampling once the module is released.
+    size_t ph_after = sweeps(MODULE_PH);
+    for (int i = 0; i < 300 && sweeps(MODULE_PH) == ph_after; ++i) {
+        usleep(10 * 1000);
+    }
+    TEST_ASSERT(sweeps(MODULE_PH) > ph_after);
+}
+
+int main(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, sampling_init(&context));
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_ec_init(&context));
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_ph_init(&context));
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_rtd_init(&context));
+    TEST_ASSERT_EQUAL(ESP_OK, sensors_init(&context));
+
+    RUN_TEST(test_sweep_is_pipelined);
+    RUN_TEST(test_compensation_only_on_change);
+    RUN_TEST(test_calibration_alongside_sampling);
+    return 0;
+}
@@ -0,0 +1,177 @@
+#include <string.h>
+
+#include "nvs.h"
+
+#include "context.h"
+#include "driver/ezo.h"
+#include "ezo_calibration.h"
+#include "simulation.h"
+#include "storage.h"
+#include "test.h"
+#include "utils.h"
+
+#define KEY_PH "cal_ph"
+
+static context_t context = {0};
+
+// Short delays, the simulated module answers on the same schedule as the real one.
+static ezo_sensor_t ph = {
+        .probe = "PH2000",
+        .desc = "ph",
+        .address = 0x63,
+        .delay_ms = 10,
+        .delay_read_ms = 10,
+        .delay_calibration_ms = 10,
+        .calibration = EZO_CALIBRATION_MODE_THREE_POINTS,
+        .channel = SIMULATION_CHANNEL_PH,
+        .simulate = 5.7f,
+};
+
+// Never snapshotted.
+static ezo_sensor_t ec = {
+        .probe = "K1.0",
+        .desc = "ec",
+        .address = 0x64,
+        .delay_ms = 10,
+        .delay_read_ms = 10,
+        .delay_calibration_ms = 10,
+        .calibration = EZO_CALIBRATION_MODE_TWO_POINTS,
+        .channel = SIMULATION_CHANNEL_EC,
+        .simulate = 1500.f,
+};
+
+float simulation_read(simulation_channel_t channel, float value, float threshold) {
+    return value;
+}
+
+esp_err_t i2c_bus_add_device(const char *name, uint8_t address, i2c_bus_priority_t priority,
+                             i2c_bus_device_handle_t *dev) {
+    *dev = NULL;
+    return ESP_OK;
+}
+
+static ezo_calibration_mode_t mode(ezo_sensor_t *sensor) {
+    ezo_calibration_mode_t m = EZO_CALIBRATION_MODE_NONE;
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_mode(sensor, &m));
+    return m;
+}
+
+static void calibrate(ezo_sensor_t *sensor) {
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_step(sensor, EZO_CALIBRATION_STEP_MID, 7.f));
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_step(sensor, EZO_CALIBRATION_STEP_LOW, 4.f));
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_step(sensor, EZO_CALIBRATION_STEP_HIGH, 10.f));
+    TEST_ASSERT_EQUAL(EZO_CALIBRATION_MODE_THREE_POINTS, mode(sensor));
+}
+
+static void clear(ezo_sensor_t *sensor) {
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_step(sensor, EZO_CALIBRATION_STEP_CLEAR, 0.f));
+    TEST_ASSERT_EQUAL(EZO_CALIBRATION_MODE_NONE, mode(sensor));
+}
+
+// Returns the stored record, which the caller must free.
+static ezo_calibration_header_t *record(const char *key, size_t *len) {
+    uint8_t *buf = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_get_blob(key, &buf, len));
+    TEST_ASSERT(buf != NULL && *len >= sizeof(ezo_calibration_header_t));
+    return (ezo_calibration_header_t *) buf;
+}
+
+// The snapshot holds the exported rows behind a versioned header, it is committed right away.
+static void test_snapshot_is_versioned(void) {
+    calibrate(&ph);
+    uint32_t commits = host_nvs_stats().commits;
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_snapshot(&ph));
+    TEST_ASSERT(host_nvs_stats().commits > commits);
+
+    size_t len = 0;
+    ezo_calibration_header_t *header = record(KEY_PH, &len);
+    TEST_ASSERT_EQUAL(EZO_CALIBRATION_FORMAT, header->format);
+    TEST_ASSERT_EQUAL(EZO_CALIBRATION_MODE_THREE_POINTS, header->mode);
+    TEST_ASSERT_EQUAL(1, header->generation);
+    TEST_ASSERT(strcmp(header->type, "sim") == 0);
+    // Three rows, one per line.
+    TEST_ASSERT_EQUAL(3 * (EZO_SIM_CALIBRATION_ROW + 1), header->size);
+    TEST_ASSERT_EQUAL(sizeof(ezo_calibration_header_t) + header->size, len);
+    const char *rows = (const char *) &header[1];
+    TEST_ASSERT(strncmp(rows, ph.calibration_blob, EZO_SIM_CALIBRATION_ROW) == 0);
+    SAFE_FREE(header);
+
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_snapshot(&ph));
+    header = record(KEY_PH, &len);
+    TEST_ASSERT_EQUAL(2, header->generation);
+    SAFE_FREE(header);
+    printf("  %zu bytes for 3 points\n", len);
+}
+
+// A replaced module comes back blank, its snapshot is never overwritten and the check puts it back.
+static void test_blank_module_is_restored(void) {
+    char calibrated[EZO_SIM_CALIBRATION_LEN];
+    strlcpy(calibrated, ph.calibration_blob, sizeof(calibrated));
+    clear(&ph);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, ezo_calibration_snapshot(&ph));
+    size_t len = 0;
+    ezo_calibration_header_t *header = record(KEY_PH, &len);
+    TEST_ASSERT_EQUAL(2, header->generation);
+    SAFE_FREE(header);
+
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_check(&ph));
+    TEST_ASSERT_EQUAL(EZO_CALIBRATION_MODE_THREE_POINTS, mode(&ph));
+    TEST_ASSERT(strcmp(calibrated, ph.calibration_blob) == 0);
+    TEST_ASSERT(!ph.pause);
+
+    // A calibrated module is left alone, even with a different calibration than the snapshot.
+    clear(&ph);
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_step(&ph, EZO_CALIBRATION_STEP_MID, 6.9f));
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_check(&ph));
+    TEST_ASSERT_EQUAL(EZO_CALIBRATION_MODE_ONE_POINT, mode(&ph));
+
+    // A restore on demand replaces it.
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_restore(&ph));
+    TEST_ASSERT(strcmp(calibrated, ph.calibration_blob) == 0);
+}
+
+// Snapshots of another module type or format, or with a truncated body, are never imported.
+static void test_foreign_snapshots_are_rejected(void) {
+    size_t len = 0;
+    ezo_calibration_header_t *header = record(KEY_PH, &len);
+    clear(&ph);
+
+    strlcpy(header->type, "EC", sizeof(header->type));
+    TEST_ASSERT_EQUAL(ESP_OK, storage_set_blob(KEY_PH, (uint8_t *) header, len));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION, ezo_calibration_restore(&ph));
+
+    strlcpy(header->type, "sim", sizeof(header->type));
+    header->format = EZO_CALIBRATION_FORMAT + 1;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_set_blob(KEY_PH, (uint8_t *) header, len));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION, ezo_calibration_restore(&ph));
+
+    header->format = EZO_CALIBRATION_FORMAT;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_set_blob(KEY_PH, (uint8_t *) header, len - 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION, ezo_calibration_restore(&ph));
+    // The blank module still samples.
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_check(&ph));
+    TEST_ASSERT_EQUAL(EZO_CALIBRATION_MODE_NONE, mode(&ph));
+
+    TEST_ASSERT_EQUAL(ESP_OK, storage_set_blob(KEY_PH, (uint8_t *) header, len));
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_restore(&ph));
+    TEST_ASSERT_EQUAL(EZO_CALIBRATION_MODE_THREE_POINTS, mode(&ph));
+    SAFE_FREE(header);
+}
+
+static void test_missing_snapshot(void) {
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, ezo_calibration_restore(&ec));
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_calibration_check(&ec));
+    TEST_ASSERT_EQUAL(EZO_CALIBRATION_MODE_NONE, mode(&ec));
+}
+
+int main(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, storage_init(&context));
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_init(&ph));
+    TEST_ASSERT_EQUAL(ESP_OK, ezo_init(&ec));
+
+    RUN_TEST(test_snapshot_is_versioned);
+    RUN_TEST(test_blank_module_is_restored);
+    RUN_TEST(test_foreign_snapshots_are_rejected);
+    RUN_TEST(test_missing_snapshot);
+    return 0;
+}
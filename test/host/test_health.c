@@ -0,0 +1,138 @@
+#include <math.h>
+
+#include "health.h"
+#include "test.h"
+
+// Same limits as the EZO drivers, without their stuck detection.
+static const health_limits_t LIMITS = {.min = 0.f, .max = 14.f, .stale_ms = 10000, .retries = 3};
+
+static void test_errors_escalate_once_per_step(void) {
+    health_t h;
+    health_init(&h, &LIMITS, 0);
+    const health_action_t expected[] = {
+            HEALTH_ACTION_RETRY, HEALTH_ACTION_RETRY, HEALTH_ACTION_RETRY,
+            HEALTH_ACTION_RESET_DEVICE, HEALTH_ACTION_RETRY, HEALTH_ACTION_RETRY,
+            HEALTH_ACTION_RESET_BUS, HEALTH_ACTION_RETRY, HEALTH_ACTION_RETRY,
+            HEALTH_ACTION_ALERT, HEALTH_ACTION_NONE, HEALTH_ACTION_NONE,
+    };
+    for (size_t i = 0; i < sizeof(expected) / sizeof(expected[0]); ++i) {
+        TEST_ASSERT_EQUAL(expected[i], health_fault(&h, HEALTH_FAULT_ERROR, i));
+        TEST_ASSERT(!health_is_good(&h));
+    }
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_FAILED, h.status);
+    TEST_ASSERT_EQUAL(12, h.errors);
+}
+
+static void test_one_good_sample_recovers(void) {
+    health_t h;
+    health_init(&h, &LIMITS, 0);
+    for (int i = 0; i < 4; ++i) {
+        health_fault(&h, HEALTH_FAULT_ERROR, i);
+    }
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_DEGRADED, h.status);
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_NONE, health_value(&h, 7.f, 10));
+    TEST_ASSERT(health_is_good(&h));
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_OK, h.status);
+    TEST_ASSERT_EQUAL(1, h.recoveries);
+    TEST_ASSERT_EQUAL(HEALTH_FAULT_ERROR, h.fault);
+    // The ladder starts over.
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_RETRY, health_fault(&h, HEALTH_FAULT_ERROR, 11));
+}
+
+static void test_out_of_range_and_nan_fault(void) {
+    health_t h;
+    health_init(&h, &LIMITS, 0);
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_RETRY, health_value(&h, -0.1f, 1));
+    TEST_ASSERT_EQUAL(HEALTH_FAULT_RANGE, h.fault);
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_RETRY, health_value(&h, 14.1f, 2));
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_RETRY, health_value(&h, NAN, 3));
+    TEST_ASSERT_EQUAL(3, h.consecutive);
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_NONE, health_value(&h, 14.f, 4));
+    TEST_ASSERT(health_is_good(&h));
+}
+
+// A calm tank reads the same pH for hours, that must not walk the ladder up to a bus reset.
+static void test_repeated_values_are_fine_without_stuck_detection(void) {
+    health_t h;
+    health_init(&h, &LIMITS, 0);
+    for (uint64_t i = 0; i < 10000; ++i) {
+        TEST_ASSERT_EQUAL(HEALTH_ACTION_NONE, health_value(&h, 6.2f, i * 1000));
+    }
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_OK, h.status);
+    TEST_ASSERT_EQUAL(0, h.errors);
+}
+
+// A stuck value alerts once and is still good, even hours of it never reset anything.
+static void test_stuck_detection(void) {
+    const health_limits_t limits = {.min = 0.f, .max = 100.f, .stuck = 5, .retries = 1};
+    health_t h;
+    health_init(&h, &limits, 0);
+    for (int i = 0; i < 5; ++i) {
+        TEST_ASSERT_EQUAL(HEALTH_ACTION_NONE, health_value(&h, 42.f, i));
+    }
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_ALERT, health_value(&h, 42.f, 5));
+    TEST_ASSERT_EQUAL(HEALTH_FAULT_STUCK, h.fault);
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_DEGRADED, h.status);
+    TEST_ASSERT(health_is_good(&h));
+    for (uint64_t i = 6; i < 100000; ++i) {
+        TEST_ASSERT_EQUAL(HEALTH_ACTION_NONE, health_value(&h, 42.f, i));
+    }
+    TEST_ASSERT_EQUAL(1, h.errors);
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_DEGRADED, h.status);
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_NONE, health_value(&h, 42.5f, 100000));
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_OK, h.status);
+    // A real fault still starts the ladder from the bottom.
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_RETRY, health_fault(&h, HEALTH_FAULT_ERROR, 100001));
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_RESET_DEVICE, health_fault(&h, HEALTH_FAULT_ERROR, 100002));
+}
+
+static void test_stale_faults_once_per_period(void) {
+    health_t h;
+    health_init(&h, &LIMITS, 0);
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_NONE, health_check(&h, 9999));
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_RETRY, health_check(&h, 10000));
+    TEST_ASSERT_EQUAL(HEALTH_FAULT_STALE, h.fault);
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_NONE, health_check(&h, 15000));
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_RETRY, health_check(&h, 20000));
+    health_success(&h, 21000);
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_NONE, health_check(&h, 30000));
+
+    const health_limits_t never = {.retries = 1};
+    health_init(&h, &never, 0);
+    TEST_ASSERT_EQUAL(HEALTH_ACTION_NONE, health_check(&h, UINT32_MAX));
+}
+
+// Replays a sensor that drops off the bus for a while among good samples.
+static void test_injected_outage(void) {
+    health_t h;
+    health_init(&h, &LIMITS, 0);
+    int resets = 0, bus_resets = 0, alerts = 0;
+    for (uint64_t t = 0; t < 100; ++t) {
+        health_action_t action;
+        if (t >= 20 && t < 40) {
+            action = health_fault(&h, HEALTH_FAULT_ERROR, t * 1000);
+        } else {
+            action = health_value(&h, 5.f + (float) (t % 3) * 0.01f, t * 1000);
+        }
+        resets += action == HEALTH_ACTION_RESET_DEVICE;
+        bus_resets += action == HEALTH_ACTION_RESET_BUS;
+        alerts += action == HEALTH_ACTION_ALERT;
+    }
+    TEST_ASSERT_EQUAL(1, resets);
+    TEST_ASSERT_EQUAL(1, bus_resets);
+    TEST_ASSERT_EQUAL(1, alerts);
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_OK, h.status);
+    TEST_ASSERT_EQUAL(20, h.errors);
+    TEST_ASSERT_EQUAL(1, h.recoveries);
+}
+
+int main(void) {
+    RUN_TEST(test_errors_escalate_once_per_step);
+    RUN_TEST(test_one_good_sample_recovers);
+    RUN_TEST(test_out_of_range_and_nan_fault);
+    RUN_TEST(test_repeated_values_are_fine_without_stuck_detection);
+    RUN_TEST(test_stuck_detection);
+    RUN_TEST(test_stale_faults_once_per_period);
+    RUN_TEST(test_injected_outage);
+    return 0;
+}
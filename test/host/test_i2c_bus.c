@@ -0,0 +1,245 @@
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#include "esp_timer.h"
+
+#include "i2c_bus.h"
+#include "test.h"
+
+#define PORT         1
+#define SIM_ADDRESS  0x48
+#define SIM_RAW      0x66
+#define MISSING      0x20
+#define MAX_ORDER    64
+
+typedef struct {
+    uint8_t address;
+    uint8_t regs[256];
+} sim_device_t;
+
+// The simulated bus, only the bus owner plays command links on it.
+static sim_device_t sims[] = {{.address = SIM_ADDRESS}, {.address = SIM_RAW}};
+static uint8_t order[MAX_ORDER];   /*!< First register of every transaction, in the order they hit the wire. */
+static size_t n_order = 0;
+static _Atomic bool hold = false;
+static SemaphoreHandle_t holding;  /*!< Given once the owner waits on the gate. */
+static SemaphoreHandle_t gate;
+
+static sim_device_t *sim_find(uint8_t address) {
+    for (size_t i = 0; i < sizeof(sims) / sizeof(sims[0]); ++i) {
+        if (sims[i].address == address) {
+            return &sims[i];
+        }
+    }
+    return NULL;
+}
+
+// Plays START, the address, the register and the writes, then an optional repeated START, the address and a read.
+static esp_err_t sim_transport(i2c_port_t port, i2c_cmd_handle_t cmd, TickType_t ticks) {
+    TEST_ASSERT_EQUAL(PORT, port);
+    TEST_ASSERT(ticks > 0);
+    if (atomic_load(&hold)) {
+        xSemaphoreGive(holding);
+        xSemaphoreTake(gate, portMAX_DELAY);
+    }
+    sim_device_t *dev = NULL;
+    bool addressing = false;
+    int reg = -1;
+    for (size_t i = 0; i < cmd->n_ops; ++i) {
+        const host_i2c_op_t *op = &cmd->ops[i];
+        switch (op->type) {
+            case HOST_I2C_START:
+                addressing = true;
+                break;
+            case HOST_I2C_WRITE:
+                for (size_t j = 0; j < op->len; ++j) {
+                    uint8_t byte = op->data != NULL ? op->data[j] : op->byte;
+                    if (addressing) {
+                        // Nobody acknowledges the address.
+                        dev = sim_find(byte >> 1);
+                        if (dev == NULL) {
+                            return ESP_FAIL;
+                        }
+                        addressing = false;
+                    } else if (reg < 0) {
+                        reg = byte;
+                        if (n_order < MAX_ORDER) {
+                            order[n_order++] = byte;
+                        }
+                    } else {
+                        dev->regs[reg++ & 0xff] = byte;
+                    }
+                }
+                break;
+            case HOST_I2C_READ:
+                TEST_ASSERT(dev != NULL && reg >= 0);
+                for (size_t j = 0; j < op->len; ++j) {
+                    op->read[j] = dev->regs[(reg + j) & 0xff];
+                }
+                break;
+            case HOST_I2C_STOP:
+                break;
+        }
+    }
+    return ESP_OK;
+}
+
+static i2c_bus_device_handle_t add(const char *name, uint8_t address, i2c_bus_priority_t priority) {
+    i2c_bus_device_handle_t dev = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_add_device(name, address, priority, &dev));
+    TEST_ASSERT_EQUAL(address, i2c_bus_device_address(dev));
+    return dev;
+}
+
+static void test_write_and_read_back(void) {
+    i2c_bus_device_handle_t dev = add("sim", SIM_ADDRESS, I2C_BUS_PRIORITY_NORMAL);
+    const uint8_t written[] = {1, 2, 3};
+    uint8_t read[3] = {0};
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_write_reg_read(dev, 0x10, written, sizeof(written), NULL, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_write_reg_read(dev, 0x10, NULL, 0, read, sizeof(read)));
+    TEST_ASSERT(memcmp(written, read, sizeof(read)) == 0);
+    TEST_ASSERT(i2c_bus_find_device(SIM_ADDRESS) == dev);
+    TEST_ASSERT(i2c_bus_find_device(SIM_RAW) == NULL);
+
+    i2c_bus_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_get_stats(dev, &stats));
+    TEST_ASSERT_EQUAL(2, stats.transactions);
+    TEST_ASSERT_EQUAL(0, stats.errors + stats.expired);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2c_bus_write_reg_read(dev, 0x10, NULL, 1, NULL, 0));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2c_bus_write_reg_read_at(dev, 0x80, 0x10, NULL, 0, NULL, 0));
+}
+
+// A raw device reaches any address, the transactions are counted on it.
+static void test_other_addresses_and_errors(void) {
+    i2c_bus_device_handle_t raw = add("raw", 0x00, I2C_BUS_PRIORITY_NORMAL);
+    const uint8_t value = 42;
+    uint8_t read = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_write_reg_read_at(raw, SIM_RAW, 0x01, &value, 1, NULL, 0));
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_write_reg_read_at(raw, SIM_RAW, 0x01, NULL, 0, &read, 1));
+    TEST_ASSERT_EQUAL(value, read);
+    TEST_ASSERT_EQUAL(ESP_FAIL, i2c_bus_write_reg_read_at(raw, MISSING, 0x01, NULL, 0, &read, 1));
+
+    i2c_bus_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_get_stats(raw, &stats));
+    TEST_ASSERT_EQUAL(3, stats.transactions);
+    TEST_ASSERT_EQUAL(1, stats.errors);
+}
+
+static _Atomic bool recovered_on_owner = false;
+
+static esp_err_t recover(i2c_port_t port) {
+    TEST_ASSERT_EQUAL(PORT, port);
+    // Runs on the bus owner, queueing from there would wait forever.
+    i2c_bus_device_handle_t dev = i2c_bus_find_device(SIM_ADDRESS);
+    uint8_t read = 0;
+    atomic_store(&recovered_on_owner,
+                 i2c_bus_write_reg_read(dev, 0x10, NULL, 0, &read, 1) == ESP_ERR_INVALID_ARG);
+    return ESP_ERR_INVALID_STATE;
+}
+
+static void test_recover_runs_on_the_owner(void) {
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, i2c_bus_recover(recover));
+    TEST_ASSERT(atomic_load(&recovered_on_owner));
+}
+
+typedef struct {
+    i2c_bus_device_handle_t dev;
+    uint8_t reg;
+    uint32_t deadline_ms;
+    esp_err_t err;
+} submit_t;
+
+static void *submit(void *arg) {
+    submit_t *s = arg;
+    i2c_cmd_handle_t cmd = i2c_cmd_link_create();
+    TEST_ASSERT(cmd != NULL);
+    i2c_master_start(cmd);
+    i2c_master_write_byte(cmd, (i2c_bus_device_address(s->dev) << 1) | I2C_MASTER_WRITE, true);
+    i2c_master_write_byte(cmd, s->reg, true);
+    i2c_master_stop(cmd);
+    s->err = i2c_bus_cmd_begin(s->dev, cmd, s->deadline_ms);
+    i2c_cmd_link_delete(cmd);
+    return NULL;
+}
+
+// While the bus is busy, the queue fills up. It drains by priority, then by deadline, and what expired while queued
+// never reaches the wire.
+static void test_queue_order_and_deadlines(void) {
+    i2c_bus_device_handle_t low = add("low", SIM_ADDRESS, I2C_BUS_PRIORITY_LOW);
+    i2c_bus_device_handle_t normal = i2c_bus_find_device(SIM_ADDRESS);
+    i2c_bus_device_handle_t high = add("high", SIM_ADDRESS, I2C_BUS_PRIORITY_HIGH);
+    submit_t requests[] = {
+            {.dev = normal, .reg = 0xb0, .deadline_ms = 1000},  // Holds the bus.
+            {.dev = low, .reg = 0xa4, .deadline_ms = 1000},
+            {.dev = normal, .reg = 0xa3, .deadline_ms = 1000},
+            {.dev = normal, .reg = 0xa2, .deadline_ms = 500},
+            {.dev = high, .reg = 0xa1, .deadline_ms = 1000},
+            {.dev = low, .reg = 0xee, .deadline_ms = 10},       // Expires in the queue.
+    };
+    const size_t n = sizeof(requests) / sizeof(requests[0]);
+    i2c_bus_stats_t before;
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_get_stats(low, &before));
+
+    n_order = 0;
+    atomic_store(&hold, true);
+    pthread_t threads[sizeof(requests) / sizeof(requests[0])];
+    TEST_ASSERT_EQUAL(0, pthread_create(&threads[0], NULL, submit, &requests[0]));
+    TEST_ASSERT_EQUAL(pdTRUE, xSemaphoreTake(holding, 1000));
+    atomic_store(&hold, false);
+    for (size_t i = 1; i < n; ++i) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, submit, &requests[i]));
+    }
+    // Give them the time to queue, then the clock moves past the short deadline.
+    usleep(100 * 1000);
+    host_timer_advance(20 * 1000);
+    xSemaphoreGive(gate);
+    for (size_t i = 0; i < n; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+
+    for (size_t i = 0; i < n - 1; ++i) {
+        TEST_ASSERT_EQUAL(ESP_OK, requests[i].err);
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, requests[n - 1].err);
+    const uint8_t expected[] = {0xb0, 0xa1, 0xa2, 0xa3, 0xa4};
+    TEST_ASSERT_EQUAL(sizeof(expected), n_order);
+    TEST_ASSERT(memcmp(expected, order, sizeof(expected)) == 0);
+
+    i2c_bus_stats_t after;
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_get_stats(low, &after));
+    TEST_ASSERT_EQUAL(before.expired + 1, after.expired);
+    TEST_ASSERT(after.max_wait_us >= 20 * 1000);
+    i2c_bus_dump();
+}
+
+static void test_device_slots_run_out(void) {
+    i2c_bus_device_handle_t dev = NULL;
+    int added = 0;
+    while (i2c_bus_add_device("more", 0x30, I2C_BUS_PRIORITY_NORMAL, &dev) == ESP_OK) {
+        added++;
+    }
+    // sim, raw, low and high took theirs.
+    TEST_ASSERT_EQUAL(I2C_BUS_MAX_DEVICES - 4, added);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2c_bus_add_device("bad", 0x30, I2C_BUS_PRIORITY_MAX, &dev));
+}
+
+int main(void) {
+    holding = xSemaphoreCreateBinary();
+    gate = xSemaphoreCreateBinary();
+    TEST_ASSERT_EQUAL(ESP_OK, i2c_bus_init_with_transport(PORT, sim_transport));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, i2c_bus_init_with_transport(PORT, sim_transport));
+
+    RUN_TEST(test_write_and_read_back);
+    RUN_TEST(test_other_addresses_and_errors);
+    RUN_TEST(test_recover_runs_on_the_owner);
+    RUN_TEST(test_queue_order_and_deadlines);
+    RUN_TEST(test_device_slots_run_out);
+    return 0;
+}
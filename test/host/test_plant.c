@@ -0,0 +1,142 @@
+#include <string.h>
+
+#include "plant.h"
+#include "test.h"
+
+#define MINUTE_MS (60 * 1000ULL)
+#define HOUR_MS   (60 * MINUTE_MS)
+
+static plant_t plant_default(void) {
+    plant_t plant;
+    plant_params_t params = PLANT_PARAMS_DEFAULT;
+    TEST_ASSERT_EQUAL(ESP_OK, plant_init(&plant, &params));
+    return plant;
+}
+
+static void plant_run(plant_t *plant, plant_output_t output, uint64_t duration_ms) {
+    TEST_ASSERT_EQUAL(ESP_OK, plant_set_output(plant, output, true));
+    TEST_ASSERT_EQUAL(ESP_OK, plant_advance(plant, plant->now_ms + duration_ms));
+    TEST_ASSERT_EQUAL(ESP_OK, plant_set_output(plant, output, false));
+}
+
+static void test_initial_state(void) {
+    plant_t plant = plant_default();
+    // The initial nutrients come as 300 ml of concentrate.
+    TEST_ASSERT_NEAR(0.603f, plant_level(&plant), 1e-4);
+    TEST_ASSERT_NEAR(21.f, plant_temp(&plant), 1e-4);
+    // 1 g/l of nutrient salts plus 0.1 g/l from the fresh water.
+    TEST_ASSERT_NEAR(1650.f, plant_ec(&plant), 20.f);
+    TEST_ASSERT(plant_ph(&plant) > 5.5f && plant_ph(&plant) < 7.5f);
+}
+
+static void test_invalid_params_are_rejected(void) {
+    plant_t plant;
+    plant_params_t params = PLANT_PARAMS_DEFAULT;
+    params.volume_l = params.capacity_l + 1;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, plant_init(&plant, &params));
+    params.volume_l = 0.f;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, plant_init(&plant, &params));
+    params = (plant_params_t) PLANT_PARAMS_DEFAULT;
+    params.capacity_l = 0.f;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, plant_init(&plant, &params));
+
+    plant = plant_default();
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, plant_set_output(&plant, PLANT_OUTPUT_MAX, true));
+}
+
+static void test_advance_uses_whole_steps(void) {
+    plant_t plant = plant_default();
+    TEST_ASSERT_EQUAL(ESP_OK, plant_advance(&plant, PLANT_STEP_MS - 1));
+    TEST_ASSERT_EQUAL(0, plant.now_ms);
+    TEST_ASSERT_EQUAL(ESP_OK, plant_advance(&plant, 5 * PLANT_STEP_MS + 1));
+    TEST_ASSERT_EQUAL(5 * PLANT_STEP_MS, plant.now_ms);
+    // Going back in time is a no-op.
+    TEST_ASSERT_EQUAL(ESP_OK, plant_advance(&plant, 0));
+    TEST_ASSERT_EQUAL(5 * PLANT_STEP_MS, plant.now_ms);
+}
+
+static void test_nutrients_only_show_once_mixed(void) {
+    plant_t plant = plant_default();
+    float ec = plant_ec(&plant);
+    plant_run(&plant, PLANT_OUTPUT_NUTRIENTS, MINUTE_MS);
+    float dosed = plant_ec(&plant);
+    TEST_ASSERT(dosed - ec < 50.f);
+
+    plant_run(&plant, PLANT_OUTPUT_MIXER, 5 * MINUTE_MS);
+    // 50 ml of concentrate at 0.2 g/ml in about 60 l.
+    TEST_ASSERT_NEAR(ec + 10.f / 60.f * 1500.f, plant_ec(&plant), 20.f);
+}
+
+static void test_ph_dosers_move_the_ph(void) {
+    plant_t plant = plant_default();
+    float ph = plant_ph(&plant);
+    plant_run(&plant, PLANT_OUTPUT_PH_DOWN, 20 * 1000);
+    plant_run(&plant, PLANT_OUTPUT_MIXER, 5 * MINUTE_MS);
+    float down = plant_ph(&plant);
+    TEST_ASSERT(down < ph - 0.05f);
+
+    plant_run(&plant, PLANT_OUTPUT_PH_UP, 40 * 1000);
+    plant_run(&plant, PLANT_OUTPUT_MIXER, 5 * MINUTE_MS);
+    TEST_ASSERT(plant_ph(&plant) > down + 0.05f);
+}
+
+static void test_irrigation_concentrates_the_solution(void) {
+    plant_t plant = plant_default();
+    float level = plant_level(&plant);
+    float ec = plant_ec(&plant);
+    float ph = plant_ph(&plant);
+    plant_run(&plant, PLANT_OUTPUT_IRRIGATION, 24 * HOUR_MS);
+    // 0.2 l/h of transpiration and 0.05 l/h of evaporation for a day.
+    TEST_ASSERT_NEAR(level - 6.f / 100.f, plant_level(&plant), 0.005f);
+    TEST_ASSERT(plant_ec(&plant) > ec);
+    TEST_ASSERT(plant_ph(&plant) > ph);
+}
+
+static void test_fill_dilutes_cools_and_spills(void) {
+    plant_t plant = plant_default();
+    float ec = plant_ec(&plant);
+    plant_run(&plant, PLANT_OUTPUT_FILL, 5 * MINUTE_MS);
+    TEST_ASSERT_NEAR(0.8f, plant_level(&plant), 0.005f);
+    TEST_ASSERT(plant_ec(&plant) < ec);
+    TEST_ASSERT(plant_temp(&plant) < 21.f);
+
+    plant_run(&plant, PLANT_OUTPUT_FILL, 30 * MINUTE_MS);
+    TEST_ASSERT_NEAR(1.f, plant_level(&plant), 1e-4);
+    // Back to ambient after long enough.
+    TEST_ASSERT_EQUAL(ESP_OK, plant_advance(&plant, plant.now_ms + 48 * HOUR_MS));
+    TEST_ASSERT_NEAR(21.f, plant_temp(&plant), 0.05f);
+}
+
+static void test_runs_replay_with_the_same_seed(void) {
+    plant_t a = plant_default(), b = plant_default();
+    const plant_output_t outputs[] = {PLANT_OUTPUT_NUTRIENTS, PLANT_OUTPUT_MIXER, PLANT_OUTPUT_IRRIGATION,
+                                      PLANT_OUTPUT_FILL, PLANT_OUTPUT_PH_DOWN};
+    for (size_t i = 0; i < sizeof(outputs) / sizeof(outputs[0]); ++i) {
+        plant_run(&a, outputs[i], (i + 1) * 7 * MINUTE_MS);
+        plant_run(&b, outputs[i], (i + 1) * 7 * MINUTE_MS);
+    }
+    TEST_ASSERT(memcmp(&a, &b, sizeof(plant_t)) == 0);
+    for (int i = 0; i < 1000; ++i) {
+        float n = plant_noise(&a, 0.5f);
+        TEST_ASSERT(n == plant_noise(&b, 0.5f));
+        TEST_ASSERT(n >= -0.5f && n <= 0.5f);
+    }
+
+    plant_params_t params = PLANT_PARAMS_DEFAULT;
+    params.seed = 2;
+    TEST_ASSERT_EQUAL(ESP_OK, plant_init(&b, &params));
+    a = plant_default();
+    TEST_ASSERT(plant_noise(&a, 1.f) != plant_noise(&b, 1.f));
+}
+
+int main(void) {
+    RUN_TEST(test_initial_state);
+    RUN_TEST(test_invalid_params_are_rejected);
+    RUN_TEST(test_advance_uses_whole_steps);
+    RUN_TEST(test_nutrients_only_show_once_mixed);
+    RUN_TEST(test_ph_dosers_move_the_ph);
+    RUN_TEST(test_irrigation_concentrates_the_solution);
+    RUN_TEST(test_fill_dilutes_cools_and_spills);
+    RUN_TEST(test_runs_replay_with_the_same_seed);
+    return 0;
+}
@@ -0,0 +1,134 @@
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "config.h"
+#include "context.h"
+#include "sampling.h"
+#include "test.h"
+
+static const uint32_t DEFAULTS_MS[SAMPLING_MAX] = {
+        CONFIG_ESP_SAMPLING_HUMIDITY_MS,
+        CONFIG_ESP_SAMPLING_TEMPERATURE_MS,
+        CONFIG_ESP_SAMPLING_TANK_MS,
+        CONFIG_ESP_SAMPLING_EC_MS,
+        CONFIG_ESP_SAMPLING_RTD_MS,
+        CONFIG_ESP_SAMPLING_PH_MS,
+};
+
+static context_t context = {0};
+static config_callback_t callback = NULL;
+
+esp_err_t context_get_config(context_t *ctx, const Hydroponics__Config **config) {
+    *config = NULL;
+    return ESP_OK;
+}
+
+esp_err_t config_register(config_callback_t cb) {
+    callback = cb;
+    return ESP_OK;
+}
+
+// The configs handed to the callback live on the test stack.
+void context_config_release(const Hydroponics__Config *config) {
+}
+
+static void configure(Hydroponics__Sampling *sampling) {
+    Hydroponics__Config config = HYDROPONICS__CONFIG__INIT;
+    config.sampling = sampling;
+    callback(&config);
+}
+
+// The EZO modules share a phase so their sampler can pipeline them, the other sensors are staggered.
+static void test_defaults_and_phases(void) {
+    for (int i = 0; i < SAMPLING_MAX; ++i) {
+        TEST_ASSERT_EQUAL(DEFAULTS_MS[i], sampling_period_ms(i));
+    }
+    TickType_t epoch = sampling_next(SAMPLING_HUMIDITY);
+    TEST_ASSERT_EQUAL(epoch + SAMPLING_STAGGER_MS, sampling_next(SAMPLING_TEMPERATURE));
+    TEST_ASSERT_EQUAL(epoch + 2 * SAMPLING_STAGGER_MS, sampling_next(SAMPLING_TANK));
+    TEST_ASSERT_EQUAL(epoch + 3 * SAMPLING_STAGGER_MS, sampling_next(SAMPLING_EC));
+    TEST_ASSERT_EQUAL(sampling_next(SAMPLING_EC), sampling_next(SAMPLING_RTD));
+    TEST_ASSERT_EQUAL(sampling_next(SAMPLING_EC), sampling_next(SAMPLING_PH));
+}
+
+// A slot is taken once, a sensor that fell behind skips the slots it missed and keeps its phase.
+static void test_take_and_fall_behind(void) {
+    TickType_t next = sampling_next(SAMPLING_TANK);
+    TickType_t period = sampling_period_ms(SAMPLING_TANK);
+    TEST_ASSERT(!sampling_take(SAMPLING_TANK, next - 1));
+    TEST_ASSERT(sampling_take(SAMPLING_TANK, next));
+    TEST_ASSERT(!sampling_take(SAMPLING_TANK, next));
+    TEST_ASSERT_EQUAL(next + period, sampling_next(SAMPLING_TANK));
+
+    TEST_ASSERT(sampling_take(SAMPLING_TANK, next + period * 7 / 2));
+    TEST_ASSERT_EQUAL(next + 4 * period, sampling_next(SAMPLING_TANK));
+    TEST_ASSERT(!sampling_take(SAMPLING_TANK, next + period * 7 / 2));
+}
+
+// Unset periods fall back to their default, periods too short are raised to the minimum.
+static void test_config_periods(void) {
+    Hydroponics__Sampling sampling = HYDROPONICS__SAMPLING__INIT;
+    sampling.humidity_ms = 10;
+    sampling.tank_ms = 60000;
+    sampling.ec_probe_ms = 3000;
+    sampling.ec_probe_temp_ms = 3000;
+    sampling.ph_probe_ms = 3000;
+    configure(&sampling);
+    TEST_ASSERT_EQUAL(SAMPLING_MIN_MS, sampling_period_ms(SAMPLING_HUMIDITY));
+    TEST_ASSERT_EQUAL(CONFIG_ESP_SAMPLING_TEMPERATURE_MS, sampling_period_ms(SAMPLING_TEMPERATURE));
+    TEST_ASSERT_EQUAL(60000, sampling_period_ms(SAMPLING_TANK));
+    TEST_ASSERT_EQUAL(3000, sampling_period_ms(SAMPLING_PH));
+    // Every slot restarted from the same epoch.
+    TEST_ASSERT_EQUAL(sampling_next(SAMPLING_HUMIDITY) + 3 * SAMPLING_STAGGER_MS, sampling_next(SAMPLING_PH));
+
+    configure(NULL);
+    for (int i = 0; i < SAMPLING_MAX; ++i) {
+        TEST_ASSERT_EQUAL(DEFAULTS_MS[i], sampling_period_ms(i));
+    }
+}
+
+static _Atomic bool woken = false;
+
+static void *wait_tank(void *arg) {
+    sampling_wait(SAMPLING_TANK);
+    atomic_store(&woken, true);
+    return NULL;
+}
+
+// A sensor waiting for a slot a minute away wakes up as soon as its period is reconfigured.
+static void test_wait_follows_reconfiguration(void) {
+    Hydroponics__Sampling sampling = HYDROPONICS__SAMPLING__INIT;
+    sampling.tank_ms = 60000;
+    configure(&sampling);
+    // The first slot of a new schedule only waits for the phase.
+    TickType_t start = xTaskGetTickCount();
+    sampling_wait(SAMPLING_TANK);
+    TEST_ASSERT_NEAR(2 * SAMPLING_STAGGER_MS, xTaskGetTickCount() - start, 20);
+
+    pthread_t waiter;
+    TEST_ASSERT_EQUAL(0, pthread_create(&waiter, NULL, wait_tank, NULL));
+    vTaskDelay(pdMS_TO_TICKS(300));
+    TEST_ASSERT(!atomic_load(&woken));
+
+    start = xTaskGetTickCount();
+    sampling.tank_ms = 30000;
+    configure(&sampling);
+    pthread_join(waiter, NULL);
+    TEST_ASSERT(atomic_load(&woken));
+    TEST_ASSERT_NEAR(2 * SAMPLING_STAGGER_MS, xTaskGetTickCount() - start, 20);
+    printf("  woke up %u ms after the reconfiguration\n", xTaskGetTickCount() - start);
+}
+
+int main(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, sampling_init(&context));
+    TEST_ASSERT(callback != NULL);
+
+    RUN_TEST(test_defaults_and_phases);
+    RUN_TEST(test_take_and_fall_behind);
+    RUN_TEST(test_config_periods);
+    RUN_TEST(test_wait_follows_reconfiguration);
+    return 0;
+}
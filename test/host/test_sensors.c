@@ -0,0 +1,179 @@
+#include <pthread.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "buses.h"
+#include "config.h"
+#include "context.h"
+#include "sampling.h"
+#include "sensors.h"
+#include "test.h"
+
+#define INIT_FAILURES 12
+#define STUCK_LIMIT   5
+
+// Written by the sensors task, read by the test.
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static TickType_t inits[INIT_FAILURES + 1];
+static size_t n_inits = 0;
+static int resets = 0;
+static int bus_recoveries = 0;
+static int collects[2] = {0};
+
+static context_t context = {0};
+
+esp_err_t context_get_config(context_t *ctx, const Hydroponics__Config **config) {
+    *config = NULL;
+    return ESP_OK;
+}
+
+void context_config_release(const Hydroponics__Config *config) {
+}
+
+esp_err_t config_register(config_callback_t callback) {
+    return ESP_OK;
+}
+
+esp_err_t buses_recover(void) {
+    pthread_mutex_lock(&lock);
+    bus_recoveries++;
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+// A module that only answers after a while, e.g. plugged in after the boot.
+static esp_err_t late_init(context_t *ctx, void *arg) {
+    pthread_mutex_lock(&lock);
+    TEST_ASSERT(n_inits < sizeof(inits) / sizeof(inits[0]));
+    inits[n_inits++] = xTaskGetTickCount();
+    bool answers = n_inits > INIT_FAILURES;
+    pthread_mutex_unlock(&lock);
+    return answers ? ESP_OK : ESP_ERR_TIMEOUT;
+}
+
+static esp_err_t late_reset(context_t *ctx, void *arg) {
+    pthread_mutex_lock(&lock);
+    resets++;
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+static esp_err_t start(context_t *ctx, void *arg, TickType_t *ready) {
+    return ESP_OK;
+}
+
+static esp_err_t poll(context_t *ctx, void *arg, TickType_t *ready) {
+    return ESP_OK;
+}
+
+static esp_err_t collect(context_t *ctx, void *arg) {
+    pthread_mutex_lock(&lock);
+    collects[(intptr_t) arg]++;
+    pthread_mutex_unlock(&lock);
+    return ESP_OK;
+}
+
+// A calm tank, the reading never moves.
+static float calm_value(void *arg) {
+    return 6.2f;
+}
+
+static const sensors_driver_t late = {
+        .name = "late",
+        .sampling = SAMPLING_HUMIDITY,
+        .arg = (void *) 0,
+        .i2c = true,
+        .health = {.min = 0.f, .max = 14.f, .retries = 3},
+        .init = late_init,
+        .start = start,
+        .poll = poll,
+        .collect = collect,
+        .reset = late_reset,
+};
+
+static const sensors_driver_t calm = {
+        .name = "calm",
+        .sampling = SAMPLING_TEMPERATURE,
+        .arg = (void *) 1,
+        .i2c = true,
+        .health = {.min = 0.f, .max = 14.f, .stuck = STUCK_LIMIT, .retries = 3},
+        .start = start,
+        .poll = poll,
+        .collect = collect,
+        .reset = late_reset,
+        .value = calm_value,
+};
+
+static int collected(int driver) {
+    pthread_mutex_lock(&lock);
+    int n = collects[driver];
+    pthread_mutex_unlock(&lock);
+    return n;
+}
+
+static health_t health_of(const char *name) {
+    sensors_health_t health[SENSORS_MAX_DRIVERS];
+    size_t count = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, sensors_get_health(health, SENSORS_MAX_DRIVERS, &count));
+    for (size_t i = 0; i < count; ++i) {
+        if (strcmp(health[i].name, name) == 0) {
+            return health[i].health;
+        }
+    }
+    TEST_ASSERT(false);
+    return health[0].health;
+}
+
+// A failed init climbs the recovery ladder on every slot, then retries once every stale period until the module answers.
+static void test_failed_init_is_retried(void) {
+    for (int i = 0; i < 500 && collected(0) == 0; ++i) {
+        usleep(10 * 1000);
+    }
+    pthread_mutex_lock(&lock);
+    TEST_ASSERT_EQUAL(INIT_FAILURES + 1, n_inits);
+    // The boot attempt and 9 slots up to the alert, the first one right away. The failed init replaces the device reset.
+    TEST_ASSERT_NEAR(0, inits[1] - inits[0], 30);
+    for (size_t i = 2; i < 10; ++i) {
+        TEST_ASSERT_NEAR(100, inits[i] - inits[i - 1], 30);
+    }
+    for (size_t i = 10; i < n_inits; ++i) {
+        TEST_ASSERT_NEAR(500, inits[i] - inits[i - 1], 30);
+    }
+    TEST_ASSERT_EQUAL(0, resets);
+    TEST_ASSERT_EQUAL(1, bus_recoveries);
+    pthread_mutex_unlock(&lock);
+
+    health_t h = health_of("late");
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_OK, h.status);
+    TEST_ASSERT_EQUAL(INIT_FAILURES, h.errors);
+    TEST_ASSERT_EQUAL(1, h.recoveries);
+    printf("  up after %u ms and %zu inits\n", inits[INIT_FAILURES] - inits[0], n_inits);
+}
+
+// A value that never moves alerts once, is still published and never resets the device or the bus.
+static void test_stuck_value_only_alerts(void) {
+    health_t h = health_of("calm");
+    TEST_ASSERT(h.samples > STUCK_LIMIT);
+    TEST_ASSERT_EQUAL(HEALTH_STATUS_DEGRADED, h.status);
+    TEST_ASSERT_EQUAL(HEALTH_FAULT_STUCK, h.fault);
+    TEST_ASSERT_EQUAL(1, h.errors);
+    TEST_ASSERT(collected(1) >= h.samples);
+    pthread_mutex_lock(&lock);
+    TEST_ASSERT_EQUAL(0, resets);
+    TEST_ASSERT_EQUAL(1, bus_recoveries);
+    pthread_mutex_unlock(&lock);
+}
+
+int main(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, sampling_init(&context));
+    TEST_ASSERT_EQUAL(ESP_OK, sensors_register(&late));
+    TEST_ASSERT_EQUAL(ESP_OK, sensors_register(&calm));
+    TEST_ASSERT_EQUAL(ESP_OK, sensors_init(&context));
+
+    RUN_TEST(test_failed_init_is_retried);
+    RUN_TEST(test_stuck_value_only_alerts);
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <string.h>
+
+#include "iot.h"
+#include "state.h"
+#include "test.h"
+
+#define MAX_ITEMS     64
+#define ITEM_MAX_SIZE 1536 // STATE_ITEM_MAX_SIZE in state.c.
+
+typedef struct {
+    size_t size;  /*!< Packed size of the states. */
+    size_t jobs;
+    char first[32];
+} item_t;
+
+// Stands in for the iot ring buffer, every published item is packed like iot_publish does.
+static item_t items[MAX_ITEMS];
+static size_t n_items = 0;
+static esp_err_t publish_err = ESP_OK;
+static uint8_t packed[4096];
+
+esp_err_t iot_publish_state(Hydroponics__States *states) {
+    if (publish_err != ESP_OK) {
+        return publish_err;
+    }
+    TEST_ASSERT(n_items < MAX_ITEMS);
+    item_t *item = &items[n_items++];
+    item->size = hydroponics__states__get_packed_size(states);
+    TEST_ASSERT(item->size <= sizeof(packed));
+    TEST_ASSERT_EQUAL(item->size, hydroponics__states__pack(states, packed));
+    TEST_ASSERT_EQUAL(1, states->n_state);
+    const Hydroponics__State *state = states->state[0];
+    if (state->state_case == HYDROPONICS__STATE__STATE_CRON) {
+        item->jobs = state->cron->n_job;
+        strlcpy(item->first, state->cron->job[0]->name, sizeof(item->first));
+    }
+    return ESP_OK;
+}
+
+esp_err_t iot_publish_telemetry(Hydroponics__States *states) {
+    return iot_publish_state(states);
+}
+
+static void reset(void) {
+    memset(items, 0, sizeof(items));
+    n_items = 0;
+    publish_err = ESP_OK;
+}
+
+static void fill_infos(cron_info_t *infos, size_t n) {
+    memset(infos, 0, n * sizeof(cron_info_t));
+    for (size_t i = 0; i < n; ++i) {
+        snprintf(infos[i].name, sizeof(infos[i].name), "job_%03zu_with_a_long_name", i);
+        strlcpy(infos[i].expression, "*/5 0,10,20,30,40,50 6-22 * * 1-5", sizeof(infos[i].expression));
+        infos[i].next_execution.tv_sec = 1709251200 + (time_t) i;
+        infos[i].stats.runs = 1000000 + i;
+        infos[i].stats.lateness[0] = 1000000;
+    }
+}
+
+// Every item fits the ring buffer, the jobs come out once and in order.
+static void test_cron_is_split(void) {
+    static cron_info_t infos[200];
+    const size_t n = sizeof(infos) / sizeof(infos[0]);
+    fill_infos(infos, n);
+    reset();
+    TEST_ASSERT_EQUAL(ESP_OK, state_push_cron(infos, n));
+    TEST_ASSERT(n_items > 1);
+    size_t jobs = 0;
+    for (size_t i = 0; i < n_items; ++i) {
+        TEST_ASSERT(items[i].size <= ITEM_MAX_SIZE);
+        TEST_ASSERT(strcmp(infos[jobs].name, items[i].first) == 0);
+        jobs += items[i].jobs;
+    }
+    TEST_ASSERT_EQUAL(n, jobs);
+    printf("  %zu jobs in %zu items, %zu bytes in the first\n", n, n_items, items[0].size);
+
+    reset();
+    TEST_ASSERT_EQUAL(ESP_OK, state_push_cron(infos, 1));
+    TEST_ASSERT_EQUAL(1, n_items);
+    TEST_ASSERT_EQUAL(ESP_OK, state_push_cron(infos, 0));
+    TEST_ASSERT_EQUAL(1, n_items);
+}
+
+// A full buffer is reported to the caller, nothing aborts.
+static void test_cron_publish_fails(void) {
+    static cron_info_t infos[50];
+    fill_infos(infos, 50);
+    reset();
+    publish_err = ESP_ERR_TIMEOUT;
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, state_push_cron(infos, 50));
+    TEST_ASSERT_EQUAL(0, n_items);
+}
+
+// Like the cron state, a full buffer drops the health report instead of aborting.
+static void test_health_publish_fails(void) {
+    sensors_health_t health[2] = {{.name = "ezo_ph"}, {.name = "bme280"}};
+    reset();
+    TEST_ASSERT_EQUAL(ESP_OK, state_push_health(health, 2));
+    TEST_ASSERT_EQUAL(1, n_items);
+    publish_err = ESP_ERR_TIMEOUT;
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, state_push_health(health, 2));
+    TEST_ASSERT_EQUAL(1, n_items);
+}
+
+// A config push costs its digest on the way back, whatever the size of the config.
+static void test_config_digest_size(void) {
+    config_digest_t digest = {.version = 1000, .size = 60000};
+    memset(digest.sha256, 0xa5, sizeof(digest.sha256));
+    reset();
+    TEST_ASSERT_EQUAL(ESP_OK, state_push_config(&digest));
+    TEST_ASSERT_EQUAL(1, n_items);
+    size_t size = items[0].size;
+    TEST_ASSERT(size < 64);
+
+    // A deleted config has no digest.
+    config_digest_t deleted = {.version = 1001};
+    TEST_ASSERT_EQUAL(ESP_OK, state_push_config(&deleted));
+    TEST_ASSERT(items[1].size < size - CONFIG_DIGEST_LEN);
+
+    publish_err = ESP_ERR_TIMEOUT;
+    TEST_ASSERT_EQUAL(ESP_ERR_TIMEOUT, state_push_config(&digest));
+    TEST_ASSERT_EQUAL(2, n_items);
+    printf("  %zu bytes per push, %zu for a deleted config\n", size, items[1].size);
+}
+
+int main(void) {
+    RUN_TEST(test_cron_is_split);
+    RUN_TEST(test_cron_publish_fails);
+    RUN_TEST(test_health_publish_fails);
+    RUN_TEST(test_config_digest_size);
+    return 0;
+}
@@ -0,0 +1,185 @@
+#include <string.h>
+#include <unistd.h>
+
+#include "esp_system.h"
+#include "esp_timer.h"
+#include "nvs.h"
+
+#include "storage.h"
+#include "test.h"
+#include "utils.h"
+
+#define MS 1000LL
+
+// The flush runs in its own task, the timer only wakes it up.
+static void wait_for_commits(uint32_t commits) {
+    for (int i = 0; i < 2000 && host_nvs_stats().commits < commits; ++i) {
+        usleep(1000);
+    }
+    TEST_ASSERT_EQUAL(commits, host_nvs_stats().commits);
+}
+
+static void assert_string(const char *key, const char *expected) {
+    char *value = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_get_string(key, &value, NULL));
+    TEST_ASSERT(value != NULL && strcmp(value, expected) == 0);
+    SAFE_FREE(value);
+}
+
+static void test_missing_key_keeps_the_default(void) {
+    char *value = NULL;
+    size_t len = 42;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_get_string("missing", &value, &len));
+    TEST_ASSERT(value == NULL);
+    TEST_ASSERT_EQUAL(42, len);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, storage_set_string("a_key_that_is_too_long", "x"));
+}
+
+static void test_writes_are_coalesced_until_quiet(void) {
+    host_nvs_stats_t before = host_nvs_stats();
+    char value[16];
+    for (int i = 0; i < 10; ++i) {
+        snprintf(value, sizeof(value), "value%d", i);
+        TEST_ASSERT_EQUAL(ESP_OK, storage_set_string("quiet", value));
+        host_timer_advance(500 * MS);
+        // Read back from the cache, nothing reached NVS yet.
+        assert_string("quiet", value);
+    }
+    TEST_ASSERT_EQUAL(before.writes, host_nvs_stats().writes);
+    host_timer_advance(2000 * MS);
+    wait_for_commits(before.commits + 1);
+    TEST_ASSERT_EQUAL(before.writes + 1, host_nvs_stats().writes);
+
+    storage_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_get_stats(&stats));
+    TEST_ASSERT(stats.coalesced >= 9);
+
+    // The same value again is not a write.
+    TEST_ASSERT_EQUAL(ESP_OK, storage_set_string("quiet", value));
+    host_timer_advance(5000 * MS);
+    usleep(10 * 1000);
+    TEST_ASSERT_EQUAL(before.writes + 1, host_nvs_stats().writes);
+}
+
+// A key written every second is still flushed every STORAGE_FLUSH_MAX_DELAY_MS.
+static void test_busy_key_is_flushed_anyway(void) {
+    host_nvs_stats_t before = host_nvs_stats();
+    for (int i = 0; i < 10; ++i) {
+        uint32_t counter = i;
+        TEST_ASSERT_EQUAL(ESP_OK, storage_set_blob("busy", (const uint8_t *) &counter, sizeof(counter)));
+        host_timer_advance(1000 * MS);
+    }
+    wait_for_commits(before.commits + 1);
+    TEST_ASSERT_EQUAL(before.writes + 1, host_nvs_stats().writes);
+}
+
+static void test_delete_and_explicit_flush(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, storage_set_string("gone", "soon"));
+    TEST_ASSERT_EQUAL(ESP_OK, storage_flush());
+    host_nvs_stats_t before = host_nvs_stats();
+    TEST_ASSERT_EQUAL(ESP_OK, storage_delete("gone"));
+    char *value = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_get_string("gone", &value, NULL));
+    TEST_ASSERT(value == NULL);
+    TEST_ASSERT_EQUAL(ESP_OK, storage_flush());
+    TEST_ASSERT_EQUAL(before.writes + 1, host_nvs_stats().writes);
+    size_t len = 0;
+    TEST_ASSERT_EQUAL(ESP_ERR_NVS_NOT_FOUND, nvs_get_str(1, "gone", NULL, &len));
+    // Nothing dirty, nothing committed.
+    TEST_ASSERT_EQUAL(ESP_OK, storage_flush());
+    TEST_ASSERT_EQUAL(before.commits + 1, host_nvs_stats().commits);
+}
+
+// Clean entries past the cache budget are dropped and read again from NVS.
+static void test_clean_entries_are_evicted(void) {
+    uint8_t blob[1024];
+    char key[16];
+    for (int i = 0; i < 16; ++i) {
+        memset(blob, i, sizeof(blob));
+        snprintf(key, sizeof(key), "blob%d", i);
+        TEST_ASSERT_EQUAL(ESP_OK, storage_set_blob(key, blob, sizeof(blob)));
+    }
+    // Dirty entries are never evicted.
+    storage_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_get_stats(&stats));
+    uint32_t evictions = stats.evictions;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_flush());
+    TEST_ASSERT_EQUAL(ESP_OK, storage_get_stats(&stats));
+    TEST_ASSERT(stats.evictions >= evictions + 12);
+
+    host_nvs_stats_t before = host_nvs_stats();
+    for (int i = 0; i < 16; ++i) {
+        snprintf(key, sizeof(key), "blob%d", i);
+        uint8_t *value = NULL;
+        size_t len = 0;
+        TEST_ASSERT_EQUAL(ESP_OK, storage_get_blob(key, &value, &len));
+        TEST_ASSERT_EQUAL(sizeof(blob), len);
+        TEST_ASSERT(value[0] == i && value[len - 1] == i);
+        SAFE_FREE(value);
+    }
+    TEST_ASSERT(host_nvs_stats().reads > before.reads);
+
+    // Small keys in use stay cached.
+    assert_string("quiet", "value9");
+    before = host_nvs_stats();
+    assert_string("quiet", "value9");
+    TEST_ASSERT_EQUAL(before.reads, host_nvs_stats().reads);
+}
+
+static void test_shutdown_flushes(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, storage_set_string("last", "words"));
+    host_shutdown();
+    char value[8];
+    size_t len = sizeof(value);
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_get_str(1, "last", value, &len));
+    TEST_ASSERT(strcmp(value, "words") == 0);
+}
+
+// A blob committed by the previous boot is read from the file once, then served from the cache. Before the digest,
+// every config push paid that first read to compare the stored config.
+static void test_blob_read_back_from_file(void) {
+    char path[] = "/tmp/host_nvs_XXXXXX";
+    int fd = mkstemp(path);
+    TEST_ASSERT(fd >= 0);
+    close(fd);
+    TEST_ASSERT_EQUAL(ESP_OK, host_nvs_open_file(path));
+    uint8_t config[1536];
+    for (size_t i = 0; i < sizeof(config); ++i) {
+        config[i] = (uint8_t) (i * 7);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_set_blob(1, "iot_config", config, sizeof(config)));
+    TEST_ASSERT_EQUAL(ESP_OK, nvs_commit(1));
+
+    // Reboot.
+    TEST_ASSERT_EQUAL(ESP_OK, host_nvs_open_file(path));
+    host_nvs_stats_t before = host_nvs_stats();
+    uint8_t *value = NULL;
+    size_t len = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, storage_get_blob("iot_config", &value, &len));
+    TEST_ASSERT_EQUAL(sizeof(config), len);
+    TEST_ASSERT(memcmp(config, value, len) == 0);
+    SAFE_FREE(value);
+    host_nvs_stats_t after = host_nvs_stats();
+    TEST_ASSERT_EQUAL(2, after.reads - before.reads);
+    TEST_ASSERT_EQUAL(sizeof(config), after.bytes_read - before.bytes_read);
+
+    TEST_ASSERT_EQUAL(ESP_OK, storage_get_blob("iot_config", &value, &len));
+    SAFE_FREE(value);
+    TEST_ASSERT_EQUAL(after.reads, host_nvs_stats().reads);
+    unlink(path);
+    printf("  %zu bytes: %u reads and %u bytes on the first get, none after\n", sizeof(config),
+           after.reads - before.reads, after.bytes_read - before.bytes_read);
+}
+
+int main(void) {
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, storage_flush());
+    TEST_ASSERT_EQUAL(ESP_OK, storage_init(NULL));
+    RUN_TEST(test_missing_key_keeps_the_default);
+    RUN_TEST(test_writes_are_coalesced_until_quiet);
+    RUN_TEST(test_busy_key_is_flushed_anyway);
+    RUN_TEST(test_delete_and_explicit_flush);
+    RUN_TEST(test_clean_entries_are_evicted);
+    RUN_TEST(test_shutdown_flushes);
+    RUN_TEST(test_blob_read_back_from_file);
+    return 0;
+}
@@ -0,0 +1,302 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "soc/soc_memory_layout.h"
+
+#include "context.h"
+#include "crashlog.h"
+#include "syslog.h"
+#include "test.h"
+
+#define PRODUCERS    4
+#define FLOOD_LINES  50000
+#define CHATTY_LINES 20000
+#define DONE         "flood: done"
+
+// Tags in flash get their own token bucket.
+enum {
+    FLOOD,
+    CHATTY,
+    QUIET,
+    N_TAGS,
+};
+static const char TAGS[N_TAGS][8] = {
+        [FLOOD] = "flood",
+        [CHATTY] = "chatty",
+        [QUIET] = "quiet",
+};
+
+#define LOG(letter, tag, format, ...) \
+    esp_log_write(ESP_LOG_INFO, TAGS[tag], LOG_FORMAT(letter, format), esp_log_timestamp(), TAGS[tag], ##__VA_ARGS__)
+
+// The local UDP receiver, it keeps every datagram until the last line of the flood.
+typedef struct {
+    int fd;
+    char *data;
+    size_t len;
+    size_t max;
+    _Atomic uint32_t packets;
+    uint32_t overflows; /*!< Datagrams the kernel dropped on a full receive buffer, SO_RXQ_OVFL. */
+} receiver_t;
+
+static receiver_t receiver = {.fd = -1};
+static context_t context = {0};
+static const char *capture_dir = NULL;
+
+static uint16_t receiver_open(void) {
+    receiver.fd = socket(AF_INET, SOCK_DGRAM, 0);
+    TEST_ASSERT(receiver.fd >= 0);
+    int val = 4 << 20;
+    setsockopt(receiver.fd, SOL_SOCKET, SO_RCVBUF, &val, sizeof(val));
+    val = 1;
+    TEST_ASSERT(setsockopt(receiver.fd, SOL_SOCKET, SO_RXQ_OVFL, &val, sizeof(val)) == 0);
+    const struct timeval timeout = {.tv_sec = 10};
+    TEST_ASSERT(setsockopt(receiver.fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)) == 0);
+    struct sockaddr_in addr = {.sin_family = AF_INET, .sin_addr.s_addr = htonl(INADDR_LOOPBACK)};
+    socklen_t addr_len = sizeof(addr);
+    TEST_ASSERT(bind(receiver.fd, (struct sockaddr *) &addr, sizeof(addr)) == 0);
+    TEST_ASSERT(getsockname(receiver.fd, (struct sockaddr *) &addr, &addr_len) == 0);
+    return ntohs(addr.sin_port);
+}
+
+static void *receiver_task(void *arg) {
+    (void) arg;
+    while (true) {
+        if (receiver.max - receiver.len < 2048) {
+            receiver.max = receiver.max ? receiver.max * 2 : 1 << 20;
+            receiver.data = realloc(receiver.data, receiver.max + 1);
+            TEST_ASSERT(receiver.data != NULL);
+        }
+        char *packet = &receiver.data[receiver.len];
+        struct iovec iov = {.iov_base = packet, .iov_len = receiver.max - receiver.len};
+        char control[CMSG_SPACE(sizeof(uint32_t))];
+        struct msghdr msg = {
+                .msg_iov = &iov,
+                .msg_iovlen = 1,
+                .msg_control = control,
+                .msg_controllen = sizeof(control),
+        };
+        ssize_t n = recvmsg(receiver.fd, &msg, 0);
+        // A timeout, the last line never came.
+        TEST_ASSERT(n > 0);
+        for (struct cmsghdr *c = CMSG_FIRSTHDR(&msg); c != NULL; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SO_RXQ_OVFL) {
+                memcpy(&receiver.overflows, CMSG_DATA(c), sizeof(receiver.overflows));
+            }
+        }
+        receiver.len += n;
+        receiver.packets++;
+        if (memmem(packet, n, DONE, strlen(DONE)) != NULL) {
+            return NULL;
+        }
+    }
+}
+
+// The lines are printed on the UART too, keep them out of the test output.
+static int stdout_to_null(void) {
+    fflush(stdout);
+    int saved = dup(STDOUT_FILENO);
+    int null = open("/dev/null", O_WRONLY);
+    TEST_ASSERT(saved >= 0 && null >= 0);
+    dup2(null, STDOUT_FILENO);
+    close(null);
+    return saved;
+}
+
+static void stdout_restore(int saved) {
+    fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+}
+
+// The clock moves 1 ms every other line, 10 s for the whole run. The quiet tag stays under its rate.
+static void log_chatty(void) {
+    for (int i = 0; i < CHATTY_LINES; ++i) {
+        LOG(I, CHATTY, "%d", i);
+        if (i % 1000 == 0) {
+            LOG(I, QUIET, "%d", i / 1000);
+            // Real lines are spread out, the client gets to send them before the ring fills.
+            usleep(1000);
+        }
+        if (i % 2 == 1) {
+            host_timer_advance(1000);
+        }
+    }
+}
+
+// Errors are never rate limited, they overflow the ring.
+static void *log_flood(void *arg) {
+    const int producer = (int) (uintptr_t) arg;
+    for (int i = 0; i < FLOOD_LINES; ++i) {
+        LOG(E, FLOOD, "%d %d", producer, i);
+    }
+    return NULL;
+}
+
+typedef struct {
+    uint8_t *seen;
+    uint32_t received[N_TAGS];
+    int next[PRODUCERS];
+    uint32_t dropped;
+    uint32_t limited;
+} capture_t;
+
+static void check_message(capture_t *c, const char *message, size_t size, const syslog_stats_t *stats) {
+    char buf[512];
+    TEST_ASSERT(size < sizeof(buf));
+    memcpy(buf, message, size);
+    buf[size] = '\0';
+    TEST_ASSERT(strncmp(buf, "<", 1) == 0 && strstr(buf, ">1 - - hydroponics - - [meta sequenceId=\"") != NULL);
+
+    const uint32_t number = strtoul(strstr(buf, "sequenceId=\"") + strlen("sequenceId=\""), NULL, 10);
+    TEST_ASSERT(number >= 1 && number <= stats->lines);
+    TEST_ASSERT(!c->seen[number]);
+    c->seen[number] = 1;
+    // Only on the first message of a packet.
+    const char *drops = strstr(buf, "[drops@32473 ");
+    if (drops != NULL) {
+        TEST_ASSERT(sscanf(drops, "[drops@32473 dropped=\"%u\" limited=\"%u\"]", &c->dropped, &c->limited) == 2);
+    }
+
+    char pattern[32];
+    for (int tag = 0; tag < N_TAGS; ++tag) {
+        snprintf(pattern, sizeof(pattern), ") %s: ", TAGS[tag]);
+        const char *msg = strstr(buf, pattern);
+        if (msg == NULL) {
+            continue;
+        }
+        msg += strlen(pattern);
+        c->received[tag]++;
+        int producer, i;
+        if (tag == FLOOD && sscanf(msg, "%d %d", &producer, &i) == 2) {
+            // Lines of a task come out in order, some are missing.
+            TEST_ASSERT(producer >= 0 && producer < PRODUCERS);
+            TEST_ASSERT(i >= c->next[producer]);
+            c->next[producer] = i + 1;
+        } else if (tag == FLOOD) {
+            TEST_ASSERT(strcmp(msg, "start") == 0 || strcmp(msg, "done") == 0);
+        }
+        return;
+    }
+    TEST_ASSERT(false);
+}
+
+static void write_file(const char *dir, const char *name, const void *data, size_t len) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "wb");
+    TEST_ASSERT(f != NULL);
+    TEST_ASSERT_EQUAL(len, fwrite(data, 1, len, f));
+    fclose(f);
+}
+
+// Every line takes a sequence number, the gaps the receiver sees are the lines the device counted as dropped or
+// rate limited, unless the kernel dropped a datagram.
+static void test_loss_accounting_under_flood(void) {
+    pthread_t thread;
+    TEST_ASSERT_EQUAL(0, pthread_create(&thread, NULL, receiver_task, NULL));
+
+    // The client is up once the first line came through.
+    LOG(W, FLOOD, "start");
+    for (int i = 0; i < 1000 && atomic_load(&receiver.packets) == 0; ++i) {
+        usleep(1000);
+    }
+    TEST_ASSERT(atomic_load(&receiver.packets) > 0);
+
+    int saved = stdout_to_null();
+    log_chatty();
+    syslog_stats_t chatty;
+    TEST_ASSERT_EQUAL(ESP_OK, syslog_get_stats(&chatty));
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_t threads[PRODUCERS];
+    for (uintptr_t i = 0; i < PRODUCERS; ++i) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, log_flood, (void *) i));
+    }
+    for (int i = 0; i < PRODUCERS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    // Once the ring drained, the last line carries the final counters.
+    usleep(200 * 1000);
+    esp_log_write(ESP_LOG_ERROR, TAGS[FLOOD], LOG_FORMAT(E, "done"), esp_log_timestamp(), TAGS[FLOOD]);
+    pthread_join(thread, NULL);
+    stdout_restore(saved);
+
+    syslog_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_OK, syslog_get_stats(&stats));
+    TEST_ASSERT_EQUAL(CHATTY_LINES + CHATTY_LINES / 1000 + PRODUCERS * FLOOD_LINES + 2, stats.lines);
+    TEST_ASSERT_EQUAL(0, chatty.dropped);
+    TEST_ASSERT(stats.dropped > 0);
+
+    capture_t c = {.seen = calloc(stats.lines + 1, 1)};
+    TEST_ASSERT(c.seen != NULL);
+    size_t offset = 0;
+    while (offset < receiver.len) {
+        // Octet counted, `LEN SP MSG`.
+        receiver.data[receiver.len] = '\0';
+        char *space;
+        size_t size = strtoul(&receiver.data[offset], &space, 10);
+        TEST_ASSERT(space > &receiver.data[offset] && *space == ' ');
+        TEST_ASSERT(space + 1 + size <= &receiver.data[receiver.len]);
+        check_message(&c, space + 1, size, &stats);
+        offset = space + 1 + size - receiver.data;
+    }
+    uint32_t received = 0;
+    for (int tag = 0; tag < N_TAGS; ++tag) {
+        received += c.received[tag];
+    }
+
+    // The quiet tag is never limited, the chatty one gets its burst and its rate over the 10 s.
+    TEST_ASSERT_EQUAL(CHATTY_LINES / 1000, c.received[QUIET]);
+    TEST_ASSERT(c.received[CHATTY] <= CONFIG_ESP_SYSLOG_RATE_BURST + CONFIG_ESP_SYSLOG_RATE_LIMIT * 10 + 1);
+    TEST_ASSERT(c.received[CHATTY] >= CONFIG_ESP_SYSLOG_RATE_LIMIT * 10);
+    TEST_ASSERT_EQUAL(CHATTY_LINES - c.received[CHATTY], chatty.limited);
+    TEST_ASSERT_EQUAL(chatty.limited, stats.limited);
+    // The last packet reports the final counters.
+    TEST_ASSERT_EQUAL(stats.dropped, c.dropped);
+    TEST_ASSERT_EQUAL(stats.limited, c.limited);
+    if (receiver.overflows == 0) {
+        TEST_ASSERT_EQUAL(stats.lines, received + stats.dropped + stats.limited);
+    } else {
+        TEST_ASSERT(stats.lines > received + stats.dropped + stats.limited);
+    }
+
+    double s = (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("  %d errors flooded in %.0f ms\n", PRODUCERS * FLOOD_LINES, s * 1000);
+    printf("  %u lines in %u packets: %u received, %u dropped, %u rate limited, %u datagrams lost\n", stats.lines,
+           atomic_load(&receiver.packets), received, stats.dropped, stats.limited, receiver.overflows);
+    // tools/syslog_decode.py accounts for the same capture, see test_syslog_decode.py.
+    if (capture_dir != NULL) {
+        char counters[64];
+        int len = snprintf(counters, sizeof(counters), "%u %u %u %u\n", stats.lines, stats.dropped, stats.limited,
+                           receiver.overflows);
+        write_file(capture_dir, "capture.bin", receiver.data, receiver.len);
+        write_file(capture_dir, "counters.txt", counters, len);
+    }
+    free(c.seen);
+}
+
+int main(int argc, char *argv[]) {
+    host_set_drom(TAGS, sizeof(TAGS));
+    TEST_ASSERT_EQUAL(ESP_OK, crashlog_init());
+    TEST_ASSERT(crashlog_previous()->n_lines == 0);
+
+    context.event_group = xEventGroupCreate();
+    context.config.syslog_hostname = "127.0.0.1";
+    context.config.syslog_port = receiver_open();
+    TEST_ASSERT_EQUAL(ESP_OK, syslog_init(&context));
+    xEventGroupSetBits(context.event_group, CONTEXT_EVENT_BASE_CONFIG | CONTEXT_EVENT_NETWORK);
+
+    capture_dir = argc > 1 ? argv[1] : NULL;
+    RUN_TEST(test_loss_accounting_under_flood);
+    return 0;
+}
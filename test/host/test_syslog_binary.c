@@ -0,0 +1,154 @@
+#include <stdarg.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "soc/soc_memory_layout.h"
+
+#include "syslog_binary.h"
+#include "test.h"
+
+// Stands in for the flash mapped rodata, the formats and tags the encoder sends as addresses.
+enum {
+    TAG,
+    PLAIN,
+    BOOT,
+    STRINGS,
+    WIDE,
+    DOUBLES,
+    CHARS,
+    POINTER,
+    FLAGS,
+    VARINT,
+    N_DROM,
+};
+static const char DROM[N_DROM][64] = {
+        [TAG] = "sensors",
+        [PLAIN] = "plain line without arguments\n",
+        [BOOT] = "%s: boot %d of %u\n",
+        [STRINGS] = "%s %-8s|%8s|%.3s|%s\n",
+        [WIDE] = "%lld %llu %jd %zu %ld %hhu\n",
+        [DOUBLES] = "%5.2f %e %g %.*f %*d\n",
+        [CHARS] = "%c%c %x %X %o %#x %%\n",
+        [POINTER] = "%p\n",
+        [FLAGS] = "%08.3f|%+d|% d|%-5u|\n",
+        [VARINT] = "%u",
+};
+
+static uint8_t records[4096];
+static size_t records_len = 0;
+static char expected[4096];
+static size_t expected_len = 0;
+
+// Encodes one record and keeps what vsnprintf prints for the same arguments.
+static size_t record(const char *fmt, ...) {
+    va_list va;
+    va_start(va, fmt);
+    size_t len = syslog_binary_encode(&records[records_len], sizeof(records) - records_len, fmt, va);
+    va_end(va);
+    TEST_ASSERT(len >= SYSLOG_BINARY_HEADER);
+    records_len += len;
+    va_start(va, fmt);
+    expected_len += vsnprintf(&expected[expected_len], sizeof(expected) - expected_len, fmt, va);
+    va_end(va);
+    return len;
+}
+
+static size_t encode(uint8_t *buf, size_t max, const char *fmt, ...) {
+    va_list va;
+    va_start(va, fmt);
+    size_t len = syslog_binary_encode(buf, max, fmt, va);
+    va_end(va);
+    return len;
+}
+
+static size_t encode_text(uint8_t *buf, size_t max, const char *fmt, ...) {
+    va_list va;
+    va_start(va, fmt);
+    size_t len = syslog_binary_encode_text(buf, max, fmt, va);
+    va_end(va);
+    return len;
+}
+
+static void test_mixed_records(void) {
+    char runtime[] = "runtime";
+    record(DROM[PLAIN]);
+    record(DROM[BOOT], DROM[TAG], -3, 4000000000u);
+    record(DROM[STRINGS], DROM[TAG], runtime, "x", "abcdef", (const char *) NULL);
+    record(DROM[WIDE], INT64_MIN, UINT64_MAX, (intmax_t) -5, (size_t) 1 << 40, -123456789L, (unsigned char) 200);
+    record(DROM[DOUBLES], 3.14159, -1e-10, 12345678.0, 3, 2.5, 6, 42);
+    record(DROM[CHARS], 'o', 'k', 0xdead, 0xbeef, 8, 255);
+    record(DROM[POINTER], (void *) 0x3ffb1234);
+    record(DROM[FLAGS], -2.5, 7, 7, 12u);
+}
+
+// A constant tag takes 6 bytes, a copied runtime string its length plus 2.
+static void test_strings_in_flash_are_sent_as_addresses(void) {
+    uint8_t buf[64];
+    char runtime[] = "sensors";
+    TEST_ASSERT_EQUAL(SYSLOG_BINARY_HEADER + 2 + 4 + 1 + 1, encode(buf, sizeof(buf), DROM[BOOT], DROM[TAG], 0, 0));
+    TEST_ASSERT_EQUAL(SYSLOG_BINARY_HEADER + 2 + 7 + 1 + 1, encode(buf, sizeof(buf), DROM[BOOT], runtime, 0, 0));
+}
+
+static void test_varints(void) {
+    const uint32_t values[] = {0, 127, 128, 16383, 16384, UINT32_MAX};
+    const size_t sizes[] = {1, 1, 2, 2, 3, 5};
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i) {
+        TEST_ASSERT_EQUAL(SYSLOG_BINARY_HEADER + sizes[i], record(DROM[VARINT], values[i]));
+    }
+    // Zigzag keeps small negative numbers small, "boot %d of %u\n".
+    uint8_t buf[16];
+    TEST_ASSERT_EQUAL(SYSLOG_BINARY_HEADER + 2, encode(buf, sizeof(buf), DROM[BOOT] + 4, -1, 0));
+}
+
+static void test_fallbacks(void) {
+    uint8_t buf[32];
+    char fmt[] = "runtime format %d\n";
+    // Not in flash, the caller falls back to text.
+    TEST_ASSERT_EQUAL(0, encode(buf, sizeof(buf), fmt, 1));
+    size_t len = encode_text(&records[records_len], sizeof(records) - records_len, fmt, 1);
+    TEST_ASSERT_EQUAL(SYSLOG_BINARY_HEADER + strlen("runtime format 1\n"), len);
+    records_len += len;
+    expected_len += snprintf(&expected[expected_len], sizeof(expected) - expected_len, fmt, 1);
+
+    // Too big for the buffer.
+    TEST_ASSERT_EQUAL(0, encode(buf, 8, DROM[BOOT], DROM[TAG], 1, 2));
+    TEST_ASSERT_EQUAL(0, encode(buf, SYSLOG_BINARY_HEADER - 1, DROM[PLAIN]));
+    // Text is truncated instead.
+    uint8_t small[16];
+    TEST_ASSERT_EQUAL(sizeof(small) - 1, encode_text(small, sizeof(small), fmt, 1));
+    uint16_t size;
+    memcpy(&size, small, sizeof(size));
+    TEST_ASSERT_EQUAL(sizeof(small) - 1 - sizeof(uint16_t), size);
+}
+
+// tools/syslog_decode.py decodes these, see test_syslog_decode.py.
+static void write_file(const char *dir, const char *name, const void *prefix, size_t prefix_len, const void *data,
+                       size_t len) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", dir, name);
+    FILE *f = fopen(path, "wb");
+    TEST_ASSERT(f != NULL);
+    TEST_ASSERT_EQUAL(prefix_len, fwrite(prefix, 1, prefix_len, f));
+    TEST_ASSERT_EQUAL(len, fwrite(data, 1, len, f));
+    fclose(f);
+}
+
+int main(int argc, char *argv[]) {
+    // Addresses are 32 bits on the wire.
+    const uint32_t base = (uint32_t) (uintptr_t) DROM;
+    TEST_ASSERT((uint64_t) base + sizeof(DROM) <= UINT32_MAX);
+    host_set_drom(DROM, sizeof(DROM));
+
+    RUN_TEST(test_mixed_records);
+    RUN_TEST(test_strings_in_flash_are_sent_as_addresses);
+    RUN_TEST(test_varints);
+    RUN_TEST(test_fallbacks);
+    printf("  %u bytes of records for %u bytes of text\n", (unsigned int) records_len, (unsigned int) expected_len);
+    if (argc > 1) {
+        write_file(argv[1], "records.bin", NULL, 0, records, records_len);
+        write_file(argv[1], "drom.bin", &base, sizeof(base), DROM, sizeof(DROM));
+        write_file(argv[1], "expected.txt", NULL, 0, expected, expected_len);
+    }
+    return 0;
+}
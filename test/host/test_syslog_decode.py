@@ -0,0 +1,144 @@
+#!/usr/bin/env python3
+"""Round trips the records of test_syslog_binary through tools/syslog_decode.py, and accounts for the packets
+test_syslog captured under flood.
+
+Usage: test_syslog_decode.py path/to/test_syslog_binary path/to/test_syslog
+"""
+import os
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+sys.path.insert(0, os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', '..', 'tools'))
+import syslog_decode  # noqa: E402
+
+ENCODER = None
+CLIENT = None
+
+
+def strings_from(path):
+    """The host stand-in for the ELF, one section at the 32 bit address of the encoder's rodata."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    strings = syslog_decode.Strings.__new__(syslog_decode.Strings)
+    strings.sections = [(struct.unpack_from('<I', data)[0], data[4:])]
+    strings.cache = {}
+    return strings
+
+
+class BinaryRoundTrip(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        cls.dir = tempfile.TemporaryDirectory()
+        subprocess.run([ENCODER, cls.dir.name], check=True, stdout=subprocess.DEVNULL)
+        cls.strings = strings_from(os.path.join(cls.dir.name, 'drom.bin'))
+        with open(os.path.join(cls.dir.name, 'records.bin'), 'rb') as f:
+            cls.records = f.read()
+        with open(os.path.join(cls.dir.name, 'expected.txt'), 'rb') as f:
+            cls.expected = f.read().decode('utf-8')
+
+    @classmethod
+    def tearDownClass(cls):
+        cls.dir.cleanup()
+
+    def test_decodes_like_vsnprintf(self):
+        self.assertEqual(self.expected, ''.join(syslog_decode.decode(self.records, self.strings)))
+
+    def test_without_the_elf(self):
+        lines = list(syslog_decode.decode(self.records, None))
+        self.assertTrue(lines[0].startswith('<binary record 0x'))
+        # Text records do not need it.
+        self.assertEqual('runtime format 1\n', lines[-1])
+
+    def test_unknown_address_and_truncated_record(self):
+        record = struct.pack('<HIB', 5, 0x10, 0)
+        self.assertIn('is not in the ELF', ''.join(syslog_decode.decode(record, self.strings)))
+        first = self.records[:2 + struct.unpack_from('<H', self.records)[0]]
+        second = self.records[len(first):]
+        size = struct.unpack_from('<H', second)[0]
+        # A record cut short in its arguments.
+        cut = struct.pack('<H', size - 3) + second[2:size - 1]
+        self.assertIn('<undecodable record', ''.join(syslog_decode.decode(cut, self.strings)))
+
+
+def message(number, msg, msgid='-', drops=None):
+    """One message the way main/network/syslog.c frames it, `LEN SP MSG`."""
+    sd = '[meta sequenceId="%d"]' % number
+    if drops is not None:
+        sd += '[drops@32473 dropped="%d" limited="%d"]' % drops
+    body = ('<14>1 - - hydroponics - %s %s %s' % (msgid, sd, msg)).encode()
+    return b'%d %s' % (len(body), body)
+
+
+class Framing(unittest.TestCase):
+    def test_split_messages(self):
+        packet = message(1, 'I (10) wifi: 12 34', drops=(0, 0)) + message(2, '') + message(3, 'x' * 300)
+        messages = list(syslog_decode.split_messages(packet))
+        self.assertEqual(3, len(messages))
+        self.assertTrue(messages[0].endswith(b'I (10) wifi: 12 34'))
+        self.assertTrue(messages[2].endswith(b'x' * 300))
+        self.assertEqual([], list(syslog_decode.split_messages(b'')))
+
+    def test_malformed_framing(self):
+        for packet in [b'<14>1 - - hydroponics', b'12x <14>1', b'12', message(1, 'ok') + b'-3 x']:
+            with self.assertRaises(ValueError):
+                list(syslog_decode.split_messages(packet))
+        with self.assertRaises(ValueError):
+            syslog_decode.parse_message(b'14>1 - - hydroponics - - - msg')
+
+    def test_parse_message(self):
+        data = message(7, 'W (1) ota: failed', drops=(3, 4))
+        msgid, params, msg = syslog_decode.parse_message(next(syslog_decode.split_messages(data)))
+        self.assertEqual('-', msgid)
+        self.assertEqual({'meta': {'sequenceId': '7'}, 'drops@32473': {'dropped': '3', 'limited': '4'}}, params)
+        self.assertEqual(b'W (1) ota: failed', msg)
+
+    def test_crashlog_lines_are_marked(self):
+        packet = message(1, 'E (5) main: before the panic', msgid='crashlog', drops=(0, 0)) + message(2, 'after')
+        lines = list(syslog_decode.receive(packet, None, syslog_decode.Loss(), False))
+        self.assertEqual(['[crashlog] E (5) main: before the panic\n', 'after\n'], lines)
+
+    def test_loss_since_boot(self):
+        loss = syslog_decode.Loss()
+        packets = [message(1, 'a', drops=(0, 0)) + message(2, 'b'), message(5, 'c', drops=(1, 1)),
+                   message(9, 'd', drops=(2, 2))]
+        for packet in packets:
+            list(syslog_decode.receive(packet, None, loss, False))
+        # 3, 4 and 6 to 8 are missing, the device counted 4 of them.
+        self.assertEqual('received 4 of 9, missing 5: dropped on the device 2, rate limited 2, lost on the network ~1',
+                         loss.report())
+
+    def test_loss_when_listening_late(self):
+        loss = syslog_decode.Loss()
+        for packet in [message(100, 'a', drops=(10, 5)), message(110, 'b', drops=(14, 8))]:
+            list(syslog_decode.receive(packet, None, loss, False))
+        # The counters of the first packet are what happened before.
+        self.assertEqual('received 2 of 11, missing 9: dropped on the device 4, rate limited 3, lost on the network ~2',
+                         loss.report())
+        self.assertEqual('no messages', syslog_decode.Loss().report())
+
+
+class Flood(unittest.TestCase):
+    def test_every_gap_is_accounted_for(self):
+        with tempfile.TemporaryDirectory() as directory:
+            subprocess.run([CLIENT, directory], check=True, stdout=subprocess.DEVNULL)
+            with open(os.path.join(directory, 'capture.bin'), 'rb') as f:
+                capture = f.read()
+            with open(os.path.join(directory, 'counters.txt')) as f:
+                lines, dropped, limited, overflows = (int(value) for value in f.read().split())
+        loss = syslog_decode.Loss()
+        received = list(syslog_decode.receive(capture, None, loss, False))
+        self.assertEqual(len(received), len(loss.seen))
+        self.assertEqual(lines, max(loss.seen))
+        if overflows == 0:
+            self.assertEqual('received %d of %d, missing %d: dropped on the device %d, rate limited %d, '
+                             'lost on the network ~0' % (len(received), lines, dropped + limited, dropped, limited),
+                             loss.report())
+
+
+if __name__ == '__main__':
+    ENCODER = sys.argv.pop(1)
+    CLIENT = sys.argv.pop(1)
+    unittest.main()
@@ -0,0 +1,201 @@
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <string.h>
+#include <time.h>
+
+#include "syslog_ring.h"
+#include "test.h"
+
+#define PRODUCERS 4
+#define LINES     200000
+
+typedef struct {
+    uint32_t producer;
+    uint32_t sequence;
+} line_t;
+
+typedef struct {
+    size_t count;
+    size_t max;
+    char lines[64][32];
+} collect_t;
+
+static bool collect(const uint8_t *record, size_t len, void *arg) {
+    collect_t *c = arg;
+    if (c->count == c->max) {
+        return false;
+    }
+    TEST_ASSERT(len < sizeof(c->lines[0]));
+    memcpy(c->lines[c->count], record, len);
+    c->lines[c->count][len] = '\0';
+    c->count++;
+    return true;
+}
+
+static bool skip(const uint8_t *record, size_t len, void *arg) {
+    (void) record;
+    (void) len;
+    (void) arg;
+    return true;
+}
+
+static void drain(void) {
+    syslog_ring_release(syslog_ring_visit(skip, NULL));
+    TEST_ASSERT_EQUAL(0, syslog_ring_visit(skip, NULL));
+}
+
+static void test_records_come_out_in_order(void) {
+    bool was_empty = false;
+    TEST_ASSERT(syslog_ring_push("first", 5, 0, &was_empty));
+    TEST_ASSERT(was_empty);
+    TEST_ASSERT(syslog_ring_push("second", 6, 0, &was_empty));
+    TEST_ASSERT(!was_empty);
+    TEST_ASSERT(syslog_ring_push("", 0, 0, NULL));
+
+    // A visitor that stops gets the same record again on the next visit.
+    collect_t c = {.max = 1};
+    uint32_t consumed = syslog_ring_visit(collect, &c);
+    TEST_ASSERT_EQUAL(1, c.count);
+    TEST_ASSERT(strcmp(c.lines[0], "first") == 0);
+    // Nothing is released until asked, the next visit starts over.
+    c = (collect_t) {.max = 64};
+    TEST_ASSERT_EQUAL(consumed + 16, syslog_ring_visit(collect, &c));
+    TEST_ASSERT_EQUAL(3, c.count);
+    TEST_ASSERT(strcmp(c.lines[1], "second") == 0 && strcmp(c.lines[2], "") == 0);
+    syslog_ring_release(consumed);
+    c = (collect_t) {.max = 64};
+    syslog_ring_release(syslog_ring_visit(collect, &c));
+    TEST_ASSERT_EQUAL(2, c.count);
+    TEST_ASSERT_EQUAL(0, syslog_ring_visit(collect, &c));
+}
+
+// Records never wrap, a filler record skips the end of the buffer and is never handed out.
+static void test_wrap_around(void) {
+    char line[20];
+    for (int i = 0; i < 5000; ++i) {
+        int len = snprintf(line, sizeof(line), "line %d", i);
+        TEST_ASSERT(syslog_ring_push(line, len, 0, NULL));
+        if (i % 7 == 6) {
+            collect_t c = {.max = 64};
+            uint32_t consumed = syslog_ring_visit(collect, &c);
+            TEST_ASSERT_EQUAL(7, c.count);
+            for (int j = 0; j < 7; ++j) {
+                snprintf(line, sizeof(line), "line %d", i - 6 + j);
+                TEST_ASSERT(strcmp(c.lines[j], line) == 0);
+            }
+            syslog_ring_release(consumed);
+        }
+    }
+    drain();
+}
+
+static void test_full_ring_drops(void) {
+    syslog_ring_stats_t before, after;
+    syslog_ring_stats(&before);
+    uint8_t big[SYSLOG_RING_SIZE / 2];
+    memset(big, 'x', sizeof(big));
+    TEST_ASSERT(!syslog_ring_push(big, sizeof(big), 0, NULL));
+
+    uint8_t record[252];
+    memset(record, 'y', sizeof(record));
+    int pushed = 0;
+    while (syslog_ring_push(record, sizeof(record), 0, NULL)) {
+        pushed++;
+    }
+    // One slot less when the free space is split by the end of the buffer.
+    TEST_ASSERT(pushed == SYSLOG_RING_SIZE / 256 || pushed == SYSLOG_RING_SIZE / 256 - 1);
+    drain();
+
+    // The reserve is kept free, e.g. for the lines that report the drops.
+    pushed = 0;
+    while (syslog_ring_push(record, sizeof(record), 1024, NULL)) {
+        pushed++;
+    }
+    TEST_ASSERT(pushed == (SYSLOG_RING_SIZE - 1024) / 256 || pushed == (SYSLOG_RING_SIZE - 1024) / 256 - 1);
+    TEST_ASSERT(syslog_ring_push("fits", 4, 0, NULL));
+    drain();
+
+    syslog_ring_stats(&after);
+    TEST_ASSERT_EQUAL(3, after.dropped - before.dropped);
+}
+
+static _Atomic uint32_t retries;
+
+static void *producer(void *arg) {
+    uint8_t record[128];
+    line_t line = {.producer = (uint32_t) (uintptr_t) arg};
+    for (line.sequence = 0; line.sequence < LINES; ++line.sequence) {
+        size_t len = sizeof(line) + (line.sequence * 7 + line.producer) % (sizeof(record) - sizeof(line));
+        memcpy(record, &line, sizeof(line));
+        for (size_t i = sizeof(line); i < len; ++i) {
+            record[i] = (uint8_t) (line.producer * 31 + line.sequence + i);
+        }
+        while (!syslog_ring_push(record, len, 0, NULL)) {
+            atomic_fetch_add(&retries, 1);
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+typedef struct {
+    uint32_t next[PRODUCERS];
+    uint64_t records;
+} check_t;
+
+static bool check(const uint8_t *record, size_t len, void *arg) {
+    check_t *c = arg;
+    line_t line;
+    TEST_ASSERT(len >= sizeof(line));
+    memcpy(&line, record, sizeof(line));
+    TEST_ASSERT(line.producer < PRODUCERS);
+    // In order and nothing lost for every producer.
+    TEST_ASSERT_EQUAL(c->next[line.producer], line.sequence);
+    TEST_ASSERT_EQUAL(sizeof(line) + (line.sequence * 7 + line.producer) % (128 - sizeof(line)), len);
+    for (size_t i = sizeof(line); i < len; ++i) {
+        TEST_ASSERT_EQUAL((uint8_t) (line.producer * 31 + line.sequence + i), record[i]);
+    }
+    c->next[line.producer]++;
+    c->records++;
+    return true;
+}
+
+// The stress runs the producers and the consumer on their own threads, the time is only printed.
+static void test_concurrent_producers(void) {
+    syslog_ring_stats_t before, after;
+    syslog_ring_stats(&before);
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    pthread_t threads[PRODUCERS];
+    for (uintptr_t i = 0; i < PRODUCERS; ++i) {
+        TEST_ASSERT_EQUAL(0, pthread_create(&threads[i], NULL, producer, (void *) i));
+    }
+    check_t c = {0};
+    while (c.records < (uint64_t) PRODUCERS * LINES) {
+        uint32_t consumed = syslog_ring_visit(check, &c);
+        if (consumed == 0) {
+            sched_yield();
+        }
+        syslog_ring_release(consumed);
+    }
+    for (int i = 0; i < PRODUCERS; ++i) {
+        pthread_join(threads[i], NULL);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double s = (double) (end.tv_sec - start.tv_sec) + (double) (end.tv_nsec - start.tv_nsec) / 1e9;
+    syslog_ring_stats(&after);
+    TEST_ASSERT_EQUAL((uint32_t) PRODUCERS * LINES, after.pushed - before.pushed);
+    TEST_ASSERT_EQUAL(atomic_load(&retries), after.dropped - before.dropped);
+    TEST_ASSERT_EQUAL(0, syslog_ring_visit(check, &c));
+    printf("  %d producers: %.0f records/s, %u pushes retried on a full ring\n", PRODUCERS, c.records / s,
+           atomic_load(&retries));
+}
+
+int main(void) {
+    RUN_TEST(test_records_come_out_in_order);
+    RUN_TEST(test_wrap_around);
+    RUN_TEST(test_full_ring_drops);
+    RUN_TEST(test_concurrent_producers);
+    return 0;
+}
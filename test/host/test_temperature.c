@@ -0,0 +1,152 @@
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "config.h"
+#include "context.h"
+#include "sensors.h"
+#include "simulation.h"
+#include "temperature.h"
+#include "test.h"
+
+// ROM codes of the two simulated probes, the first one sits in the water.
+#define ROM_TANK "0100000000000028"
+#define ROM_AIR  "0200000000000028"
+
+static context_t context = {0};
+static const sensors_driver_t *driver = NULL;
+static config_callback_t callback = NULL;
+static float water = CONTEXT_UNKNOWN_VALUE;
+static int published = 0;
+
+esp_err_t sensors_register(const sensors_driver_t *d) {
+    driver = d;
+    return ESP_OK;
+}
+
+esp_err_t context_get_config(context_t *ctx, const Hydroponics__Config **config) {
+    *config = NULL;
+    return ESP_OK;
+}
+
+esp_err_t config_register(config_callback_t cb) {
+    callback = cb;
+    return ESP_OK;
+}
+
+esp_err_t context_set_temp_water(context_t *ctx, float temp) {
+    water = temp;
+    published++;
+    return ESP_OK;
+}
+
+esp_err_t gpio_set_direction(gpio_num_t gpio, gpio_mode_t mode) {
+    return ESP_OK;
+}
+
+// Off the grid of every resolution, the quantized reading tells the resolution apart.
+float simulation_read(simulation_channel_t channel, float value, float threshold) {
+    return value + 0.3f;
+}
+
+// The configs handed to the callback live on the test stack.
+void context_config_release(const Hydroponics__Config *config) {
+}
+
+typedef struct {
+    int polls;
+    TickType_t ready_ms[OWB_MAX_DEVICES]; /*!< When every probe is collected, from the start of the conversion. */
+    esp_err_t err;
+} sweep_t;
+
+static sweep_t sweep(void) {
+    sweep_t s = {0};
+    water = CONTEXT_UNKNOWN_VALUE;
+    published = 0;
+    TickType_t started = xTaskGetTickCount();
+    TickType_t ready = 0;
+    TEST_ASSERT_EQUAL(ESP_OK, driver->start(&context, driver->arg, &ready));
+    do {
+        TEST_ASSERT(s.polls < OWB_MAX_DEVICES);
+        s.ready_ms[s.polls++] = ready - started;
+        s.err = driver->poll(&context, driver->arg, &ready);
+    } while (s.err == ESP_ERR_NOT_FINISHED);
+    return s;
+}
+
+static void configure(Hydroponics__OneWireProbe *probes, size_t n) {
+    Hydroponics__OneWireProbe *list[OWB_MAX_DEVICES];
+    Hydroponics__Config config = HYDROPONICS__CONFIG__INIT;
+    for (size_t i = 0; i < n; ++i) {
+        list[i] = &probes[i];
+    }
+    config.n_one_wire_probe = n;
+    config.one_wire_probe = list;
+    callback(&config);
+}
+
+// Without any binding the first probe found is the water temperature, every probe converts at 12 bits.
+static void test_first_probe_is_water_without_bindings(void) {
+    sweep_t s = sweep();
+    TEST_ASSERT_EQUAL(ESP_OK, s.err);
+    TEST_ASSERT_EQUAL(2, s.polls);
+    TEST_ASSERT_NEAR(750, s.ready_ms[0], 1);
+    TEST_ASSERT_NEAR(750, s.ready_ms[1], 1);
+    TEST_ASSERT_EQUAL(1, published);
+    TEST_ASSERT_NEAR(19.3125f, water, 1e-4);
+}
+
+// The air probe becomes the water one by its ROM code, the low resolution probe is collected first.
+static void test_probes_bind_by_rom(void) {
+    Hydroponics__OneWireProbe probes[] = {HYDROPONICS__ONE_WIRE_PROBE__INIT, HYDROPONICS__ONE_WIRE_PROBE__INIT};
+    probes[0].rom = ROM_TANK;
+    probes[0].channel = HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__NONE;
+    probes[0].resolution = 10;
+    probes[1].rom = ROM_AIR;
+    probes[1].channel = HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__WATER;
+    probes[1].resolution = 9;
+    configure(probes, 2);
+
+    sweep_t s = sweep();
+    TEST_ASSERT_EQUAL(ESP_OK, s.err);
+    TEST_ASSERT_NEAR(94, s.ready_ms[0], 1);
+    TEST_ASSERT_NEAR(188, s.ready_ms[1], 1);
+    TEST_ASSERT_EQUAL(1, published);
+    TEST_ASSERT_NEAR(23.5f, water, 1e-4);
+}
+
+// A ROM code nobody has binds nothing, the probes found are then only logged, at the default resolution.
+static void test_unknown_rom_and_resolution(void) {
+    Hydroponics__OneWireProbe probes[] = {HYDROPONICS__ONE_WIRE_PROBE__INIT, HYDROPONICS__ONE_WIRE_PROBE__INIT};
+    probes[0].rom = "ec03109779b03128";
+    probes[0].channel = HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__WATER;
+    probes[1].rom = ROM_AIR;
+    probes[1].channel = HYDROPONICS__ONE_WIRE_PROBE__CHANNEL__NONE;
+    probes[1].resolution = 7;
+    configure(probes, 2);
+
+    sweep_t s = sweep();
+    TEST_ASSERT_EQUAL(ESP_OK, s.err);
+    TEST_ASSERT_NEAR(750, s.ready_ms[0], 1);
+    TEST_ASSERT_NEAR(750, s.ready_ms[1], 1);
+    TEST_ASSERT_EQUAL(0, published);
+}
+
+// Dropping the bindings goes back to the first probe.
+static void test_bindings_removed(void) {
+    callback(NULL);
+    sweep_t s = sweep();
+    TEST_ASSERT_EQUAL(1, published);
+    TEST_ASSERT_NEAR(19.3125f, water, 1e-4);
+    TEST_ASSERT_NEAR(750, s.ready_ms[0], 1);
+}
+
+int main(void) {
+    TEST_ASSERT_EQUAL(ESP_OK, temperature_init(&context));
+    TEST_ASSERT(driver != NULL && callback != NULL);
+
+    RUN_TEST(test_first_probe_is_water_without_bindings);
+    RUN_TEST(test_probes_bind_by_rom);
+    RUN_TEST(test_unknown_rom_and_resolution);
+    RUN_TEST(test_bindings_removed);
+    return 0;
+}
@@ -0,0 +1,277 @@
+#!/usr/bin/env python
+"""Receives the syslog packets of the firmware and accounts for the lines that never arrived.
+
+Every packet holds octet counted RFC5424 messages, `LEN SP MSG`, see main/network/syslog.c. Gaps in the meta
+sequenceId are lines that were lost, the drop counters of the first message tell the ones the device gave up on from
+the ones the network lost. Binary records (CONFIG_ESP_SYSLOG_BINARY) are decoded against the ELF of the running
+firmware, see main/network/syslog_binary.h for their layout.
+
+Usage:
+  syslog_decode.py --udp 514 --stats 10
+  syslog_decode.py --elf build/esp32/hydroponics.elf --udp 514
+  syslog_decode.py --elf build/esp32/hydroponics.elf --file capture.bin
+"""
+import argparse
+import re
+import signal
+import socket
+import struct
+import sys
+import time
+
+TEXT = 0
+STRING_REF = 0xffff
+CONVERSION = re.compile(r'%(?P<flags>[-+ #0]*)(?P<width>\*|\d+)?(?:\.(?P<precision>\*|\d*))?'
+                        r'(?P<length>hh|h|ll|l|L|z|j|t)?(?P<conversion>[diouxXeEfFgGaAcspn%])')
+
+
+class Strings:
+    """Reads the NUL terminated strings of the allocated ELF sections by address."""
+
+    def __init__(self, path):
+        from elftools.elf.constants import SH_FLAGS
+        from elftools.elf.elffile import ELFFile
+
+        self.sections = []
+        with open(path, 'rb') as f:
+            elf = ELFFile(f)
+            for section in elf.iter_sections():
+                if section['sh_flags'] & SH_FLAGS.SHF_ALLOC and section['sh_type'] == 'SHT_PROGBITS':
+                    self.sections.append((section['sh_addr'], section.data()))
+        self.cache = {}
+
+    def get(self, addr):
+        if addr in self.cache:
+            return self.cache[addr]
+        for start, data in self.sections:
+            if start <= addr < start + len(data):
+                end = data.index(b'\0', addr - start)
+                value = data[addr - start:end].decode('utf-8', 'replace')
+                self.cache[addr] = value
+                return value
+        raise KeyError('0x%08x is not in the ELF, is it the firmware that is running?' % addr)
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.offset = 0
+
+    def take(self, fmt):
+        value = struct.unpack_from(fmt, self.data, self.offset)
+        self.offset += struct.calcsize(fmt)
+        return value[0]
+
+    def varint(self):
+        value = 0
+        shift = 0
+        while True:
+            if self.offset >= len(self.data):
+                raise struct.error('truncated varint')
+            byte = self.data[self.offset]
+            self.offset += 1
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if byte & 0x80 == 0:
+                return value
+
+    def signed(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+
+def read_string(reader, strings):
+    length = reader.take('<H')
+    if length == STRING_REF:
+        return strings.get(reader.take('<I'))
+    value = reader.data[reader.offset:reader.offset + length]
+    reader.offset += length
+    return value.decode('utf-8', 'replace')
+
+
+def read_arg(reader, strings, conversion):
+    if conversion in 'di':
+        return reader.signed()
+    if conversion in 'uoxXcp':
+        return reader.varint()
+    if conversion in 'eEfFgGaA':
+        return reader.take('<d')
+    if conversion == 's':
+        return read_string(reader, strings)
+    return None
+
+
+def format_line(fmt, reader, strings):
+    def replace(match):
+        conversion = match.group('conversion')
+        if conversion == '%':
+            return '%'
+        flags = match.group('flags')
+        width = match.group('width') or ''
+        precision = match.group('precision')
+        if width == '*':
+            width = str(reader.signed())
+        if precision == '*':
+            precision = str(reader.signed())
+        value = read_arg(reader, strings, conversion)
+        spec = '%' + flags + width + ('.' + precision if precision is not None else '')
+        if conversion == 'n':
+            return ''
+        if conversion == 'c':
+            return (spec + 's') % chr(value)
+        if conversion == 'p':
+            return (spec + 's') % ('0x%x' % value)
+        if conversion in 'aA':
+            return (spec + 's') % float.hex(value)
+        if conversion in 'iu':
+            conversion = 'd'
+        return (spec + conversion) % value
+
+    return CONVERSION.sub(replace, fmt)
+
+
+def decode(data, strings):
+    """Yields the text of every binary record in `data`."""
+    offset = 0
+    while offset + 2 <= len(data):
+        size = struct.unpack_from('<H', data, offset)[0]
+        record = data[offset + 2:offset + 2 + size]
+        offset += 2 + size
+        if len(record) < 4:
+            break
+        reader = Reader(record)
+        addr = reader.take('<I')
+        if addr == TEXT:
+            yield record[4:].decode('utf-8', 'replace')
+            continue
+        if strings is None:
+            yield '<binary record 0x%08x, pass --elf to decode it>\n' % addr
+            continue
+        try:
+            yield format_line(strings.get(addr), reader, strings)
+        except (KeyError, struct.error) as e:
+            yield '<undecodable record 0x%08x: %s>\n' % (addr, e)
+
+
+def split_messages(data):
+    """Yields the messages of a packet, or of a capture of several, framed as `LEN SP MSG`."""
+    offset = 0
+    while offset < len(data):
+        space = data.find(b' ', offset)
+        if space < 0 or not data[offset:space].isdigit():
+            raise ValueError('bad octet count at %d' % offset)
+        size = int(data[offset:space])
+        yield data[space + 1:space + 1 + size]
+        offset = space + 1 + size
+
+
+def parse_message(message):
+    """Splits an RFC5424 message into its MSGID, its structured data, {sd_id: {name: value}}, and its MSG."""
+    header = message.split(b' ', 6)
+    if len(header) < 7 or not header[0].startswith(b'<'):
+        raise ValueError('not an RFC5424 message')
+    rest = header[6]
+    params = {}
+    if rest.startswith(b'-'):
+        rest = rest[1:]
+    while rest.startswith(b'['):
+        end = rest.index(b']')
+        element = rest[1:end].decode('utf-8', 'replace')
+        sd_id, _, pairs = element.partition(' ')
+        params[sd_id] = dict(re.findall(r'(\S+?)="([^"]*)"', pairs))
+        rest = rest[end + 1:]
+    return header[5].decode('ascii', 'replace'), params, rest[1:] if rest.startswith(b' ') else rest
+
+
+class Loss:
+    """Accounts for the sequence numbers that never arrived."""
+
+    def __init__(self):
+        self.seen = set()
+        self.first = None
+        self.last = None
+
+    def message(self, params):
+        number = int(params.get('meta', {}).get('sequenceId', 0))
+        if number:
+            self.seen.add(number)
+        drops = params.get('drops@32473')
+        if drops is not None:
+            counters = (int(drops.get('dropped', 0)), int(drops.get('limited', 0)))
+            self.first = self.first or counters
+            self.last = counters
+
+    def report(self):
+        if not self.seen:
+            return 'no messages'
+        span = max(self.seen) - min(self.seen) + 1
+        missing = span - len(self.seen)
+        # The counters are since boot, when listening since boot they account for every gap.
+        first = (0, 0) if min(self.seen) == 1 else self.first
+        dropped = self.last[0] - first[0] if self.last else 0
+        limited = self.last[1] - first[1] if self.last else 0
+        return ('received %d of %d, missing %d: dropped on the device %d, rate limited %d, lost on the network ~%d'
+                % (len(self.seen), span, missing, dropped, limited, max(missing - dropped - limited, 0)))
+
+
+def receive(data, strings, loss, binary):
+    for message in split_messages(data):
+        msgid, params, msg = parse_message(message)
+        loss.message(params)
+        # Lines the previous boot logged right before a panic or a watchdog reset.
+        prefix = '[crashlog] ' if msgid == 'crashlog' else ''
+        if binary:
+            for line in decode(msg, strings):
+                yield prefix + line
+        else:
+            yield prefix + msg.decode('utf-8', 'replace').rstrip('\n') + '\n'
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--elf', help='ELF of the firmware, to decode binary records')
+    parser.add_argument('--stats', type=float, metavar='SECONDS', help='print the loss accounting this often')
+    parser.add_argument('--quiet', action='store_true', help='do not print the lines, e.g. while flooding')
+    group = parser.add_mutually_exclusive_group(required=True)
+    group.add_argument('--udp', type=int, metavar='PORT', help='listen for syslog packets')
+    group.add_argument('--file', type=argparse.FileType('rb'), help='decode a capture of concatenated packets')
+    args = parser.parse_args()
+
+    strings = Strings(args.elf) if args.elf else None
+    loss = Loss()
+
+    def handle(data):
+        try:
+            for line in receive(data, strings, loss, strings is not None):
+                if not args.quiet:
+                    sys.stdout.write(line)
+        except ValueError as e:
+            sys.stdout.write('<malformed packet: %s>\n' % e)
+        sys.stdout.flush()
+
+    if args.file:
+        handle(args.file.read())
+        sys.stderr.write(loss.report() + '\n')
+        return
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_RCVBUF, 1 << 20)
+    sock.bind(('', args.udp))
+    if args.stats:
+        sock.settimeout(args.stats)
+    reported = time.time()
+    signal.signal(signal.SIGTERM, signal.default_int_handler)
+    try:
+        while True:
+            try:
+                handle(sock.recvfrom(2048)[0])
+            except socket.timeout:
+                pass
+            if args.stats and time.time() - reported >= args.stats:
+                sys.stderr.write(loss.report() + '\n')
+                reported = time.time()
+    except KeyboardInterrupt:
+        sys.stderr.write(loss.report() + '\n')
+
+
+if __name__ == '__main__':
+    main()